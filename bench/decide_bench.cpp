@@ -0,0 +1,125 @@
+/*
+Decide-stage benchmark for the NFV orchestrator
+Builds a synthetic edge topology (RSUs behind a ring of edge servers and one
+regional cloud), deploys a fleet across it and replays synthetic follower
+reports through the offline pipeline, each carrying a full per-node delta with
+drifting hot spots. Prints the orchestrator's own decide() histogram, which
+covers the load model and the whole policy for each report, and the wall time
+of each replayed report (ingest, decide and actuate).
+
+Usage: decide_bench [rsus] [edges] [instances] [reports]
+*/
+
+#include "omnet_orchestrator.h"
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+
+using namespace cosim;
+
+namespace {
+
+std::string topologyJson(size_t rsus, size_t edges) {
+    std::ostringstream json;
+    json << "{\"sites\":[";
+    for (size_t r = 0; r < rsus; ++r) {
+        json << "{\"name\":\"RSU_" << r << "\",\"tier\":\"rsu\",\"cpu\":2,\"memory\":4},";
+    }
+    for (size_t e = 0; e < edges; ++e) {
+        json << "{\"name\":\"EDGE_" << e << "\",\"tier\":\"edge\",\"cpu\":16,\"memory\":32},";
+    }
+    json << "{\"name\":\"CLOUD\",\"tier\":\"cloud\",\"cpu\":256,\"memory\":512}],\"links\":[";
+    for (size_t r = 0; r < rsus; ++r) {
+        json << "{\"from\":\"RSU_" << r << "\",\"to\":\"EDGE_" << r % edges << "\",\"latency_ms\":2.0},";
+    }
+    for (size_t e = 0; e < edges; ++e) {
+        json << "{\"from\":\"EDGE_" << e << "\",\"to\":\"EDGE_" << (e + 1) % edges << "\",\"latency_ms\":1.0},"
+             << "{\"from\":\"EDGE_" << e << "\",\"to\":\"CLOUD\",\"latency_ms\":20.0}"
+             << (e + 1 < edges ? "," : "");
+    }
+    json << "]}";
+    return json.str();
+}
+
+// One NDN_METRICS report with every node's PIT, Content Store, Interest and rate fields
+std::string report(double time, size_t nodes, std::mt19937& rng, std::vector<uint64_t>& interests) {
+    const uint32_t mask = NodeMetricsMatrix::FIELD_PIT | NodeMetricsMatrix::FIELD_CS_HITS |
+                          NodeMetricsMatrix::FIELD_CS_MISSES | NodeMetricsMatrix::FIELD_INTERESTS |
+                          NodeMetricsMatrix::FIELD_RATE;
+    const size_t hotSpot = static_cast<size_t>(time * 7) % nodes;
+    std::uniform_real_distribution<double> noise(0.5, 1.5);
+
+    std::ostringstream json;
+    json << "{\"type\":\"NDN_METRICS\",\"timestamp\":" << time
+         << ",\"avg_latency\":0.04,\"cache_hit_ratio\":0.4,\"pit_size\":" << nodes * 10 << ",\"node_delta\":[";
+    for (size_t n = 0; n < nodes; ++n) {
+        bool hot = (n + nodes - hotSpot) % nodes < nodes / 20;
+        double rate = (hot ? 400.0 : 40.0) * noise(rng);
+        interests[n] += static_cast<uint64_t>(rate);
+        json << (n ? "," : "") << "[" << n << "," << mask << "," << static_cast<int>(rate / 10) << ","
+             << interests[n] * 2 / 5 << "," << interests[n] * 3 / 5 << "," << interests[n] << "," << rate << "]";
+    }
+    json << "]}";
+    return json.str();
+}
+
+} // anonymous namespace
+
+int main(int argc, char* argv[]) {
+    size_t rsus = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000;
+    size_t edges = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 40;
+    size_t instances = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 1500;
+    size_t reports = argc > 4 ? std::strtoul(argv[4], nullptr, 10) : 200;
+    if (rsus == 0 || edges == 0) {
+        std::cerr << "❌ Need at least one RSU and one edge site" << std::endl;
+        return 1;
+    }
+
+    OMNeTOrchestrator orchestrator;
+    orchestrator.setVerbose(false);
+    orchestrator.setPlacementWorkers(1);
+
+    auto started = std::chrono::steady_clock::now();
+    std::string error;
+    if (!orchestrator.loadEdgeTopologyJson(topologyJson(rsus, edges), error)) {
+        std::cerr << "❌ Topology: " << error << std::endl;
+        return 1;
+    }
+    double loadSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+
+    orchestrator.initializeOffline();
+    std::mt19937 rng(3);
+    for (size_t i = 0; i < instances; ++i) {
+        std::string site = i % 4 == 0 ? "EDGE_" + std::to_string(rng() % edges) : "RSU_" + std::to_string(rng() % rsus);
+        orchestrator.deployVNF(static_cast<VNFType>(i % VNF_TYPE_COUNT), site);
+    }
+
+    std::vector<uint64_t> interests(rsus, 0);
+    LatencyHistogram replay;
+    size_t decisions = 0;
+    for (size_t i = 0; i < reports; ++i) {
+        std::string payload = report(1.0 + i * 0.5, rsus, rng, interests);
+        TraceRecord record = {1.0 + i * 0.5, payload.data(), static_cast<uint32_t>(payload.size())};
+        OMNeTOrchestrator::ReplayStep step;
+
+        auto before = std::chrono::steady_clock::now();
+        if (!orchestrator.replayReport(record, step)) {
+            return 1;
+        }
+        replay.record(std::chrono::steady_clock::now() - before);
+        decisions += step.executed.size();
+    }
+
+    std::cout << "📐 " << orchestrator.getEdgeTopology().siteCount() << " sites (loaded in " << loadSeconds << " s), "
+              << orchestrator.getVNFRegistry().size() << " instances at the end, " << rsus << " reporting nodes, "
+              << reports << " reports, " << decisions << " decisions executed" << std::endl;
+    const int labelWidth = 10;
+    LatencyHistogram::printHeader(std::cout, labelWidth);
+    orchestrator.getDecideLatency().printRow(std::cout, "decide", labelWidth);
+    replay.printRow(std::cout, "report", labelWidth);
+    orchestrator.shutdown();
+    return 0;
+}
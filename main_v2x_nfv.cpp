@@ -15,6 +15,7 @@ Implements Leader-Follower architecture with OMNeT++ as time master
 Based on simulation methodology document
 */
 
+#include <algorithm>
 #include <iostream>
 #include <memory>
 #include <string>
@@ -29,10 +30,16 @@ Based on simulation methodology document
 #include "src/common/synchronizer.h"
 #include "src/common/message.h"
 #include "src/common/leader_follower_synchronizer.h"
+#include "src/common/event_log.h"
+#include "src/common/multi_follower_synchronizer.h"
+#include "src/common/metrics_endpoint.h"
+#include "src/common/step_tracer.h"
 
 // Simulator adapters
 #include "src/adapters/ns3_adapter.h"
 #include "src/adapters/omnet_orchestrator.h"
+#include "src/adapters/policy_evaluator.h"
+#include "src/adapters/policy_tuner.h"
 
 // Mock simulators for testing
 #include "src/common/mock_simulators.h"
@@ -50,6 +57,29 @@ void printUsage(const char* programName) {
               << "  --sim-time <seconds>    Simulation duration (default: 120)\n"
               << "  --sync-interval <ms>    Sync interval in ms (default: 100)\n"
               << "  --kathmandu             Use Kathmandu intersection scenario\n"
+              << "  --summarize-trace <f>   Print a summary of an ndnSIM binary event log and exit\n"
+              << "  --partitions <n>        Run ndnSIM as n >= 2 region partitions connected through proxy faces\n"
+              << "                          (partitions report no NDN metrics, so the NFV pipeline sees none)\n"
+              << "  --partition-port <port> Port the partitions connect to (default: leader port + 1)\n"
+              << "  --nfv-rules <file>      Load NFV scaling/migration rules from a JSON rule file\n"
+              << "  --edge-topology <file>  Load edge sites, capacities and link latencies for VNF placement\n"
+              << "  --export-metrics <file> Write the orchestrator's downsampled metrics history as CSV at the end\n"
+              << "  --record-trace <file>   Record every ndnSIM metrics report for offline what-if evaluation\n"
+              << "  --what-if <trace>       Replay a recorded trace through the --policies variants and exit\n"
+              << "  --policies <file>       NFV policy variants (rules, governor settings, sweeps) for --what-if\n"
+              << "  --what-if-csv <file>    Also write the what-if comparison as CSV\n"
+              << "  --tune <trace>          Search NFV thresholds for the cost vs SLA Pareto front on a trace and exit\n"
+              << "                          (starts from the first --policies variant, reads its \"tune\" section)\n"
+              << "  --tune-budget <n>       Replays the tuner may spend (default: 64)\n"
+              << "  --tune-csv <file>       Also write every tuned candidate as CSV\n"
+              << "  --decision-journal <f>  Record every NFV decision and fleet change to a binary journal\n"
+              << "  --replay-journal <f>    Rebuild the NFV state from a decision journal and exit\n"
+              << "  --at <seconds>          Simulation time --replay-journal rebuilds (default: end of journal)\n"
+              << "  --migration-strategy <s> VNF migration strategy: pre-copy|post-copy (default: pre-copy)\n"
+              << "  --migration-bandwidth <Mbps> Backhaul share per VNF migration, 0 migrates instantly (default: 1000)\n"
+              << "  --migration-traffic     Publish migration state transfers to ndnSIM as backhaul load\n"
+              << "  --trace-steps <file>    Trace every step phase per thread and write Chrome/Perfetto JSON at the end\n"
+              << "  --metrics-endpoint <a>  Serve Prometheus metrics at /metrics on <port>, <host>:<port> or a Unix socket path\n"
               << "  --help                  Show this help\n"
               << "\nAvailable NS-3 examples:\n"
               << "  ndn-grid, ndn-simple, ndn-tree-tracers, ndn-congestion-topo-plugin\n"
@@ -79,6 +109,84 @@ bool findAvailablePort(int& port) {
     return false;
 }
 
+// Written whether or not the run completed: a failing run is the one worth looking at
+void exportStepTrace(const std::string& path) {
+    if (path.empty()) {
+        return;
+    }
+    StepTracer& tracer = StepTracer::instance();
+    tracer.disable();
+    if (tracer.exportChromeTrace(path)) {
+        std::cout << "📁 Step trace exported to: " << path << " (" << tracer.spanCount() << " spans";
+        if (tracer.overwrittenSpans() > 0) {
+            std::cout << ", " << tracer.overwrittenSpans() << " oldest overwritten";
+        }
+        std::cout << ")" << std::endl;
+    }
+}
+
+// Scrapes run on the endpoint's reactor thread. The endpoint must be declared after the
+// synchronizer and the orchestrator, so it stops before either is destroyed.
+template <typename Synchronizer>
+bool startMetricsEndpoint(MetricsEndpoint& endpoint, const std::string& address, const Synchronizer& synchronizer,
+                          const OMNeTOrchestrator* orchestrator) {
+    if (address.empty()) {
+        return true;
+    }
+    endpoint.addCollector([&synchronizer](PrometheusWriter& out) { synchronizer.writePrometheus(out); });
+    if (orchestrator) {
+        endpoint.addCollector([orchestrator](PrometheusWriter& out) { orchestrator->writePrometheus(out); });
+    }
+    return endpoint.start(address);
+}
+
+// Post-mortem: fleet and recent decisions at one simulation time, from the journal alone
+int replayDecisionJournal(const std::string& path, double at) {
+    DecisionJournal journal;
+    if (!journal.open(path)) {
+        return 1;
+    }
+    if (at < 0.0) {
+        at = journal.endTime();
+    }
+    std::cout << "📜 Decision journal " << path << ": " << journal.decisionCount() << " decisions, "
+              << journal.snapshotCount() << " snapshots, " << journal.startTime() << "s - "
+              << journal.endTime() << "s" << std::endl;
+    
+    auto started = std::chrono::steady_clock::now();
+    JournalState state;
+    std::vector<JournalDecision> recent;
+    journal.stateAt(at, state);
+    journal.decisionsBetween(at - 10.0, at, recent);
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    
+    std::cout << "\n=== NFV State at " << state.time << "s ===" << std::endl;
+    std::cout << "Rebuilt from the snapshot at " << state.snapshotTime << "s plus " << state.recordsReplayed
+              << " records in " << (elapsed * 1000.0) << " ms" << std::endl;
+    std::cout << "Decisions: " << state.decisions << " (" << state.admitted << " admitted)" << std::endl;
+    std::cout << "Instances: " << state.instances.size() << std::endl;
+    for (const auto& instance : state.instances) {
+        std::cout << "  " << instance.instanceId << " @ " << instance.location
+                  << (instance.state == VNFState::ACTIVE ? "" : " (inactive)") << std::endl;
+    }
+    
+    // The most recent ones; suppressed decisions repeat every report while a cooldown runs
+    const size_t shown = std::min<size_t>(recent.size(), 20);
+    std::cout << "Decisions in the last 10s: " << recent.size() << (shown < recent.size() ? ", newest:" : "")
+              << std::endl;
+    for (size_t i = recent.size() - shown; i < recent.size(); ++i) {
+        const JournalDecision& decision = recent[i];
+        std::cout << "  [" << decision.time << "s] #" << decision.sequence << " " << decision.action << " "
+                  << vnfTypeToString(decision.type) << " x" << decision.targetInstances;
+        if (!decision.source.empty()) {
+            std::cout << " from " << decision.source;
+        }
+        std::cout << " -> " << decision.target << " (" << decision.reason << ", priority " << decision.priority
+                  << ") " << governorVerdictName(decision.verdict) << std::endl;
+    }
+    return 0;
+}
+
 int main(int argc, char* argv[]) {
     std::cout << "=== V2X-NDN-NFV Co-simulation Platform ===" << std::endl;
     std::cout << "Leader-Follower Architecture: OMNeT++ (Leader) ↔ ndnSIM (Follower)" << std::endl;
@@ -93,6 +201,25 @@ int main(int argc, char* argv[]) {
     double simulationTime = 120.0;  // 2 minutes as per methodology
     double syncInterval = 0.1;      // 100ms for V2X requirements
     int serverPort = 0;             // 0 means auto-allocate
+    uint32_t partitions = 0;        // 0 means a single ndnSIM follower
+    int partitionPort = 0;
+    std::string nfvRulesFile;       // Empty means the built-in rule set
+    std::string edgeTopologyFile;   // Empty means the built-in intersection topology
+    std::string metricsExportFile;  // Empty means no metrics history export
+    std::string traceRecordFile;    // Empty means reports are not recorded
+    std::string whatIfTrace;        // Non-empty runs the offline policy evaluation instead
+    std::string policiesFile;
+    std::string whatIfCsvFile;
+    std::string tuneTrace;          // Non-empty runs the offline threshold tuner instead
+    std::string tuneCsvFile;
+    size_t tuneBudget = 0;          // 0 keeps the policy file's or the tuner's default
+    std::string decisionJournalFile;  // Empty means decisions are not journaled
+    std::string replayJournalFile;    // Non-empty rebuilds the NFV state from it instead
+    double replayAt = -1.0;           // Negative means the end of the journal
+    MigrationConfig migrationConfig;
+    bool migrationTraffic = false;    // Publish MIGRATE state transfers for the follower's backhaul
+    std::string stepTraceFile;        // Empty means step phases are not traced
+    std::string metricsEndpoint;      // Empty means no live metrics endpoint
     
     // Parse command line arguments
     for (int i = 1; i < argc; i++) {
@@ -134,6 +261,102 @@ int main(int argc, char* argv[]) {
             useKathmanduScenario = true;
             std::cout << "✓ Using Kathmandu intersection scenario" << std::endl;
             
+        } else if (arg == "--summarize-trace" && i + 1 < argc) {
+            std::string traceFile = argv[++i];
+            EventLogSummary summary;
+            if (!summarizeEventLog(traceFile, summary)) {
+                return 1;
+            }
+            printEventLogSummary(traceFile, summary);
+            return 0;
+            
+        } else if (arg == "--partitions" && i + 1 < argc) {
+            partitions = static_cast<uint32_t>(std::stoul(argv[++i]));
+            if (partitions < 2) {
+                // The scenario only partitions from two regions up; one would never connect
+                std::cerr << "❌ --partitions needs at least 2 partitions" << std::endl;
+                return 1;
+            }
+            std::cout << "✓ ndnSIM partitions: " << partitions << std::endl;
+            
+        } else if (arg == "--partition-port" && i + 1 < argc) {
+            partitionPort = std::stoi(argv[++i]);
+            std::cout << "✓ Partition port: " << partitionPort << std::endl;
+            
+        } else if (arg == "--nfv-rules" && i + 1 < argc) {
+            nfvRulesFile = argv[++i];
+            std::cout << "✓ NFV rules: " << nfvRulesFile << std::endl;
+            
+        } else if (arg == "--edge-topology" && i + 1 < argc) {
+            edgeTopologyFile = argv[++i];
+            std::cout << "✓ Edge topology: " << edgeTopologyFile << std::endl;
+            
+        } else if (arg == "--export-metrics" && i + 1 < argc) {
+            metricsExportFile = argv[++i];
+            std::cout << "✓ Metrics export: " << metricsExportFile << std::endl;
+            
+        } else if (arg == "--record-trace" && i + 1 < argc) {
+            traceRecordFile = argv[++i];
+            std::cout << "✓ Recording metrics trace: " << traceRecordFile << std::endl;
+            
+        } else if (arg == "--what-if" && i + 1 < argc) {
+            whatIfTrace = argv[++i];
+            std::cout << "✓ What-if trace: " << whatIfTrace << std::endl;
+            
+        } else if (arg == "--policies" && i + 1 < argc) {
+            policiesFile = argv[++i];
+            std::cout << "✓ Policy variants: " << policiesFile << std::endl;
+            
+        } else if (arg == "--what-if-csv" && i + 1 < argc) {
+            whatIfCsvFile = argv[++i];
+            std::cout << "✓ What-if export: " << whatIfCsvFile << std::endl;
+            
+        } else if (arg == "--tune" && i + 1 < argc) {
+            tuneTrace = argv[++i];
+            std::cout << "✓ Tuning trace: " << tuneTrace << std::endl;
+            
+        } else if (arg == "--tune-budget" && i + 1 < argc) {
+            tuneBudget = std::stoul(argv[++i]);
+            std::cout << "✓ Tuning budget: " << tuneBudget << " replays" << std::endl;
+            
+        } else if (arg == "--tune-csv" && i + 1 < argc) {
+            tuneCsvFile = argv[++i];
+            std::cout << "✓ Tuning export: " << tuneCsvFile << std::endl;
+            
+        } else if (arg == "--decision-journal" && i + 1 < argc) {
+            decisionJournalFile = argv[++i];
+            std::cout << "✓ Decision journal: " << decisionJournalFile << std::endl;
+            
+        } else if (arg == "--replay-journal" && i + 1 < argc) {
+            replayJournalFile = argv[++i];
+            
+        } else if (arg == "--at" && i + 1 < argc) {
+            replayAt = std::stod(argv[++i]);
+            
+        } else if (arg == "--migration-strategy" && i + 1 < argc) {
+            std::string strategy = argv[++i];
+            if (!parseMigrationStrategy(strategy, migrationConfig.strategy)) {
+                std::cerr << "❌ Unknown migration strategy: " << strategy << std::endl;
+                return 1;
+            }
+            std::cout << "✓ Migration strategy: " << migrationStrategyName(migrationConfig.strategy) << std::endl;
+            
+        } else if (arg == "--migration-bandwidth" && i + 1 < argc) {
+            migrationConfig.bandwidthMbps = std::stod(argv[++i]);
+            std::cout << "✓ Migration bandwidth: " << migrationConfig.bandwidthMbps << " Mbps" << std::endl;
+            
+        } else if (arg == "--migration-traffic") {
+            migrationTraffic = true;
+            std::cout << "✓ Publishing migration traffic to the follower" << std::endl;
+            
+        } else if (arg == "--trace-steps" && i + 1 < argc) {
+            stepTraceFile = argv[++i];
+            std::cout << "✓ Step trace: " << stepTraceFile << std::endl;
+            
+        } else if (arg == "--metrics-endpoint" && i + 1 < argc) {
+            metricsEndpoint = argv[++i];
+            std::cout << "✓ Metrics endpoint: " << metricsEndpoint << std::endl;
+            
         } else if (arg == "--help") {
             printUsage(argv[0]);
             return 0;
@@ -145,6 +368,91 @@ int main(int argc, char* argv[]) {
         }
     }
     
+    if (!replayJournalFile.empty()) {
+        return replayDecisionJournal(replayJournalFile, replayAt);
+    }
+    
+    // Offline tuning: the what-if replay is the objective function
+    if (!tuneTrace.empty()) {
+        WhatIfOptions options;
+        options.kathmanduScenario = useKathmanduScenario;
+        PolicyEvaluator evaluator(options);
+        PolicySpec base;
+        base.name = "baseline";
+        if (!policiesFile.empty()) {
+            if (!evaluator.loadPolicies(policiesFile)) {
+                return 1;
+            }
+            base = evaluator.policies().front();
+        }
+        if (!edgeTopologyFile.empty() && !evaluator.loadEdgeTopology(edgeTopologyFile)) {
+            return 1;
+        }
+        
+        PolicyTuner tuner(evaluator, base);
+        if (policiesFile.empty()) {
+            tuner.useDefaultSpace();
+        } else if (!tuner.loadSpace(policiesFile)) {
+            return 1;
+        }
+        if (tuneBudget > 0) {
+            tuner.options().budget = tuneBudget;
+        }
+        
+        MetricsTrace trace;
+        if (!trace.open(tuneTrace)) {
+            return 1;
+        }
+        std::cout << "▶️  Tuning " << tuner.parameters().size() << " thresholds of " << base.name << " on "
+                  << trace.size() << " reports (" << trace.duration() << "s), " << tuner.options().budget
+                  << " replays" << std::endl;
+        
+        TuneResult result = tuner.tune(trace);
+        tuner.printFront(result);
+        std::cout << "⏱️  Tuned in " << result.wallSeconds << "s" << std::endl;
+        if (!tuneCsvFile.empty() && !tuner.exportSamples(result, tuneCsvFile)) {
+            return 1;
+        }
+        return result.reference.ok ? 0 : 1;
+    }
+    
+    // Offline mode: no simulators, only the recorded reports and the policy variants
+    if (!whatIfTrace.empty()) {
+        if (policiesFile.empty()) {
+            std::cerr << "❌ --what-if needs a --policies file" << std::endl;
+            return 1;
+        }
+        
+        WhatIfOptions options;
+        options.kathmanduScenario = useKathmanduScenario;
+        PolicyEvaluator evaluator(options);
+        if (!evaluator.loadPolicies(policiesFile)) {
+            return 1;
+        }
+        if (!edgeTopologyFile.empty() && !evaluator.loadEdgeTopology(edgeTopologyFile)) {
+            return 1;
+        }
+        
+        MetricsTrace trace;
+        if (!trace.open(whatIfTrace)) {
+            return 1;
+        }
+        std::cout << "▶️  Replaying " << trace.size() << " reports (" << trace.duration() << "s) through "
+                  << evaluator.policies().size() << " policies" << std::endl;
+        
+        auto started = std::chrono::steady_clock::now();
+        std::vector<PolicyResult> results = evaluator.evaluate(trace);
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+        
+        PolicyEvaluator::printComparison(results, evaluator.options().slaLatency);
+        PolicyEvaluator::printClassComparison(results);
+        std::cout << "⏱️  Evaluated " << results.size() << " policies in " << elapsed << "s" << std::endl;
+        if (!whatIfCsvFile.empty() && !PolicyEvaluator::exportComparison(results, whatIfCsvFile)) {
+            return 1;
+        }
+        return 0;
+    }
+    
     try {
         // Create configuration
         Config config;
@@ -159,9 +467,15 @@ int main(int argc, char* argv[]) {
         std::cout << "Traffic density: " << trafficDensity << std::endl;
         std::cout << "Scenario: " << (useKathmanduScenario ? "Kathmandu intersection" : "Generic") << std::endl;
         
+        // Before any simulator thread starts, so every thread gets its row
+        if (!stepTraceFile.empty()) {
+            StepTracer::instance().enable();
+        }
+        
         // Create simulators based on configuration
         std::unique_ptr<SimulatorInterface> orchestrator;  // OMNeT++ (Leader)
         std::unique_ptr<SimulatorInterface> ndnSimulator;  // NS-3 (Follower)
+        OMNeTOrchestrator* nfvOrchestrator = nullptr;      // Set when the real orchestrator leads
         
         // Dynamic port allocation
         int dynamicPort = (serverPort > 0) ? serverPort : 9999;
@@ -177,17 +491,74 @@ int main(int argc, char* argv[]) {
             auto omnetOrch = std::make_unique<OMNeTOrchestrator>();
             omnetOrch->setTrafficDensity(trafficDensity);
             omnetOrch->setScenarioType(useKathmanduScenario ? "kathmandu_intersection" : "generic");
+            if (!nfvRulesFile.empty() && !omnetOrch->loadNFVRules(nfvRulesFile)) {
+                return 1;
+            }
+            if (!edgeTopologyFile.empty() && !omnetOrch->loadEdgeTopology(edgeTopologyFile)) {
+                return 1;
+            }
+            if (!traceRecordFile.empty() && !omnetOrch->recordTrace(traceRecordFile)) {
+                return 1;
+            }
+            if (!decisionJournalFile.empty() && !omnetOrch->recordDecisions(decisionJournalFile)) {
+                return 1;
+            }
+            omnetOrch->setMigrationConfig(migrationConfig);
+            omnetOrch->setMigrationTraffic(migrationTraffic);
             // Start as leader with dynamic port
             if (!omnetOrch->startAsLeader(dynamicPort)) {
                 std::cerr << "❌ Failed to start OMNeT++ orchestrator as leader" << std::endl;
                 return 1;
             }
+            nfvOrchestrator = omnetOrch.get();
             orchestrator = std::move(omnetOrch);
         } else {
             std::cout << "\n=== Using Mock OMNeT++ Orchestrator (Leader) ===" << std::endl;
             orchestrator = std::make_unique<MockOMNeTSimulator>();
         }
         
+        // Partitioned ndnSIM: region followers connect on their own port and are
+        // advanced in lookahead windows by the multi-follower synchronizer
+        if (partitions > 0) {
+            if (partitionPort == 0) {
+                partitionPort = dynamicPort + 1;
+                if (!findAvailablePort(partitionPort)) {
+                    std::cerr << "❌ No available partition port found" << std::endl;
+                    return 1;
+                }
+            }
+            
+            MultiFollowerSynchronizer synchronizer(config, partitionPort, partitions);
+            synchronizer.setLeader(orchestrator.get());
+            MetricsEndpoint endpoint;
+            if (!startMetricsEndpoint(endpoint, metricsEndpoint, synchronizer, nfvOrchestrator)) {
+                return 1;
+            }
+            
+            std::cout << "\n=== Initializing Partitioned Co-simulation ===" << std::endl;
+            std::cout << "Start " << partitions << " ndnSIM partitions with --partition=<i> --partitions="
+                      << partitions << " --partition-port=" << partitionPort << std::endl;
+            
+            if (!synchronizer.initialize()) {
+                std::cerr << "❌ Failed to initialize partitioned co-simulation" << std::endl;
+                return 1;
+            }
+            
+            bool completed = synchronizer.run();
+            exportStepTrace(stepTraceFile);
+            if (!completed) {
+                std::cerr << "❌ Partitioned co-simulation failed during execution" << std::endl;
+                return 1;
+            }
+            
+            synchronizer.printPerformanceSummary();
+            if (nfvOrchestrator && !metricsExportFile.empty()) {
+                nfvOrchestrator->exportMetrics(metricsExportFile);
+            }
+            std::cout << "\n🎉 V2X-NDN-NFV Co-simulation platform completed successfully!" << std::endl;
+            return 0;
+        }
+        
         // Initialize NS-3/ndnSIM (Follower)
         if (useRealNS3) {
             std::cout << "\n=== Initializing NS-3/ndnSIM (Follower) ===" << std::endl;
@@ -205,6 +576,10 @@ int main(int argc, char* argv[]) {
         LeaderFollowerSynchronizer synchronizer(config);
         synchronizer.setLeader(orchestrator.get());
         synchronizer.setFollower(ndnSimulator.get());
+        MetricsEndpoint endpoint;
+        if (!startMetricsEndpoint(endpoint, metricsEndpoint, synchronizer, nfvOrchestrator)) {
+            return 1;
+        }
         
         std::cout << "\n=== Initializing Co-simulation Framework ===" << std::endl;
         
@@ -222,7 +597,10 @@ int main(int argc, char* argv[]) {
         
         auto startTime = std::chrono::steady_clock::now();
         
-        if (synchronizer.run()) {
+        bool completed = synchronizer.run();
+        exportStepTrace(stepTraceFile);
+        
+        if (completed) {
             auto endTime = std::chrono::steady_clock::now();
             auto duration = std::chrono::duration_cast<std::chrono::seconds>(endTime - startTime);
             
@@ -233,6 +611,9 @@ int main(int argc, char* argv[]) {
             
             // Print performance summary
             synchronizer.printPerformanceSummary();
+            if (nfvOrchestrator && !metricsExportFile.empty()) {
+                nfvOrchestrator->exportMetrics(metricsExportFile);
+            }
             
         } else {
             std::cerr << "❌ Co-simulation failed during execution" << std::endl;
@@ -4,12 +4,21 @@
 #include "ns3/ndnSIM-module.h"
 #include "ns3/mobility-module.h"
 #include "ns3/netanim-module.h"
-#include "ns3/ndnSIM/utils/tracers/ndn-cs-tracer.hpp"
+#include "ndn-binary-tracer.hpp"
+
+#include <memory>
 
 int main(int argc, char *argv[]) {
     std::cout << "NDN network simulation started." << std::endl;
 
+    std::string binaryTraceFile = "ndn-network.evlog";
+    double traceInterval = 0.0;
+    bool textTraces = false;
+
     ns3::CommandLine cmd;
+    cmd.AddValue("traceFile", "Binary event log written by the NDN tracer", binaryTraceFile);
+    cmd.AddValue("traceInterval", "Aggregate trace records per interval in seconds (0 = per packet)", traceInterval);
+    cmd.AddValue("textTraces", "Also write ASCII/PCAP/NetAnim traces", textTraces);
     cmd.Parse(argc, argv);
 
     // Create nodes
@@ -63,7 +72,7 @@ int main(int argc, char *argv[]) {
     ndnHelper.setPolicy("nfd::cs::lru");
     ndnHelper.Install(allNodes);
 
-    ns3::ndn::CsTracer::InstallAll("cs-trace.txt", ns3::Seconds(1));
+    ns3::ndn::BinaryTracer::InstallAll(binaryTraceFile, ns3::Seconds(traceInterval));
 
     // Routing helper
     ns3::ndn::GlobalRoutingHelper ndnGlobalRoutingHelper;
@@ -124,27 +133,31 @@ int main(int argc, char *argv[]) {
     // Calculate routes
     ns3::ndn::GlobalRoutingHelper::CalculateRoutes();
 
-    // Enable packet tracing
-    ns3::AsciiTraceHelper ascii;
+    // Text traces are verbose and dominate I/O in long runs, so they are opt-in
     std::string traceFile = "ndn-packet-trace.txt";
-    wifiPhy.EnableAsciiAll(ascii.CreateFileStream(traceFile));
-
-    // Enable pcap tracing for detailed packet analysis
-    wifiPhy.EnablePcap("ndn-network", wifiDevices);
-
-    // NetAnim visualization
-    ns3::AnimationInterface anim("ndn-network.xml");
-    anim.SetConstantPosition(rsu.Get(0), 30, 50, 0);
-    anim.SetConstantPosition(vehicles.Get(0), 10, 20, 0);
-    anim.SetConstantPosition(vehicles.Get(1), 30, 20, 0);
-    anim.SetConstantPosition(vehicles.Get(2), 50, 20, 0);
-    anim.UpdateNodeDescription(rsu.Get(0), "RSU");
-    anim.UpdateNodeDescription(vehicles.Get(0), "Vehicle1");
-    anim.UpdateNodeDescription(vehicles.Get(1), "Vehicle2");
-    anim.UpdateNodeDescription(vehicles.Get(2), "Vehicle3");
-    anim.EnablePacketMetadata(true);
-    anim.EnableWifiPhyCounters(ns3::Seconds(0), ns3::Seconds(20), ns3::Seconds(1));
-    anim.EnableWifiMacCounters(ns3::Seconds(0), ns3::Seconds(20), ns3::Seconds(1));
+    std::unique_ptr<ns3::AnimationInterface> anim;
+    if (textTraces) {
+        // Enable packet tracing
+        ns3::AsciiTraceHelper ascii;
+        wifiPhy.EnableAsciiAll(ascii.CreateFileStream(traceFile));
+
+        // Enable pcap tracing for detailed packet analysis
+        wifiPhy.EnablePcap("ndn-network", wifiDevices);
+
+        // NetAnim visualization
+        anim = std::make_unique<ns3::AnimationInterface>("ndn-network.xml");
+        anim->SetConstantPosition(rsu.Get(0), 30, 50, 0);
+        anim->SetConstantPosition(vehicles.Get(0), 10, 20, 0);
+        anim->SetConstantPosition(vehicles.Get(1), 30, 20, 0);
+        anim->SetConstantPosition(vehicles.Get(2), 50, 20, 0);
+        anim->UpdateNodeDescription(rsu.Get(0), "RSU");
+        anim->UpdateNodeDescription(vehicles.Get(0), "Vehicle1");
+        anim->UpdateNodeDescription(vehicles.Get(1), "Vehicle2");
+        anim->UpdateNodeDescription(vehicles.Get(2), "Vehicle3");
+        anim->EnablePacketMetadata(true);
+        anim->EnableWifiPhyCounters(ns3::Seconds(0), ns3::Seconds(20), ns3::Seconds(1));
+        anim->EnableWifiMacCounters(ns3::Seconds(0), ns3::Seconds(20), ns3::Seconds(1));
+    }
 
     // Run simulation
     ns3::Simulator::Stop(ns3::Seconds(20.0));
@@ -152,9 +165,12 @@ int main(int argc, char *argv[]) {
     ns3::Simulator::Destroy();
 
     std::cout << "NDN network simulation completed." << std::endl;
-    std::cout << "Packet trace files generated:" << std::endl;
-    std::cout << "  - ASCII trace: " << traceFile << std::endl;
-    std::cout << "  - PCAP files: ndn-network-*.pcap" << std::endl;
-    std::cout << "  - Animation: ndn-network.xml" << std::endl;
+    std::cout << "Trace files generated:" << std::endl;
+    std::cout << "  - Binary event log: " << binaryTraceFile << std::endl;
+    if (textTraces) {
+        std::cout << "  - ASCII trace: " << traceFile << std::endl;
+        std::cout << "  - PCAP files: ndn-network-*.pcap" << std::endl;
+        std::cout << "  - Animation: ndn-network.xml" << std::endl;
+    }
     return 0;
 }
@@ -21,6 +21,11 @@ This script integrates with existing ndnSIM simulations and sends data to OMNeT+
 #include <iomanip>
 #include <signal.h>  
 #include <errno.h>   
+#include <array>
+#include <memory>
+#include <vector>
+
+#include "event_sampler.h"
 
 using namespace ns3;
 using namespace ns3::ndn;
@@ -37,58 +42,179 @@ void sigpipe_handler(int sig) {
 }
 
 // Data extraction callback class
+//
+// By default every event is exported as one line. With a sample budget, events
+// pass through a stratified sampler instead: exact per-node and per-class counts
+// are exported every interval, together with at most `budget` sampled records
+// carrying a trailing ",w=<weight>" Horvitz-Thompson weight.
 class NDNDataExtractor {
 public:
     // Fix callback signatures - parameters should be in correct order for ndnSIM traces
     static void OnInterestReceived(shared_ptr<const Interest> interest, Ptr<App> app, shared_ptr<Face> face) {
         uint32_t nodeId = app->GetNode()->GetId();
+        Admission admission = Admit(nodeId, COUNT_INTEREST, interest->getName());
+        if (admission.slot == REJECTED) return;
+        
         std::string name = interest->getName().toUri();
         double timestamp = Simulator::Now().GetSeconds();
         
         // Store interest data for co-simulation
         std::ostringstream data;
         data << "NDN_INTEREST," << nodeId << "," << name << "," << timestamp << "," 
-             << interest->getInterestLifetime().count() << "\n";
+             << interest->getInterestLifetime().count();
         
         // Send to co-simulation platform
-        SendToCoSimulation(data.str());
+        Export(admission, data.str());
     }
     
     static void OnDataReceived(shared_ptr<const Data> data, Ptr<App> app, shared_ptr<Face> face) {
         uint32_t nodeId = app->GetNode()->GetId();
+        Admission admission = Admit(nodeId, COUNT_DATA, data->getName());
+        if (admission.slot == REJECTED) return;
+        
         std::string name = data->getName().toUri();
         double timestamp = Simulator::Now().GetSeconds();
         size_t contentSize = data->getContent().size();
         
         // Store data packet info for co-simulation
         std::ostringstream output;
-        output << "NDN_DATA," << nodeId << "," << name << "," << timestamp << "," << contentSize << "\n";
+        output << "NDN_DATA," << nodeId << "," << name << "," << timestamp << "," << contentSize;
         
         // Send to co-simulation platform
-        SendToCoSimulation(output.str());
+        Export(admission, output.str());
     }
     
     static void OnInterestTimedOut(shared_ptr<const Interest> interest, Ptr<App> app) {
         uint32_t nodeId = app->GetNode()->GetId();
+        Admission admission = Admit(nodeId, COUNT_TIMEOUT, interest->getName());
+        if (admission.slot == REJECTED) return;
+        
         std::string name = interest->getName().toUri();
         double timestamp = Simulator::Now().GetSeconds();
         
         std::ostringstream data;
-        data << "NDN_TIMEOUT," << nodeId << "," << name << "," << timestamp << "\n";
+        data << "NDN_TIMEOUT," << nodeId << "," << name << "," << timestamp;
         
-        SendToCoSimulation(data.str());
+        Export(admission, data.str());
     }
     
     static void SendToCoSimulation(const std::string& data);
     static void SetSocket(int socket, bool* active);
     
+    // budget == 0 keeps the unsampled per-event export
+    static void ConfigureSampling(size_t budget, Time interval) {
+        if (budget == 0) return;
+        s_sampler.reset(new cosim::StratifiedSampler<std::string>(budget));
+        s_sampleInterval = interval;
+        Simulator::Schedule(interval, &NDNDataExtractor::PeriodicFlush);
+        NS_LOG_INFO("Sampling NDN events: budget " << budget << " records per " << interval.GetSeconds() << "s");
+    }
+    
+    // Exports exact counts and the interval's samples as one batch
+    static void FlushSamples() {
+        if (!s_sampler) return;
+        
+        double timestamp = Simulator::Now().GetSeconds();
+        std::ostringstream batch;
+        
+        for (uint32_t node = 0; node < s_counts.size(); ++node) {
+            const auto& c = s_counts[node];
+            if (c[COUNT_INTEREST] || c[COUNT_DATA] || c[COUNT_TIMEOUT]) {
+                batch << "NDN_COUNTS," << node << ",*," << timestamp << "," << c[COUNT_INTEREST]
+                      << "," << c[COUNT_DATA] << "," << c[COUNT_TIMEOUT] << "\n";
+            }
+        }
+        s_counts.assign(s_counts.size(), {0, 0, 0});
+        
+        // Per-class Interests, as the unsampled path counts them
+        batch << "NDN_CLASS_COUNTS,0,*," << timestamp
+              << "," << s_classInterests[static_cast<size_t>(cosim::TrafficClass::EMERGENCY)]
+              << "," << s_classInterests[static_cast<size_t>(cosim::TrafficClass::AWARENESS)]
+              << "," << s_classInterests[static_cast<size_t>(cosim::TrafficClass::OTHER)] << "\n";
+        s_classInterests.fill(0);
+        
+        s_sampler->flush([&batch](const std::string& record, cosim::TrafficClass, double weight) {
+            batch << record << ",w=" << weight << "\n";
+        });
+        
+        SendToCoSimulation(batch.str());
+    }
+    
 private:
+    enum CountIndex { COUNT_INTEREST = 0, COUNT_DATA = 1, COUNT_TIMEOUT = 2 };
+    static constexpr long REJECTED = -1;
+    static constexpr long UNSAMPLED = -2;
+    
+    struct Admission {
+        long slot;
+        cosim::TrafficClass cls;
+    };
+    
+    // Counts the event exactly and decides whether its record is built at all
+    static Admission Admit(uint32_t nodeId, CountIndex index, const Name& name) {
+        if (!s_sampler) return {UNSAMPLED, cosim::TrafficClass::OTHER};
+        
+        if (nodeId >= s_counts.size()) {
+            s_counts.resize(nodeId + 1, {0, 0, 0});
+        }
+        s_counts[nodeId][index]++;
+        
+        cosim::TrafficClass cls = ClassifyName(name);
+        if (index == COUNT_INTEREST) {
+            s_classInterests[static_cast<size_t>(cls)]++;
+        }
+        return {s_sampler->reserve(cls), cls};
+    }
+    
+    static void Export(const Admission& admission, std::string record) {
+        if (admission.slot == UNSAMPLED) {
+            SendToCoSimulation(record + "\n");
+        } else {
+            s_sampler->store(admission.cls, admission.slot, std::move(record));
+        }
+    }
+    
+    // Component comparison avoids building the URI for events that are not sampled
+    static cosim::TrafficClass ClassifyName(const Name& name) {
+        static const name::Component emergency("emergency");
+        static const name::Component collision("collision");
+        static const name::Component awareness("awareness");
+        static const name::Component safety("safety");
+        
+        cosim::TrafficClass cls = cosim::TrafficClass::OTHER;
+        for (const auto& component : name) {
+            if (component == emergency || component == collision) {
+                return cosim::TrafficClass::EMERGENCY;
+            }
+            if (component == awareness || component == safety) {
+                cls = cosim::TrafficClass::AWARENESS;
+            }
+        }
+        return cls;
+    }
+    
+    static void PeriodicFlush() {
+        FlushSamples();
+        if (!g_shutdown) {
+            Simulator::Schedule(s_sampleInterval, &NDNDataExtractor::PeriodicFlush);
+        }
+    }
+    
     static int s_socket;
     static bool* s_active;
+    
+    static std::unique_ptr<cosim::StratifiedSampler<std::string>> s_sampler;
+    static std::vector<std::array<uint64_t, 3>> s_counts;
+    static std::array<uint64_t, cosim::TRAFFIC_CLASS_COUNT> s_classInterests;
+    static Time s_sampleInterval;
 };
 
 int NDNDataExtractor::s_socket = -1;
 bool* NDNDataExtractor::s_active = nullptr;
+std::unique_ptr<cosim::StratifiedSampler<std::string>> NDNDataExtractor::s_sampler;
+std::vector<std::array<uint64_t, 3>> NDNDataExtractor::s_counts;
+std::array<uint64_t, cosim::TRAFFIC_CLASS_COUNT> NDNDataExtractor::s_classInterests = {};
+Time NDNDataExtractor::s_sampleInterval = Seconds(1.0);
 
 void NDNDataExtractor::SetSocket(int socket, bool* active) {
     s_socket = socket;
@@ -181,6 +307,7 @@ private:
     
     void StopSimulation() {
         NS_LOG_INFO("Simulation time limit reached - stopping");
+        NDNDataExtractor::FlushSamples();
         m_running = false;
         m_connectionActive = false;
         Simulator::Stop();
@@ -442,9 +569,13 @@ int main(int argc, char *argv[]) {
     CommandLine cmd;
     int port = 9999;
     std::string example = "simple";  // Default to simple
+    uint32_t sampleBudget = 0;
+    double sampleInterval = 1.0;
     
     cmd.AddValue("port", "Communication port", port);
     cmd.AddValue("example", "NDN example type: simple or grid", example);
+    cmd.AddValue("sample-budget", "Sampled event records exported per interval (0 = export every event)", sampleBudget);
+    cmd.AddValue("sample-interval", "Sampling interval in seconds", sampleInterval);
     cmd.Parse(argc, argv);
     
     // Validate example type
@@ -460,6 +591,8 @@ int main(int argc, char *argv[]) {
     NS_LOG_INFO("Starting NDN Co-simulation Script");
     NS_LOG_INFO("Port: " << port << ", Example: " << example);
     
+    NDNDataExtractor::ConfigureSampling(sampleBudget, Seconds(sampleInterval));
+    
     CoSimulationManager manager(port, example);
     manager.Initialize();
     manager.Run();
@@ -0,0 +1,169 @@
+/*
+Binary ndnSIM tracer for the co-simulation scenarios
+Replaces the text CsTracer/L3RateTracer output with the platform's columnar
+event log (src/common/event_log.h), either per packet or aggregated per interval
+
+Copy event_log.h next to the scenario in scratch/ together with this header
+*/
+
+#ifndef NDN_BINARY_TRACER_HPP
+#define NDN_BINARY_TRACER_HPP
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/ndnSIM-module.h"
+#include "ns3/ndnSIM/model/ndn-l3-protocol.hpp"
+#include "ns3/ndnSIM/NFD/daemon/fw/forwarder.hpp"
+
+#include "event_log.h"
+
+#include <map>
+#include <memory>
+#include <tuple>
+#include <unordered_map>
+
+namespace ns3 {
+namespace ndn {
+
+class BinaryTracer {
+public:
+    // Installs on every node; interval == 0 writes one record per packet event
+    static std::shared_ptr<BinaryTracer> InstallAll(const std::string& filename,
+                                                    Time aggregationInterval = Seconds(0),
+                                                    int namePrefixComponents = -1) {
+        auto tracer = std::make_shared<BinaryTracer>(aggregationInterval, namePrefixComponents);
+        if (!tracer->m_writer.open(filename)) {
+            NS_FATAL_ERROR("Cannot open binary trace file " << filename);
+        }
+        for (NodeList::Iterator node = NodeList::Begin(); node != NodeList::End(); ++node) {
+            tracer->Connect(*node);
+        }
+        tracer->ScheduleFlush();
+        Simulator::ScheduleDestroy(&BinaryTracer::Close, tracer.get());
+        s_tracers.push_back(tracer);
+        return tracer;
+    }
+
+    BinaryTracer(Time aggregationInterval, int namePrefixComponents)
+        : m_interval(aggregationInterval), m_prefixComponents(namePrefixComponents) {}
+
+    void Connect(Ptr<Node> node) {
+        Ptr<L3Protocol> l3 = node->GetObject<L3Protocol>();
+        if (!l3) return;
+
+        uint32_t nodeId = node->GetId();
+        m_forwarders.emplace_back(nodeId, l3->getForwarder());
+        m_lastCsHits.push_back(0);
+        m_lastCsMisses.push_back(0);
+
+        l3->TraceConnectWithoutContext("InInterests", MakeBoundCallback(&BinaryTracer::InInterest, this, nodeId));
+        l3->TraceConnectWithoutContext("OutInterests", MakeBoundCallback(&BinaryTracer::OutInterest, this, nodeId));
+        l3->TraceConnectWithoutContext("InData", MakeBoundCallback(&BinaryTracer::InData, this, nodeId));
+        l3->TraceConnectWithoutContext("OutData", MakeBoundCallback(&BinaryTracer::OutData, this, nodeId));
+        l3->TraceConnectWithoutContext("InNack", MakeBoundCallback(&BinaryTracer::InNack, this, nodeId));
+        l3->TraceConnectWithoutContext("OutNack", MakeBoundCallback(&BinaryTracer::OutNack, this, nodeId));
+        l3->TraceConnectWithoutContext("SatisfiedInterests", MakeBoundCallback(&BinaryTracer::Satisfied, this, nodeId));
+        l3->TraceConnectWithoutContext("TimedOutInterests", MakeBoundCallback(&BinaryTracer::TimedOut, this, nodeId));
+    }
+
+    uint64_t EventsWritten() const { return m_writer.eventsWritten(); }
+
+private:
+    using EventType = cosim::eventlog::EventType;
+
+    // Trace sinks; tracer and node id are bound in at connect time
+    static void InInterest(BinaryTracer* t, uint32_t node, const Interest& interest, const Face&) { t->Record(node, cosim::eventlog::IN_INTEREST, interest.getName()); }
+    static void OutInterest(BinaryTracer* t, uint32_t node, const Interest& interest, const Face&) { t->Record(node, cosim::eventlog::OUT_INTEREST, interest.getName()); }
+    static void InData(BinaryTracer* t, uint32_t node, const Data& data, const Face&) { t->Record(node, cosim::eventlog::IN_DATA, data.getName()); }
+    static void OutData(BinaryTracer* t, uint32_t node, const Data& data, const Face&) { t->Record(node, cosim::eventlog::OUT_DATA, data.getName()); }
+    static void InNack(BinaryTracer* t, uint32_t node, const lp::Nack& nack, const Face&) { t->Record(node, cosim::eventlog::IN_NACK, nack.getInterest().getName()); }
+    static void OutNack(BinaryTracer* t, uint32_t node, const lp::Nack& nack, const Face&) { t->Record(node, cosim::eventlog::OUT_NACK, nack.getInterest().getName()); }
+    static void Satisfied(BinaryTracer* t, uint32_t node, const nfd::pit::Entry& entry, const Face&, const Data&) { t->Record(node, cosim::eventlog::SATISFIED, entry.getName()); }
+    static void TimedOut(BinaryTracer* t, uint32_t node, const nfd::pit::Entry& entry) { t->Record(node, cosim::eventlog::TIMED_OUT, entry.getName()); }
+
+    void Record(uint32_t node, EventType type, const Name& name) {
+        uint32_t nameId = Intern(name);
+
+        if (m_interval.IsZero()) {
+            m_writer.append(Simulator::Now().GetSeconds(), node, type, nameId, 1.0);
+        } else {
+            m_counts[std::make_tuple(node, static_cast<uint8_t>(type), nameId)] += 1;
+        }
+    }
+
+    // Interns the name without its trailing (sequence) components so the dictionary stays bounded
+    uint32_t Intern(const Name& name) {
+        Name prefix = name.getPrefix(m_prefixComponents);
+        auto it = m_nameIds.find(prefix);
+        if (it != m_nameIds.end()) return it->second;
+
+        uint32_t id = m_writer.intern(prefix.toUri());
+        m_nameIds.emplace(prefix, id);
+        return id;
+    }
+
+    void ScheduleFlush() {
+        Time period = m_interval.IsZero() ? Seconds(1.0) : m_interval;
+        m_flushEvent = Simulator::Schedule(period, &BinaryTracer::PeriodicFlush, this);
+    }
+
+    void PeriodicFlush() {
+        double now = Simulator::Now().GetSeconds();
+
+        // Content Store outcomes come from forwarder counters, sampled once per period
+        for (size_t i = 0; i < m_forwarders.size(); ++i) {
+            const auto& counters = m_forwarders[i].second->getCounters();
+            uint64_t hits = counters.nCsHits;
+            uint64_t misses = counters.nCsMisses;
+            if (hits != m_lastCsHits[i]) {
+                m_writer.append(now, m_forwarders[i].first,
+                                cosim::eventlog::CS_HIT | cosim::eventlog::AGGREGATED, 0,
+                                static_cast<double>(hits - m_lastCsHits[i]));
+            }
+            if (misses != m_lastCsMisses[i]) {
+                m_writer.append(now, m_forwarders[i].first,
+                                cosim::eventlog::CS_MISS | cosim::eventlog::AGGREGATED, 0,
+                                static_cast<double>(misses - m_lastCsMisses[i]));
+            }
+            m_lastCsHits[i] = hits;
+            m_lastCsMisses[i] = misses;
+        }
+
+        for (const auto& entry : m_counts) {
+            m_writer.append(now, std::get<0>(entry.first),
+                            std::get<1>(entry.first) | cosim::eventlog::AGGREGATED,
+                            std::get<2>(entry.first), static_cast<double>(entry.second));
+        }
+        m_counts.clear();
+
+        ScheduleFlush();
+    }
+
+    void Close() {
+        Simulator::Cancel(m_flushEvent);
+        PeriodicFlush();
+        Simulator::Cancel(m_flushEvent);
+        m_writer.close();
+    }
+
+    cosim::EventLogWriter m_writer;
+    Time m_interval;
+    int m_prefixComponents;
+    EventId m_flushEvent;
+
+    std::unordered_map<Name, uint32_t> m_nameIds;
+    std::map<std::tuple<uint32_t, uint8_t, uint32_t>, uint64_t> m_counts;
+
+    std::vector<std::pair<uint32_t, std::shared_ptr<nfd::Forwarder>>> m_forwarders;
+    std::vector<uint64_t> m_lastCsHits;
+    std::vector<uint64_t> m_lastCsMisses;
+
+    static std::vector<std::shared_ptr<BinaryTracer>> s_tracers;
+};
+
+std::vector<std::shared_ptr<BinaryTracer>> BinaryTracer::s_tracers;
+
+} // namespace ndn
+} // namespace ns3
+
+#endif // NDN_BINARY_TRACER_HPP
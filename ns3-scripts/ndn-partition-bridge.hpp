@@ -0,0 +1,242 @@
+/*
+Partition bridge for running one ndnSIM region per process
+Cross-partition links are replaced by proxy faces: packets sent on them are
+stamped with their arrival time (now + link delay) and handed to the platform,
+which delivers them to the peer partition at the next window barrier. The
+simulator only runs up to the end of each window granted by the platform's
+MultiFollowerSynchronizer, so no packet can arrive in a partition's past.
+
+Copy src/common/partition_protocol.h next to the scenario in scratch/ together
+with this header. Written against the NFD Transport API shipped with ndnSIM 2.8.
+*/
+
+#ifndef NDN_PARTITION_BRIDGE_HPP
+#define NDN_PARTITION_BRIDGE_HPP
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/ndnSIM-module.h"
+#include "ns3/ndnSIM/model/ndn-l3-protocol.hpp"
+#include "ns3/ndnSIM/NFD/daemon/face/face.hpp"
+#include "ns3/ndnSIM/NFD/daemon/face/generic-link-service.hpp"
+#include "ns3/ndnSIM/NFD/daemon/face/transport.hpp"
+
+#include "partition_protocol.h"
+
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <jsoncpp/json/json.h>
+
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+namespace ndn {
+
+class PartitionBridge;
+
+// Transport of a proxy face; sends go to the bridge, receives come from the platform
+class ProxyTransport : public ::nfd::face::Transport {
+public:
+    ProxyTransport(PartitionBridge& bridge, uint32_t linkId, uint32_t peerPartition)
+        : m_bridge(bridge), m_linkId(linkId) {
+        this->setLocalUri(FaceUri("proxy://link" + std::to_string(linkId)));
+        this->setRemoteUri(FaceUri("proxy://partition" + std::to_string(peerPartition)));
+        this->setScope(::ndn::nfd::FACE_SCOPE_NON_LOCAL);
+        this->setPersistency(::ndn::nfd::FACE_PERSISTENCY_PERMANENT);
+        this->setLinkType(::ndn::nfd::LINK_TYPE_POINT_TO_POINT);
+        this->setMtu(::nfd::face::MTU_UNLIMITED);
+    }
+
+    void Deliver(const Block& wire) { this->receive(wire); }
+
+private:
+    void doClose() override { this->setState(::nfd::face::TransportState::CLOSED); }
+    void doSend(const Block& packet, const ::nfd::EndpointId& endpoint) override;
+
+    PartitionBridge& m_bridge;
+    uint32_t m_linkId;
+};
+
+class PartitionBridge {
+public:
+    explicit PartitionBridge(uint32_t partition) : m_partition(partition), m_socket(-1) {}
+    ~PartitionBridge() { Disconnect(); }
+
+    // Attaches a proxy face for a cross-partition link to a local node
+    std::shared_ptr<::nfd::face::Face> AddLink(Ptr<Node> node, uint32_t linkId, uint32_t peerPartition, Time delay) {
+        auto transport = std::make_unique<ProxyTransport>(*this, linkId, peerPartition);
+        Link& link = m_links[linkId];
+        link.info.linkId = linkId;
+        link.info.peerPartition = peerPartition;
+        link.info.delayNs = delay.GetNanoSeconds();
+        link.transport = transport.get();
+
+        auto face = std::make_shared<::nfd::face::Face>(std::make_unique<::nfd::face::GenericLinkService>(),
+                                                        std::move(transport));
+        node->GetObject<L3Protocol>()->addFace(face);
+        return face;
+    }
+
+    bool Connect(const std::string& address, int port) {
+        m_socket = socket(AF_INET, SOCK_STREAM, 0);
+        if (m_socket < 0) return false;
+
+        struct sockaddr_in serverAddr;
+        serverAddr.sin_family = AF_INET;
+        serverAddr.sin_port = htons(port);
+        inet_pton(AF_INET, address.c_str(), &serverAddr.sin_addr);
+
+        for (int attempt = 0; attempt < 10; attempt++) {
+            if (connect(m_socket, (struct sockaddr*)&serverAddr, sizeof(serverAddr)) == 0) {
+                return SendHello();
+            }
+            sleep(2);
+        }
+
+        close(m_socket);
+        m_socket = -1;
+        return false;
+    }
+
+    void Disconnect() {
+        if (m_socket >= 0) {
+            close(m_socket);
+            m_socket = -1;
+        }
+    }
+
+    // Replaces Simulator::Run(): advances one granted window at a time until the platform ends the run
+    void Run() {
+        Json::Value message;
+        while (ReadMessage(message)) {
+            std::string type = message.get("type", "").asString();
+            if (type == cosim::partition::MSG_END) break;
+            if (type != cosim::partition::MSG_GRANT) continue;
+
+            DeliverPackets(message["packets"]);
+
+            Time until = NanoSeconds(message.get("until_ns", 0).asInt64());
+            if (until > Simulator::Now()) {
+                Simulator::Stop(until - Simulator::Now());
+                Simulator::Run();
+            }
+
+            if (!SendDone()) break;
+        }
+    }
+
+    void Send(uint32_t linkId, const Block& wire) {
+        auto it = m_links.find(linkId);
+        if (it == m_links.end()) return;
+
+        Json::Value packet;
+        packet["link"] = linkId;
+        packet["t_ns"] = static_cast<Json::Int64>(Simulator::Now().GetNanoSeconds() + it->second.info.delayNs);
+        packet["wire"] = cosim::partition::base64Encode(wire.wire(), wire.size());
+        m_outbox.append(packet);
+    }
+
+    uint64_t PacketsSent() const { return m_packetsSent; }
+    uint64_t PacketsReceived() const { return m_packetsReceived; }
+
+private:
+    struct Link {
+        cosim::partition::LinkInfo info;
+        ProxyTransport* transport = nullptr;
+    };
+
+    void DeliverPackets(const Json::Value& packets) {
+        std::vector<uint8_t> bytes;
+        for (const auto& packet : packets) {
+            auto it = m_links.find(packet.get("link", 0).asUInt());
+            if (it == m_links.end() || !cosim::partition::base64Decode(packet.get("wire", "").asString(), bytes)) {
+                continue;
+            }
+
+            Block wire(std::make_shared<::ndn::Buffer>(bytes.begin(), bytes.end()));
+            Time arrival = NanoSeconds(packet.get("t_ns", 0).asInt64());
+            Time delay = arrival > Simulator::Now() ? arrival - Simulator::Now() : Seconds(0);
+            Simulator::Schedule(delay, &ProxyTransport::Deliver, it->second.transport, wire);
+            m_packetsReceived++;
+        }
+    }
+
+    bool SendHello() {
+        Json::Value hello;
+        hello["type"] = cosim::partition::MSG_HELLO;
+        hello["partition"] = m_partition;
+        hello["links"] = Json::Value(Json::arrayValue);
+        for (const auto& entry : m_links) {
+            Json::Value link;
+            link["link"] = entry.second.info.linkId;
+            link["peer"] = entry.second.info.peerPartition;
+            link["delay_ns"] = static_cast<Json::Int64>(entry.second.info.delayNs);
+            hello["links"].append(link);
+        }
+        return SendMessage(hello);
+    }
+
+    bool SendDone() {
+        Json::Value done;
+        done["type"] = cosim::partition::MSG_DONE;
+        done["now_ns"] = static_cast<Json::Int64>(Simulator::Now().GetNanoSeconds());
+        m_packetsSent += m_outbox.size();
+        done["packets"].swap(m_outbox);
+        m_outbox = Json::Value(Json::arrayValue);
+        return SendMessage(done);
+    }
+
+    bool SendMessage(const Json::Value& message) {
+        Json::StreamWriterBuilder builder;
+        builder["indentation"] = "";
+        std::string data = Json::writeString(builder, message) + "\n";
+
+        size_t sent = 0;
+        while (sent < data.size()) {
+            ssize_t n = send(m_socket, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+            if (n <= 0) return false;
+            sent += static_cast<size_t>(n);
+        }
+        return true;
+    }
+
+    bool ReadMessage(Json::Value& message) {
+        size_t end;
+        while ((end = m_readBuffer.find('\n')) == std::string::npos) {
+            char buffer[65536];
+            ssize_t n = recv(m_socket, buffer, sizeof(buffer), 0);
+            if (n <= 0) return false;
+            m_readBuffer.append(buffer, static_cast<size_t>(n));
+        }
+
+        std::istringstream stream(m_readBuffer.substr(0, end));
+        m_readBuffer.erase(0, end + 1);
+
+        Json::CharReaderBuilder builder;
+        std::string errors;
+        return Json::parseFromStream(builder, stream, &message, &errors);
+    }
+
+    uint32_t m_partition;
+    int m_socket;
+    std::string m_readBuffer;
+    std::map<uint32_t, Link> m_links;
+    Json::Value m_outbox{Json::arrayValue};
+    uint64_t m_packetsSent = 0;
+    uint64_t m_packetsReceived = 0;
+};
+
+inline void ProxyTransport::doSend(const Block& packet, const ::nfd::EndpointId&) {
+    m_bridge.Send(m_linkId, packet);
+}
+
+} // namespace ndn
+} // namespace ns3
+
+#endif // NDN_PARTITION_BRIDGE_HPP
@@ -11,16 +11,22 @@ Integrates with existing ndnSIM examples and provides real-time metrics
 #include "ns3/mobility-module.h"
 #include "ns3/wifi-module.h"
 #include "ns3/internet-module.h"
+#include "ns3/ndnSIM/apps/ndn-app.hpp"
+#include "ndn-binary-tracer.hpp"
+#include "ndn-partition-bridge.hpp"
 
 #include <sys/socket.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
 #include <unistd.h>
+#include <cmath>
+#include <cstdlib>
 #include <iostream>
 #include <sstream>
 #include <thread>
 #include <mutex>
 #include <fstream>
+#include <vector>
 #include <jsoncpp/json/json.h>
 #include <signal.h>
 
@@ -35,6 +41,20 @@ static std::string g_leaderAddress = "127.0.0.1";
 static int g_leaderPort = 9999;
 static int g_clientSocket = -1;
 static std::string g_ndnExample = "ndn-grid";
+static uint32_t g_vehicleCount = 10;
+static double g_awarenessFrequency = 10.0;
+static double g_emergencyRate = 0.01;
+static std::string g_traceFile = "";
+static double g_traceInterval = 0.0;
+static uint32_t g_partition = 0;
+static uint32_t g_partitions = 1;
+static int g_partitionPort = 10000;
+static double g_backboneDelayMs = 5.0;
+static double g_regionQueryRate = 10.0;
+static double g_migrationScale = 1.0;
+static std::string g_leaderBuffer;          // Unparsed bytes from the leader
+static NodeContainer g_siteNodes;           // RSUs, then the central controller
+static uint32_t g_migrationTransfers = 0;
 
 // NDN Metrics structure matching methodology
 struct NDNMetrics {
@@ -54,6 +74,7 @@ struct NDNMetrics {
 // Global metrics collector
 static NDNMetrics g_metrics;
 static std::mutex g_metricsMutex;
+static uint64_t g_latencySamples = 0;
 
 // Signal handler for graceful shutdown
 void signalHandler(int signum) {
@@ -152,10 +173,7 @@ public:
         std::lock_guard<std::mutex> lock(g_metricsMutex);
         g_metrics.dataCount++;
         
-        // Calculate simple latency (mock - would need real tracking)
-        double currentLatency = 0.05; // 50ms mock latency
-        g_metrics.avgLatency = (g_metrics.avgLatency * (g_metrics.dataCount - 1) + currentLatency) / g_metrics.dataCount;
-        
+        // Latency itself is reported by V2XTrafficApp's "Latency" trace source
         NS_LOG_INFO("Data received: " << data->getName().toUri());
     }
     
@@ -249,6 +267,53 @@ public:
         return SendMessage(message);
     }
     
+    // Drains the leader's socket; commands arrive as back-to-back JSON objects
+    static void ReceiveCommands(std::vector<Json::Value>& commands) {
+        if (g_clientSocket < 0) return;
+        
+        char buffer[4096];
+        ssize_t received;
+        while ((received = recv(g_clientSocket, buffer, sizeof(buffer), MSG_DONTWAIT)) > 0) {
+            g_leaderBuffer.append(buffer, static_cast<size_t>(received));
+        }
+        if (received == 0) {
+            NS_LOG_WARN("Leader closed the connection");
+            close(g_clientSocket);
+            g_clientSocket = -1;
+        }
+        
+        // Split on balanced braces outside strings
+        int depth = 0;
+        bool inString = false;
+        bool escaped = false;
+        size_t start = 0;
+        for (size_t i = 0; i < g_leaderBuffer.size(); ++i) {
+            char c = g_leaderBuffer[i];
+            if (inString) {
+                if (escaped) {
+                    escaped = false;
+                } else if (c == '\\') {
+                    escaped = true;
+                } else if (c == '"') {
+                    inString = false;
+                }
+            } else if (c == '"') {
+                inString = true;
+            } else if (c == '{') {
+                if (depth++ == 0) start = i;
+            } else if (c == '}' && depth > 0 && --depth == 0) {
+                Json::Value command;
+                Json::CharReaderBuilder builder;
+                std::string errors;
+                std::istringstream stream(g_leaderBuffer.substr(start, i + 1 - start));
+                if (Json::parseFromStream(builder, stream, &command, &errors)) {
+                    commands.push_back(std::move(command));
+                }
+            }
+        }
+        g_leaderBuffer.erase(0, depth == 0 ? g_leaderBuffer.size() : start);
+    }
+    
     static bool SendTimeAck() {
         if (g_clientSocket < 0) return false;
         
@@ -274,55 +339,272 @@ void PeriodicMetricsReport() {
     }
 }
 
-// V2X Application for Kathmandu scenario
-// Simple V2X Application - avoiding complex NDN APIs for compilation
-class SimpleV2XApp : public Application {
+// V2X NDN traffic application for the Kathmandu scenario
+//
+// Vehicles emit awareness Interests at a fixed rate and emergency Interests as a
+// Poisson process; RSUs answer both from a pre-signed Data template. Names are
+// expanded from their scheme once at start-up and Interest/Data objects are
+// recycled from a small pool, so the per-packet cost is one Name copy plus a
+// sequence number component.
+class V2XTrafficApp : public ndn::App {
 public:
     static TypeId GetTypeId() {
-        static TypeId tid = TypeId("SimpleV2XApp")
-            .SetParent<Application>()
-            .AddConstructor<SimpleV2XApp>();
+        static TypeId tid = TypeId("V2XTrafficApp")
+            .SetParent<ndn::App>()
+            .AddConstructor<V2XTrafficApp>()
+            .AddAttribute("Consume", "Emit awareness/emergency Interests (vehicle role)",
+                          BooleanValue(true),
+                          MakeBooleanAccessor(&V2XTrafficApp::m_consume),
+                          MakeBooleanChecker())
+            .AddAttribute("Produce", "Answer V2X Interests with Data (RSU role)",
+                          BooleanValue(false),
+                          MakeBooleanAccessor(&V2XTrafficApp::m_produce),
+                          MakeBooleanChecker())
+            .AddAttribute("AwarenessScheme", "Awareness name scheme, %node% expands to the node id",
+                          StringValue("/v2x/awareness/%node%"),
+                          MakeStringAccessor(&V2XTrafficApp::m_awarenessScheme),
+                          MakeStringChecker())
+            .AddAttribute("EmergencyScheme", "Emergency name scheme, %node% expands to the node id",
+                          StringValue("/v2x/emergency/%node%"),
+                          MakeStringAccessor(&V2XTrafficApp::m_emergencyScheme),
+                          MakeStringChecker())
+            .AddAttribute("AwarenessFrequency", "Awareness Interests per second",
+                          DoubleValue(10.0),
+                          MakeDoubleAccessor(&V2XTrafficApp::m_awarenessFrequency),
+                          MakeDoubleChecker<double>(0.0))
+            .AddAttribute("EmergencyRate", "Mean emergency Interests per second (Poisson)",
+                          DoubleValue(0.01),
+                          MakeDoubleAccessor(&V2XTrafficApp::m_emergencyRate),
+                          MakeDoubleChecker<double>(0.0))
+            .AddAttribute("LifeTime", "Interest lifetime",
+                          StringValue("100ms"),
+                          MakeTimeAccessor(&V2XTrafficApp::m_interestLifetime),
+                          MakeTimeChecker())
+            .AddAttribute("PayloadSize", "Virtual payload size of produced Data",
+                          UintegerValue(200),
+                          MakeUintegerAccessor(&V2XTrafficApp::m_payloadSize),
+                          MakeUintegerChecker<uint32_t>())
+            .AddAttribute("Freshness", "Freshness period of produced Data",
+                          StringValue("100ms"),
+                          MakeTimeAccessor(&V2XTrafficApp::m_freshness),
+                          MakeTimeChecker())
+            .AddAttribute("PoolSize", "Upper bound on pooled Interest/Data objects",
+                          UintegerValue(64),
+                          MakeUintegerAccessor(&V2XTrafficApp::m_poolSize),
+                          MakeUintegerChecker<uint32_t>(1))
+            .AddTraceSource("Latency", "Round-trip latency of satisfied V2X Interests",
+                            MakeTraceSourceAccessor(&V2XTrafficApp::m_latencyTrace),
+                            "ns3::V2XTrafficApp::LatencyCallback");
         return tid;
     }
     
-    SimpleV2XApp() : m_running(false) {}
+    typedef void (*LatencyCallback)(Time latency, bool emergency);
+    
+    V2XTrafficApp()
+        : m_consume(true), m_produce(false), m_awarenessFrequency(10.0), m_emergencyRate(0.01),
+          m_payloadSize(200), m_poolSize(64), m_awarenessSeq(0), m_emergencySeq(0),
+          m_interestCursor(0), m_dataCursor(0),
+          m_rand(CreateObject<UniformRandomVariable>()),
+          m_emergencyGap(CreateObject<ExponentialRandomVariable>()) {}
     
 protected:
     void StartApplication() override {
-        m_running = true;
-        std::cout << "V2X App started on node " << GetNode()->GetId() << std::endl;
+        ndn::App::StartApplication();
+        
+        // Expand name schemes once; per-packet names only append a sequence number
+        std::string nodeId = std::to_string(GetNode()->GetId());
+        m_awarenessName = ExpandScheme(m_awarenessScheme, nodeId);
+        m_emergencyName = ExpandScheme(m_emergencyScheme, nodeId);
+        m_awarenessTag = m_awarenessName.getPrefix(2);
+        
+        if (m_produce) {
+            PrepareDataTemplate();
+            ndn::FibHelper::AddRoute(GetNode(), SchemeRoot(m_awarenessScheme), m_face, 0);
+            ndn::FibHelper::AddRoute(GetNode(), SchemeRoot(m_emergencyScheme), m_face, 0);
+        }
         
-        // Schedule periodic awareness messages  
-        ScheduleAwarenessMessage();
+        if (m_consume) {
+            // Random phase so thousands of vehicles do not beacon in lock-step
+            if (m_awarenessFrequency > 0.0) {
+                double period = 1.0 / m_awarenessFrequency;
+                m_awarenessEvent = Simulator::Schedule(Seconds(m_rand->GetValue(0.0, period)),
+                                                       &V2XTrafficApp::SendAwareness, this);
+            }
+            ScheduleEmergency();
+        }
     }
     
     void StopApplication() override {
-        m_running = false;
-        std::cout << "V2X App stopped on node " << GetNode()->GetId() << std::endl;
+        Simulator::Cancel(m_awarenessEvent);
+        Simulator::Cancel(m_emergencyEvent);
+        ndn::App::StopApplication();
     }
     
-    void ScheduleAwarenessMessage() {
-        if (!m_running) return;
+    void OnInterest(std::shared_ptr<const ndn::Interest> interest) override {
+        ndn::App::OnInterest(interest);
+        if (!m_active || !m_produce) return;
         
-        // Simulate V2X awareness message
-        std::cout << "Node " << GetNode()->GetId() 
-                  << " sending V2X awareness at " << Simulator::Now().GetSeconds() << "s" << std::endl;
+        std::shared_ptr<ndn::Data> data = AcquireData();
+        data->setName(interest->getName());
+        data->setFreshnessPeriod(::ndn::time::milliseconds(m_freshness.GetMilliSeconds()));
+        data->setContent(m_payload);
+        data->setSignature(m_signature);
         
-        // Update global metrics
-        g_metrics.emergencyMessages++;
-        g_metrics.safetyMessages++;
-        g_metrics.interestCount++;
+        m_transmittedDatas(data, this, m_face);
+        m_appLink->onReceiveData(*data);
+    }
+    
+    void OnData(std::shared_ptr<const ndn::Data> data) override {
+        ndn::App::OnData(data);
+        if (!m_active) return;
+        
+        const ndn::Name& name = data->getName();
+        if (name.empty() || !name.get(-1).isSequenceNumber()) return;
         
-        // Schedule next message
-        Simulator::Schedule(Seconds(1.0), &SimpleV2XApp::ScheduleAwarenessMessage, this);
+        // Send times are kept in small rings indexed by sequence number
+        uint64_t seq = name.get(-1).toSequenceNumber();
+        bool emergency = !m_awarenessTag.isPrefixOf(name);
+        const std::vector<Time>& sent = emergency ? m_emergencySent : m_awarenessSent;
+        if (!sent.empty()) {
+            m_latencyTrace(Simulator::Now() - sent[seq % sent.size()], emergency);
+        }
     }
     
 private:
-    bool m_running;
+    static ndn::Name ExpandScheme(const std::string& scheme, const std::string& nodeId) {
+        std::string uri = scheme;
+        size_t pos = uri.find("%node%");
+        if (pos != std::string::npos) {
+            uri.replace(pos, 6, nodeId);
+        }
+        return ndn::Name(uri);
+    }
+    
+    // Longest prefix of the scheme that does not depend on the node
+    static ndn::Name SchemeRoot(const std::string& scheme) {
+        size_t pos = scheme.find("%node%");
+        return ndn::Name(pos == std::string::npos ? scheme : scheme.substr(0, pos));
+    }
+    
+    void PrepareDataTemplate() {
+        m_payload = std::make_shared<::ndn::Buffer>(m_payloadSize);
+        
+        // Same fake signature as ndn::Producer, built once instead of per Data
+        ::ndn::SignatureInfo signatureInfo(static_cast<::ndn::tlv::SignatureTypeValue>(255));
+        m_signature.setInfo(signatureInfo);
+        m_signature.setValue(::ndn::makeNonNegativeIntegerBlock(::ndn::tlv::SignatureValue, 0));
+    }
+    
+    void SendAwareness() {
+        SendInterest(m_awarenessName, m_awarenessSeq++, m_awarenessSent);
+        m_awarenessEvent = Simulator::Schedule(Seconds(1.0 / m_awarenessFrequency),
+                                               &V2XTrafficApp::SendAwareness, this);
+    }
+    
+    void ScheduleEmergency() {
+        if (m_emergencyRate <= 0.0) return;
+        m_emergencyGap->SetAttribute("Mean", DoubleValue(1.0 / m_emergencyRate));
+        m_emergencyEvent = Simulator::Schedule(Seconds(m_emergencyGap->GetValue()),
+                                               &V2XTrafficApp::SendEmergency, this);
+    }
+    
+    void SendEmergency() {
+        SendInterest(m_emergencyName, m_emergencySeq++, m_emergencySent);
+        ScheduleEmergency();
+    }
+    
+    void SendInterest(const ndn::Name& base, uint64_t seq, std::vector<Time>& sentRing) {
+        if (!m_active) return;
+        
+        ndn::Name name(base);
+        name.appendSequenceNumber(seq);
+        
+        std::shared_ptr<ndn::Interest> interest = AcquireInterest();
+        interest->setName(name);
+        interest->setCanBePrefix(false);
+        interest->setNonce(m_rand->GetInteger(0, std::numeric_limits<uint32_t>::max()));
+        interest->setInterestLifetime(::ndn::time::milliseconds(m_interestLifetime.GetMilliSeconds()));
+        
+        if (sentRing.empty()) {
+            sentRing.resize(m_poolSize);
+        }
+        sentRing[seq % sentRing.size()] = Simulator::Now();
+        
+        m_transmittedInterests(interest, this, m_face);
+        m_appLink->onReceiveInterest(*interest);
+    }
+    
+    // Reuse a pooled object once the forwarder has dropped every other reference to it
+    template <typename T>
+    std::shared_ptr<T> AcquireFromPool(std::vector<std::shared_ptr<T>>& pool, size_t& cursor) {
+        for (size_t i = 0; i < pool.size(); ++i) {
+            std::shared_ptr<T>& candidate = pool[cursor];
+            cursor = (cursor + 1) % pool.size();
+            if (candidate.use_count() == 1) {
+                return candidate;
+            }
+        }
+        auto fresh = std::make_shared<T>();
+        if (pool.size() < m_poolSize) {
+            pool.push_back(fresh);
+        }
+        return fresh;
+    }
+    
+    std::shared_ptr<ndn::Interest> AcquireInterest() {
+        return AcquireFromPool(m_interestPool, m_interestCursor);
+    }
+    
+    std::shared_ptr<ndn::Data> AcquireData() {
+        return AcquireFromPool(m_dataPool, m_dataCursor);
+    }
+    
+    // Configuration
+    bool m_consume;
+    bool m_produce;
+    std::string m_awarenessScheme;
+    std::string m_emergencyScheme;
+    double m_awarenessFrequency;
+    double m_emergencyRate;
+    Time m_interestLifetime;
+    uint32_t m_payloadSize;
+    Time m_freshness;
+    uint32_t m_poolSize;
+    
+    // Pre-built templates
+    ndn::Name m_awarenessName;
+    ndn::Name m_emergencyName;
+    ndn::Name m_awarenessTag;
+    std::shared_ptr<::ndn::Buffer> m_payload;
+    ::ndn::Signature m_signature;
+    
+    // Runtime state
+    uint64_t m_awarenessSeq;
+    uint64_t m_emergencySeq;
+    std::vector<Time> m_awarenessSent;
+    std::vector<Time> m_emergencySent;
+    std::vector<std::shared_ptr<ndn::Interest>> m_interestPool;
+    std::vector<std::shared_ptr<ndn::Data>> m_dataPool;
+    size_t m_interestCursor;
+    size_t m_dataCursor;
+    EventId m_awarenessEvent;
+    EventId m_emergencyEvent;
+    Ptr<UniformRandomVariable> m_rand;
+    Ptr<ExponentialRandomVariable> m_emergencyGap;
+    TracedCallback<Time, bool> m_latencyTrace;
 };
 
-// Setup Kathmandu intersection topology
-void SetupKathmanduTopology() {
+NS_OBJECT_ENSURE_REGISTERED(V2XTrafficApp);
+
+// Fold measured V2X latencies into the reported metrics
+void OnV2XLatency(Time latency, bool emergency) {
+    std::lock_guard<std::mutex> lock(g_metricsMutex);
+    g_latencySamples++;
+    g_metrics.avgLatency += (latency.GetSeconds() - g_metrics.avgLatency) / g_latencySamples;
+}
+
+// Setup Kathmandu intersection topology; returns the central controller
+Ptr<Node> SetupKathmanduTopology() {
     NS_LOG_INFO("Setting up Kathmandu intersection topology");
     
     // Create nodes for intersection
@@ -330,11 +612,28 @@ void SetupKathmanduTopology() {
     intersectionNodes.Create(5); // 4 RSUs + 1 central controller
     
     NodeContainer vehicles;
-    vehicles.Create(10); // Initial vehicle count
+    vehicles.Create(g_vehicleCount);
     
-    // Install NDN stack
-    ndn::StackHelper ndnHelper;
-    ndnHelper.InstallAll();
+    NodeContainer allNodes;
+    allNodes.Add(intersectionNodes);
+    allNodes.Add(vehicles);
+    
+    // Ad-hoc WiFi so V2X Interests actually reach the RSUs
+    WifiHelper wifi;
+    wifi.SetStandard(WIFI_STANDARD_80211n_5GHZ);
+    wifi.SetRemoteStationManager("ns3::ConstantRateWifiManager",
+                                 "DataMode", StringValue("HtMcs7"),
+                                 "ControlMode", StringValue("HtMcs0"));
+    
+    YansWifiPhyHelper wifiPhy;
+    YansWifiChannelHelper wifiChannel;
+    wifiChannel.SetPropagationDelay("ns3::ConstantSpeedPropagationDelayModel");
+    wifiChannel.AddPropagationLoss("ns3::FriisPropagationLossModel", "Frequency", DoubleValue(5.9e9));
+    wifiPhy.SetChannel(wifiChannel.Create());
+    
+    WifiMacHelper wifiMac;
+    wifiMac.SetType("ns3::AdhocWifiMac", "Ssid", SsidValue(Ssid("Kathmandu-V2X")));
+    wifi.Install(wifiPhy, wifiMac, allNodes);
     
     // Install mobility for vehicles
     MobilityHelper mobility;
@@ -360,30 +659,139 @@ void SetupKathmanduTopology() {
                              "Speed", StringValue("ns3::UniformRandomVariable[Min=5|Max=15]"));
     mobility.Install(vehicles);
     
-    // Install V2X applications  
-    TypeId tid = TypeId::LookupByName("SimpleV2XApp");
-    ApplicationContainer apps;
-    for (auto& node : intersectionNodes) {
-        Ptr<SimpleV2XApp> app = CreateObject<SimpleV2XApp>();
-        node->AddApplication(app);
-        apps.Add(app);
+    // Install NDN stack; broadcast faces need multicast forwarding for V2X names
+    ndn::StackHelper ndnHelper;
+    ndnHelper.SetDefaultRoutes(true);
+    ndnHelper.InstallAll();
+    ndn::StrategyChoiceHelper::InstallAll("/v2x", "/localhost/nfd/strategy/multicast");
+    
+    // RSUs and the controller serve V2X names, vehicles beacon and raise emergencies
+    ndn::AppHelper rsuHelper("V2XTrafficApp");
+    rsuHelper.SetAttribute("Produce", BooleanValue(true));
+    rsuHelper.SetAttribute("Consume", BooleanValue(false));
+    rsuHelper.Install(intersectionNodes);
+    
+    ndn::AppHelper vehicleHelper("V2XTrafficApp");
+    vehicleHelper.SetAttribute("AwarenessFrequency", DoubleValue(g_awarenessFrequency));
+    vehicleHelper.SetAttribute("EmergencyRate", DoubleValue(g_emergencyRate));
+    ApplicationContainer vehicleApps = vehicleHelper.Install(vehicles);
+    
+    for (uint32_t i = 0; i < vehicleApps.GetN(); ++i) {
+        vehicleApps.Get(i)->TraceConnectWithoutContext("Latency", MakeCallback(&OnV2XLatency));
+    }
+    
+    NS_LOG_INFO("Kathmandu topology setup complete: " << vehicles.GetN() << " vehicles, "
+                << intersectionNodes.GetN() << " RSUs");
+    
+    g_siteNodes = intersectionNodes;
+    return intersectionNodes.Get(4);
+}
+
+// NFV site of a node in the intersection scenario: RSU_<i> is RSU i (mod 4), and
+// edge and cloud sites are reached through the central controller
+Ptr<Node> SiteNode(const std::string& site) {
+    if (g_siteNodes.GetN() < 5) return nullptr;
+    if (site.compare(0, 4, "RSU_") == 0) {
+        return g_siteNodes.Get(std::strtoul(site.c_str() + 4, nullptr, 10) % 4);
     }
-    for (auto& node : vehicles) {
-        Ptr<SimpleV2XApp> app = CreateObject<SimpleV2XApp>();
-        node->AddApplication(app);
-        apps.Add(app);
+    return g_siteNodes.Get(4);
+}
+
+// A VNF migration's state transfer as bulk NDN traffic: the target fetches the
+// state from the source in segments paced evenly over the transfer time
+void StartMigrationTransfer(const Json::Value& command) {
+    static const uint32_t SEGMENT_BYTES = 1024;     // Fits one WiFi frame
+    static const Time DRAIN = Seconds(2.0);         // Lets retransmitted segments finish
+    
+    const Json::Value& transfer = command["transfer"];
+    double bytes = transfer.get("bytes", 0.0).asDouble() * g_migrationScale;
+    double seconds = transfer.get("seconds", 0.0).asDouble();
+    std::string from = command.get("source_location", "").asString();
+    std::string to = command.get("target_location", "").asString();
+    Ptr<Node> source = SiteNode(from);
+    Ptr<Node> target = SiteNode(to);
+    if (bytes < 1.0 || seconds <= 0.0 || !source || !target) return;
+    if (source == target) {
+        NS_LOG_INFO("Migration " << from << " -> " << to << " stays behind one node, no transfer traffic");
+        return;
     }
     
-    // Setup basic NDN routing
-    ns3::ndn::StackHelper ndnHelper;
-    ndnHelper.InstallAll();
+    uint32_t segments = static_cast<uint32_t>(std::ceil(bytes / SEGMENT_BYTES));
+    std::string prefix = "/nfv/migration/" + std::to_string(g_migrationTransfers++);
+    
+    ndn::AppHelper producerHelper("ns3::ndn::Producer");
+    producerHelper.SetPrefix(prefix);
+    producerHelper.SetAttribute("PayloadSize", UintegerValue(SEGMENT_BYTES));
+    ApplicationContainer serving = producerHelper.Install(source);
+    
+    ndn::AppHelper consumerHelper("ns3::ndn::ConsumerCbr");
+    consumerHelper.SetPrefix(prefix);
+    consumerHelper.SetAttribute("Frequency", DoubleValue(segments / seconds));
+    consumerHelper.SetAttribute("MaxSeq", IntegerValue(segments));
+    ApplicationContainer fetching = consumerHelper.Install(target);
     
-    ns3::ndn::GlobalRoutingHelper routingHelper;
-    routingHelper.InstallAll();
-    routingHelper.AddOrigins("/kathmandu", intersectionNodes);
-    routingHelper.CalculateRoutes();
+    // Applications installed mid-run start now; stop times are relative to now as well
+    fetching.Stop(Seconds(seconds) + DRAIN);
+    serving.Stop(Seconds(seconds) + DRAIN);
     
-    NS_LOG_INFO("Kathmandu topology setup complete");
+    NS_LOG_INFO("Migration transfer " << prefix << ": " << from << " -> " << to << ", "
+                << segments << " segments over " << seconds << "s");
+}
+
+// NFV commands from the leader; only migrations that carry a transfer load the network
+void PollLeaderCommands() {
+    std::vector<Json::Value> commands;
+    CoSimCommunicator::ReceiveCommands(commands);
+    for (const auto& command : commands) {
+        if (command.get("action", "").asString() == "MIGRATE" && command.isMember("transfer")) {
+            StartMigrationTransfer(command);
+        }
+    }
+    
+    if (g_coSimEnabled && g_clientSocket >= 0) {
+        Simulator::Schedule(Seconds(0.1), &PollLeaderCommands);
+    }
+}
+
+// Partitioned run: this process simulates one intersection region. Region
+// controllers form a backbone line (link i joins region i and i+1) whose links
+// leave the process through proxy faces, so they set the synchronizer's lookahead.
+void SetupPartitionBackbone(ndn::PartitionBridge& bridge, Ptr<Node> gateway) {
+    Time delay = MilliSeconds(g_backboneDelayMs);
+    
+    std::shared_ptr<::nfd::face::Face> westFace;
+    std::shared_ptr<::nfd::face::Face> eastFace;
+    if (g_partition > 0) {
+        westFace = bridge.AddLink(gateway, g_partition - 1, g_partition - 1, delay);
+    }
+    if (g_partition + 1 < g_partitions) {
+        eastFace = bridge.AddLink(gateway, g_partition, g_partition + 1, delay);
+    }
+    
+    // Other regions are reached hop by hop along the line
+    for (uint32_t region = 0; region < g_partitions; ++region) {
+        if (region == g_partition) continue;
+        auto face = (region < g_partition) ? westFace : eastFace;
+        ndn::FibHelper::AddRoute(gateway, "/v2x/region/" + std::to_string(region), face, 1);
+    }
+    ndn::StrategyChoiceHelper::Install(gateway, "/v2x/region", "/localhost/nfd/strategy/best-route");
+    
+    // Each controller serves its region's status and polls the next region's
+    ndn::AppHelper producerHelper("ns3::ndn::Producer");
+    producerHelper.SetPrefix("/v2x/region/" + std::to_string(g_partition));
+    producerHelper.SetAttribute("PayloadSize", StringValue("256"));
+    producerHelper.Install(gateway);
+    
+    if (g_regionQueryRate > 0.0) {
+        uint32_t next = (g_partition + 1) % g_partitions;
+        ndn::AppHelper consumerHelper("ns3::ndn::ConsumerCbr");
+        consumerHelper.SetPrefix("/v2x/region/" + std::to_string(next) + "/status");
+        consumerHelper.SetAttribute("Frequency", DoubleValue(g_regionQueryRate));
+        consumerHelper.Install(gateway);
+    }
+    
+    NS_LOG_INFO("Partition " << g_partition << "/" << g_partitions << " backbone ready, link delay "
+                << g_backboneDelayMs << "ms");
 }
 
 // Run existing ndnSIM example
@@ -443,6 +851,17 @@ int main(int argc, char* argv[]) {
     cmd.AddValue("leader-port", "Leader port", g_leaderPort);
     cmd.AddValue("kathmandu", "Use Kathmandu scenario", g_kathmanduScenario);
     cmd.AddValue("example", "NDN example to run", g_ndnExample);
+    cmd.AddValue("vehicles", "Number of vehicles in the Kathmandu scenario", g_vehicleCount);
+    cmd.AddValue("awareness-hz", "Awareness Interests per vehicle per second", g_awarenessFrequency);
+    cmd.AddValue("emergency-rate", "Mean emergency Interests per vehicle per second", g_emergencyRate);
+    cmd.AddValue("trace-file", "Write NDN events to this binary event log", g_traceFile);
+    cmd.AddValue("trace-interval", "Aggregate trace records per interval in seconds (0 = per packet)", g_traceInterval);
+    cmd.AddValue("partition", "Index of the region simulated by this process", g_partition);
+    cmd.AddValue("partitions", "Number of region partitions (1 = single process)", g_partitions);
+    cmd.AddValue("partition-port", "Platform port for partition synchronization", g_partitionPort);
+    cmd.AddValue("backbone-delay", "Delay of the inter-region backbone links in ms", g_backboneDelayMs);
+    cmd.AddValue("region-query-rate", "Cross-region status Interests per second per region controller", g_regionQueryRate);
+    cmd.AddValue("migration-scale", "Fraction of published migration state sent as transfer traffic", g_migrationScale);
     cmd.Parse(argc, argv);
     
     NS_LOG_INFO("Starting V2X-NDN-NFV Co-simulation (Follower)");
@@ -450,14 +869,29 @@ int main(int argc, char* argv[]) {
     NS_LOG_INFO("Kathmandu scenario: " << (g_kathmanduScenario ? "enabled" : "disabled"));
     NS_LOG_INFO("NDN example: " << g_ndnExample);
     
-    // Connect to leader
-    if (!CoSimCommunicator::ConnectToLeader()) {
+    // Partitions talk only to the partition synchronizer; the leader port does not serve them
+    bool partitioned = g_partitions > 1;
+    if (partitioned) {
+        g_coSimEnabled = false;
+    } else if (!CoSimCommunicator::ConnectToLeader()) {
         NS_LOG_ERROR("Failed to connect to leader, running standalone");
         g_coSimEnabled = false;
     }
     
-    // Setup topology based on scenario
-    if (g_kathmanduScenario) {
+    // Setup topology based on scenario; partitions always simulate one Kathmandu region
+    ndn::PartitionBridge bridge(g_partition);
+    
+    if (partitioned) {
+        if (g_partition >= g_partitions) {
+            NS_LOG_ERROR("Partition index " << g_partition << " out of range");
+            return 1;
+        }
+        SetupPartitionBackbone(bridge, SetupKathmanduTopology());
+        if (!bridge.Connect(g_leaderAddress, g_partitionPort)) {
+            NS_LOG_ERROR("Failed to connect to the partition synchronizer");
+            return 1;
+        }
+    } else if (g_kathmanduScenario) {
         SetupKathmanduTopology();
     } else {
         RunNDNExample(g_ndnExample);
@@ -471,14 +905,25 @@ int main(int argc, char* argv[]) {
     Config::Connect("/NodeList/*/ApplicationList/*/$ns3::ndn::App/TimedOutInterests",
                    MakeCallback(&V2XNDNMetricsCollector::OnInterestTimedOut));
     
-    // Start periodic metrics reporting
+    if (!g_traceFile.empty()) {
+        ndn::BinaryTracer::InstallAll(g_traceFile, Seconds(g_traceInterval));
+    }
+    
+    // Start periodic metrics reporting and polling for leader commands
     if (g_coSimEnabled) {
         Simulator::Schedule(Seconds(1.0), &PeriodicMetricsReport);
+        Simulator::Schedule(Seconds(0.1), &PollLeaderCommands);
     }
     
-    // Run simulation
-    Simulator::Stop(Seconds(120.0)); // 2 minutes as per methodology
-    Simulator::Run();
+    // Run simulation; partitions advance only through windows granted by the platform
+    if (partitioned) {
+        bridge.Run();
+        NS_LOG_INFO("Partition " << g_partition << " proxied " << bridge.PacketsSent() << " packets out, "
+                    << bridge.PacketsReceived() << " in");
+    } else {
+        Simulator::Stop(Seconds(120.0)); // 2 minutes as per methodology
+        Simulator::Run();
+    }
     
     // Cleanup
     if (g_clientSocket >= 0) {
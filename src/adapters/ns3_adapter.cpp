@@ -4,6 +4,8 @@ Independent implementation inspired by ns3-cosim for V2X-NDN-NFV platform
 */
 
 #include "ns3_adapter.h"
+#include "event_sampler.h"
+#include "step_tracer.h"
 #include <iostream>
 #include <sstream>
 #include <unistd.h>
@@ -13,6 +15,7 @@ Independent implementation inspired by ns3-cosim for V2X-NDN-NFV platform
 #include <arpa/inet.h>
 #include <signal.h>
 #include <cstring>
+#include <cmath>
 #include <jsoncpp/json/json.h>
 
 #include <chrono>
@@ -132,6 +135,7 @@ bool ExternalSyncManager::SyncToTime(double targetTime) {
 
 void ExternalSyncManager::CommunicationLoop() {
     std::cout << "Starting communication loop..." << std::endl;
+    StepTracer::nameThread("ns3_io");
     
     while (running_) {
         if (clientSocket_ < 0) {
@@ -150,14 +154,23 @@ void ExternalSyncManager::CommunicationLoop() {
             std::cout << "NS-3 client connected" << std::endl;
         }
         
-        // Handle incoming messages
-        char buffer[1024];
-        ssize_t bytesRead = recv(clientSocket_, buffer, sizeof(buffer) - 1, MSG_DONTWAIT);
+        // Handle incoming messages; sampled exports arrive as multi-line batches,
+        // so dispatch complete lines only and keep any partial tail for the next read
+        char buffer[4096];
+        ssize_t bytesRead = recv(clientSocket_, buffer, sizeof(buffer), MSG_DONTWAIT);
         
         if (bytesRead > 0) {
-            buffer[bytesRead] = '\0';
-            std::string message(buffer);
-            HandleIncomingMessage(message);
+            TraceSpan span("handle_ns3_messages", "io");
+            readBuffer_.append(buffer, static_cast<size_t>(bytesRead));
+            size_t start = 0;
+            size_t end;
+            while ((end = readBuffer_.find('\n', start)) != std::string::npos) {
+                if (end > start) {
+                    HandleIncomingMessage(readBuffer_.substr(start, end - start));
+                }
+                start = end + 1;
+            }
+            readBuffer_.erase(0, start);
         } else if (bytesRead == 0) {
             // Client disconnected
             std::cout << "NS-3 client disconnected" << std::endl;
@@ -296,6 +309,7 @@ void SocketClient::StopAsyncReceive() {
 }
 
 void SocketClient::ReceiveLoop() {
+    StepTracer::nameThread("ns3_receive");
     while (receiving_ && connected_) {
         std::string message = ReceiveMessage();
         if (!message.empty()) {
@@ -471,6 +485,7 @@ bool NS3Adapter::step(double timeStep) {
     }
     
     double targetTime = currentTime_ + timeStep;
+    TraceSpan span("ns3_sync", "follower");
     
     // Synchronize to target time
     if (!syncManager_->SyncToTime(targetTime)) {
@@ -645,6 +660,147 @@ void NS3Adapter::handleNDNMessage(const std::string& message) {
     } else if (message.find("DATA") != std::string::npos) {
         updateStats("ndn_data");
     }
+    
+    // A single read may carry several trace lines from the ns-3 data extractor
+    std::istringstream lines(message);
+    std::string line;
+    while (std::getline(lines, line)) {
+        if (line.compare(0, 4, "NDN_") == 0) {
+            processNDNTraceLine(line);
+        }
+    }
+}
+
+// Parses "NDN_<EVENT>,<nodeId>,<name>,<timestamp>[,...][,w=<weight>]" lines into the per-node matrix.
+// Lines with a weight are samples from a budgeted export; their counts arrive exactly in NDN_COUNTS lines.
+void NS3Adapter::processNDNTraceLine(const std::string& line) {
+    std::istringstream iss(line);
+    std::string event, nodeField, name, timeField;
+    
+    if (!std::getline(iss, event, ',') || !std::getline(iss, nodeField, ',') ||
+        !std::getline(iss, name, ',') || !std::getline(iss, timeField, ',')) {
+        return;
+    }
+    
+    std::vector<std::string> extra;
+    std::string field;
+    while (std::getline(iss, field, ',')) {
+        extra.push_back(field);
+    }
+    
+    uint32_t nodeId = 0;
+    double timestamp = 0.0;
+    double weight = 0.0; // 0 = unsampled export
+    std::vector<uint64_t> counts;
+    try {
+        nodeId = static_cast<uint32_t>(std::stoul(nodeField));
+        timestamp = std::stod(timeField);
+        if (!extra.empty() && extra.back().compare(0, 2, "w=") == 0) {
+            weight = std::stod(extra.back().substr(2));
+            extra.pop_back();
+        }
+        if (event == "NDN_COUNTS" || event == "NDN_CLASS_COUNTS") {
+            for (const auto& value : extra) {
+                counts.push_back(std::stoull(value));
+            }
+        }
+    } catch (const std::exception&) {
+        return;
+    }
+    
+    std::lock_guard<std::mutex> lock(metricsMutex_);
+    
+    if (event == "NDN_COUNTS") {
+        if (counts.size() >= 3) {
+            nodeMetrics_.addCounts(nodeId, counts[0], counts[1], counts[2]);
+        }
+        return;
+    }
+    if (event == "NDN_CLASS_COUNTS") {
+        if (counts.size() >= 2) {
+            ndnStats_.emergencyMessages += counts[0];
+            ndnStats_.safetyMessages += counts[1];
+        }
+        return;
+    }
+    
+    if (event == "NDN_INTEREST") {
+        // Sampled Interests stand for `weight` requests of their class
+        popularity_.record(name, weight > 0.0 ? static_cast<uint32_t>(std::lround(weight)) : 1);
+    }
+    
+    if (weight > 0.0) {
+        // Only classes kept in full (weight 1) have both ends of an exchange in the sample
+        if (weight != 1.0) return;
+        
+        if (event == "NDN_INTEREST") {
+            trackPendingInterest(name, nodeId, timestamp);
+        } else if (event == "NDN_DATA" || event == "NDN_TIMEOUT") {
+            auto it = pendingInterests_.find(name);
+            if (it != pendingInterests_.end()) {
+                if (event == "NDN_DATA") {
+                    nodeMetrics_.recordLatency(it->second.first, timestamp - it->second.second);
+                }
+                pendingInterests_.erase(it);
+            }
+        }
+        return;
+    }
+    
+    if (event == "NDN_INTEREST") {
+        TrafficClass cls = classifyName(name);
+        if (cls == TrafficClass::EMERGENCY) {
+            ndnStats_.emergencyMessages++;
+        } else if (cls == TrafficClass::AWARENESS) {
+            ndnStats_.safetyMessages++;
+        }
+
+        nodeMetrics_.recordInterest(nodeId);
+        trackPendingInterest(name, nodeId, timestamp);
+    } else if (event == "NDN_DATA" || event == "NDN_TIMEOUT") {
+        // Attribute the outcome to the node that issued the Interest, when known
+        auto it = pendingInterests_.find(name);
+        if (it != pendingInterests_.end()) {
+            if (event == "NDN_DATA") {
+                nodeMetrics_.recordData(it->second.first, timestamp - it->second.second);
+            } else {
+                nodeMetrics_.recordTimeout(it->second.first);
+            }
+            pendingInterests_.erase(it);
+        } else if (event == "NDN_DATA") {
+            nodeMetrics_.recordData(nodeId, -1.0);
+        } else {
+            nodeMetrics_.recordTimeout(nodeId);
+        }
+    } else if (event == "NDN_CS_HIT") {
+        nodeMetrics_.recordCacheHit(nodeId);
+    } else if (event == "NDN_CS_MISS") {
+        nodeMetrics_.recordCacheMiss(nodeId);
+    }
+}
+
+// Sweeps out stale entries every PENDING_INTEREST_MAX_AGE; between sweeps the map is
+// capped, and Interests beyond the cap go untracked (caller holds metricsMutex_)
+void NS3Adapter::trackPendingInterest(const std::string& name, uint32_t nodeId, double timestamp) {
+    if (timestamp - lastPendingSweep_ >= PENDING_INTEREST_MAX_AGE) {
+        for (auto it = pendingInterests_.begin(); it != pendingInterests_.end();) {
+            if (timestamp - it->second.second >= PENDING_INTEREST_MAX_AGE) {
+                it = pendingInterests_.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        lastPendingSweep_ = timestamp;
+    }
+    
+    if (pendingInterests_.size() < MAX_PENDING_INTERESTS) {
+        pendingInterests_[name] = {nodeId, timestamp};
+    } else {
+        auto it = pendingInterests_.find(name);
+        if (it != pendingInterests_.end()) {
+            it->second = {nodeId, timestamp};
+        }
+    }
 }
 
 void NS3Adapter::handleVehicleMessage(const std::string& message) {
@@ -737,12 +893,15 @@ NDNMetrics NS3Adapter::collectNDNMetrics() const {
     metrics.cacheHitRatio = (ndnStats_.interests > 0) 
                            ? static_cast<double>(ndnStats_.cacheHits) / ndnStats_.interests : 0.0;
     metrics.unsatisfiedInterests = ndnStats_.timeouts;
+    metrics.emergencyMessages = static_cast<uint32_t>(ndnStats_.emergencyMessages);
+    metrics.safetyMessages = static_cast<uint32_t>(ndnStats_.safetyMessages);
     
     return metrics;
 }
 
 void NS3Adapter::sendMetricsToLeader() {
     if (leaderSocket_ < 0) return;
+    TraceSpan span("send_metrics", "io");
     
     NDNMetrics metrics = collectNDNMetrics();
     
@@ -756,8 +915,24 @@ void NS3Adapter::sendMetricsToLeader() {
     json["interest_count"] = static_cast<Json::UInt64>(metrics.interestCount);
     json["data_count"] = static_cast<Json::UInt64>(metrics.dataCount);
     json["fib_entries"] = metrics.fibEntries;
+    json["emergency_messages"] = metrics.emergencyMessages;
+    json["safety_messages"] = metrics.safetyMessages;
+    
+    // Only rows that changed since the previous report are sent
+    {
+        std::lock_guard<std::mutex> lock(metricsMutex_);
+        double now = getCurrentTime();
+        nodeMetrics_.encodeDelta(now - lastMetricsReportTime_, json["node_delta"]);
+        lastMetricsReportTime_ = now;
+        
+        if (!popularity_.empty()) {
+            popularity_.encode(json["popularity"]);
+            popularity_.clear();
+        }
+    }
     
     Json::StreamWriterBuilder builder;
+    builder["indentation"] = "";
     std::string message = Json::writeString(builder, json) + "\n";
     
     send(leaderSocket_, message.c_str(), message.length(), MSG_NOSIGNAL);
@@ -8,6 +8,8 @@ Inspired by ns3-cosim but built independently for V2X-NDN-NFV platform
 
 #include "synchronizer.h"
 #include "message.h"
+#include "node_metrics.h"
+#include "popularity_sketch.h"
 #include <string>
 #include <thread>
 #include <atomic>
@@ -17,6 +19,7 @@ Inspired by ns3-cosim but built independently for V2X-NDN-NFV platform
 #include <functional>
 #include <memory>
 #include <chrono>
+#include <unordered_map>
 #include <sys/socket.h>
 #include <netinet/in.h>
 #include <unistd.h>
@@ -71,6 +74,7 @@ private:
     
     int serverSocket_;
     int clientSocket_;
+    std::string readBuffer_;
     std::thread communicationThread_;
     
     std::function<void(double)> syncCallback_;
@@ -200,6 +204,7 @@ public:
     
     // Method to update NDN statistics from callbacks
     void updateNDNStats(const std::string& event, double latency = 0.0);
+    const NodeMetricsMatrix& getNodeMetrics() const { return nodeMetrics_; }
     
     // NS-3 example configuration
     void setNS3Example(const std::string& example) { ns3Example_ = example; }
@@ -230,6 +235,8 @@ private:
     std::string formatVehicleUpdate(const VehicleInfo& vehicle);
     void processNDNInterest(const std::string& message);
     void processNDNData(const std::string& message);
+    void processNDNTraceLine(const std::string& line);
+    void trackPendingInterest(const std::string& name, uint32_t nodeId, double timestamp);
     
     // Configuration
     std::string ns3ScriptPath_;
@@ -275,11 +282,26 @@ private:
         uint64_t dataPackets = 0;
         uint64_t satisfiedInterests = 0;
         double totalLatency = 0.0;
+        uint64_t emergencyMessages = 0;
+        uint64_t safetyMessages = 0;
     };
     
     NDNStatistics ndnStats_;
     int leaderSocket_ = -1;
     
+    // Per-node metrics matrix, shipped to the leader as a sparse delta each report
+    NodeMetricsMatrix nodeMetrics_;
+    std::unordered_map<std::string, std::pair<uint32_t, double>> pendingInterests_; // name -> (node, time)
+    double lastPendingSweep_ = 0.0;
+    
+    // Interests whose Data or timeout line never arrives are dropped after this long
+    static constexpr double PENDING_INTEREST_MAX_AGE = 10.0;    // Simulation seconds
+    static constexpr size_t MAX_PENDING_INTERESTS = 65536;
+    double lastMetricsReportTime_ = 0.0;
+    
+    // Interest name popularity for the current report window, merged by the leader
+    PopularitySketch popularity_;
+    
     // Statistics and monitoring
     struct SimulationStats {
         uint64_t messagesSent;
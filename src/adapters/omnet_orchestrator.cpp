@@ -4,34 +4,84 @@ Leader in V2X-NDN-NFV Co-simulation
 */
 
 #include "omnet_orchestrator.h"
+#include "../common/metrics_endpoint.h"
+#include "../common/step_tracer.h"
 #include <iostream>
 #include <sstream>
 #include <algorithm>
+#include <cmath>
 #include <random>
 #include <fstream>
 #include <iomanip>
+#include <iterator>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
 #include <arpa/inet.h>
 #include <jsoncpp/json/json.h>
 
 namespace cosim {
 
+namespace {
+
+// Reported NDNMetrics fields kept in the metrics history, in recordReportedHistory order
+const char* const REPORTED_HISTORY_SERIES[] = {
+    "pit_size", "fib_entries", "cache_hit_ratio", "interest_count", "data_count", "avg_latency",
+    "unsatisfied_interests", "emergency_messages", "safety_messages", "network_utilization"
+};
+
+constexpr size_t REPORTED_HISTORY_COUNT = sizeof(REPORTED_HISTORY_SERIES) / sizeof(REPORTED_HISTORY_SERIES[0]);
+
+// Prometheus name and help of each reported field, in REPORTED_HISTORY_SERIES order
+const char* const REPORTED_GAUGES[][2] = {
+    {"cosim_ndn_pit_entries", "PIT entries in the latest ndnSIM report"},
+    {"cosim_ndn_fib_entries", "FIB entries in the latest ndnSIM report"},
+    {"cosim_ndn_cache_hit_ratio", "Content store hit ratio in the latest ndnSIM report"},
+    {"cosim_ndn_interests", "Interests counted in the latest ndnSIM report"},
+    {"cosim_ndn_data", "Data packets counted in the latest ndnSIM report"},
+    {"cosim_ndn_latency_seconds", "Average Interest-Data latency in the latest ndnSIM report"},
+    {"cosim_ndn_unsatisfied_interests", "Unsatisfied Interests in the latest ndnSIM report"},
+    {"cosim_ndn_emergency_messages", "Emergency messages in the latest ndnSIM report"},
+    {"cosim_ndn_safety_messages", "Safety messages in the latest ndnSIM report"},
+    {"cosim_ndn_network_utilization", "Network utilization in the latest ndnSIM report"}
+};
+
+static_assert(sizeof(REPORTED_GAUGES) / sizeof(REPORTED_GAUGES[0]) == REPORTED_HISTORY_COUNT,
+              "every reported history series needs a gauge");
+
+constexpr uint32_t NO_LOCATION = 0xffffffffu;   // Topology site the registry has not seen yet
+
+} // anonymous namespace
+
+const char* coSimMessageTypeName(CoSimMessage::Type type) {
+    switch (type) {
+        case CoSimMessage::TIME_SYNC: return "time_sync";
+        case CoSimMessage::NDN_METRICS: return "ndn_metrics";
+        case CoSimMessage::NFV_COMMAND: return "nfv_command";
+        case CoSimMessage::VEHICLE_UPDATE: return "vehicle_update";
+        case CoSimMessage::EMERGENCY_EVENT: return "emergency_event";
+    }
+    return "unknown";
+}
+
 OMNeTOrchestrator::OMNeTOrchestrator() 
     : currentTime_(0.0), running_(false), initialized_(false), leaderReady_(false),
-      followerConnected_(false), serverSocket_(-1), followerSocket_(-1),
+      followerConnected_(false), serverSocket_(-1), followerSocket_(-1), placementSolver_(edgeTopology_),
       trafficDensity_("normal"), scenarioType_("generic"), useKathmanduScenario_(false),
-      serverPort_(9999), syncAckReceived_(false), metricsReceived_(false) {
-    
-    // Initialize VNF instances as per methodology
-    vnfInstances_[VNFType::NDN_ROUTER] = {};
-    vnfInstances_[VNFType::TRAFFIC_ANALYZER] = {};
-    vnfInstances_[VNFType::SECURITY_VNF] = {};
-    vnfInstances_[VNFType::CACHE_OPTIMIZER] = {};
+      serverPort_(9999), reportQueue_(PIPELINE_QUEUE_CAPACITY), actuateQueue_(PIPELINE_QUEUE_CAPACITY),
+      publishQueue_(PIPELINE_QUEUE_CAPACITY), pipelineRunning_(false), verbose_(true),
+      syncAckReceived_(false), metricsReceived_(false) {
     
     // Initialize performance metrics
     performanceMetrics_.totalDecisions = 0;
     performanceMetrics_.scalingEvents = 0;
     performanceMetrics_.migrationEvents = 0;
     performanceMetrics_.emergencyResponses = 0;
+    performanceMetrics_.metricsReports = 0;
+    performanceMetrics_.coalescedReports = 0;
+    performanceMetrics_.droppedReports = 0;
+    performanceMetrics_.coalescedDecisions = 0;
+    performanceMetrics_.suppressedDecisions = 0;
     performanceMetrics_.avgDecisionLatency = 0.0;
     performanceMetrics_.resourceUtilization = 0.0;
     performanceMetrics_.startTime = std::chrono::steady_clock::now();
@@ -42,6 +92,35 @@ OMNeTOrchestrator::OMNeTOrchestrator()
     kathmanduIntersection_.approaches = {"North", "South", "East", "West"};
     kathmanduIntersection_.currentPhase = 0;
     kathmanduIntersection_.phaseTimer = 0.0;
+    
+    // Metrics history series: reported fields, modeled latency, then CPU and instances per VNF type
+    for (const char* name : REPORTED_HISTORY_SERIES) {
+        historySeries_.push_back(metricsHistory_.series(name));
+    }
+    historySeries_.push_back(metricsHistory_.series("modeled_latency"));
+    for (size_t k = 0; k < TRAFFIC_CLASS_COUNT; ++k) {
+        std::string name = trafficClassName(static_cast<TrafficClass>(k));
+        historySeries_.push_back(metricsHistory_.series("latency." + name));
+        historySeries_.push_back(metricsHistory_.series("loss." + name));
+    }
+    for (size_t t = 0; t < VNF_TYPE_COUNT; ++t) {
+        historySeries_.push_back(metricsHistory_.series("cpu." + vnfTypeToString(static_cast<VNFType>(t))));
+    }
+    for (size_t t = 0; t < VNF_TYPE_COUNT; ++t) {
+        historySeries_.push_back(metricsHistory_.series("instances." + vnfTypeToString(static_cast<VNFType>(t))));
+    }
+    
+    setCpuThresholds(CPU_SCALE_UP_THRESHOLD, CPU_SCALE_DOWN_THRESHOLD);
+}
+
+// Site verdicts use the fleet-wide CPU thresholds
+void OMNeTOrchestrator::setCpuThresholds(double scaleUp, double scaleDown) {
+    cpuScaleUp_ = scaleUp;
+    cpuScaleDown_ = scaleDown;
+    SiteThresholds siteThresholds = siteEvaluator_.thresholds();
+    siteThresholds.scaleUpCpu = static_cast<float>(scaleUp);
+    siteThresholds.scaleDownCpu = static_cast<float>(scaleDown);
+    siteEvaluator_.setThresholds(siteThresholds);
 }
 
 OMNeTOrchestrator::~OMNeTOrchestrator() {
@@ -86,11 +165,7 @@ bool OMNeTOrchestrator::initialize() {
         }
     }
     
-    // Deploy initial VNF instances
-    deployVNF(VNFType::NDN_ROUTER, "RSU_1");
-    deployVNF(VNFType::TRAFFIC_ANALYZER, "EDGE_1");
-    deployVNF(VNFType::SECURITY_VNF, "RSU_1");
-    deployVNF(VNFType::CACHE_OPTIMIZER, "EDGE_1");
+    deployInitialVNFs();
     
     running_ = true;
     initialized_ = true;
@@ -101,7 +176,27 @@ bool OMNeTOrchestrator::initialize() {
     return true;
 }
 
+// Replay needs only the initial fleet: no leader server and no vehicle simulation
+void OMNeTOrchestrator::initializeOffline() {
+    deployInitialVNFs();
+    initialized_ = true;
+}
+
+// The actuate stage may already be running
+void OMNeTOrchestrator::deployInitialVNFs() {
+    std::lock_guard<std::mutex> lock(nfvStateMutex_);
+    deployVNF(VNFType::NDN_ROUTER, "RSU_1");
+    deployVNF(VNFType::TRAFFIC_ANALYZER, "EDGE_1");
+    deployVNF(VNFType::SECURITY_VNF, "RSU_1");
+    deployVNF(VNFType::CACHE_OPTIMIZER, "EDGE_1");
+    publishFleetGauges();
+}
+
 bool OMNeTOrchestrator::startAsLeader(int port) {
+    // main() starts the leader before initialize() does; keep the first server
+    if (leaderReady_) {
+        return true;
+    }
     serverPort_ = port;
     
     // Create server socket
@@ -138,7 +233,9 @@ bool OMNeTOrchestrator::startAsLeader(int port) {
         return false;
     }
     
-    // Start leader thread
+    // Start the decision pipeline before anything can be ingested, then the leader thread
+    running_ = true;
+    startPipeline();
     leaderThread_ = std::thread(&OMNeTOrchestrator::leaderLoop, this);
     leaderReady_ = true;
     
@@ -148,6 +245,7 @@ bool OMNeTOrchestrator::startAsLeader(int port) {
 
 void OMNeTOrchestrator::leaderLoop() {
     std::cout << "🔄 Leader communication loop started..." << std::endl;
+    StepTracer::nameThread("leader_io");
     
     while (running_) {
         if (followerSocket_ < 0) {
@@ -171,29 +269,55 @@ void OMNeTOrchestrator::leaderLoop() {
                       << inet_ntoa(followerAddr.sin_addr) << std::endl;
         }
         
-        // Handle incoming messages from follower
+        // Handle incoming messages from follower. This is the ingest stage: reports are
+        // parsed and queued, decisions are made on the pipeline threads.
         try {
-            CoSimMessage message = receiveMessage(followerSocket_);
-            
-            switch (message.type) {
-                case CoSimMessage::NDN_METRICS: {
-                    // Parse NDN metrics from follower
-                    NDNMetrics metrics = parseNDNMetrics(message.payload);
-                    handleFollowerMetrics(metrics);
-                    metricsReceived_ = true;
-                    break;
-                }
-                
-                case CoSimMessage::TIME_SYNC: {
-                    // Follower acknowledging time sync
-                    syncAckReceived_ = true;
-                    syncCondition_.notify_one();
-                    break;
+            CoSimMessage message;
+            auto received = std::chrono::steady_clock::now();
+            while (receiveMessage(followerSocket_, message)) {
+                TraceSpan messageSpan(coSimMessageTypeName(message.type), "io");
+                switch (message.type) {
+                    case CoSimMessage::NDN_METRICS: {
+                        MetricsReport report;
+                        bool parsed;
+                        {
+                            TraceSpan span("parse_report", "io");
+                            parsed = parseMetricsReport(message.payload.data(), message.payload.size(), report);
+                        }
+                        if (!parsed) {
+                            break;
+                        }
+                        traceWriter_.append(currentTime_, message.payload);
+                        performanceMetrics_.metricsReports++;
+                        if (!reportQueue_.tryPush(std::move(report))) {
+                            performanceMetrics_.droppedReports++;
+                        }
+                        decideSignal_.raise();
+                        metricsReceived_ = true;
+                        break;
+                    }
+                    
+                    case CoSimMessage::TIME_SYNC: {
+                        // Follower acknowledging time sync
+                        int64_t sentAt = syncSentAt_.exchange(0);
+                        if (sentAt != 0) {
+                            syncRoundTrip_.record(static_cast<uint64_t>(std::max<int64_t>(0,
+                                std::chrono::steady_clock::now().time_since_epoch().count() - sentAt)));
+                        }
+                        syncAckReceived_ = true;
+                        syncCondition_.notify_one();
+                        break;
+                    }
+                    
+                    default:
+                        std::cout << "📨 Received message type: " << message.type << std::endl;
+                        break;
                 }
                 
-                default:
-                    std::cout << "📨 Received message type: " << message.type << std::endl;
-                    break;
+                // Reading and parsing the message included
+                auto handled = std::chrono::steady_clock::now();
+                messageHandling_[message.type].record(handled - received);
+                received = handled;
             }
             
         } catch (const std::exception& e) {
@@ -202,6 +326,7 @@ void OMNeTOrchestrator::leaderLoop() {
                 close(followerSocket_);
                 followerSocket_ = -1;
                 followerConnected_ = false;
+                followerReadBuffer_.clear();
             }
         }
         
@@ -222,6 +347,7 @@ bool OMNeTOrchestrator::step(double timeStep) {
     }
     
     double nextTime = currentTime_ + timeStep;
+    TraceSpan stepSpan("orchestrator_step", "leader");
     
     // As leader, send time synchronization command to follower
     if (!sendTimeSyncCommand(nextTime)) {
@@ -230,12 +356,18 @@ bool OMNeTOrchestrator::step(double timeStep) {
     }
     
     // Wait for follower acknowledgment
-    if (!waitForFollowerAck()) {
+    bool acknowledged;
+    {
+        TraceSpan span("ack_wait", "io");
+        acknowledged = waitForFollowerAck();
+    }
+    if (!acknowledged) {
         std::cerr << "❌ Timeout waiting for follower acknowledgment" << std::endl;
         return false;
     }
     
     // Update our simulation state
+    TraceSpan modelSpan("vehicle_model", "leader");
     if (useKathmanduScenario_) {
         simulateIntersectionBehavior(timeStep);
     } else {
@@ -260,6 +392,7 @@ bool OMNeTOrchestrator::sendTimeSyncCommand(double nextTime) {
         return true; // Allow operation without follower for testing
     }
     
+    TraceSpan span("send_time_sync", "io");
     CoSimMessage message;
     message.type = CoSimMessage::TIME_SYNC;
     message.timestamp = nextTime;
@@ -275,6 +408,8 @@ bool OMNeTOrchestrator::sendTimeSyncCommand(double nextTime) {
     message.payload = Json::writeString(builder, payload);
     
     syncAckReceived_ = false;
+    syncSentAt_ = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
     return sendMessage(followerSocket_, message);
 }
 
@@ -291,137 +426,1284 @@ bool OMNeTOrchestrator::waitForFollowerAck() {
     });
 }
 
-void OMNeTOrchestrator::handleFollowerMetrics(const NDNMetrics& metrics) {
-    std::lock_guard<std::mutex> lock(nfvStateMutex_);
+// Runs on the decide stage. Decisions depend only on the metrics, the per-node matrix
+// and the popularity sketch, all owned by this stage, so no lock is held here.
+void OMNeTOrchestrator::handleFollowerMetrics(const NDNMetrics& reported) {
+    TraceSpan span("handle_follower_metrics", "pipeline");
+    NDNMetrics metrics = reported;
+    std::vector<NFVDecision> decisions = decide(metrics);
+    
+    // Hand the decisions to the actuate stage
+    if (!decisions.empty()) {
+        if (actuateQueue_.tryPush(std::move(decisions))) {
+            actuateSignal_.raise();
+        } else {
+            std::cerr << "❌ NFV actuation queue full, dropping decisions" << std::endl;
+        }
+    }
     
-    // Analyze metrics and make NFV decisions
-    std::vector<NFVDecision> decisions = analyzeAndDecide(metrics);
+    // Log metrics
+    if (verbose_) {
+        std::cout << "📊 NDN Metrics - PIT: " << metrics.pitSize 
+                  << ", Cache Hit: " << std::fixed << std::setprecision(2) << metrics.cacheHitRatio
+                  << ", Latency: " << (metrics.avgLatency * 1000) << "ms" << std::endl;
+    }
+}
+
+// Offline replay: the report goes through ingest, decide and actuate on the calling
+// thread at the leader time it was recorded at, and nothing is published
+bool OMNeTOrchestrator::replayReport(const TraceRecord& record, ReplayStep& step) {
+    MetricsReport report;
+    if (!parseMetricsReport(record.payload, record.size, report)) {
+        return false;
+    }
     
-    // Execute decisions
-    if (!decisions.empty()) {
-        executeNFVDecisions(decisions);
+    currentTime_ = record.leaderTime;
+    ingestReport(report);
+    step.modeled = report.metrics;
+    std::vector<NFVDecision> decisions = decide(step.modeled);
+    step.classes = modeledClasses_;
+    step.executed = decisions.empty() ? std::move(decisions) : actuate(decisions);
+    return true;
+}
+
+// ============================================================================
+// NFV decision pipeline
+// ============================================================================
+
+void OMNeTOrchestrator::startPipeline() {
+    if (pipelineRunning_.exchange(true)) {
+        return;
+    }
+    decideThread_ = std::thread(&OMNeTOrchestrator::decideLoop, this);
+    actuateThread_ = std::thread(&OMNeTOrchestrator::actuateLoop, this);
+    publishThread_ = std::thread(&OMNeTOrchestrator::publishLoop, this);
+}
+
+void OMNeTOrchestrator::stopPipeline() {
+    if (!pipelineRunning_.exchange(false)) {
+        return;
+    }
+    decideSignal_.raise();
+    actuateSignal_.raise();
+    publishSignal_.raise();
+    for (std::thread* stage : {&decideThread_, &actuateThread_, &publishThread_}) {
+        if (stage->joinable()) {
+            stage->join();
+        }
+    }
+}
+
+// Reports that queued up while a decision was running are coalesced: every node delta
+// and popularity sketch is applied, but only the newest metrics are evaluated.
+void OMNeTOrchestrator::decideLoop() {
+    StepTracer::nameThread("decide");
+    MetricsReport report;
+    while (pipelineRunning_) {
+        decideSignal_.wait(std::chrono::milliseconds(100));
         
-        // Send decisions to follower
-        for (const auto& decision : decisions) {
-            CoSimMessage message;
-            message.type = CoSimMessage::NFV_COMMAND;
-            message.timestamp = currentTime_;
-            message.priority = decision.priority;
-            message.payload = nfvDecisionToJson(decision);
-            
-            if (followerSocket_ >= 0) {
-                sendMessage(followerSocket_, message);
+        bool pending = false;
+        while (reportQueue_.tryPop(report)) {
+            if (pending) {
+                performanceMetrics_.coalescedReports++;
             }
+            pending = true;
+            ingestReport(report);
+        }
+        
+        if (pending) {
+            handleFollowerMetrics(report.metrics);
+        }
+    }
+}
+
+// Folds one report into the per-node matrix, the popularity sketch, the forecaster and
+// the metrics history; every report is a sample, coalesced or not
+void OMNeTOrchestrator::ingestReport(const MetricsReport& report) {
+    TraceSpan span("ingest_report", "pipeline");
+    std::lock_guard<std::mutex> lock(nfvStateMutex_);
+    if (!report.nodeDelta.isNull()) {
+        nodeMetrics_.applyDelta(report.nodeDelta);
+    }
+    if (!report.popularity.isNull()) {
+        popularity_.mergeReport(report.popularity);
+    }
+    
+    double sampleTime = report.metrics.timestamp > 0.0 ? report.metrics.timestamp : currentTime_.load();
+    recordReportedHistory(sampleTime, report.metrics);
+    forecaster_.update(sampleTime, report.metrics);
+    for (const auto& row : nodeMetrics_.rows()) {
+        if (row.present) {
+            forecaster_.updateNode(row.nodeId, sampleTime, row.interestRate);
         }
     }
+}
+
+// Runs the load model on a copy of the reported metrics, then the policy
+std::vector<NFVDecision> OMNeTOrchestrator::decide(NDNMetrics& metrics) {
+    auto started = std::chrono::steady_clock::now();
+    
+    {
+        TraceSpan span("load_model", "pipeline");
+        applyLoadModel(metrics);
+        recordModeledHistory(metrics.timestamp > 0.0 ? metrics.timestamp : currentTime_.load(), metrics);
+    }
+    std::vector<NFVDecision> decisions;
+    {
+        TraceSpan span("analyze_and_decide", "pipeline");
+        decisions = analyzeAndDecide(metrics);
+    }
     
-    // Log metrics
-    std::cout << "📊 NDN Metrics - PIT: " << metrics.pitSize 
-              << ", Cache Hit: " << std::fixed << std::setprecision(2) << metrics.cacheHitRatio
-              << ", Latency: " << (metrics.avgLatency * 1000) << "ms" << std::endl;
+    auto finished = std::chrono::steady_clock::now();
+    decideLatency_.record(finished - started);
+    double elapsed = std::chrono::duration<double>(finished - started).count();
+    performanceMetrics_.avgDecisionLatency += 0.1 * (elapsed - performanceMetrics_.avgDecisionLatency);
+    return decisions;
+}
+
+// Everything queued since the last pass is coalesced and governed as one batch, so
+// a burst of equivalent decisions actuates (and reaches the follower) at most once
+void OMNeTOrchestrator::actuateLoop() {
+    StepTracer::nameThread("actuate");
+    std::vector<NFVDecision> batch;
+    std::vector<NFVDecision> pending;
+    while (pipelineRunning_) {
+        actuateSignal_.wait(std::chrono::milliseconds(100));
+        
+        while (actuateQueue_.tryPop(batch)) {
+            std::move(batch.begin(), batch.end(), std::back_inserter(pending));
+        }
+        if (pending.empty()) {
+            continue;
+        }
+        
+        std::vector<NFVDecision> admitted = actuate(pending);
+        pending.clear();
+        
+        if (!admitted.empty() && publishQueue_.tryPush(std::move(admitted))) {
+            publishSignal_.raise();
+        }
+    }
+}
+
+// Coalesces and governs the pending decisions, then executes the admitted ones
+std::vector<NFVDecision> OMNeTOrchestrator::actuate(std::vector<NFVDecision>& pending) {
+    TraceSpan span("actuate", "pipeline");
+    performanceMetrics_.coalescedDecisions += DecisionGovernor::coalesce(pending);
+    
+    std::vector<NFVDecision> admitted;
+    std::lock_guard<std::mutex> lock(nfvStateMutex_);
+    for (auto& decision : pending) {
+        GovernorVerdict verdict = governor_.admit(decision, vnfRegistry_, currentTime_);
+        if (verdict == GovernorVerdict::ADMIT) {
+            admitted.push_back(std::move(decision));
+        } else {
+            performanceMetrics_.suppressedDecisions++;
+            decisionJournal_.appendDecision(currentTime_, decision, verdict);
+        }
+    }
+    executeNFVDecisions(admitted);
+    publishFleetGauges();
+    
+    if (decisionJournal_.snapshotDue(currentTime_)) {
+        decisionJournal_.snapshot(currentTime_, vnfRegistry_);
+    }
+    return admitted;
+}
+
+// Sends executed decisions to the follower as NFV commands
+void OMNeTOrchestrator::publishLoop() {
+    StepTracer::nameThread("publish");
+    std::vector<NFVDecision> decisions;
+    while (pipelineRunning_) {
+        publishSignal_.wait(std::chrono::milliseconds(100));
+        
+        while (publishQueue_.tryPop(decisions)) {
+            TraceSpan span("publish_decisions", "io");
+            for (const auto& decision : decisions) {
+                CoSimMessage message;
+                message.type = CoSimMessage::NFV_COMMAND;
+                message.timestamp = currentTime_;
+                message.priority = decision.priority;
+                message.payload = nfvDecisionToJson(decision);
+                
+                if (followerSocket_ >= 0) {
+                    sendMessage(followerSocket_, message);
+                }
+            }
+        }
+    }
 }
 
 std::vector<NFVDecision> OMNeTOrchestrator::analyzeAndDecide(const NDNMetrics& metrics) {
     std::vector<NFVDecision> decisions;
-    auto now = std::chrono::steady_clock::now();
     
-    // Check if NDN Router VNF needs scaling
-    if (shouldScaleUp(metrics, VNFType::NDN_ROUTER)) {
+    uint64_t escalated = 0;
+    uint64_t fired = ruleEngine_.evaluate(metrics, escalated);
+    materializeDecisions(fired, escalated, metrics, "", decisions);
+    addCpuScalingDecisions(decisions);
+    
+    // Predictive scale-up: SCALE_UP rules the forecast trips ahead of the current metrics
+    if (forecaster_.ready()) {
+        uint64_t scaleUpRules = 0;
+        for (size_t rule = 0; rule < ruleEngine_.ruleCount(); ++rule) {
+            if (ruleEngine_.action(rule).action == "SCALE_UP") {
+                scaleUpRules |= uint64_t(1) << rule;
+            }
+        }
+        
+        NDNMetrics predicted = forecaster_.forecast(FORECAST_HORIZON);
+        uint64_t predictedEscalated = 0;
+        uint64_t ahead = ruleEngine_.evaluate(predicted, predictedEscalated) & scaleUpRules & ~fired;
+        if (ahead != 0) {
+            std::ostringstream prefix;
+            prefix << "Predicted in " << FORECAST_HORIZON << "s: ";
+            materializeDecisions(ahead, 0, predicted, prefix.str(), decisions);
+        }
+    }
+    
+    addScaleDownDecisions(metrics, decisions);
+    addSiteDecisions(metrics, decisions);
+    if (currentTime_ - lastConsolidation_ >= CONSOLIDATION_INTERVAL) {
+        lastConsolidation_ = currentTime_;
+        std::vector<NFVDecision> moves = optimizeVNFPlacement();
+        std::move(moves.begin(), moves.end(), std::back_inserter(decisions));
+    }
+    
+    performanceMetrics_.totalDecisions += decisions.size();
+    
+    return decisions;
+}
+
+// Materialize decisions for the rules that fired, in rule-file order
+void OMNeTOrchestrator::materializeDecisions(uint64_t fired, uint64_t escalated, const NDNMetrics& metrics,
+                                             const std::string& reasonPrefix, std::vector<NFVDecision>& decisions) {
+    for (size_t rule = 0; fired != 0; ++rule, fired >>= 1) {
+        if (!(fired & 1)) continue;
+        const RuleAction& action = ruleEngine_.action(rule);
+        
+        NFVDecision decision;
+        decision.vnfType = stringToVNFType(action.vnfType);
+        decision.action = action.action;
+        decision.targetInstances = ruleEngine_.instancesFor(rule, metrics);
+        decision.sourceLocation = resolveLocation(action.sourceLocation, metrics, decision.vnfType);
+        
+        // Scale-ups to "@optimal" place every new instance jointly against site capacity;
+        // when the demand is known but no site has room, nothing is deployed
+        if (decision.action == "SCALE_UP" && action.location.compare(0, 8, "@optimal") == 0 &&
+            planPlacement(decision.vnfType, decision.targetInstances, decision.placements) &&
+            decision.placements.empty()) {
+            continue;
+        }
+        decision.targetLocation = decision.placements.empty()
+            ? resolveLocation(action.location, metrics, decision.vnfType)
+            : decision.placements.front();
+        if (decision.targetLocation.empty() && !action.location.empty() && action.location[0] == '@' &&
+            (decision.action == "SCALE_UP" || decision.action == "MIGRATE")) {
+            continue;
+        }
+        decision.reason = reasonPrefix + ruleEngine_.reasonFor(rule, metrics);
+        decision.reasonKey = reasonPrefix.empty() ? action.name : "forecast:" + action.name;
+        decision.timestamp = currentTime_;
+        decision.priority = ruleEngine_.priorityFor(rule, (escalated >> rule) & 1);
+        
+        if (decision.vnfType == VNFType::CACHE_OPTIMIZER && decision.action == "OPTIMIZE" &&
+            !refineCacheDecision(decision, metrics)) {
+            continue;
+        }
+        
+        decisions.push_back(decision);
+        
+        // Scaling and migration events are counted when executed
+        if (action.event == "emergency") {
+            performanceMetrics_.emergencyResponses++;
+        }
+    }
+}
+
+// Grow a type whose instances run above the CPU threshold on average, to the fleet
+// size that would bring them back under it (at most double)
+void OMNeTOrchestrator::addCpuScalingDecisions(std::vector<NFVDecision>& decisions) {
+    for (size_t t = 0; t < VNF_TYPE_COUNT; ++t) {
+        size_t count = modeledInstances_[t];
+        double cpu = modeledCpu_[t];
+        if (count == 0 || cpu <= cpuScaleUp_) continue;
+        
+        VNFType type = static_cast<VNFType>(t);
+        size_t target = static_cast<size_t>(std::ceil(count * cpu / cpuScaleUp_));
+        target = std::min(2 * count, std::max(count + 1, target));
+        
         NFVDecision decision;
-        decision.vnfType = VNFType::NDN_ROUTER;
+        decision.vnfType = type;
         decision.action = "SCALE_UP";
-        decision.targetInstances = calculateRequiredInstances(metrics, VNFType::NDN_ROUTER);
-        decision.targetLocation = findOptimalLocation(metrics, VNFType::NDN_ROUTER);
-        decision.reason = "PIT size exceeded threshold: " + std::to_string(metrics.pitSize);
+        decision.targetInstances = static_cast<int>(target);
+        bool planned = planPlacement(type, static_cast<int>(target - count), decision.placements);
+        if (planned && decision.placements.empty()) continue;   // No edge room; already reported
+        decision.targetLocation = decision.placements.empty() ? "EDGE_1" : decision.placements.front();
+        
+        std::ostringstream reason;
+        reason << "Modeled CPU " << std::fixed << std::setprecision(2) << cpu << " above "
+               << cpuScaleUp_ << " across " << count << " instances";
+        decision.reason = reason.str();
+        decision.reasonKey = "modeled_cpu";
         decision.timestamp = currentTime_;
-        decision.priority = (metrics.emergencyMessages > 0) ? 1 : 2;
+        decision.priority = 2;
         
         decisions.push_back(decision);
-        performanceMetrics_.scalingEvents++;
+    }
+}
+
+// A type may shrink once its modeled CPU has stayed under the scale-down threshold for a
+// whole window, and the remaining instances would stay under the scale-up threshold even
+// at the window's peak
+bool OMNeTOrchestrator::shouldScaleDown(const NDNMetrics& metrics, VNFType vnfType) {
+    size_t t = static_cast<size_t>(vnfType);
+    size_t count = modeledInstances_[t];
+    if (count <= 1 || modeledCpu_[t] >= cpuScaleDown_) {
+        return false;
+    }
+    
+    double now = metrics.timestamp > 0.0 ? metrics.timestamp : currentTime_.load();
+    std::vector<Rollup> buckets;
+    if (queryHistory("cpu." + vnfTypeToString(vnfType), Resolution::SECOND, now - SCALE_DOWN_WINDOW, now,
+                     buckets) == 0 ||
+        buckets.front().start > now - SCALE_DOWN_WINDOW + 1.0) {
+        return false;   // Not enough history yet
     }
     
-    // Check cache efficiency for Cache Optimizer VNF
-    if (metrics.cacheHitRatio < CACHE_EFFICIENCY_THRESHOLD) {
+    Rollup window;
+    for (const auto& bucket : buckets) {
+        window.merge(bucket);
+    }
+    double peakAfter = window.max * count / (count - 1);
+    return window.avg() < cpuScaleDown_ && peakAfter < cpuScaleUp_;
+}
+
+// Removes the least loaded instance of each type that has been idle long enough, unless
+// the policy is growing the same type in this pass
+void OMNeTOrchestrator::addScaleDownDecisions(const NDNMetrics& metrics, std::vector<NFVDecision>& decisions) {
+    for (size_t t = 0; t < VNF_TYPE_COUNT; ++t) {
+        VNFType type = static_cast<VNFType>(t);
+        if (!shouldScaleDown(metrics, type)) continue;
+        
+        bool growing = std::any_of(decisions.begin(), decisions.end(), [type](const NFVDecision& decision) {
+            return decision.vnfType == type && decision.action == "SCALE_UP";
+        });
+        if (growing) continue;
+        
+        std::string victim;
+        {
+            std::lock_guard<std::mutex> lock(nfvStateMutex_);
+            const VNFInstance* instance = vnfRegistry_.get(leastLoaded(type, ""));
+            if (!instance) continue;
+            victim = instance->location;
+        }
+        
         NFVDecision decision;
-        decision.vnfType = VNFType::CACHE_OPTIMIZER;
-        decision.action = "OPTIMIZE";
-        decision.targetInstances = 1;
-        decision.targetLocation = "EDGE_1";
-        decision.reason = "Cache hit ratio below threshold: " + std::to_string(metrics.cacheHitRatio);
+        decision.vnfType = type;
+        decision.action = "SCALE_DOWN";
+        decision.targetInstances = static_cast<int>(modeledInstances_[t] - 1);
+        decision.sourceLocation = victim;
+        decision.targetLocation = victim;
+        
+        std::ostringstream reason;
+        reason << "Modeled CPU " << std::fixed << std::setprecision(2) << modeledCpu_[t] << " below "
+               << cpuScaleDown_ << " for " << SCALE_DOWN_WINDOW << "s across "
+               << modeledInstances_[t] << " instances";
+        decision.reason = reason.str();
+        decision.reasonKey = "modeled_cpu_idle";
         decision.timestamp = currentTime_;
         decision.priority = 3;
         
         decisions.push_back(decision);
     }
+}
+
+// Instance with the lowest modeled CPU that is not migrating, at `location` or anywhere
+// when it is empty (caller holds nfvStateMutex_)
+VNFHandle OMNeTOrchestrator::leastLoaded(VNFType vnfType, const std::string& location) const {
+    VNFHandle best;
+    double bestCpu = std::numeric_limits<double>::infinity();
+    auto consider = [&](VNFHandle handle, const VNFInstance& instance) {
+        if (instance.cpuUsage < bestCpu && !migrations_.inFlight(handle)) {
+            bestCpu = instance.cpuUsage;
+            best = handle;
+        }
+    };
+    if (location.empty()) {
+        vnfRegistry_.forEachOfType(vnfType, consider);
+    } else {
+        vnfRegistry_.forEachAt(vnfType, location, consider);
+    }
+    return best;
+}
+
+// Consolidation: drains lightly reserved sites whose instances are all under-utilized onto
+// sites that are already in use, first-fit decreasing by footprint. Candidate hosts are
+// tried cheapest migration first (state size times link latency), a site is drained only
+// if all of its instances fit, and a pass moves at most CONSOLIDATION_MAX_MOVES instances.
+std::vector<NFVDecision> OMNeTOrchestrator::optimizeVNFPlacement() {
+    struct SiteUse {
+        SiteCapacity residual;
+        double reserved = 0.0;      // Cores
+        std::array<int, VNF_TYPE_COUNT> instances{};
+        size_t total = 0;
+        bool busy = false;          // Hosts an instance at or above the scale-down threshold
+        bool pinned = false;        // Received instances this pass, or was drained
+    };
+    
+    const size_t siteCount = edgeTopology_.siteCount();
+    std::vector<SiteUse> sites(siteCount);
+    for (uint32_t s = 0; s < siteCount; ++s) {
+        sites[s].residual = {edgeTopology_.site(s).cpuCapacity, edgeTopology_.site(s).memoryCapacity};
+    }
+    {
+        std::lock_guard<std::mutex> lock(nfvStateMutex_);
+        vnfRegistry_.forEach([&](VNFHandle handle, const VNFInstance& instance) {
+            uint32_t s = edgeTopology_.findSite(instance.location);
+            if (s == EdgeTopology::INVALID_SITE) return;
+            VNFFootprint footprint = vnfFootprint(instance.type);
+            SiteUse& site = sites[s];
+            site.pinned = site.pinned || migrations_.inFlight(handle);
+            site.residual.cpu -= footprint.cpu;
+            site.residual.memory -= footprint.memory;
+            site.reserved += footprint.cpu;
+            site.instances[static_cast<size_t>(instance.type)]++;
+            site.total++;
+            site.busy = site.busy || instance.cpuUsage >= cpuScaleDown_;
+        });
+        
+        // Sites with migrations in or out are left alone until they settle
+        for (uint32_t s = 0; s < std::min(siteCount, inbound_.size()); ++s) {
+            if (inbound_[s].cpu > 0.0) {
+                sites[s].residual.cpu -= inbound_[s].cpu;
+                sites[s].residual.memory -= inbound_[s].memory;
+                sites[s].reserved += inbound_[s].cpu;
+                sites[s].pinned = true;
+            }
+        }
+    }
     
-    // Check latency for potential migration
-    if (metrics.avgLatency > LATENCY_THRESHOLD) {
-        if (shouldMigrate(metrics, VNFType::NDN_ROUTER)) {
+    // Emptiest sources first: they free a site for the fewest moves
+    std::vector<uint32_t> sources;
+    for (uint32_t s = 0; s < siteCount; ++s) {
+        const SiteUse& site = sites[s];
+        double capacity = edgeTopology_.site(s).cpuCapacity;
+        if (site.total > 0 && !site.busy && capacity > 0.0 && site.reserved / capacity <= CONSOLIDATION_OCCUPANCY) {
+            sources.push_back(s);
+        }
+    }
+    std::sort(sources.begin(), sources.end(), [&](uint32_t a, uint32_t b) {
+        return sites[a].reserved / edgeTopology_.site(a).cpuCapacity <
+               sites[b].reserved / edgeTopology_.site(b).cpuCapacity;
+    });
+    
+    std::vector<NFVDecision> decisions;
+    size_t budget = CONSOLIDATION_MAX_MOVES;
+    for (uint32_t source : sources) {
+        SiteUse& from = sites[source];
+        if (from.pinned || from.total > budget) continue;
+        
+        // Items by decreasing footprint
+        std::vector<VNFType> items;
+        for (size_t t = 0; t < VNF_TYPE_COUNT; ++t) {
+            items.insert(items.end(), static_cast<size_t>(from.instances[t]), static_cast<VNFType>(t));
+        }
+        std::sort(items.begin(), items.end(), [](VNFType a, VNFType b) {
+            VNFFootprint fa = vnfFootprint(a), fb = vnfFootprint(b);
+            return fa.cpu != fb.cpu ? fa.cpu > fb.cpu : fa.memory > fb.memory;
+        });
+        
+        // Hosts already in use, cheapest link first
+        std::vector<uint32_t> hosts;
+        for (uint32_t s = 0; s < siteCount; ++s) {
+            if (s != source && sites[s].total > 0 && edgeTopology_.latency(source, s) <= CONSOLIDATION_MAX_LATENCY_MS) {
+                hosts.push_back(s);
+            }
+        }
+        std::sort(hosts.begin(), hosts.end(), [&](uint32_t a, uint32_t b) {
+            return edgeTopology_.latency(source, a) < edgeTopology_.latency(source, b);
+        });
+        
+        std::vector<SiteCapacity> residual(siteCount);
+        for (uint32_t host : hosts) {
+            residual[host] = sites[host].residual;
+        }
+        std::vector<uint32_t> placed;
+        for (VNFType type : items) {
+            VNFFootprint footprint = vnfFootprint(type);
+            auto fit = std::find_if(hosts.begin(), hosts.end(), [&](uint32_t host) {
+                return residual[host].cpu >= footprint.cpu && residual[host].memory >= footprint.memory;
+            });
+            if (fit == hosts.end()) break;
+            residual[*fit].cpu -= footprint.cpu;
+            residual[*fit].memory -= footprint.memory;
+            placed.push_back(*fit);
+        }
+        if (placed.size() < items.size()) continue;
+        
+        // Commit: one MIGRATE per (type, host), moving as many instances as were placed there
+        for (size_t i = 0; i < items.size(); ++i) {
+            uint32_t host = placed[i];
+            VNFFootprint footprint = vnfFootprint(items[i]);
+            sites[host].residual.cpu -= footprint.cpu;
+            sites[host].residual.memory -= footprint.memory;
+            sites[host].pinned = true;
+            
+            const std::string& target = edgeTopology_.site(host).name;
+            auto same = std::find_if(decisions.begin(), decisions.end(), [&](const NFVDecision& decision) {
+                return decision.vnfType == items[i] && decision.sourceLocation == edgeTopology_.site(source).name &&
+                       decision.targetLocation == target;
+            });
+            if (same != decisions.end()) {
+                same->targetInstances++;
+                continue;
+            }
+            
             NFVDecision decision;
-            decision.vnfType = VNFType::NDN_ROUTER;
+            decision.vnfType = items[i];
             decision.action = "MIGRATE";
             decision.targetInstances = 1;
-            decision.sourceLocation = "RSU_1";
-            decision.targetLocation = findOptimalLocation(metrics, VNFType::NDN_ROUTER);
-            decision.reason = "High latency: " + std::to_string(metrics.avgLatency * 1000) + "ms";
+            decision.sourceLocation = edgeTopology_.site(source).name;
+            decision.targetLocation = target;
+            decision.reason = "Consolidating " + std::to_string(from.total) + " under-utilized instances off " +
+                              decision.sourceLocation;
+            decision.reasonKey = "consolidation";
             decision.timestamp = currentTime_;
-            decision.priority = (metrics.avgLatency > EMERGENCY_LATENCY_THRESHOLD) ? 1 : 2;
-            
+            decision.priority = 3;
             decisions.push_back(decision);
-            performanceMetrics_.migrationEvents++;
+        }
+        from.pinned = true;
+        from.total = 0;
+        budget -= items.size();
+        if (budget == 0) break;
+    }
+    return decisions;
+}
+
+// Brings the shared site tables up to date: all of them after a topology change, and the
+// per-type host counts and nearest host per site from the registry's change journal. A new
+// host only has to beat each site's current nearest one, and only the sites whose nearest
+// host went away are searched again, so a fleet change costs O(sites) rather than the
+// O(types x nodes x hosts) of routing every node from scratch.
+void OMNeTOrchestrator::refreshSiteCaches() {
+    const size_t siteCount = edgeTopology_.siteCount();
+    const uint32_t none = EdgeTopology::INVALID_SITE;
+    bool rebuild = false;
+    
+    if (cachedSiteCount_ != siteCount) {
+        cachedSiteCount_ = siteCount;
+        nodeSites_.clear();
+        locationSites_.clear();
+        siteLocations_.assign(siteCount, NO_LOCATION);
+        mappedLocations_ = 0;
+        rebuild = true;
+        
+        // Ties keep id order, as a linear scan for the minimum would
+        siteOrder_.assign(siteCount, std::vector<uint32_t>());
+        for (uint32_t s = 0; s < siteCount; ++s) {
+            std::vector<uint32_t>& order = siteOrder_[s];
+            order.resize(siteCount);
+            std::iota(order.begin(), order.end(), 0u);
+            const double* latency = edgeTopology_.latencyRow(s);
+            std::stable_sort(order.begin(), order.end(),
+                             [latency](uint32_t a, uint32_t b) { return latency[a] < latency[b]; });
+        }
+    }
+    
+    // Closest reachable site hosting the type, from the site's latency order
+    auto closestHost = [&](size_t t, uint32_t site) {
+        const double* latency = edgeTopology_.latencyRow(site);
+        for (uint32_t s : siteOrder_[site]) {
+            if (latency[s] == std::numeric_limits<double>::infinity()) break;
+            if (hostedCount_[t][s] > 0) return s;
+        }
+        return none;
+    };
+    auto hostAdded = [&](size_t t, uint32_t host) {
+        if (host == none || hostedCount_[t][host]++ > 0) return;
+        std::vector<uint32_t>& nearest = nearestHost_[t];
+        const double* latency = edgeTopology_.latencyRow(host);     // Symmetric
+        for (uint32_t s = 0; s < siteCount; ++s) {
+            if (latency[s] == std::numeric_limits<double>::infinity()) continue;
+            double current = nearest[s] == none ? std::numeric_limits<double>::infinity()
+                                                : edgeTopology_.latency(s, nearest[s]);
+            if (latency[s] < current || (latency[s] == current && host < nearest[s])) {
+                nearest[s] = host;
+            }
+        }
+    };
+    auto hostRemoved = [&](size_t t, uint32_t host) {
+        if (host == none || --hostedCount_[t][host] > 0) return;
+        std::vector<uint32_t>& nearest = nearestHost_[t];
+        for (uint32_t s = 0; s < siteCount; ++s) {
+            if (nearest[s] == host) {
+                nearest[s] = closestHost(t, s);
+            }
+        }
+    };
+    
+    if (!rebuild) {
+        fleetChanges_.clear();
+        rebuild = vnfRegistry_.readJournal(fleetCursor_, fleetChanges_) > 0;
+    }
+    if (rebuild) {
+        fleetCursor_ = vnfRegistry_.journalHead();
+        for (size_t t = 0; t < VNF_TYPE_COUNT; ++t) {
+            hostedCount_[t].assign(siteCount, 0);
+            for (uint32_t id = 0; id < vnfRegistry_.locationCount(); ++id) {
+                uint32_t s = locationSite(id);
+                if (s != none) {
+                    hostedCount_[t][s] += static_cast<uint32_t>(vnfRegistry_.count(static_cast<VNFType>(t), id));
+                }
+            }
+            nearestHost_[t].resize(siteCount);
+            for (uint32_t s = 0; s < siteCount; ++s) {
+                nearestHost_[t][s] = closestHost(t, s);
+            }
+        }
+        return;
+    }
+    
+    for (const VNFChange& change : fleetChanges_) {
+        size_t t = static_cast<size_t>(change.type);
+        switch (change.kind) {
+            case VNFChangeKind::CREATED:
+                hostAdded(t, locationSite(change.toLocation));
+                break;
+            case VNFChangeKind::DESTROYED:
+                hostRemoved(t, locationSite(change.fromLocation));
+                break;
+            case VNFChangeKind::RELOCATED:
+                hostAdded(t, locationSite(change.toLocation));
+                hostRemoved(t, locationSite(change.fromLocation));
+                break;
+            case VNFChangeKind::STATE_CHANGED:
+                break;
+        }
+    }
+}
+
+uint32_t OMNeTOrchestrator::nodeSite(uint32_t node) {
+    while (nodeSites_.size() <= node) {
+        nodeSites_.push_back(edgeTopology_.findSite(
+            NodeMetricsMatrix::locationName(static_cast<uint32_t>(nodeSites_.size()))));
+    }
+    return nodeSites_[node];
+}
+
+uint32_t OMNeTOrchestrator::locationSite(uint32_t location) {
+    while (locationSites_.size() <= location) {
+        locationSites_.push_back(edgeTopology_.findSite(
+            vnfRegistry_.locationName(static_cast<uint32_t>(locationSites_.size()))));
+    }
+    return locationSites_[location];
+}
+
+// Fills the site evaluator's columns from the registry's per-location aggregates and the
+// per-node metrics, O(1) per site and per node, through the cached site lookups
+void OMNeTOrchestrator::fillSiteColumns() {
+    const size_t siteCount = edgeTopology_.siteCount();
+    float* capacity = siteEvaluator_.capacity();
+    if (siteEvaluator_.size() != siteCount) {
+        siteEvaluator_.resize(siteCount);
+        capacity = siteEvaluator_.capacity();
+        for (uint32_t s = 0; s < siteCount; ++s) {
+            capacity[s] = static_cast<float>(edgeTopology_.site(s).cpuCapacity);
         }
     }
     
-    // Emergency response for safety messages
-    if (metrics.emergencyMessages > 0) {
+    float* reserved = siteEvaluator_.reserved();
+    float* cpu = siteEvaluator_.cpu();
+    uint16_t* instances = siteEvaluator_.instances();
+    uint8_t* duplicateType = siteEvaluator_.duplicateType();
+    float* rate = siteEvaluator_.interestRate();
+    float* hitRatio = siteEvaluator_.hitRatio();
+    
+    std::array<float, VNF_TYPE_COUNT> footprint;
+    for (size_t t = 0; t < VNF_TYPE_COUNT; ++t) {
+        footprint[t] = static_cast<float>(vnfFootprint(static_cast<VNFType>(t)).cpu);
+    }
+    {
+        std::lock_guard<std::mutex> lock(nfvStateMutex_);
+        refreshSiteCaches();
+        for (; mappedLocations_ < vnfRegistry_.locationCount(); ++mappedLocations_) {
+            uint32_t s = locationSite(mappedLocations_);
+            if (s != EdgeTopology::INVALID_SITE) {
+                siteLocations_[s] = mappedLocations_;
+            }
+        }
+        
+        for (uint32_t s = 0; s < siteCount; ++s) {
+            reserved[s] = s < inbound_.size() ? static_cast<float>(inbound_[s].cpu) : 0.0f;  // Migrating in
+            cpu[s] = 0.0f;
+            instances[s] = 0;
+            duplicateType[s] = SiteEvaluator::NO_TYPE;
+            rate[s] = 0.0f;
+            hitRatio[s] = 0.0f;
+            
+            uint32_t id = siteLocations_[s];
+            if (id == NO_LOCATION) continue;
+            const UtilizationAggregate& load = vnfRegistry_.utilizationAt(id);
+            instances[s] = static_cast<uint16_t>(std::min<uint32_t>(load.instances(), 0xffff));
+            cpu[s] = static_cast<float>(load.cpu.mean());
+            for (size_t t = 0; t < VNF_TYPE_COUNT; ++t) {
+                size_t hosted = vnfRegistry_.count(static_cast<VNFType>(t), id);
+                reserved[s] += hosted * footprint[t];
+                if (hosted >= 2) {
+                    duplicateType[s] = static_cast<uint8_t>(t);
+                }
+            }
+        }
+    }
+    
+    const std::vector<NodeMetricsRow>& rows = nodeMetrics_.rows();
+    for (uint32_t node = 0; node < rows.size(); ++node) {
+        if (!rows[node].present) continue;
+        uint32_t s = nodeSite(node);
+        if (s == EdgeTopology::INVALID_SITE) continue;
+        // A node without Content Store lookups has no misses to act on
+        const NodeMetricsRow& row = rows[node];
+        rate[s] += static_cast<float>(row.interestRate);
+        hitRatio[s] = row.csHits + row.csMisses > 0 ? static_cast<float>(row.cacheHitRatio()) : 1.0f;
+    }
+}
+
+// Per-site verdicts: every site is evaluated each report, but only the sites whose verdict
+// changed become decisions. A type the fleet-wide policy already scales in this pass is
+// left to it, and a verdict that cannot be acted on is released to be retried.
+void OMNeTOrchestrator::addSiteDecisions(const NDNMetrics& metrics, std::vector<NFVDecision>& decisions) {
+    fillSiteColumns();
+    const std::vector<SiteChange>& changes = siteEvaluator_.evaluate();
+    if (changes.empty()) {
+        return;
+    }
+    
+    std::array<bool, VNF_TYPE_COUNT> scaling{};
+    for (const auto& decision : decisions) {
+        if (decision.action == "SCALE_UP" || decision.action == "SCALE_DOWN") {
+            scaling[static_cast<size_t>(decision.vnfType)] = true;
+        }
+    }
+    
+    const float* cpu = siteEvaluator_.cpu();
+    for (const SiteChange& change : changes) {
+        const uint32_t s = change.site;
+        const std::string& site = edgeTopology_.site(s).name;
+        if (change.verdict == SiteVerdict::HOLD) continue;
+        
         NFVDecision decision;
-        decision.vnfType = VNFType::SECURITY_VNF;
-        decision.action = "SCALE_UP";
-        decision.targetInstances = 2;
-        decision.targetLocation = "RSU_1";
-        decision.reason = "Emergency messages detected: " + std::to_string(metrics.emergencyMessages);
+        decision.action = siteVerdictName(change.verdict);
+        if (change.verdict == SiteVerdict::SCALE_DOWN) {
+            decision.vnfType = static_cast<VNFType>(siteEvaluator_.duplicateType()[s]);
+        } else if (change.verdict == SiteVerdict::OPTIMIZE) {
+            decision.vnfType = VNFType::CACHE_OPTIMIZER;
+        } else {
+            std::lock_guard<std::mutex> lock(nfvStateMutex_);
+            decision.vnfType = hottestTypeAt(site);
+        }
+        decision.targetInstances = 0;
+        decision.sourceLocation = site;
+        decision.targetLocation = site;
+        decision.reasonKey = std::string("site:") + siteVerdictName(change.verdict);
         decision.timestamp = currentTime_;
-        decision.priority = 1; // Critical
+        decision.priority = 3;
+        size_t count = modeledInstances_[static_cast<size_t>(decision.vnfType)];
+        
+        std::ostringstream reason;
+        reason << std::fixed << std::setprecision(2) << "Site " << site << ": ";
+        
+        switch (change.verdict) {
+            case SiteVerdict::HOLD:
+                continue;
+            
+            case SiteVerdict::SCALE_UP:
+            case SiteVerdict::SCALE_DOWN:
+                if (scaling[static_cast<size_t>(decision.vnfType)]) continue;
+                if (change.verdict == SiteVerdict::SCALE_DOWN && !shouldScaleDown(metrics, decision.vnfType)) {
+                    siteEvaluator_.release(s);
+                    continue;
+                }
+                scaling[static_cast<size_t>(decision.vnfType)] = true;
+                if (change.verdict == SiteVerdict::SCALE_UP) {
+                    // In place when the site has room, else on the closest site that does
+                    uint32_t target = reserveSite(s, decision.vnfType);
+                    if (target == EdgeTopology::INVALID_SITE) {
+                        siteEvaluator_.release(s);
+                        continue;
+                    }
+                    decision.targetLocation = edgeTopology_.site(target).name;
+                    decision.targetInstances = static_cast<int>(count + 1);
+                    decision.priority = 2;
+                    reason << "modeled CPU " << cpu[s] << " above " << cpuScaleUp_;
+                } else {
+                    decision.targetInstances = static_cast<int>(count - 1);
+                    reason << "modeled CPU " << cpu[s] << " below " << cpuScaleDown_
+                           << " with duplicate " << vnfTypeToString(decision.vnfType) << " instances";
+                }
+                break;
+            
+            case SiteVerdict::MIGRATE: {
+                uint32_t target = reserveSite(s, decision.vnfType, false);
+                if (target == EdgeTopology::INVALID_SITE) {
+                    siteEvaluator_.release(s);
+                    continue;
+                }
+                decision.targetLocation = edgeTopology_.site(target).name;
+                decision.targetInstances = 1;
+                decision.priority = 2;
+                reason << siteEvaluator_.reserved()[s] << " cores reserved of " << siteEvaluator_.capacity()[s];
+                break;
+            }
+            
+            case SiteVerdict::OPTIMIZE:
+                reason << siteEvaluator_.interestRate()[s] << " Interests/s at cache hit ratio "
+                       << siteEvaluator_.hitRatio()[s];
+                decision.reason = reason.str();
+                if (!refineCacheDecision(decision, metrics, false)) {
+                    siteEvaluator_.release(s);
+                    continue;
+                }
+                decisions.push_back(decision);
+                continue;
+        }
         
+        decision.reason = reason.str();
         decisions.push_back(decision);
-        performanceMetrics_.emergencyResponses++;
+    }
+}
+
+// Closest site with room for one more instance of the type, from the site columns (the site
+// itself counts when `inPlace`); the footprint is booked against it so one cycle does not
+// overfill a target. Unreachable sites never qualify.
+uint32_t OMNeTOrchestrator::reserveSite(uint32_t site, VNFType vnfType, bool inPlace) {
+    const float needed = static_cast<float>(vnfFootprint(vnfType).cpu);
+    const float* capacity = siteEvaluator_.capacity();
+    float* reserved = siteEvaluator_.reserved();
+    
+    // Sites closest first, so the walk usually stops within the first few
+    for (uint32_t s : siteOrder_[site]) {
+        if ((inPlace || s != site) && capacity[s] - reserved[s] >= needed &&
+            siteEvaluator_.verdict(s) != SiteVerdict::MIGRATE &&
+            edgeTopology_.latency(site, s) < std::numeric_limits<double>::infinity()) {
+            reserved[s] += needed;
+            return s;
+        }
+    }
+    return EdgeTopology::INVALID_SITE;
+}
+
+// Type of the hottest instance at a location (caller holds nfvStateMutex_)
+VNFType OMNeTOrchestrator::hottestTypeAt(const std::string& location) const {
+    VNFType hottest = VNFType::NDN_ROUTER;
+    double hottestCpu = -1.0;
+    for (size_t t = 0; t < VNF_TYPE_COUNT; ++t) {
+        vnfRegistry_.forEachAt(static_cast<VNFType>(t), location, [&](VNFHandle, const VNFInstance& instance) {
+            if (instance.cpuUsage > hottestCpu) {
+                hottestCpu = instance.cpuUsage;
+                hottest = instance.type;
+            }
+        });
+    }
+    return hottest;
+}
+
+// Splits the Interest rate into SLA classes from the growth of the follower's cumulative
+// emergency and safety counters since the previous report; returns the seconds since it
+double OMNeTOrchestrator::updateClassMix(const NDNMetrics& metrics) {
+    double time = metrics.timestamp > 0.0 ? metrics.timestamp : currentTime_.load();
+    double elapsed = classMixTime_ >= 0.0 ? time - classMixTime_ : 0.0;
+    classMixTime_ = time;
+    
+    // A counter that went back means the follower restarted
+    const double counts[2] = {static_cast<double>(metrics.emergencyMessages), static_cast<double>(metrics.safetyMessages)};
+    double grown[2];
+    for (size_t i = 0; i < 2; ++i) {
+        grown[i] = counts[i] >= classCounts_[i] ? counts[i] - classCounts_[i] : counts[i];
+        classCounts_[i] = counts[i];
+    }
+    if (elapsed <= 0.0) {
+        return 0.0;
     }
     
-    performanceMetrics_.totalDecisions += decisions.size();
+    double total = 0.0;
+    for (const auto& row : nodeMetrics_.rows()) {
+        if (row.present) total += row.interestRate;
+    }
+    if (total > 0.0) {
+        double emergency = std::min(1.0, grown[0] / elapsed / total);
+        double awareness = std::min(1.0 - emergency, grown[1] / elapsed / total);
+        classMix_ = {emergency, awareness, 1.0 - emergency - awareness};
+    }
+    return elapsed;
+}
+
+// Routes each node's Interest rate to the nearest instance of every VNF type, admits it
+// per SLA class, solves the queueing model for all instances, stores the modeled loads in
+// the registry and adds the on-path sojourn times to the reported latency
+void OMNeTOrchestrator::applyLoadModel(NDNMetrics& metrics) {
+    std::lock_guard<std::mutex> lock(nfvStateMutex_);
+    advanceMigrations();
+    publishFleetGauges();
+    double elapsed = updateClassMix(metrics);
+    double reportedLatency = metrics.avgLatency;
+    
+    loadModel_.clear();
+    loadModelHandles_.clear();
+    loadModel_.reserve(vnfRegistry_.size());
+    classModel_.clear();
+    
+    refreshSiteCaches();
+    const size_t siteCount = edgeTopology_.siteCount();
+    std::vector<double> siteRate(siteCount, 0.0);
+    std::vector<uint32_t> siteInstances(siteCount, 0);
+    std::array<size_t, VNF_TYPE_COUNT> firstRow{};
+    
+    for (size_t t = 0; t < VNF_TYPE_COUNT; ++t) {
+        VNFType type = static_cast<VNFType>(t);
+        firstRow[t] = loadModel_.size();
+        
+        std::vector<std::pair<VNFHandle, uint32_t>> instances;
+        std::vector<uint32_t> hosts;
+        vnfRegistry_.forEachOfType(type, [&](VNFHandle handle, const VNFInstance&) {
+            uint32_t site = locationSite(vnfRegistry_.locationIdOf(handle));
+            instances.emplace_back(handle, site);
+            if (site != EdgeTopology::INVALID_SITE && siteInstances[site]++ == 0) {
+                hosts.push_back(site);
+            }
+        });
+        if (instances.empty()) continue;
+        
+        // Nodes outside the topology, or with no reachable host, are spread over all instances
+        double unrouted = 0.0;
+        for (const auto& row : nodeMetrics_.rows()) {
+            if (!row.present || row.interestRate <= 0.0) continue;
+            uint32_t node = nodeSite(row.nodeId);
+            uint32_t best = node != EdgeTopology::INVALID_SITE ? nearestHost_[t][node] : EdgeTopology::INVALID_SITE;
+            if (best != EdgeTopology::INVALID_SITE) {
+                siteRate[best] += row.interestRate;
+            } else {
+                unrouted += row.interestRate;
+            }
+        }
+        
+        double share = unrouted / instances.size();
+        uint32_t servers = static_cast<uint32_t>(std::ceil(vnfFootprint(type).cpu));
+        VNFServiceProfile profile = vnfServiceProfile(type);
+        for (const auto& instance : instances) {
+            double rate = share;
+            if (instance.second != EdgeTopology::INVALID_SITE) {
+                rate += siteRate[instance.second] / siteInstances[instance.second];
+            }
+            // Post-copy faults slow the instance until its state has arrived
+            VNFServiceProfile served = profile;
+            served.serviceRate *= migrations_.serviceFactor(instance.first);
+            
+            // Only what the class token buckets admit reaches the queue
+            ClassRates offered;
+            for (size_t k = 0; k < TRAFFIC_CLASS_COUNT; ++k) {
+                offered[k] = rate * profile.packetsPerInterest * classMix_[k];
+            }
+            size_t row = classModel_.add(instance.first, offered, served.serviceRate, servers, elapsed);
+            loadModel_.add(classModel_.admittedTotal(row) / profile.packetsPerInterest, served, servers);
+            loadModelHandles_.push_back(instance.first);
+        }
+        
+        for (uint32_t host : hosts) {
+            siteRate[host] = 0.0;
+            siteInstances[host] = 0;
+        }
+    }
     
-    return decisions;
+    loadModel_.evaluate();
+    classModel_.evaluate(loadModel_);
+    
+    for (size_t row = 0; row < loadModel_.size(); ++row) {
+        vnfRegistry_.updateLoad(loadModelHandles_[row],
+                                {loadModel_.cpu(row), loadModel_.memory(row), loadModel_.utilization(row)});
+    }
+    
+    std::array<double, TRAFFIC_CLASS_COUNT> delivered;
+    delivered.fill(1.0);
+    for (size_t k = 0; k < TRAFFIC_CLASS_COUNT; ++k) {
+        modeledClasses_[k] = {0.0, reportedLatency, 0.0};
+    }
+    
+    for (size_t t = 0; t < VNF_TYPE_COUNT; ++t) {
+        VNFType type = static_cast<VNFType>(t);
+        modeledInstances_[t] = vnfRegistry_.count(type);
+        modeledCpu_[t] = vnfRegistry_.utilization(type).cpu.mean();
+        
+        // Traffic-weighted sojourn time through this VNF type
+        size_t last = t + 1 < VNF_TYPE_COUNT ? firstRow[t + 1] : loadModel_.size();
+        double carried = 0.0;
+        double weightedDelay = 0.0;
+        for (size_t row = firstRow[t]; row < last; ++row) {
+            // Interests reaching an instance in its migration downtime wait for the switchover
+            double stall = migrations_.stall(loadModelHandles_[row], currentTime_);
+            carried += loadModel_.arrivalRate(row);
+            weightedDelay += loadModel_.arrivalRate(row) * (loadModel_.delay(row) + stall);
+        }
+        if (carried > 0.0 && vnfServiceProfile(type).onPath) {
+            metrics.avgLatency += weightedDelay / carried;
+        }
+        
+        // The same per class; a class loses whatever any on-path type refuses or drops
+        if (!vnfServiceProfile(type).onPath) continue;
+        for (size_t k = 0; k < TRAFFIC_CLASS_COUNT; ++k) {
+            double offered = 0.0;
+            double admitted = 0.0;
+            double lost = 0.0;
+            double classDelay = 0.0;
+            for (size_t row = firstRow[t]; row < last; ++row) {
+                double stall = migrations_.stall(loadModelHandles_[row], currentTime_);
+                offered += classModel_.offered(row, k);
+                admitted += classModel_.admitted(row, k);
+                lost += classModel_.offered(row, k) * classModel_.loss(row, k);
+                classDelay += classModel_.admitted(row, k) * (classModel_.delay(row, k) + stall);
+            }
+            if (admitted > 0.0) {
+                modeledClasses_[k].latency += classDelay / admitted;
+            }
+            if (offered > 0.0) {
+                delivered[k] *= 1.0 - lost / offered;
+                modeledClasses_[k].offered = std::max(modeledClasses_[k].offered,
+                                                      offered / vnfServiceProfile(type).packetsPerInterest);
+            }
+        }
+    }
+    for (size_t k = 0; k < TRAFFIC_CLASS_COUNT; ++k) {
+        modeledClasses_[k].loss = 1.0 - delivered[k];
+    }
 }
 
-bool OMNeTOrchestrator::shouldScaleUp(const NDNMetrics& metrics, VNFType vnfType) {
-    switch (vnfType) {
-        case VNFType::NDN_ROUTER:
-            return metrics.pitSize > PIT_SCALE_THRESHOLD;
-        case VNFType::TRAFFIC_ANALYZER:
-            return metrics.networkUtilization > 0.8;
-        case VNFType::SECURITY_VNF:
-            return metrics.emergencyMessages > 5;
-        case VNFType::CACHE_OPTIMIZER:
-            return metrics.cacheHitRatio < 0.3;
-        default:
-            return false;
+void OMNeTOrchestrator::recordReportedHistory(double time, const NDNMetrics& metrics) {
+    const double values[REPORTED_HISTORY_COUNT] = {
+        static_cast<double>(metrics.pitSize), static_cast<double>(metrics.fibEntries), metrics.cacheHitRatio,
+        static_cast<double>(metrics.interestCount), static_cast<double>(metrics.dataCount), metrics.avgLatency,
+        static_cast<double>(metrics.unsatisfiedInterests), static_cast<double>(metrics.emergencyMessages),
+        static_cast<double>(metrics.safetyMessages), metrics.networkUtilization
+    };
+    
+    static_assert(std::tuple_size<decltype(latestReported_)>::value == REPORTED_HISTORY_COUNT,
+                  "latestReported_ holds one value per reported series");
+    for (size_t i = 0; i < REPORTED_HISTORY_COUNT; ++i) {
+        latestReported_[i].store(values[i], std::memory_order_relaxed);
+    }
+    
+    std::lock_guard<std::mutex> lock(historyMutex_);
+    for (size_t i = 0; i < REPORTED_HISTORY_COUNT; ++i) {
+        metricsHistory_.append(historySeries_[i], time, values[i]);
     }
 }
 
-int OMNeTOrchestrator::calculateRequiredInstances(const NDNMetrics& metrics, VNFType vnfType) {
-    switch (vnfType) {
-        case VNFType::NDN_ROUTER:
-            return std::min(5, static_cast<int>(metrics.pitSize / 50) + 1);
-        case VNFType::TRAFFIC_ANALYZER:
-            return std::min(3, static_cast<int>(metrics.networkUtilization * 4));
-        case VNFType::SECURITY_VNF:
-            return std::min(3, static_cast<int>(metrics.emergencyMessages / 3) + 1);
-        default:
-            return 1;
+// Decide stage only: the modeled loads are written by applyLoadModel on the same thread
+void OMNeTOrchestrator::recordModeledHistory(double time, const NDNMetrics& metrics) {
+    std::lock_guard<std::mutex> lock(historyMutex_);
+    size_t next = REPORTED_HISTORY_COUNT;
+    metricsHistory_.append(historySeries_[next++], time, metrics.avgLatency);
+    for (size_t k = 0; k < TRAFFIC_CLASS_COUNT; ++k) {
+        metricsHistory_.append(historySeries_[next++], time, modeledClasses_[k].latency);
+        metricsHistory_.append(historySeries_[next++], time, modeledClasses_[k].loss);
+    }
+    for (size_t t = 0; t < VNF_TYPE_COUNT; ++t) {
+        metricsHistory_.append(historySeries_[next++], time, modeledCpu_[t]);
+    }
+    for (size_t t = 0; t < VNF_TYPE_COUNT; ++t) {
+        metricsHistory_.append(historySeries_[next++], time, static_cast<double>(modeledInstances_[t]));
+    }
+}
+
+Rollup OMNeTOrchestrator::summarizeHistory(const std::string& series, double from, double to) const {
+    std::lock_guard<std::mutex> lock(historyMutex_);
+    return metricsHistory_.summarize(metricsHistory_.find(series), from, to);
+}
+
+size_t OMNeTOrchestrator::queryHistory(const std::string& series, Resolution resolution, double from, double to,
+                                       std::vector<Rollup>& out) const {
+    std::lock_guard<std::mutex> lock(historyMutex_);
+    return metricsHistory_.rollups(metricsHistory_.find(series), resolution, from, to, out);
+}
+
+void OMNeTOrchestrator::exportMetrics(const std::string& filename) const {
+    std::ofstream file(filename);
+    if (!file.is_open()) {
+        std::cerr << "❌ Failed to open metrics export file: " << filename << std::endl;
+        return;
+    }
+    
+    std::lock_guard<std::mutex> lock(historyMutex_);
+    
+    file << "# V2X-NDN-NFV Co-simulation Metrics History\n";
+    file << "# Series: " << metricsHistory_.seriesCount() << ", memory: " << metricsHistory_.memoryBytes() << " bytes\n";
+    file << "series,resolution_s,start,min,max,avg,count\n";
+    
+    std::vector<Rollup> buckets;
+    for (SeriesId id = 0; id < metricsHistory_.seriesCount(); ++id) {
+        for (size_t r = 0; r < RESOLUTION_COUNT; ++r) {
+            buckets.clear();
+            metricsHistory_.rollups(id, static_cast<Resolution>(r), -std::numeric_limits<double>::infinity(),
+                                    std::numeric_limits<double>::infinity(), buckets);
+            for (const auto& bucket : buckets) {
+                file << metricsHistory_.name(id) << "," << metricsHistory_.config().tierWidth[r] << ","
+                     << bucket.start << "," << bucket.min << "," << bucket.max << ","
+                     << bucket.avg() << "," << bucket.count << "\n";
+            }
+        }
+    }
+    
+    file.close();
+    std::cout << "📁 Metrics history exported to: " << filename << std::endl;
+}
+
+void OMNeTOrchestrator::publishFleetGauges() {
+    for (size_t t = 0; t < VNF_TYPE_COUNT; ++t) {
+        liveInstances_[t].store(static_cast<uint32_t>(vnfRegistry_.count(static_cast<VNFType>(t))),
+                                std::memory_order_relaxed);
     }
+    liveMigrations_.store(static_cast<uint32_t>(migrations_.active()), std::memory_order_relaxed);
+}
+
+// Scrapes read only atomics, lock-free histograms and the SPSC queue indices; the
+// registry and the metrics history stay with the pipeline stages that own them
+void OMNeTOrchestrator::writePrometheus(PrometheusWriter& out) const {
+    out.gauge("cosim_follower_connected", "Whether an ndnSIM follower is connected", followerConnected_ ? 1.0 : 0.0);
+    out.histogram("cosim_sync_round_trip_seconds", "Time sync command to follower acknowledgment",
+                  syncRoundTrip_);
+    out.histogram("cosim_nfv_decide_seconds", "Load model and NFV policy for one report", decideLatency_);
+    for (size_t t = 0; t < COSIM_MESSAGE_TYPE_COUNT; ++t) {
+        out.counter("cosim_follower_messages_total", "Messages received from the follower",
+                    static_cast<double>(messageHandling_[t].count()),
+                    PrometheusWriter::label("type", coSimMessageTypeName(static_cast<CoSimMessage::Type>(t))));
+    }
+    for (size_t t = 0; t < COSIM_MESSAGE_TYPE_COUNT; ++t) {
+        out.histogram("cosim_follower_message_handling_seconds", "Reading, parsing and queueing one follower message",
+                      messageHandling_[t],
+                      PrometheusWriter::label("type", coSimMessageTypeName(static_cast<CoSimMessage::Type>(t))));
+    }
+    
+    out.counter("cosim_metrics_reports_total", "ndnSIM metrics reports ingested",
+                static_cast<double>(performanceMetrics_.metricsReports));
+    out.counter("cosim_metrics_reports_coalesced_total", "Reports superseded before their decision started",
+                static_cast<double>(performanceMetrics_.coalescedReports));
+    out.counter("cosim_metrics_reports_dropped_total", "Reports dropped on a full pipeline queue",
+                static_cast<double>(performanceMetrics_.droppedReports));
+    out.counter("cosim_nfv_decisions_total", "NFV decisions made", static_cast<double>(performanceMetrics_.totalDecisions));
+    out.counter("cosim_nfv_decisions_coalesced_total", "Decisions merged with an equivalent pending one",
+                static_cast<double>(performanceMetrics_.coalescedDecisions));
+    out.counter("cosim_nfv_decisions_suppressed_total", "Decisions held back by the decision governor",
+                static_cast<double>(performanceMetrics_.suppressedDecisions));
+    out.counter("cosim_nfv_scaling_events_total", "VNF scale-ups and scale-downs executed",
+                static_cast<double>(performanceMetrics_.scalingEvents));
+    out.counter("cosim_nfv_migration_events_total", "VNF migrations started",
+                static_cast<double>(performanceMetrics_.migrationEvents));
+    out.counter("cosim_nfv_emergency_responses_total", "Emergency VNF deployments",
+                static_cast<double>(performanceMetrics_.emergencyResponses));
+    
+    const std::pair<const char*, size_t> queues[] = {
+        {"report", reportQueue_.size()}, {"actuate", actuateQueue_.size()}, {"publish", publishQueue_.size()}
+    };
+    for (const auto& queue : queues) {
+        out.gauge("cosim_pipeline_queue_depth", "Items waiting between pipeline stages",
+                  static_cast<double>(queue.second), PrometheusWriter::label("queue", queue.first));
+    }
+    out.gauge("cosim_pipeline_queue_capacity", "Capacity of each pipeline queue",
+              static_cast<double>(PIPELINE_QUEUE_CAPACITY));
+    
+    for (size_t t = 0; t < VNF_TYPE_COUNT; ++t) {
+        out.gauge("cosim_vnf_instances", "Live VNF instances by type",
+                  liveInstances_[t].load(std::memory_order_relaxed),
+                  PrometheusWriter::label("type", vnfTypeToString(static_cast<VNFType>(t))));
+    }
+    out.gauge("cosim_vnf_migrations_in_flight", "VNF state transfers in progress",
+              liveMigrations_.load(std::memory_order_relaxed));
+    
+    for (size_t i = 0; i < REPORTED_HISTORY_COUNT; ++i) {
+        out.gauge(REPORTED_GAUGES[i][0], REPORTED_GAUGES[i][1], latestReported_[i].load(std::memory_order_relaxed));
+    }
+}
+
+// Seasonal profile over the traffic-light cycle when the intersection scenario is active
+void OMNeTOrchestrator::configureForecaster() {
+    ForecastConfig config;
+    if (useKathmanduScenario_ || scenarioType_ == "kathmandu_intersection") {
+        config.seasonPeriod = TRAFFIC_LIGHT_CYCLE;
+        // Slow level and trend so the phase-to-phase swings are learned by the seasonal profile
+        config.alpha = 0.1;
+        config.beta = 0.01;
+    }
+    forecaster_.configure(config);
+}
+
+// Size and place the cache from the request distribution when the follower reports one
+// (`relocate` false keeps the decision's site).
+// Returns false when the distribution is near-uniform and a larger cache would not raise the hit ratio.
+bool OMNeTOrchestrator::refineCacheDecision(NFVDecision& decision, const NDNMetrics& metrics, bool relocate) {
+    if (popularity_.empty()) {
+        return true;
+    }
+    
+    double share = popularity_.topShare();
+    if (share < POPULARITY_MIN_SHARE) {
+        return false;
+    }
+    
+    std::vector<HeavyHitter> top = popularity_.topPrefixes();
+    size_t hot = popularity_.prefixesForCoverage(CACHE_COVERAGE_TARGET);
+    if (hot == 0) hot = top.size();
+    for (size_t i = 0; i < hot && i < top.size(); ++i) {
+        decision.hotPrefixes.push_back(top[i].prefix);
+    }
+    decision.cacheCapacity = static_cast<uint32_t>(
+        std::ceil(popularity_.distinctNames() * std::min(share, CACHE_COVERAGE_TARGET)));
+    if (relocate) {
+        std::string site = findOptimalLocation(metrics, VNFType::CACHE_OPTIMIZER);
+        if (!site.empty()) {
+            decision.targetLocation = site;
+        }
+    }
+    decision.reason += ", " + std::to_string(decision.hotPrefixes.size()) + " prefixes carry " +
+                       std::to_string(static_cast<int>(share * 100)) + "% of requests";
+    return true;
+}
+
+// Rule locations: a site name, or "@selector[|fallback]" resolved against the per-node metrics
+std::string OMNeTOrchestrator::resolveLocation(const std::string& spec, const NDNMetrics& metrics, VNFType vnfType) {
+    if (spec.empty() || spec[0] != '@') {
+        return spec;
+    }
+    
+    size_t bar = spec.find('|');
+    std::string selector = spec.substr(1, bar == std::string::npos ? std::string::npos : bar - 1);
+    std::string fallback = bar == std::string::npos ? "" : spec.substr(bar + 1);
+    
+    if (selector == "optimal") {
+        return findOptimalLocation(metrics, vnfType);
+    }
+    
+    const NodeMetricsRow* node = nullptr;
+    if (selector == "max_pit_node") {
+        node = nodeMetrics_.maxPitNode();
+    } else if (selector == "max_latency_node") {
+        node = nodeMetrics_.maxLatencyNode();
+    } else if (selector == "min_cache_hit_node") {
+        node = nodeMetrics_.minCacheHitNode();
+    }
+    
+    if (node) {
+        return NodeMetricsMatrix::locationName(node->nodeId);
+    }
+    return fallback.empty() ? findOptimalLocation(metrics, vnfType) : fallback;
 }
 
 std::string OMNeTOrchestrator::findOptimalLocation(const NDNMetrics& metrics, VNFType vnfType) {
-    // Simple location optimization based on VNF type and metrics
+    // Capacity-aware placement against the per-node demand when the follower reports one
+    std::vector<std::string> sites;
+    if (planPlacement(vnfType, 1, sites)) {
+        return sites.empty() ? std::string() : sites.front();
+    }
+    
+    // No per-node demand: simple location optimization based on VNF type and metrics
     switch (vnfType) {
         case VNFType::NDN_ROUTER:
             return (metrics.avgLatency > 0.05) ? "EDGE_1" : "RSU_1";
@@ -436,6 +1718,82 @@ std::string OMNeTOrchestrator::findOptimalLocation(const NDNMetrics& metrics, VN
     }
 }
 
+// Places `instances` new VNFs on the edge topology, minimizing latency to the nodes where
+// requests enter. False when no reporting node maps onto a topology site; otherwise `sites`
+// holds one site per instance that fits, which may be fewer than asked for or none.
+bool OMNeTOrchestrator::planPlacement(VNFType vnfType, int instances, std::vector<std::string>& sites) {
+    sites.clear();
+    PlacementRequest request;
+    request.type = vnfType;
+    request.footprint = vnfFootprint(vnfType);
+    
+    for (const auto& row : nodeMetrics_.rows()) {
+        if (!row.present) continue;
+        uint32_t site = nodeSite(row.nodeId);
+        if (site == EdgeTopology::INVALID_SITE) continue;
+        
+        // Place for the demand expected once the instance is up, not only the current one
+        double rate = row.interestRate > 0.0 ? row.interestRate : static_cast<double>(row.interests);
+        rate = std::max(rate, forecaster_.forecastNodeRate(row.nodeId, FORECAST_HORIZON));
+        double weight = rate;
+        if (vnfType == VNFType::NDN_ROUTER) {
+            weight += row.pitSize;                       // Pending Interests wait on the forwarder
+        } else if (vnfType == VNFType::CACHE_OPTIMIZER) {
+            weight *= 1.0 - row.cacheHitRatio();         // Misses are what a new cache would absorb
+        }
+        if (weight > 0.0) {
+            request.demand.push_back({site, weight});
+        }
+    }
+    if (request.demand.empty()) {
+        return false;
+    }
+    if (instances <= 0) {
+        return true;
+    }
+    
+    // Residual capacity after the instances already running (the actuate stage mutates the
+    // registry), from the per-location counts rather than per instance
+    std::vector<SiteCapacity> capacity(edgeTopology_.siteCount());
+    for (uint32_t s = 0; s < capacity.size(); ++s) {
+        capacity[s].cpu = edgeTopology_.site(s).cpuCapacity;
+        capacity[s].memory = edgeTopology_.site(s).memoryCapacity;
+    }
+    {
+        std::lock_guard<std::mutex> lock(nfvStateMutex_);
+        refreshSiteCaches();
+        for (uint32_t id = 0; id < vnfRegistry_.locationCount(); ++id) {
+            uint32_t s = locationSite(id);
+            if (s == EdgeTopology::INVALID_SITE) continue;
+            for (size_t t = 0; t < VNF_TYPE_COUNT; ++t) {
+                size_t hosted = vnfRegistry_.count(static_cast<VNFType>(t), id);
+                VNFFootprint footprint = vnfFootprint(static_cast<VNFType>(t));
+                capacity[s].cpu -= hosted * footprint.cpu;
+                capacity[s].memory -= hosted * footprint.memory;
+            }
+        }
+        for (uint32_t s = 0; s < std::min(capacity.size(), inbound_.size()); ++s) {
+            capacity[s].cpu -= inbound_[s].cpu;
+            capacity[s].memory -= inbound_[s].memory;
+        }
+    }
+    
+    std::vector<PlacementRequest> requests(static_cast<size_t>(instances), request);
+    PlacementResult result = placementSolver_.solve(requests, capacity,
+                                                    placementBudget_);
+    
+    for (uint32_t s : result.sites) {
+        if (s != EdgeTopology::INVALID_SITE) {
+            sites.push_back(edgeTopology_.site(s).name);
+        }
+    }
+    if (result.unplaced > 0) {
+        std::cerr << "⚠️ No edge capacity for " << result.unplaced << " of " << instances << " "
+                  << vnfTypeToString(vnfType) << " instances" << std::endl;
+    }
+    return true;
+}
+
 void OMNeTOrchestrator::initializeKathmanduTopology() {
     std::cout << "🏙️  Initializing Kathmandu intersection topology..." << std::endl;
     
@@ -506,17 +1864,17 @@ void OMNeTOrchestrator::generateKathmanduTraffic() {
     std::cout << "✅ Generated " << vehicleCount << " vehicles for Kathmandu scenario" << std::endl;
 }
 
-// Parse NDN metrics from JSON string
-NDNMetrics OMNeTOrchestrator::parseNDNMetrics(const std::string& jsonStr) {
-    NDNMetrics metrics;
+// Parse an NDN metrics report from JSON string; node and popularity state are applied by the decide stage
+bool OMNeTOrchestrator::parseMetricsReport(const char* data, size_t size, MetricsReport& report) {
+    NDNMetrics& metrics = report.metrics;
     Json::Value json;
     Json::CharReaderBuilder builder;
     std::string errors;
     
-    std::istringstream stream(jsonStr);
-    if (!Json::parseFromStream(builder, stream, &json, &errors)) {
+    std::unique_ptr<Json::CharReader> reader(builder.newCharReader());
+    if (!reader->parse(data, data + size, &json, &errors)) {
         std::cerr << "❌ Failed to parse NDN metrics JSON: " << errors << std::endl;
-        return metrics; // Return default metrics
+        return false;
     }
     
     // Parse metrics fields
@@ -532,7 +1890,16 @@ NDNMetrics OMNeTOrchestrator::parseNDNMetrics(const std::string& jsonStr) {
     metrics.safetyMessages = json.get("safety_messages", 0).asUInt();
     metrics.networkUtilization = json.get("network_utilization", 0.0).asDouble();
     
-    return metrics;
+    // Sparse per-node delta: only rows changed since the follower's last report
+    if (json.isMember("node_delta")) {
+        report.nodeDelta = std::move(json["node_delta"]);
+    }
+    
+    if (json.isMember("popularity")) {
+        report.popularity = std::move(json["popularity"]);
+    }
+    
+    return true;
 }
 
 // ============================================================================
@@ -540,9 +1907,20 @@ NDNMetrics OMNeTOrchestrator::parseNDNMetrics(const std::string& jsonStr) {
 // ============================================================================
 
 void OMNeTOrchestrator::shutdown() {
-    std::cout << "🔌 Shutting down OMNeT++ orchestrator..." << std::endl;
+    if (verbose_) {
+        std::cout << "🔌 Shutting down OMNeT++ orchestrator..." << std::endl;
+    }
     running_ = false;
     
+    // Wakes a leader thread blocked in accept()
+    if (serverSocket_ >= 0) {
+        ::shutdown(serverSocket_, SHUT_RDWR);
+    }
+    if (leaderThread_.joinable()) {
+        leaderThread_.join();
+    }
+    stopPipeline();
+    
     // Close sockets
     if (followerSocket_ >= 0) {
         close(followerSocket_);
@@ -552,71 +1930,108 @@ void OMNeTOrchestrator::shutdown() {
         close(serverSocket_);
         serverSocket_ = -1;
     }
+    traceWriter_.close();
+    {
+        std::lock_guard<std::mutex> lock(nfvStateMutex_);
+        journalChanges(0);
+        decisionJournal_.close();
+    }
     
-    std::cout << "✅ OMNeT++ orchestrator shutdown complete" << std::endl;
+    if (verbose_) {
+        std::cout << "✅ OMNeT++ orchestrator shutdown complete" << std::endl;
+    }
+}
+
+bool OMNeTOrchestrator::migrateVNF(const std::string& instanceId, const std::string& targetLocation) {
+    if (!beginMigration(vnfRegistry_.find(instanceId), targetLocation, nullptr)) {
+        std::cerr << "❌ Unknown or migrating VNF instance " << instanceId << std::endl;
+        return false;
+    }
+    if (verbose_) {
+        std::cout << "📦 Migrated " << instanceId << " to " << targetLocation << std::endl;
+    }
+    performanceMetrics_.migrationEvents++;
+    return true;
 }
 
 bool OMNeTOrchestrator::deployVNF(VNFType type, const std::string& location) {
-    std::cout << "🚀 Deploying " << vnfTypeToString(type) << " VNF at " << location << std::endl;
+    if (verbose_) {
+        std::cout << "🚀 Deploying " << vnfTypeToString(type) << " VNF at " << location << std::endl;
+    }
     
     VNFInstance instance;
-    instance.instanceId = vnfTypeToString(type) + "_" + std::to_string(vnfInstances_[type].size());
+    instance.instanceId = vnfTypeToString(type) + "_" + std::to_string(vnfRegistry_.createdTotal(type));
     instance.type = type;
     instance.location = location;
-    instance.isActive = true;
+    instance.state = VNFState::ACTIVE;
     instance.cpuUsage = 0.3;  // Initial load
     instance.memoryUsage = 0.2;
+    instance.networkLoad = 0.0;
     instance.createdAt = std::chrono::steady_clock::now();
     
-    vnfInstances_[type].push_back(instance);
-    std::cout << "✅ VNF " << instance.instanceId << " deployed successfully" << std::endl;
+    std::string instanceId = instance.instanceId;
+    vnfRegistry_.create(std::move(instance));
+    if (verbose_) {
+        std::cout << "✅ VNF " << instanceId << " deployed successfully" << std::endl;
+    }
     
     return true;
 }
 
-CoSimMessage OMNeTOrchestrator::receiveMessage(int socket) {
-    CoSimMessage message;
-    char buffer[4096];
+// Returns one complete '\n'-terminated message at a time; partial reads stay buffered
+bool OMNeTOrchestrator::receiveMessage(int socket, CoSimMessage& message) {
+    size_t end = followerReadBuffer_.find('\n');
+    if (end == std::string::npos) {
+        char buffer[4096];
+        ssize_t bytesReceived = recv(socket, buffer, sizeof(buffer), MSG_DONTWAIT);
+        
+        if (bytesReceived == 0) {
+            throw std::runtime_error("follower closed the connection");
+        }
+        if (bytesReceived < 0) {
+            return false;
+        }
+        followerReadBuffer_.append(buffer, static_cast<size_t>(bytesReceived));
+        end = followerReadBuffer_.find('\n');
+        if (end == std::string::npos) {
+            return false;
+        }
+    }
     
-    ssize_t bytesReceived = recv(socket, buffer, sizeof(buffer) - 1, MSG_DONTWAIT);
+    std::string data = followerReadBuffer_.substr(0, end);
+    followerReadBuffer_.erase(0, end + 1);
     
-    if (bytesReceived > 0) {
-        buffer[bytesReceived] = '\0';
-        std::string data(buffer);
-        
-        Json::Value json;
-        Json::CharReaderBuilder builder;
-        std::string errors;
-        std::istringstream stream(data);
+    Json::Value json;
+    Json::CharReaderBuilder builder;
+    std::string errors;
+    std::istringstream stream(data);
+    
+    // Unparseable and unknown messages fall through to the caller's default case
+    message = CoSimMessage();
+    message.type = CoSimMessage::VEHICLE_UPDATE;
+    if (Json::parseFromStream(builder, stream, &json, &errors)) {
+        std::string type = json.get("type", "").asString();
+        message.timestamp = json.get("timestamp", 0.0).asDouble();
         
-        if (Json::parseFromStream(builder, stream, &json, &errors)) {
-            std::string type = json.get("type", "").asString();
-            
-            if (type == "NDN_METRICS") {
-                message.type = CoSimMessage::NDN_METRICS;
-                message.payload = data;
-                message.timestamp = json.get("timestamp", 0.0).asDouble();
-                
-                // Parse and handle metrics immediately
-                NDNMetrics metrics = parseNDNMetrics(data);
-                handleFollowerMetrics(metrics);
-                
-            } else if (type == "TIME_SYNC_ACK") {
-                message.type = CoSimMessage::TIME_SYNC;
-                syncAckReceived_ = true;
-                syncCondition_.notify_one();
-            }
+        if (type == "NDN_METRICS") {
+            message.type = CoSimMessage::NDN_METRICS;
+            message.payload = std::move(data);
+        } else if (type == "TIME_SYNC_ACK") {
+            message.type = CoSimMessage::TIME_SYNC;
         }
     }
     
-    return message;
+    return true;
 }
 
 bool OMNeTOrchestrator::sendMessage(int socket, const CoSimMessage& message) {
     // Convert message to string format
     std::string data = message.payload;
     
-    ssize_t bytesSent = send(socket, data.c_str(), data.length(), 0);
+    // Time sync (step thread) and NFV commands (publish stage) share the socket
+    TraceSpan span("socket_send", "io");
+    std::lock_guard<std::mutex> lock(communicationMutex_);
+    ssize_t bytesSent = send(socket, data.c_str(), data.length(), MSG_NOSIGNAL);
     if (bytesSent < 0) {
         std::cerr << "❌ Failed to send message to follower" << std::endl;
         return false;
@@ -682,73 +2097,215 @@ void OMNeTOrchestrator::handleEmergencyScenarios() {
     }
 }
 
-void OMNeTOrchestrator::executeNFVDecisions(const std::vector<NFVDecision>& decisions) {
-    for (const auto& decision : decisions) {
-        std::cout << "🎯 Executing NFV decision: " << decision.action 
-                  << " for " << vnfTypeToString(decision.vnfType) << std::endl;
+void OMNeTOrchestrator::executeNFVDecisions(std::vector<NFVDecision>& decisions) {
+    advanceMigrations();
+    vnfRegistry_.setTime(currentTime_);
+    journalChanges(0);  // Anything done outside a decision, such as the initial fleet
+    
+    for (auto& decision : decisions) {
+        if (verbose_) {
+            std::cout << "🎯 Executing NFV decision: " << decision.action 
+                      << " for " << vnfTypeToString(decision.vnfType) << std::endl;
+        }
         
         if (decision.action == "SCALE_UP") {
-            for (int i = 0; i < decision.targetInstances; ++i) {
-                deployVNF(decision.vnfType, decision.targetLocation);
+            // Planned scale-ups deploy only the instances that found room
+            bool deployed = false;
+            if (decision.placements.empty()) {
+                for (int i = 0; i < decision.targetInstances; ++i) {
+                    deployed |= deployVNF(decision.vnfType, decision.targetLocation);
+                }
+            } else {
+                size_t placed = std::min(decision.placements.size(),
+                                         static_cast<size_t>(std::max(0, decision.targetInstances)));
+                for (size_t slot = 0; slot < placed; ++slot) {
+                    deployed |= deployVNF(decision.vnfType, decision.placements[slot]);
+                }
+            }
+            if (deployed) {
+                performanceMetrics_.scalingEvents++;
             }
-            performanceMetrics_.scalingEvents++;
             
         } else if (decision.action == "SCALE_DOWN") {
-            // Remove VNF instances
-            auto& instances = vnfInstances_[decision.vnfType];
-            if (!instances.empty()) {
-                instances.pop_back();
-                std::cout << "⬇️ Scaled down " << vnfTypeToString(decision.vnfType) << std::endl;
+            // Remove the least loaded instance at the source, else the most recently indexed one
+            VNFHandle victim = leastLoaded(decision.vnfType, decision.sourceLocation);
+            if (!victim.valid()) {
+                victim = vnfRegistry_.lastOf(decision.vnfType);
+            }
+            const Migration* migration = migrations_.of(victim);
+            if (migration) {
+                if (migration->phase == MigrationPhase::COPYING || migration->phase == MigrationPhase::DOWNTIME) {
+                    holdInbound(*migration, -1.0);
+                }
+                migrations_.cancel(victim);
+            }
+            if (vnfRegistry_.destroy(victim)) {
+                performanceMetrics_.scalingEvents++;
+                if (verbose_) {
+                    std::cout << "⬇️ Scaled down " << vnfTypeToString(decision.vnfType) << std::endl;
+                }
             }
             
         } else if (decision.action == "MIGRATE") {
-            // Simulate VNF migration
-            auto& instances = vnfInstances_[decision.vnfType];
-            if (!instances.empty()) {
-                instances[0].location = decision.targetLocation;
-                std::cout << "📦 Migrated " << vnfTypeToString(decision.vnfType) 
-                          << " to " << decision.targetLocation << std::endl;
+            // Move instances away from the reported source, or any instance of the type;
+            // instances already in flight keep their migration
+            auto settled = [this](VNFType type, const std::string& location) {
+                VNFHandle found = location.empty() ? vnfRegistry_.firstOf(type) : vnfRegistry_.firstOf(type, location);
+                if (!migrations_.inFlight(found)) {
+                    return found;
+                }
+                found = VNFHandle();
+                auto consider = [&](VNFHandle handle, const VNFInstance&) {
+                    if (!found.valid() && !migrations_.inFlight(handle)) {
+                        found = handle;
+                    }
+                };
+                if (location.empty()) {
+                    vnfRegistry_.forEachOfType(type, consider);
+                } else {
+                    vnfRegistry_.forEachAt(type, location, consider);
+                }
+                return found;
+            };
+            
+            int moves = std::max(1, decision.targetInstances);
+            for (int i = 0; i < moves; ++i) {
+                VNFHandle handle = settled(decision.vnfType, decision.sourceLocation);
+                if (!handle.valid() && i == 0 && vnfRegistry_.count(decision.vnfType, decision.sourceLocation) == 0) {
+                    handle = settled(decision.vnfType, "");
+                }
+                if (!beginMigration(handle, decision.targetLocation, &decision)) {
+                    break;
+                }
+                if (verbose_ && migrations_.inFlight(handle)) {
+                    const Migration* migration = migrations_.of(handle);
+                    std::cout << "📦 Migrating " << vnfTypeToString(decision.vnfType) << " to "
+                              << decision.targetLocation << " (" << migration->stateBytes / 1e6 << " MB, "
+                              << migrationStrategyName(migration->strategy) << ", "
+                              << (migration->downtimeEnd - migration->downtimeStart) * 1e3 << " ms downtime)"
+                              << std::endl;
+                } else if (verbose_) {
+                    std::cout << "📦 Migrated " << vnfTypeToString(decision.vnfType) 
+                              << " to " << decision.targetLocation << std::endl;
+                }
                 performanceMetrics_.migrationEvents++;
             }
         }
         
+        if (decisionJournal_.isOpen()) {
+            journalChanges(decisionJournal_.appendDecision(currentTime_, decision, GovernorVerdict::ADMIT));
+        }
         logDecisionMaking(decision);
     }
+    advanceMigrations();
 }
 
-bool OMNeTOrchestrator::shouldMigrate(const NDNMetrics& metrics, VNFType type) {
-    // Decision logic for VNF migration based on metrics
-    if (metrics.avgLatency > LATENCY_THRESHOLD && type == VNFType::NDN_ROUTER) {
-        return true;
+// Relocates at once when migrations are instant, else starts an in-flight migration whose
+// footprint stays reserved at the target until it completes (caller holds nfvStateMutex_)
+bool OMNeTOrchestrator::beginMigration(VNFHandle handle, const std::string& targetLocation, NFVDecision* decision) {
+    const VNFInstance* instance = vnfRegistry_.get(handle);
+    if (!instance || migrations_.inFlight(handle)) {
+        return false;
     }
-    
-    if (metrics.cacheHitRatio < CACHE_EFFICIENCY_THRESHOLD && type == VNFType::CACHE_OPTIMIZER) {
-        return true;
+    if (migrations_.instant() || instance->location == targetLocation) {
+        return vnfRegistry_.relocate(handle, targetLocation);
     }
     
-    return false;
+    VNFFootprint footprint = vnfFootprint(instance->type);
+    double stateBytes = footprint.memory * 1e9 * std::min(1.0, std::max(0.0, instance->memoryUsage));
+    if (!migrations_.start(currentTime_, handle, instance->type, instance->location, targetLocation,
+                           footprint.cpu, stateBytes, instance->cpuUsage)) {
+        return false;
+    }
+    holdInbound(*migrations_.of(handle), 1.0);
+    if (decision && migrationTraffic_) {
+        const Migration* migration = migrations_.of(handle);
+        decision->transferBytes += migration->transferBytes;
+        decision->transferSeconds = std::max(decision->transferSeconds, migration->end - migration->start);
+    }
+    return true;
 }
 
-void OMNeTOrchestrator::updatePerformanceMetrics() {
-    performanceMetrics_.totalDecisions++;
-    
-    // Calculate resource utilization
-    double totalCpu = 0.0;
-    int totalInstances = 0;
+// Applies the phase changes due by now: the instance stops serving for its downtime and
+// serves from the target after the switchover (caller holds nfvStateMutex_)
+void OMNeTOrchestrator::advanceMigrations() {
+    if (migrations_.active() == 0) {
+        return;
+    }
+    migrationEvents_.clear();
+    migrations_.advance(currentTime_, migrationEvents_);
+    if (migrationEvents_.empty()) {
+        return;
+    }
     
-    for (const auto& [type, instances] : vnfInstances_) {
-        for (const auto& instance : instances) {
-            totalCpu += instance.cpuUsage;
-            totalInstances++;
+    vnfRegistry_.setTime(currentTime_);
+    for (const auto& event : migrationEvents_) {
+        const Migration& migration = event.migration;
+        bool switched = migration.phase == MigrationPhase::POST_COPYING ||
+                        (migration.phase == MigrationPhase::DONE && migration.strategy == MigrationStrategy::PRE_COPY);
+        if (migration.phase == MigrationPhase::DOWNTIME) {
+            vnfRegistry_.setState(migration.handle, VNFState::INACTIVE);
+        } else if (switched) {
+            holdInbound(migration, -1.0);
+            vnfRegistry_.relocate(migration.handle, migration.target);
+            vnfRegistry_.setState(migration.handle, VNFState::ACTIVE);
+        }
+        if (verbose_ && migration.phase == MigrationPhase::DONE) {
+            std::cout << "📦 Migrated " << vnfTypeToString(migration.type) << " to " << migration.target
+                      << " in " << migration.end - migration.start << " s" << std::endl;
         }
     }
-    
-    if (totalInstances > 0) {
-        performanceMetrics_.resourceUtilization = totalCpu / totalInstances;
+    journalChanges(0);
+}
+
+// The target's share of a migration, counted against its site until the switchover
+void OMNeTOrchestrator::holdInbound(const Migration& migration, double sign) {
+    uint32_t s = edgeTopology_.findSite(migration.target);
+    if (s == EdgeTopology::INVALID_SITE) {
+        return;
+    }
+    if (inbound_.size() <= s) {
+        inbound_.resize(edgeTopology_.siteCount(), SiteCapacity{0.0, 0.0});
+    }
+    VNFFootprint footprint = vnfFootprint(migration.type);
+    inbound_[s].cpu = std::max(0.0, inbound_[s].cpu + sign * footprint.cpu);
+    inbound_[s].memory = std::max(0.0, inbound_[s].memory + sign * footprint.memory);
+}
+
+// Appends the registry changes since the last call, attributed to `decision`
+void OMNeTOrchestrator::journalChanges(uint64_t decision) {
+    if (!decisionJournal_.isOpen()) {
+        return;
+    }
+    journalScratch_.clear();
+    uint64_t lost = vnfRegistry_.readJournal(journalCursor_, journalScratch_);
+    decisionJournal_.appendChanges(vnfRegistry_, journalScratch_, decision);
+    if (lost > 0) {
+        decisionJournal_.snapshot(currentTime_, vnfRegistry_);
     }
 }
 
+// Snapshots the fleet as it is now, so the journal replays from a known state
+bool OMNeTOrchestrator::recordDecisions(const std::string& path) {
+    std::lock_guard<std::mutex> lock(nfvStateMutex_);
+    if (!decisionJournal_.open(path)) {
+        return false;
+    }
+    journalCursor_ = vnfRegistry_.journalHead();
+    decisionJournal_.snapshot(currentTime_, vnfRegistry_);
+    return true;
+}
+
+void OMNeTOrchestrator::updatePerformanceMetrics() {
+    // Maintained incrementally by the registry; no walk over the fleet
+    std::lock_guard<std::mutex> lock(nfvStateMutex_);
+    performanceMetrics_.resourceUtilization = vnfRegistry_.utilization().cpu.mean();
+}
+
 void OMNeTOrchestrator::logDecisionMaking(const NFVDecision& decision) {
+    if (!verbose_) {
+        return;
+    }
     std::cout << "📊 NFV Decision Log: " << decision.action 
               << " for " << vnfTypeToString(decision.vnfType)
               << " at " << decision.timestamp << "s" << std::endl;
@@ -796,6 +2353,19 @@ std::string cosim::nfvDecisionToJson(const cosim::NFVDecision& decision) {
     json["reason"] = decision.reason;
     json["timestamp"] = decision.timestamp;
     json["priority"] = decision.priority;
+    if (decision.cacheCapacity > 0) {
+        json["cache_capacity"] = decision.cacheCapacity;
+    }
+    for (const auto& prefix : decision.hotPrefixes) {
+        json["hot_prefixes"].append(prefix);
+    }
+    for (const auto& site : decision.placements) {
+        json["placements"].append(site);
+    }
+    if (decision.transferBytes > 0.0) {
+        json["transfer"]["bytes"] = decision.transferBytes;
+        json["transfer"]["seconds"] = decision.transferSeconds;
+    }
     
     Json::StreamWriterBuilder builder;
     return Json::writeString(builder, json);
@@ -817,6 +2387,15 @@ cosim::NFVDecision cosim::jsonToNFVDecision(const std::string& jsonStr) {
         decision.reason = json.get("reason", "").asString();
         decision.timestamp = json.get("timestamp", 0.0).asDouble();
         decision.priority = json.get("priority", 1).asInt();
+        decision.cacheCapacity = json.get("cache_capacity", 0).asUInt();
+        for (const auto& prefix : json["hot_prefixes"]) {
+            decision.hotPrefixes.push_back(prefix.asString());
+        }
+        for (const auto& site : json["placements"]) {
+            decision.placements.push_back(site.asString());
+        }
+        decision.transferBytes = json["transfer"].get("bytes", 0.0).asDouble();
+        decision.transferSeconds = json["transfer"].get("seconds", 0.0).asDouble();
     }
     
     return decision;
@@ -9,6 +9,23 @@ Based on simulation methodology document
 
 #include "../common/synchronizer.h"
 #include "../common/message.h"
+#include "../common/metrics_trace.h"
+#include "../common/latency_histogram.h"
+#include "../common/node_metrics.h"
+#include "../common/popularity_sketch.h"
+#include "../common/spsc_queue.h"
+#include "../common/timeseries_store.h"
+#include "../nfv/edge_topology.h"
+#include "../nfv/decision_governor.h"
+#include "../nfv/decision_journal.h"
+#include "../nfv/metrics_forecaster.h"
+#include "../nfv/migration_tracker.h"
+#include "../nfv/nfv_rule_engine.h"
+#include "../nfv/placement_solver.h"
+#include "../nfv/service_classes.h"
+#include "../nfv/site_evaluator.h"
+#include "../nfv/vnf_load_model.h"
+#include "../nfv/vnf_registry.h"
 #include <string>
 #include <thread>
 #include <atomic>
@@ -18,44 +35,16 @@ Based on simulation methodology document
 #include <map>
 #include <vector>
 #include <functional>
+#include <array>
 #include <chrono>
 #include <sys/socket.h>
 #include <netinet/in.h>
 #include <unistd.h>
+#include <jsoncpp/json/json.h>
 
 namespace cosim {
 
-// VNF Types as defined in methodology
-enum class VNFType {
-    NDN_ROUTER,
-    TRAFFIC_ANALYZER, 
-    SECURITY_VNF,
-    CACHE_OPTIMIZER
-};
-
-// NFV Decision structure
-struct NFVDecision {
-    VNFType vnfType;
-    std::string action; // SCALE_UP, SCALE_DOWN, MIGRATE, OPTIMIZE
-    int targetInstances;
-    std::string sourceLocation;
-    std::string targetLocation;
-    std::string reason;
-    double timestamp;
-    int priority; // 1=critical, 2=high, 3=normal
-};
-
-// VNF Instance state
-struct VNFInstance {
-    std::string instanceId;
-    VNFType type;
-    std::string location;
-    double cpuUsage;
-    double memoryUsage;
-    double networkLoad;
-    bool isActive;
-    std::chrono::steady_clock::time_point createdAt;
-};
+class PrometheusWriter;
 
 // Co-simulation message types
 struct CoSimMessage {
@@ -72,6 +61,9 @@ struct CoSimMessage {
     int priority;
 };
 
+constexpr size_t COSIM_MESSAGE_TYPE_COUNT = CoSimMessage::EMERGENCY_EVENT + 1;
+const char* coSimMessageTypeName(CoSimMessage::Type type);
+
 // OMNeT++ Orchestrator (Leader in co-simulation)
 class OMNeTOrchestrator : public SimulatorInterface {
 public:
@@ -94,39 +86,122 @@ public:
     bool startAsLeader(int port = 9999);
     bool sendTimeSyncCommand(double nextTime);
     bool waitForFollowerAck();
-    void handleFollowerMetrics(const NDNMetrics& metrics);
+    void handleFollowerMetrics(const NDNMetrics& reported); // Decide stage of the NFV pipeline
     
     // NFV Orchestration methods
     std::vector<NFVDecision> analyzeAndDecide(const NDNMetrics& metrics);
-    void executeNFVDecisions(const std::vector<NFVDecision>& decisions);
+    void executeNFVDecisions(std::vector<NFVDecision>& decisions);  // Fills in the transfer of MIGRATE decisions
     bool deployVNF(VNFType type, const std::string& location);
     bool scaleVNF(VNFType type, int targetInstances);
     bool migrateVNF(const std::string& instanceId, const std::string& targetLocation);
-    void optimizeVNFPlacement();
+    std::vector<NFVDecision> optimizeVNFPlacement();  // Bounded consolidation pass, as MIGRATE decisions
     
     // Configuration
     void setTrafficDensity(const std::string& density) { trafficDensity_ = density; }
-    void setScenarioType(const std::string& scenario) { scenarioType_ = scenario; }
-    void setKathmanduScenario(bool enable) { useKathmanduScenario_ = enable; }
+    void setScenarioType(const std::string& scenario) { scenarioType_ = scenario; configureForecaster(); }
+    void setKathmanduScenario(bool enable) { useKathmanduScenario_ = enable; configureForecaster(); }
+    bool loadNFVRules(const std::string& path) { return ruleEngine_.loadFile(path); }
+    const NFVRuleEngine& getRuleEngine() const { return ruleEngine_; }
+    bool loadEdgeTopology(const std::string& path) { return edgeTopology_.loadFile(path); }
+    bool loadEdgeTopologyJson(const std::string& text, std::string& error) { return edgeTopology_.loadJson(text, error); }
+    const EdgeTopology& getEdgeTopology() const { return edgeTopology_; }
+    bool loadNFVRulesJson(const std::string& text, std::string& error) { return ruleEngine_.loadJson(text, error); }
+    void setGovernorConfig(const GovernorConfig& config) { governor_ = DecisionGovernor(config); }
+    void setServiceClasses(const ServiceClassPolicy& policy) { classModel_.setPolicy(policy); }
+    void setMigrationConfig(const MigrationConfig& config) { migrations_.configure(config); }
+    void setCpuThresholds(double scaleUp, double scaleDown);  // Modeled CPU that scales a type or a site
+    void setMigrationTraffic(bool inject) { migrationTraffic_ = inject; }  // Publish MIGRATE transfers for the follower's backhaul
+    void setPlacementWorkers(unsigned workers) { placementSolver_.setWorkers(workers); }
+    void setPlacementBudget(std::chrono::microseconds budget) { placementBudget_ = budget; }
+    void setVerbose(bool verbose) { verbose_ = verbose; }  // Per-report and per-decision console logging
+    
+    // Offline what-if evaluation: record the follower's reports during a live run, then
+    // replay them through any number of independently configured orchestrators
+    struct ReplayStep {
+        NDNMetrics modeled;                  // Reported metrics with the modeled VNF latency added
+        std::vector<NFVDecision> executed;   // Admitted by the governor and applied to the registry
+        std::array<ClassOutcome, TRAFFIC_CLASS_COUNT> classes;   // Modeled per SLA class
+    };
+    
+    bool recordTrace(const std::string& path) { return traceWriter_.open(path); }
+    bool recordDecisions(const std::string& path);  // Binary decision journal, see decision_journal.h
+    void initializeOffline();
+    bool replayReport(const TraceRecord& record, ReplayStep& step);
     
     // Monitoring and metrics
+    const NodeMetricsMatrix& getNodeMetrics() const { return nodeMetrics_; }
+    const PopularitySketch& getPopularity() const { return popularity_; }
+    const VNFRegistry& getVNFRegistry() const { return vnfRegistry_; }
+    const MigrationTracker& getMigrations() const { return migrations_; }
     void printNFVStatus() const;
-    void exportMetrics(const std::string& filename) const;
+    void exportMetrics(const std::string& filename) const;  // Every history tier as CSV
+    
+    // Time sync round trips to the follower and handling time of its messages, by type
+    const LatencyHistogram& getSyncRoundTrip() const { return syncRoundTrip_; }
+    const LatencyHistogram& getMessageHandling(CoSimMessage::Type type) const { return messageHandling_[type]; }
+    const LatencyHistogram& getDecideLatency() const { return decideLatency_; }   // decide() end to end
+    void writePrometheus(PrometheusWriter& out) const;     // Safe from any thread
+    
+    // Metrics history, safe to query from any thread. Series are named after the reported
+    // NDNMetrics fields ("pit_size", "avg_latency", ...) plus the modeled "modeled_latency",
+    // "latency.<class>", "loss.<class>", "cpu.<VNF type>" and "instances.<VNF type>".
+    Rollup summarizeHistory(const std::string& series, double from, double to) const;
+    size_t queryHistory(const std::string& series, Resolution resolution, double from, double to,
+                        std::vector<Rollup>& out) const;
     
 private:
     // TCP Server for leader role
     bool setupLeaderServer();
     void leaderLoop();
     void handleFollowerConnection(int clientSocket);
+    void deployInitialVNFs();
     bool sendMessage(int socket, const CoSimMessage& message);
-    CoSimMessage receiveMessage(int socket);
+    bool receiveMessage(int socket, CoSimMessage& message);
+    
+    // NFV decision pipeline: ingest (leaderLoop) -> decide -> actuate -> publish.
+    // Stages hand work over through SPSC queues, so reception never waits on decisions.
+    struct MetricsReport {
+        NDNMetrics metrics;
+        Json::Value nodeDelta;
+        Json::Value popularity;
+    };
     
-    // NFV Decision Logic (from methodology)
-    bool shouldScaleUp(const NDNMetrics& metrics, VNFType vnfType);
+    void startPipeline();
+    void stopPipeline();
+    void decideLoop();
+    void actuateLoop();
+    void publishLoop();
+    void ingestReport(const MetricsReport& report);
+    std::vector<NFVDecision> decide(NDNMetrics& metrics);
+    std::vector<NFVDecision> actuate(std::vector<NFVDecision>& pending);
+    
+    // NFV Decision Logic (from methodology); thresholds live in the rule set
     bool shouldScaleDown(const NDNMetrics& metrics, VNFType vnfType);
-    bool shouldMigrate(const NDNMetrics& metrics, VNFType vnfType);
-    std::string findOptimalLocation(const NDNMetrics& metrics, VNFType vnfType);
-    int calculateRequiredInstances(const NDNMetrics& metrics, VNFType vnfType);
+    std::string findOptimalLocation(const NDNMetrics& metrics, VNFType vnfType);   // Empty when nothing fits
+    bool planPlacement(VNFType vnfType, int instances, std::vector<std::string>& sites);
+    std::string resolveLocation(const std::string& spec, const NDNMetrics& metrics, VNFType vnfType);
+    bool refineCacheDecision(NFVDecision& decision, const NDNMetrics& metrics, bool relocate = true);
+    void materializeDecisions(uint64_t fired, uint64_t escalated, const NDNMetrics& metrics,
+                              const std::string& reasonPrefix, std::vector<NFVDecision>& decisions);
+    void configureForecaster();
+    double updateClassMix(const NDNMetrics& metrics);
+    void applyLoadModel(NDNMetrics& metrics);
+    void addCpuScalingDecisions(std::vector<NFVDecision>& decisions);
+    void addScaleDownDecisions(const NDNMetrics& metrics, std::vector<NFVDecision>& decisions);
+    VNFHandle leastLoaded(VNFType vnfType, const std::string& location) const;
+    bool beginMigration(VNFHandle handle, const std::string& targetLocation, NFVDecision* decision);
+    void advanceMigrations();
+    void holdInbound(const Migration& migration, double sign);
+    void refreshSiteCaches();       // Caller holds nfvStateMutex_
+    uint32_t nodeSite(uint32_t node);
+    uint32_t locationSite(uint32_t location);
+    void fillSiteColumns();
+    void addSiteDecisions(const NDNMetrics& metrics, std::vector<NFVDecision>& decisions);
+    uint32_t reserveSite(uint32_t site, VNFType vnfType, bool inPlace = true);
+    VNFType hottestTypeAt(const std::string& location) const;
+    void journalChanges(uint64_t decision);
+    void recordReportedHistory(double time, const NDNMetrics& metrics);
+    void recordModeledHistory(double time, const NDNMetrics& metrics);
     
     // Kathmandu scenario specific
     void initializeKathmanduTopology();
@@ -143,15 +218,22 @@ private:
     void logDecisionMaking(const NFVDecision& decision);
     
     // Message parsing
-    NDNMetrics parseNDNMetrics(const std::string& jsonStr);
+    bool parseMetricsReport(const char* data, size_t size, MetricsReport& report);
     
-    // Thresholds from methodology
-    static constexpr uint32_t PIT_SCALE_THRESHOLD = 100;
-    static constexpr double LATENCY_THRESHOLD = 0.1; // 100ms
-    static constexpr double CACHE_EFFICIENCY_THRESHOLD = 0.5;
+    // Thresholds from methodology; scale-up, migration and cache triggers are NFV rules.
+    // The CPU thresholds are defaults, see setCpuThresholds
     static constexpr double CPU_SCALE_UP_THRESHOLD = 0.8;
     static constexpr double CPU_SCALE_DOWN_THRESHOLD = 0.3;
-    static constexpr double EMERGENCY_LATENCY_THRESHOLD = 0.05; // 50ms for safety
+    static constexpr double SCALE_DOWN_WINDOW = 30.0;       // Seconds the modeled CPU must stay low
+    static constexpr double CONSOLIDATION_INTERVAL = 15.0;  // Seconds between consolidation passes
+    static constexpr double CONSOLIDATION_OCCUPANCY = 0.5;  // Sites reserved up to this share get drained
+    static constexpr size_t CONSOLIDATION_MAX_MOVES = 4;    // Instances moved per pass
+    static constexpr double CONSOLIDATION_MAX_LATENCY_MS = 10.0;  // Farthest a consolidation moves an instance
+    static constexpr double POPULARITY_MIN_SHARE = 0.2;    // Below this, requests are too uniform to cache
+    static constexpr double CACHE_COVERAGE_TARGET = 0.8;   // Request share the optimized CS should serve
+    static constexpr int PLACEMENT_BUDGET_US = 2000;        // Solver time per placement decision
+    static constexpr double FORECAST_HORIZON = 5.0;         // Seconds predictive scale-ups look ahead
+    static constexpr double TRAFFIC_LIGHT_CYCLE = 120.0;    // Four 30 s phases at the Kathmandu intersection
     
     // State management
     std::atomic<double> currentTime_;
@@ -171,10 +253,78 @@ private:
     std::mutex vehiclesMutex_;
     
     // NFV State tracking
-    std::map<VNFType, std::vector<VNFInstance>> vnfInstances_;
-    std::map<std::string, std::string> vnfLocations_; // instanceId -> location
+    VNFRegistry vnfRegistry_;
     std::mutex nfvStateMutex_;
     
+    // Cooldowns, hysteresis and coalescing in front of actuation (under nfvStateMutex_)
+    DecisionGovernor governor_;
+    
+    // Every governed decision and the registry changes it caused (under nfvStateMutex_)
+    DecisionJournalWriter decisionJournal_;
+    uint64_t journalCursor_ = 0;
+    std::vector<VNFChange> journalScratch_;
+    
+    // Migrations in flight, advanced on simulation time (under nfvStateMutex_)
+    MigrationTracker migrations_;
+    std::vector<MigrationEvent> migrationEvents_;
+    std::vector<SiteCapacity> inbound_;     // Per topology site: footprint of migrations not yet switched over
+    bool migrationTraffic_ = false;
+    
+    // Per-node NDN metrics reconstructed from the follower's sparse deltas
+    NodeMetricsMatrix nodeMetrics_;
+    
+    // Compiled decision policy (built-in defaults unless --nfv-rules is given)
+    NFVRuleEngine ruleEngine_;
+    
+    // Edge sites and latencies (built-in intersection model unless --edge-topology is given)
+    EdgeTopology edgeTopology_;
+    PlacementSolver placementSolver_;
+    std::chrono::microseconds placementBudget_{PLACEMENT_BUDGET_US};
+    
+    // Aged Interest popularity merged from the follower's per-report sketches
+    PopularitySketch popularity_;
+    
+    // Aggregate and per-node load trends for predictive scaling (decide stage only)
+    MetricsForecaster forecaster_;
+    
+    // Queueing model of every instance, solved per report (decide stage only)
+    VNFLoadModel loadModel_;
+    std::vector<VNFHandle> loadModelHandles_;
+    std::array<double, VNF_TYPE_COUNT> modeledCpu_{};       // Mean modeled CPU per type
+    std::array<size_t, VNF_TYPE_COUNT> modeledInstances_{};
+    double cpuScaleUp_ = CPU_SCALE_UP_THRESHOLD;
+    double cpuScaleDown_ = CPU_SCALE_DOWN_THRESHOLD;
+    
+    // Per-class admission and weighted scheduling at the same instances (decide stage only)
+    ServiceClassModel classModel_;
+    ClassRates classMix_ = {0.0, 0.0, 1.0};     // Share of the Interest rate per class
+    std::array<double, 2> classCounts_{};       // Last emergency and safety counters
+    double classMixTime_ = -1.0;
+    std::array<ClassOutcome, TRAFFIC_CLASS_COUNT> modeledClasses_{};
+    double lastConsolidation_ = 0.0;
+    
+    // Scale, migrate and optimize verdicts per edge site; only changes become decisions (decide stage only)
+    SiteEvaluator siteEvaluator_;
+    std::vector<uint32_t> siteLocations_;       // Topology site -> registry location id
+    uint32_t mappedLocations_ = 0;              // Registry locations already in siteLocations_
+    
+    // Site lookups shared by the load model, placement and the site columns (decide stage only).
+    // Name lookups are cached per node and per registry location, the site order is built
+    // when the topology changes, and the host tables follow the registry's change journal.
+    size_t cachedSiteCount_ = 0;
+    std::vector<uint32_t> nodeSites_;           // ndnSIM node id -> topology site
+    std::vector<uint32_t> locationSites_;       // Registry location id -> topology site
+    std::vector<std::vector<uint32_t>> siteOrder_;    // Per site: every site, closest first, ties by id
+    uint64_t fleetCursor_ = 0;                  // Registry journal position the host tables include
+    std::vector<VNFChange> fleetChanges_;
+    std::array<std::vector<uint32_t>, VNF_TYPE_COUNT> hostedCount_;   // Instances per topology site
+    std::array<std::vector<uint32_t>, VNF_TYPE_COUNT> nearestHost_;    // Topology site -> closest host
+    
+    // Bounded history of every report and of the modeled loads (under historyMutex_)
+    TimeSeriesStore metricsHistory_;
+    std::vector<SeriesId> historySeries_;   // In the order the record functions append
+    mutable std::mutex historyMutex_;
+    
     // Kathmandu scenario data
     struct KathmanduIntersection {
         double x, y; // Position
@@ -192,11 +342,16 @@ private:
     
     // Performance tracking
     struct PerformanceMetrics {
-        uint64_t totalDecisions;
-        uint64_t scalingEvents;
-        uint64_t migrationEvents;
-        uint64_t emergencyResponses;
-        double avgDecisionLatency;
+        std::atomic<uint64_t> totalDecisions;
+        std::atomic<uint64_t> scalingEvents;
+        std::atomic<uint64_t> migrationEvents;
+        std::atomic<uint64_t> emergencyResponses;
+        std::atomic<uint64_t> metricsReports;     // Reports ingested from the follower
+        std::atomic<uint64_t> coalescedReports;   // Superseded before their decision started
+        std::atomic<uint64_t> droppedReports;     // Pipeline full
+        std::atomic<uint64_t> coalescedDecisions; // Merged with an equivalent pending decision
+        std::atomic<uint64_t> suppressedDecisions; // Held back by the decision governor
+        double avgDecisionLatency;                // Decide stage, seconds (EWMA)
         double resourceUtilization;
         std::chrono::steady_clock::time_point startTime;
     } performanceMetrics_;
@@ -207,11 +362,39 @@ private:
     std::mutex messageQueueMutex_;
     std::condition_variable messageCondition_;
     
+    // Pipeline stages
+    static constexpr size_t PIPELINE_QUEUE_CAPACITY = 1024;
+    SPSCQueue<MetricsReport> reportQueue_;
+    SPSCQueue<std::vector<NFVDecision>> actuateQueue_;
+    SPSCQueue<std::vector<NFVDecision>> publishQueue_;
+    StageSignal decideSignal_;
+    StageSignal actuateSignal_;
+    StageSignal publishSignal_;
+    std::thread decideThread_;
+    std::thread actuateThread_;
+    std::thread publishThread_;
+    std::atomic<bool> pipelineRunning_;
+    std::string followerReadBuffer_;
+    
+    // Every ingested report, when --record-trace is given (ingest stage only)
+    MetricsTraceWriter traceWriter_;
+    bool verbose_;
+    
     // Synchronization for leader-follower
     std::mutex syncMutex_;
     std::condition_variable syncCondition_;
     std::atomic<bool> syncAckReceived_;
     std::atomic<bool> metricsReceived_;
+    std::atomic<int64_t> syncSentAt_{0};    // Steady clock ns of the unacknowledged sync, 0 when none
+    LatencyHistogram syncRoundTrip_;
+    std::array<LatencyHistogram, COSIM_MESSAGE_TYPE_COUNT> messageHandling_;
+    LatencyHistogram decideLatency_;        // Load model and policy, per report
+    
+    // Copies for the metrics endpoint, which must not take the NFV or history locks
+    void publishFleetGauges();      // Caller holds nfvStateMutex_
+    std::array<std::atomic<double>, 10> latestReported_{};    // Metrics history order
+    std::array<std::atomic<uint32_t>, VNF_TYPE_COUNT> liveInstances_{};
+    std::atomic<uint32_t> liveMigrations_{0};
 };
 
 // Utility functions for VNF management
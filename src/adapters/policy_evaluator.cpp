@@ -0,0 +1,640 @@
+/*
+Implementation of the offline NFV policy evaluator
+*/
+
+#include "policy_evaluator.h"
+#include "omnet_orchestrator.h"
+#include "../nfv/placement_solver.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <thread>
+#include <jsoncpp/json/json.h>
+
+namespace cosim {
+
+namespace {
+
+bool readText(const std::string& path, std::string& text) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        return false;
+    }
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    text = buffer.str();
+    return true;
+}
+
+std::string compactJson(const Json::Value& json) {
+    Json::StreamWriterBuilder builder;
+    builder["indentation"] = "";
+    return Json::writeString(builder, json);
+}
+
+bool setGovernorField(GovernorConfig& config, const std::string& field, double value) {
+    if (field == "scale_up_cooldown") config.scaleUpCooldown = value;
+    else if (field == "scale_down_cooldown") config.scaleDownCooldown = value;
+    else if (field == "migrate_cooldown") config.migrateCooldown = value;
+    else if (field == "optimize_refresh") config.optimizeRefresh = value;
+    else if (field == "capacity_band") config.capacityBand = value;
+    else return false;
+    return true;
+}
+
+// Numeric fields only; the strategy is parsed by name
+bool setMigrationField(MigrationConfig& config, const std::string& field, double value) {
+    if (field == "bandwidth_mbps") config.bandwidthMbps = value;
+    else if (field == "dirty_rate") config.dirtyRate = value;
+    else if (field == "stop_copy_mb") config.stopCopyBytes = value * 1e6;
+    else if (field == "max_rounds") config.maxRounds = static_cast<int>(value);
+    else if (field == "switchover_ms") config.switchoverSeconds = value / 1000.0;
+    else if (field == "post_copy_speed") config.postCopySpeed = value;
+    else return false;
+    return true;
+}
+
+bool setCpuField(PolicySpec& policy, const std::string& field, double value) {
+    if (field == "scale_up") policy.scaleUpCpu = value;
+    else if (field == "scale_down") policy.scaleDownCpu = value;
+    else return false;
+    return true;
+}
+
+bool parseCpuThresholds(const Json::Value& json, PolicySpec& policy, std::string& error) {
+    if (!json.isObject()) {
+        error = "\"cpu\" must be an object";
+        return false;
+    }
+    for (const auto& field : json.getMemberNames()) {
+        if (!json[field].isNumeric() || !setCpuField(policy, field, json[field].asDouble())) {
+            error = "invalid cpu threshold \"" + field + "\"";
+            return false;
+        }
+    }
+    return true;
+}
+
+// One axis of the sweep grid
+struct SweepAxis {
+    PolicyKnob knob;
+    std::vector<double> values;
+};
+
+bool parseSweep(const Json::Value& json, std::vector<SweepAxis>& axes, std::string& error) {
+    if (!json.isArray()) {
+        error = "\"sweep\" must be an array";
+        return false;
+    }
+    for (const auto& entry : json) {
+        SweepAxis axis;
+        if (!parsePolicyKnob(entry, axis.knob, error)) {
+            return false;
+        }
+        const Json::Value& values = entry["values"];
+        if (!values.isArray() || values.empty()) {
+            error = "sweep axis needs a non-empty \"values\" array";
+            return false;
+        }
+        for (const auto& value : values) {
+            axis.values.push_back(value.asDouble());
+        }
+        axes.push_back(std::move(axis));
+    }
+    return true;
+}
+
+// Cores reserved by the fleet, from the placement footprints
+double reservedCores(const VNFRegistry& registry) {
+    double cores = 0.0;
+    for (size_t t = 0; t < VNF_TYPE_COUNT; ++t) {
+        VNFType type = static_cast<VNFType>(t);
+        cores += registry.count(type) * vnfFootprint(type).cpu;
+    }
+    return cores;
+}
+
+} // anonymous namespace
+
+bool parseGovernorConfig(const Json::Value& json, GovernorConfig& config, std::string& error) {
+    if (!json.isObject()) {
+        error = "\"governor\" must be an object";
+        return false;
+    }
+    for (const auto& field : json.getMemberNames()) {
+        if (!json[field].isNumeric() || !setGovernorField(config, field, json[field].asDouble())) {
+            error = "invalid governor field \"" + field + "\"";
+            return false;
+        }
+    }
+    return true;
+}
+
+bool parseMigrationConfig(const Json::Value& json, MigrationConfig& config, std::string& error) {
+    if (!json.isObject()) {
+        error = "\"migration\" must be an object";
+        return false;
+    }
+    for (const auto& field : json.getMemberNames()) {
+        if (field == "strategy") {
+            if (!json[field].isString() || !parseMigrationStrategy(json[field].asString(), config.strategy)) {
+                error = "invalid migration strategy (pre-copy or post-copy)";
+                return false;
+            }
+        } else if (!json[field].isNumeric() || !setMigrationField(config, field, json[field].asDouble())) {
+            error = "invalid migration field \"" + field + "\"";
+            return false;
+        }
+    }
+    return true;
+}
+
+const std::string& PolicyKnob::field() const {
+    return !rule.empty() ? rule : !governor.empty() ? governor : !migration.empty() ? migration : cpu;
+}
+
+bool parsePolicyKnob(const Json::Value& json, PolicyKnob& knob, std::string& error) {
+    knob.rule = json.get("rule", "").asString();
+    knob.governor = json.get("governor", "").asString();
+    knob.migration = json.get("migration", "").asString();
+    knob.cpu = json.get("cpu", "").asString();
+    if (knob.rule.empty() + knob.governor.empty() + knob.migration.empty() + knob.cpu.empty() != 3) {
+        error = "each sweep or tuning entry needs exactly one of \"rule\", \"governor\", \"migration\" or \"cpu\"";
+        return false;
+    }
+    GovernorConfig governor;
+    MigrationConfig migration;
+    PolicySpec policy;
+    if (!knob.governor.empty() && !setGovernorField(governor, knob.governor, 0.0)) {
+        error = "unknown governor field \"" + knob.governor + "\"";
+        return false;
+    }
+    if (!knob.migration.empty() && !setMigrationField(migration, knob.migration, 0.0)) {
+        error = "unknown migration field \"" + knob.migration + "\"";
+        return false;
+    }
+    if (!knob.cpu.empty() && !setCpuField(policy, knob.cpu, 0.0)) {
+        error = "unknown cpu threshold \"" + knob.cpu + "\" (scale_up or scale_down)";
+        return false;
+    }
+    return true;
+}
+
+bool applyPolicyKnobs(const PolicySpec& base, const std::vector<PolicyKnob>& knobs,
+                      const std::vector<double>& values, PolicySpec& policy, std::string& error) {
+    policy = base;
+    Json::Value rules;
+    bool setsRules = false;
+    for (size_t i = 0; i < knobs.size(); ++i) {
+        const PolicyKnob& knob = knobs[i];
+        if (!knob.governor.empty()) {
+            setGovernorField(policy.governor, knob.governor, values[i]);
+            continue;
+        }
+        if (!knob.migration.empty()) {
+            setMigrationField(policy.migration, knob.migration, values[i]);
+            continue;
+        }
+        if (!knob.cpu.empty()) {
+            setCpuField(policy, knob.cpu, values[i]);
+            continue;
+        }
+
+        if (!setsRules) {
+            const std::string source = base.rules.empty() ? NFVRuleEngine::defaultRules() : base.rules;
+            Json::CharReaderBuilder builder;
+            std::unique_ptr<Json::CharReader> reader(builder.newCharReader());
+            if (!reader->parse(source.data(), source.data() + source.size(), &rules, &error)) {
+                error = base.name + ": " + error;
+                return false;
+            }
+            setsRules = true;
+        }
+        bool found = false;
+        for (auto& rule : rules["rules"]) {
+            if (rule.get("name", "").asString() == knob.rule && rule["when"].isArray() && !rule["when"].empty()) {
+                rule["when"][0]["value"] = values[i];
+                found = true;
+            }
+        }
+        if (!found) {
+            error = base.name + ": no rule \"" + knob.rule + "\" with a condition to set";
+            return false;
+        }
+    }
+    if (setsRules) {
+        policy.rules = compactJson(rules);
+    }
+    return true;
+}
+
+bool parseServiceClasses(const Json::Value& json, ServiceClassPolicy& policy, std::string& error) {
+    if (!json.isObject()) {
+        error = "\"classes\" must be an object";
+        return false;
+    }
+    for (const auto& name : json.getMemberNames()) {
+        size_t k = 0;
+        while (k < TRAFFIC_CLASS_COUNT && name != trafficClassName(static_cast<TrafficClass>(k))) ++k;
+        if (k == TRAFFIC_CLASS_COUNT || !json[name].isObject()) {
+            error = "unknown service class \"" + name + "\"";
+            return false;
+        }
+        ServiceClass& cls = policy.classes[k];
+        for (const auto& field : json[name].getMemberNames()) {
+            const Json::Value& value = json[name][field];
+            if (!value.isNumeric()) {
+                error = "invalid " + name + " field \"" + field + "\"";
+                return false;
+            }
+            if (field == "weight" && value.asDouble() > 0.0) cls.weight = value.asDouble();
+            else if (field == "token_share" && value.asDouble() >= 0.0) cls.tokenShare = value.asDouble();
+            else if (field == "burst_s" && value.asDouble() >= 0.0) cls.burstSeconds = value.asDouble();
+            else if (field == "budget_ms" && value.asDouble() > 0.0) cls.latencyBudget = value.asDouble() / 1000.0;
+            else {
+                error = "invalid " + name + " field \"" + field + "\"";
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+PolicyEvaluator::PolicyEvaluator(const WhatIfOptions& options) : options_(options) {}
+
+bool PolicyEvaluator::loadEdgeTopology(const std::string& path) {
+    std::string text;
+    std::string error;
+    EdgeTopology probe;
+    if (!readText(path, text)) {
+        std::cerr << "❌ Cannot open edge topology " << path << std::endl;
+        return false;
+    }
+    if (!probe.loadJson(text, error)) {
+        std::cerr << "❌ Invalid edge topology " << path << ": " << error << std::endl;
+        return false;
+    }
+    edgeTopology_ = std::move(text);
+    return true;
+}
+
+bool PolicyEvaluator::loadPolicies(const std::string& path) {
+    std::string text;
+    if (!readText(path, text)) {
+        std::cerr << "❌ Cannot open policy file " << path << std::endl;
+        return false;
+    }
+
+    std::string error;
+    if (!loadPoliciesJson(text, error)) {
+        std::cerr << "❌ Invalid policy file " << path << ": " << error << std::endl;
+        return false;
+    }
+    std::cout << "📜 Loaded " << policies_.size() << " policy variants from " << path << std::endl;
+    return true;
+}
+
+bool PolicyEvaluator::loadPoliciesJson(const std::string& text, std::string& error) {
+    Json::Value root;
+    Json::CharReaderBuilder builder;
+    std::unique_ptr<Json::CharReader> reader(builder.newCharReader());
+    if (!reader->parse(text.data(), text.data() + text.size(), &root, &error)) {
+        return false;
+    }
+
+    if (root.isMember("sla_latency_ms")) {
+        options_.slaLatency = root["sla_latency_ms"].asDouble() / 1000.0;
+    }
+
+    const Json::Value& list = root["policies"];
+    if (!list.isArray() || list.empty()) {
+        error = "\"policies\" must be a non-empty array";
+        return false;
+    }
+
+    std::vector<SweepAxis> axes;
+    if (root.isMember("sweep") && !parseSweep(root["sweep"], axes, error)) {
+        return false;
+    }
+
+    std::vector<PolicySpec> policies;
+    for (Json::ArrayIndex i = 0; i < list.size(); ++i) {
+        const Json::Value& entry = list[i];
+        PolicySpec base;
+        base.name = entry.get("name", "policy_" + std::to_string(i)).asString();
+
+        const Json::Value& rules = entry["rules"];
+        if (rules.isString()) {
+            if (!readText(rules.asString(), base.rules)) {
+                error = "cannot open rule file " + rules.asString();
+                return false;
+            }
+        } else if (rules.isObject()) {
+            base.rules = compactJson(rules);
+        } else if (!rules.isNull()) {
+            error = "\"rules\" must be a file name or a rule set";
+            return false;
+        }
+
+        if (entry.isMember("governor") && !parseGovernorConfig(entry["governor"], base.governor, error)) {
+            return false;
+        }
+        if (entry.isMember("migration") && !parseMigrationConfig(entry["migration"], base.migration, error)) {
+            return false;
+        }
+        if (entry.isMember("classes") && !parseServiceClasses(entry["classes"], base.classes, error)) {
+            return false;
+        }
+        if (entry.isMember("cpu") && !parseCpuThresholds(entry["cpu"], base, error)) {
+            return false;
+        }
+
+        // Odometer over the sweep grid; a policy with no sweep is a single point
+        std::vector<PolicyKnob> knobs;
+        for (const auto& axis : axes) {
+            knobs.push_back(axis.knob);
+        }
+        std::vector<size_t> point(axes.size(), 0);
+        std::vector<double> values(axes.size());
+        while (true) {
+            std::ostringstream suffix;
+            for (size_t a = 0; a < axes.size(); ++a) {
+                values[a] = axes[a].values[point[a]];
+                suffix << (a == 0 ? "[" : ",") << axes[a].knob.field() << "=" << values[a];
+            }
+
+            PolicySpec variant;
+            if (!applyPolicyKnobs(base, knobs, values, variant, error)) {
+                return false;
+            }
+            if (!axes.empty()) {
+                suffix << "]";
+                variant.name += suffix.str();
+            }
+            policies.push_back(std::move(variant));
+
+            size_t a = 0;
+            while (a < axes.size() && ++point[a] == axes[a].values.size()) {
+                point[a++] = 0;
+            }
+            if (a == axes.size()) {
+                break;
+            }
+        }
+    }
+
+    policies_ = std::move(policies);
+    return true;
+}
+
+// ============================================================================
+// Evaluation
+// ============================================================================
+
+std::vector<PolicyResult> PolicyEvaluator::evaluate(const std::vector<PolicySpec>& policies,
+                                                     const MetricsTrace& trace) const {
+    std::vector<PolicyResult> results(policies.size());
+    unsigned threads = options_.threads > 0 ? options_.threads : std::max(1u, std::thread::hardware_concurrency());
+    threads = static_cast<unsigned>(std::min<size_t>(threads, policies.size()));
+
+    // Policies are handed out one at a time, so a slow variant does not hold back a batch
+    std::atomic<size_t> next(0);
+    auto worker = [&]() {
+        for (size_t i = next++; i < policies.size(); i = next++) {
+            results[i] = evaluate(policies[i], trace);
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (unsigned t = 1; t < threads; ++t) {
+        pool.emplace_back(worker);
+    }
+    worker();
+    for (auto& thread : pool) {
+        thread.join();
+    }
+    return results;
+}
+
+// The SLA and reserved cores are charged for the interval that follows each report,
+// i.e. until the next report can change the fleet
+PolicyResult PolicyEvaluator::evaluate(const PolicySpec& policy, const MetricsTrace& trace) const {
+    PolicyResult result;
+    result.name = policy.name;
+    auto started = std::chrono::steady_clock::now();
+
+    OMNeTOrchestrator orchestrator;
+    orchestrator.setVerbose(false);
+    orchestrator.setPlacementWorkers(1);
+    orchestrator.setPlacementBudget(std::chrono::microseconds(options_.placementBudgetUs));
+    if (options_.kathmanduScenario) {
+        orchestrator.setKathmanduScenario(true);
+        orchestrator.setScenarioType("kathmandu_intersection");
+    }
+    if (!edgeTopology_.empty() && !orchestrator.loadEdgeTopologyJson(edgeTopology_, result.error)) {
+        return result;
+    }
+    if (!policy.rules.empty() && !orchestrator.loadNFVRulesJson(policy.rules, result.error)) {
+        return result;
+    }
+    orchestrator.setGovernorConfig(policy.governor);
+    orchestrator.setMigrationConfig(policy.migration);
+    orchestrator.setServiceClasses(policy.classes);
+    orchestrator.setCpuThresholds(policy.scaleUpCpu, policy.scaleDownCpu);
+    orchestrator.initializeOffline();
+
+    OMNeTOrchestrator::ReplayStep step;
+    const MigrationTracker& migrations = orchestrator.getMigrations();
+    double cores = reservedCores(orchestrator.getVNFRegistry());
+    double latencySum = 0.0;
+    std::array<double, TRAFFIC_CLASS_COUNT> classLatencySum{};
+    std::array<double, TRAFFIC_CLASS_COUNT> classOffered{};
+    std::array<double, TRAFFIC_CLASS_COUNT> classLost{};
+    bool violating = false;
+    double previousTime = 0.0;
+
+    for (size_t i = 0; i < trace.size(); ++i) {
+        const TraceRecord& record = trace[i];
+        if (i > 0) {
+            double interval = std::max(0.0, record.leaderTime - previousTime);
+            result.coreSeconds += cores * interval;
+            if (violating) {
+                result.violationSeconds += interval;
+            }
+        }
+        previousTime = record.leaderTime;
+
+        if (!orchestrator.replayReport(record, step)) {
+            continue;
+        }
+        result.reports++;
+
+        double latency = step.modeled.avgLatency;
+        latencySum += latency;
+        result.maxLatency = std::max(result.maxLatency, latency);
+        violating = latency > options_.slaLatency;
+        if (violating) {
+            result.slaViolations++;
+        }
+        
+        for (size_t k = 0; k < TRAFFIC_CLASS_COUNT; ++k) {
+            const ClassOutcome& outcome = step.classes[k];
+            if (outcome.offered <= 0.0) continue;
+            ClassResult& cls = result.classes[k];
+            cls.reports++;
+            cls.maxLatency = std::max(cls.maxLatency, outcome.latency);
+            if (outcome.latency > policy.classes.classes[k].latencyBudget) {
+                cls.violations++;
+            }
+            classLatencySum[k] += outcome.latency;
+            classOffered[k] += outcome.offered;
+            classLost[k] += outcome.offered * outcome.loss;
+        }
+
+        for (const auto& decision : step.executed) {
+            result.decisions++;
+            if (decision.action == "SCALE_UP") {
+                result.scaleUps++;
+                result.instancesDeployed += static_cast<uint64_t>(std::max(0, decision.targetInstances));
+            } else if (decision.action == "SCALE_DOWN") {
+                result.scaleDowns++;
+            } else if (decision.action == "MIGRATE") {
+                result.migrations++;
+            } else if (decision.action == "OPTIMIZE") {
+                result.optimizations++;
+            }
+        }
+
+        const VNFRegistry& registry = orchestrator.getVNFRegistry();
+        cores = reservedCores(registry) + migrations.reservedCores();
+        result.peakInstances = std::max(result.peakInstances, registry.size());
+    }
+
+    result.migratedGB = migrations.transferredBytes() / 1e9;
+    result.migrationSeconds = migrations.transferSeconds();
+    result.downtimeSeconds = migrations.downtimeSeconds();
+
+    result.meanLatency = result.reports > 0 ? latencySum / result.reports : 0.0;
+    for (size_t k = 0; k < TRAFFIC_CLASS_COUNT; ++k) {
+        ClassResult& cls = result.classes[k];
+        cls.meanLatency = cls.reports > 0 ? classLatencySum[k] / cls.reports : 0.0;
+        cls.loss = classOffered[k] > 0.0 ? classLost[k] / classOffered[k] : 0.0;
+    }
+    result.wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    result.ok = true;
+    return result;
+}
+
+// ============================================================================
+// Reporting
+// ============================================================================
+
+void PolicyEvaluator::printComparison(const std::vector<PolicyResult>& results, double slaLatency) {
+    size_t nameWidth = 6;
+    for (const auto& result : results) {
+        nameWidth = std::max(nameWidth, result.name.size());
+    }
+
+    std::cout << "\n📊 ========== NFV Policy What-If Comparison ==========" << std::endl;
+    std::cout << "SLA: modeled latency <= " << (slaLatency * 1000) << " ms" << std::endl;
+    std::cout << std::left << std::setw(static_cast<int>(nameWidth)) << "Policy" << std::right
+              << std::setw(8) << "Scale+" << std::setw(8) << "Scale-" << std::setw(8) << "Migr"
+              << std::setw(9) << "Mig GB" << std::setw(9) << "Down-s" << std::setw(8) << "Opt" << std::setw(7) << "Peak" << std::setw(12) << "Core-s"
+              << std::setw(8) << "SLA!" << std::setw(10) << "SLA!-s" << std::setw(10) << "Mean ms"
+              << std::setw(10) << "Max ms" << std::endl;
+
+    for (const auto& result : results) {
+        std::cout << std::left << std::setw(static_cast<int>(nameWidth)) << result.name << std::right;
+        if (!result.ok) {
+            std::cout << "  ❌ " << result.error << std::endl;
+            continue;
+        }
+        std::cout << std::setw(8) << result.scaleUps << std::setw(8) << result.scaleDowns
+                  << std::setw(8) << result.migrations
+                  << std::fixed << std::setprecision(2) << std::setw(9) << result.migratedGB
+                  << std::setw(9) << result.downtimeSeconds
+                  << std::setw(8) << result.optimizations << std::setw(7) << result.peakInstances
+                  << std::setprecision(1) << std::setw(12) << result.coreSeconds
+                  << std::setw(8) << result.slaViolations << std::setw(10) << result.violationSeconds
+                  << std::setprecision(2) << std::setw(10) << (result.meanLatency * 1000)
+                  << std::setw(10) << (result.maxLatency * 1000) << std::endl;
+    }
+    std::cout << "=====================================================\n" << std::endl;
+}
+
+// One block per SLA class: reports over budget, mean and max modeled latency, loss
+void PolicyEvaluator::printClassComparison(const std::vector<PolicyResult>& results) {
+    size_t nameWidth = 6;
+    for (const auto& result : results) {
+        nameWidth = std::max(nameWidth, result.name.size());
+    }
+
+    std::cout << "\n🚦 ========== Per-Class SLA (reports over budget / mean ms / max ms / loss %) ==========" << std::endl;
+    std::cout << std::left << std::setw(static_cast<int>(nameWidth)) << "Policy" << std::right;
+    for (size_t k = 0; k < TRAFFIC_CLASS_COUNT; ++k) {
+        std::cout << std::setw(32) << trafficClassName(static_cast<TrafficClass>(k));
+    }
+    std::cout << std::endl;
+
+    for (const auto& result : results) {
+        std::cout << std::left << std::setw(static_cast<int>(nameWidth)) << result.name << std::right;
+        if (!result.ok) {
+            std::cout << "  ❌ " << result.error << std::endl;
+            continue;
+        }
+        for (const auto& cls : result.classes) {
+            std::ostringstream cell;
+            if (cls.reports == 0) {
+                cell << "-";
+            } else {
+                cell << cls.violations << " / " << std::fixed << std::setprecision(1) << (cls.meanLatency * 1000)
+                     << " / " << (cls.maxLatency * 1000) << " / " << std::setprecision(2) << (cls.loss * 100);
+            }
+            std::cout << std::setw(32) << cell.str();
+        }
+        std::cout << std::endl;
+    }
+    std::cout << "=====================================================\n" << std::endl;
+}
+
+bool PolicyEvaluator::exportComparison(const std::vector<PolicyResult>& results, const std::string& filename) {
+    std::ofstream file(filename);
+    if (!file.is_open()) {
+        std::cerr << "❌ Failed to open what-if export file: " << filename << std::endl;
+        return false;
+    }
+
+    file << "policy,ok,reports,decisions,scale_ups,instances_deployed,scale_downs,migrations,"
+         << "migrated_gb,migration_seconds,downtime_seconds,optimizations,"
+         << "peak_instances,core_seconds,sla_violations,violation_seconds,mean_latency_ms,max_latency_ms";
+    for (size_t k = 0; k < TRAFFIC_CLASS_COUNT; ++k) {
+        std::string name = trafficClassName(static_cast<TrafficClass>(k));
+        file << "," << name << "_violations," << name << "_mean_latency_ms," << name << "_max_latency_ms,"
+             << name << "_loss";
+    }
+    file << ",wall_seconds\n";
+    for (const auto& result : results) {
+        file << "\"" << result.name << "\"," << (result.ok ? 1 : 0) << "," << result.reports << ","
+             << result.decisions << "," << result.scaleUps << "," << result.instancesDeployed << ","
+             << result.scaleDowns << "," << result.migrations << "," << result.migratedGB << ","
+             << result.migrationSeconds << "," << result.downtimeSeconds << "," << result.optimizations << ","
+             << result.peakInstances << "," << result.coreSeconds << "," << result.slaViolations << ","
+             << result.violationSeconds << "," << (result.meanLatency * 1000) << ","
+             << (result.maxLatency * 1000);
+        for (const auto& cls : result.classes) {
+            file << "," << cls.violations << "," << (cls.meanLatency * 1000) << "," << (cls.maxLatency * 1000)
+                 << "," << cls.loss;
+        }
+        file << "," << result.wallSeconds << "\n";
+    }
+
+    file.close();
+    std::cout << "📁 What-if comparison exported to: " << filename << std::endl;
+    return true;
+}
+
+} // namespace cosim
@@ -0,0 +1,159 @@
+/*
+Offline what-if evaluation of NFV policies
+Replays one recorded metrics trace through many policy variants at once. Every
+variant gets its own quiet orchestrator (rules, governor, registry, load model
+and forecaster) driven on a worker thread, while all workers read the same
+mapped trace. Each variant is scored on the actions it took, the cores it held
+over time and how often the modeled latency broke the SLA.
+
+Policy file format:
+{
+  "sla_latency_ms": 100,
+  "policies": [
+    {"name": "baseline"},
+    {"name": "eager", "rules": "rules/eager.json", "governor": {"scale_up_cooldown": 5}},
+    {"name": "inline", "rules": {"rules": [ ... ]}},
+    {"name": "postcopy", "migration": {"strategy": "post-copy", "bandwidth_mbps": 200}},
+    {"name": "strict", "classes": {"emergency": {"weight": 16, "token_share": 0.3, "budget_ms": 50}}},
+    {"name": "busy", "cpu": {"scale_up": 0.9, "scale_down": 0.2}}
+  ],
+  "sweep": [
+    {"rule": "router_pit_pressure", "values": [50, 100, 150, 200]},
+    {"governor": "scale_down_cooldown", "values": [10, 30, 60]},
+    {"migration": "bandwidth_mbps", "values": [100, 1000]},
+    {"cpu": "scale_up", "values": [0.7, 0.8, 0.9]}
+  ]
+}
+
+Policies without "rules" use the built-in rule set. Every policy is crossed with
+every point of the sweep grid; a rule sweep sets the threshold of the rule's
+first condition, a governor, migration or cpu sweep sets one config field. A
+"migration" bandwidth of 0 relocates instances instantly. "classes" overrides the
+weight, token_share, burst_s and budget_ms of the emergency, awareness and other
+SLA classes; each class is scored against its own latency budget.
+*/
+
+#ifndef POLICY_EVALUATOR_H
+#define POLICY_EVALUATOR_H
+
+#include "../common/metrics_trace.h"
+#include "../nfv/decision_governor.h"
+#include "../nfv/migration_tracker.h"
+#include "../nfv/service_classes.h"
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Json {
+class Value;
+}
+
+namespace cosim {
+
+struct PolicySpec {
+    std::string name;
+    std::string rules;          // Rule set JSON; empty means the built-in rules
+    GovernorConfig governor;
+    MigrationConfig migration;
+    ServiceClassPolicy classes;
+    double scaleUpCpu = 0.8;        // Modeled CPU thresholds; the orchestrator's CPU_SCALE_* defaults
+    double scaleDownCpu = 0.3;
+};
+
+// One policy value a sweep or the tuner varies
+struct PolicyKnob {
+    std::string rule;       // Either a rule whose first threshold is set...
+    std::string governor;   // ...or a GovernorConfig field...
+    std::string migration;  // ...or a MigrationConfig field...
+    std::string cpu;        // ...or a CPU threshold, "scale_up" or "scale_down"
+
+    const std::string& field() const;
+};
+
+struct ClassResult {
+    uint64_t reports = 0;           // Reports with traffic of the class
+    uint64_t violations = 0;        // Of those, modeled class latency over its budget
+    double meanLatency = 0.0;       // Seconds
+    double maxLatency = 0.0;
+    double loss = 0.0;              // Share of the class's Interests refused or dropped
+};
+
+struct PolicyResult {
+    std::string name;
+    bool ok = false;
+    std::string error;
+
+    uint64_t reports = 0;
+    uint64_t decisions = 0;         // Executed, i.e. admitted by the governor
+    uint64_t scaleUps = 0;
+    uint64_t instancesDeployed = 0;
+    uint64_t scaleDowns = 0;
+    uint64_t migrations = 0;
+    double migratedGB = 0.0;        // State moved by completed migrations, resent pages included
+    double migrationSeconds = 0.0;  // Summed transfer time of completed migrations
+    double downtimeSeconds = 0.0;   // Summed time migrating instances served nothing
+    uint64_t optimizations = 0;
+    size_t peakInstances = 0;
+    double coreSeconds = 0.0;       // Reserved cores, migration targets included, integrated over leader time
+    uint64_t slaViolations = 0;     // Reports whose modeled latency exceeded the SLA
+    double violationSeconds = 0.0;
+    double meanLatency = 0.0;       // Modeled, seconds
+    double maxLatency = 0.0;
+    std::array<ClassResult, TRAFFIC_CLASS_COUNT> classes;
+    double wallSeconds = 0.0;
+};
+
+struct WhatIfOptions {
+    bool kathmanduScenario = false;
+    double slaLatency = 0.1;        // Seconds; the policy file may override it
+    unsigned threads = 0;           // 0 uses the hardware concurrency
+    int placementBudgetUs = 200;    // Per placement; placements are small, the live budget is for headroom
+};
+
+class PolicyEvaluator {
+public:
+    explicit PolicyEvaluator(const WhatIfOptions& options = WhatIfOptions());
+
+    bool loadPolicies(const std::string& path);
+    bool loadEdgeTopology(const std::string& path);  // Otherwise the built-in intersection topology
+    bool loadPoliciesJson(const std::string& text, std::string& error);
+    void addPolicy(const PolicySpec& policy) { policies_.push_back(policy); }
+    const std::vector<PolicySpec>& policies() const { return policies_; }
+    const WhatIfOptions& options() const { return options_; }
+
+    // Results are in policy order
+    std::vector<PolicyResult> evaluate(const MetricsTrace& trace) const { return evaluate(policies_, trace); }
+    std::vector<PolicyResult> evaluate(const std::vector<PolicySpec>& policies, const MetricsTrace& trace) const;
+    PolicyResult evaluate(const PolicySpec& policy, const MetricsTrace& trace) const;
+
+    static void printComparison(const std::vector<PolicyResult>& results, double slaLatency);
+    static void printClassComparison(const std::vector<PolicyResult>& results);
+    static bool exportComparison(const std::vector<PolicyResult>& results, const std::string& filename);
+
+private:
+    WhatIfOptions options_;
+    std::vector<PolicySpec> policies_;
+    std::string edgeTopology_;      // File contents, parsed once per policy
+};
+
+// Applies the GovernorConfig fields present in a JSON object
+bool parseGovernorConfig(const Json::Value& json, GovernorConfig& config, std::string& error);
+
+// Applies the MigrationConfig fields present in a JSON object
+bool parseMigrationConfig(const Json::Value& json, MigrationConfig& config, std::string& error);
+
+// Applies the per-class fields present in a JSON object keyed by class name
+bool parseServiceClasses(const Json::Value& json, ServiceClassPolicy& policy, std::string& error);
+
+// Reads the one of "rule", "governor", "migration" or "cpu" an entry names
+bool parsePolicyKnob(const Json::Value& json, PolicyKnob& knob, std::string& error);
+
+// A copy of `base` with `values[i]` set on `knobs[i]`; rule thresholds are written into
+// its rule set, the built-in one when it has none
+bool applyPolicyKnobs(const PolicySpec& base, const std::vector<PolicyKnob>& knobs,
+                      const std::vector<double>& values, PolicySpec& policy, std::string& error);
+
+} // namespace cosim
+
+#endif // POLICY_EVALUATOR_H
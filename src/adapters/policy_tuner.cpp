@@ -0,0 +1,575 @@
+/*
+Implementation of the Bayesian NFV policy tuner
+*/
+
+#include "policy_tuner.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <thread>
+#include <jsoncpp/json/json.h>
+
+namespace cosim {
+
+namespace {
+
+constexpr double CHEBYSHEV_AUGMENT = 0.05;     // Keeps weakly dominated points from tying
+constexpr double GP_NOISE = 1e-6;              // Replays are deterministic; this is jitter
+constexpr size_t RANDOM_CANDIDATES = 1024;     // Acquisition: uniform draws over the box...
+constexpr size_t LOCAL_CANDIDATES = 64;        // ...plus perturbations around each of the best points
+constexpr size_t LOCAL_CENTERS = 4;
+constexpr double LOCAL_SPREAD = 0.05;
+constexpr double MIN_SEPARATION = 1e-3;        // In the unit box; closer proposals are redundant
+
+// Gaussian process regression with a Matern 5/2 kernel over the unit box. Targets are
+// standardized; the length scale is the one of a short list with the best marginal likelihood.
+// fit() fails when no length scale gives a positive definite kernel matrix
+class GaussianProcess {
+public:
+    bool fit(const std::vector<std::vector<double>>& x, const std::vector<double>& y) {
+        const size_t n = x.size();
+        x_ = x;
+        mean_ = 0.0;
+        for (double v : y) mean_ += v;
+        mean_ /= n;
+        double variance = 0.0;
+        for (double v : y) variance += (v - mean_) * (v - mean_);
+        scale_ = variance > 0.0 ? std::sqrt(variance / n) : 1.0;
+
+        std::vector<double> z(n);
+        for (size_t i = 0; i < n; ++i) {
+            z[i] = (y[i] - mean_) / scale_;
+        }
+
+        double bestLikelihood = -std::numeric_limits<double>::infinity();
+        chol_.clear();
+        std::vector<double> chol;
+        std::vector<double> alpha;
+        for (double length : {0.05, 0.1, 0.2, 0.35, 0.6, 1.0}) {
+            length_ = length;
+            if (!factor(z, chol, alpha)) continue;
+            double likelihood = 0.0;
+            for (size_t i = 0; i < n; ++i) {
+                likelihood -= 0.5 * z[i] * alpha[i] + std::log(chol[i * n + i]);
+            }
+            if (likelihood > bestLikelihood) {
+                bestLikelihood = likelihood;
+                bestLength_ = length;
+                chol_ = chol;
+                alpha_ = alpha;
+            }
+        }
+        length_ = bestLength_;
+        return !chol_.empty();
+    }
+
+    void predict(const std::vector<double>& point, double& mean, double& sd) const {
+        const size_t n = x_.size();
+        std::vector<double> k(n);
+        double mu = 0.0;
+        for (size_t i = 0; i < n; ++i) {
+            k[i] = kernel(point, x_[i]);
+            mu += k[i] * alpha_[i];
+        }
+        // v = L^-1 k, var = k(x, x) - v.v
+        double reduction = 0.0;
+        for (size_t i = 0; i < n; ++i) {
+            double v = k[i];
+            for (size_t j = 0; j < i; ++j) v -= chol_[i * n + j] * k[j];
+            k[i] = v / chol_[i * n + i];
+            reduction += k[i] * k[i];
+        }
+        mean = mean_ + scale_ * mu;
+        sd = scale_ * std::sqrt(std::max(1e-12, 1.0 - reduction));
+    }
+
+private:
+    double kernel(const std::vector<double>& a, const std::vector<double>& b) const {
+        double squared = 0.0;
+        for (size_t d = 0; d < a.size(); ++d) squared += (a[d] - b[d]) * (a[d] - b[d]);
+        double r = std::sqrt(5.0 * squared) / length_;
+        return (1.0 + r + r * r / 3.0) * std::exp(-r);
+    }
+
+    // Cholesky of K + noise; alpha = K^-1 z
+    bool factor(const std::vector<double>& z, std::vector<double>& chol, std::vector<double>& alpha) const {
+        const size_t n = x_.size();
+        chol.assign(n * n, 0.0);
+        for (size_t i = 0; i < n; ++i) {
+            for (size_t j = 0; j <= i; ++j) {
+                double sum = kernel(x_[i], x_[j]) + (i == j ? GP_NOISE : 0.0);
+                for (size_t k = 0; k < j; ++k) sum -= chol[i * n + k] * chol[j * n + k];
+                if (i == j) {
+                    if (sum <= 0.0) return false;
+                    chol[i * n + i] = std::sqrt(sum);
+                } else {
+                    chol[i * n + j] = sum / chol[j * n + j];
+                }
+            }
+        }
+        alpha = z;
+        for (size_t i = 0; i < n; ++i) {
+            for (size_t k = 0; k < i; ++k) alpha[i] -= chol[i * n + k] * alpha[k];
+            alpha[i] /= chol[i * n + i];
+        }
+        for (size_t i = n; i-- > 0;) {
+            for (size_t k = i + 1; k < n; ++k) alpha[i] -= chol[k * n + i] * alpha[k];
+            alpha[i] /= chol[i * n + i];
+        }
+        return true;
+    }
+
+    std::vector<std::vector<double>> x_;
+    std::vector<double> chol_;
+    std::vector<double> alpha_;
+    double mean_ = 0.0;
+    double scale_ = 1.0;
+    double length_ = 0.2;
+    double bestLength_ = 0.2;
+};
+
+// For minimization
+double expectedImprovement(double best, double mean, double sd) {
+    double z = (best - mean) / sd;
+    double cdf = 0.5 * std::erfc(-z / std::sqrt(2.0));
+    double pdf = std::exp(-0.5 * z * z) / std::sqrt(2.0 * M_PI);
+    return (best - mean) * cdf + sd * pdf;
+}
+
+double squaredDistance(const std::vector<double>& a, const std::vector<double>& b) {
+    double sum = 0.0;
+    for (size_t d = 0; d < a.size(); ++d) sum += (a[d] - b[d]) * (a[d] - b[d]);
+    return sum;
+}
+
+bool dominates(const PolicyResult& a, const PolicyResult& b) {
+    return a.coreSeconds <= b.coreSeconds && a.slaViolations <= b.slaViolations &&
+           (a.coreSeconds < b.coreSeconds || a.slaViolations < b.slaViolations);
+}
+
+// Of candidates that tie on both objectives only the first is kept
+void markFront(std::vector<TuneSample>& samples) {
+    for (size_t i = 0; i < samples.size(); ++i) {
+        const PolicyResult& result = samples[i].result;
+        samples[i].pareto = result.ok;
+        for (size_t j = 0; j < samples.size() && samples[i].pareto; ++j) {
+            const PolicyResult& other = samples[j].result;
+            bool tie = j < i && other.coreSeconds == result.coreSeconds && other.slaViolations == result.slaViolations;
+            samples[i].pareto = !(other.ok && (tie || dominates(other, result)));
+        }
+    }
+}
+
+} // anonymous namespace
+
+PolicyTuner::PolicyTuner(const PolicyEvaluator& evaluator, const PolicySpec& base, const TunerOptions& options)
+    : evaluator_(evaluator), base_(base), options_(options) {}
+
+// The PIT and cache thresholds the orchestrator once hard-coded, now NFV rules, and the CPU thresholds
+void PolicyTuner::useDefaultSpace() {
+    parameters_.clear();
+    TuneParameter pit;
+    pit.knob.rule = "router_pit_pressure";
+    pit.min = 25;
+    pit.max = 400;
+    pit.integer = true;
+    TuneParameter cache;
+    cache.knob.rule = "cache_efficiency";
+    cache.min = 0.1;
+    cache.max = 0.9;
+    TuneParameter up;
+    up.knob.cpu = "scale_up";
+    up.min = 0.5;
+    up.max = 0.95;
+    TuneParameter down;
+    down.knob.cpu = "scale_down";
+    down.min = 0.05;
+    down.max = 0.5;
+    parameters_ = {pit, cache, up, down};
+}
+
+bool PolicyTuner::loadSpace(const std::string& path) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        std::cerr << "❌ Cannot open policy file " << path << std::endl;
+        return false;
+    }
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+
+    std::string error;
+    if (!loadSpaceJson(buffer.str(), error)) {
+        std::cerr << "❌ Invalid tuning section in " << path << ": " << error << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool PolicyTuner::loadSpaceJson(const std::string& text, std::string& error) {
+    Json::Value root;
+    Json::CharReaderBuilder builder;
+    std::unique_ptr<Json::CharReader> reader(builder.newCharReader());
+    if (!reader->parse(text.data(), text.data() + text.size(), &root, &error)) {
+        return false;
+    }
+    const Json::Value& tune = root["tune"];
+    if (tune.isNull()) {
+        useDefaultSpace();
+        return true;
+    }
+    if (!tune.isObject()) {
+        error = "\"tune\" must be an object";
+        return false;
+    }
+
+    if (tune.isMember("budget")) options_.budget = tune["budget"].asUInt();
+    if (tune.isMember("batch")) options_.batch = tune["batch"].asUInt();
+    if (tune.isMember("seeds")) options_.seeds = tune["seeds"].asUInt();
+    if (tune.isMember("seed")) options_.seed = tune["seed"].asUInt64();
+
+    const Json::Value& list = tune["parameters"];
+    if (list.isNull()) {
+        useDefaultSpace();
+        return true;
+    }
+    if (!list.isArray() || list.empty()) {
+        error = "\"parameters\" must be a non-empty array";
+        return false;
+    }
+    parameters_.clear();
+    for (const auto& entry : list) {
+        TuneParameter parameter;
+        if (!parsePolicyKnob(entry, parameter.knob, error)) {
+            return false;
+        }
+        if (!entry["min"].isNumeric() || !entry["max"].isNumeric() ||
+            entry["min"].asDouble() >= entry["max"].asDouble()) {
+            error = parameter.knob.field() + ": needs numeric \"min\" < \"max\"";
+            return false;
+        }
+        parameter.min = entry["min"].asDouble();
+        parameter.max = entry["max"].asDouble();
+        parameter.integer = entry.get("integer", false).asBool();
+        parameters_.push_back(parameter);
+    }
+    return true;
+}
+
+std::vector<double> PolicyTuner::decode(const std::vector<double>& unit) const {
+    std::vector<double> values(parameters_.size());
+    size_t up = parameters_.size();
+    size_t down = parameters_.size();
+    for (size_t d = 0; d < parameters_.size(); ++d) {
+        const TuneParameter& parameter = parameters_[d];
+        values[d] = parameter.min + unit[d] * (parameter.max - parameter.min);
+        if (parameter.integer) {
+            values[d] = std::round(values[d]);
+        }
+        if (parameter.knob.cpu == "scale_up") up = d;
+        if (parameter.knob.cpu == "scale_down") down = d;
+    }
+
+    // Overlapping CPU thresholds would scale a type up and down in turn
+    double scaleUp = up < values.size() ? values[up] : base_.scaleUpCpu;
+    if (down < values.size()) {
+        values[down] = std::min(values[down], scaleUp * 0.75);
+    } else if (up < values.size()) {
+        values[up] = std::max(values[up], base_.scaleDownCpu / 0.75);
+    }
+    return values;
+}
+
+bool PolicyTuner::makePolicy(const std::vector<double>& values, size_t index, PolicySpec& policy,
+                             std::string& error) const {
+    std::vector<PolicyKnob> knobs;
+    for (const auto& parameter : parameters_) {
+        knobs.push_back(parameter.knob);
+    }
+    if (!applyPolicyKnobs(base_, knobs, values, policy, error)) {
+        return false;
+    }
+    policy.name = base_.name + "#" + std::to_string(index);
+    return true;
+}
+
+TuneResult PolicyTuner::tune(const MetricsTrace& trace) const {
+    TuneResult result;
+    auto started = std::chrono::steady_clock::now();
+    const size_t dims = parameters_.size();
+    std::mt19937_64 rng(options_.seed);
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+
+    unsigned threads = evaluator_.options().threads > 0 ? evaluator_.options().threads
+                                                        : std::max(1u, std::thread::hardware_concurrency());
+    const size_t batch = std::max<size_t>(1, options_.batch > 0 ? options_.batch : threads);
+    const size_t budget = std::max<size_t>(1, options_.budget);
+    const size_t seeds = std::min(budget, options_.seeds > 0 ? options_.seeds : std::max<size_t>(2 * dims, 4));
+
+    std::vector<std::vector<double>> unit;      // Per sample, in the unit box
+    std::vector<PolicySpec> pending;
+    std::vector<std::vector<double>> pendingUnit;
+    std::string error;
+
+    auto propose = [&](const std::vector<double>& point) {
+        PolicySpec policy;
+        std::vector<double> values = decode(point);
+        if (!makePolicy(values, result.samples.size() + pending.size(), policy, error)) {
+            return false;
+        }
+        pending.push_back(std::move(policy));
+        pendingUnit.push_back(point);
+        return true;
+    };
+
+    auto replay = [&](size_t round) {
+        std::vector<PolicyResult> replayed = evaluator_.evaluate(pending, trace);
+        for (size_t i = 0; i < pending.size(); ++i) {
+            TuneSample sample;
+            sample.values = decode(pendingUnit[i]);
+            sample.result = std::move(replayed[i]);
+            sample.round = round;
+            result.samples.push_back(std::move(sample));
+            unit.push_back(pendingUnit[i]);
+        }
+        pending.clear();
+        pendingUnit.clear();
+    };
+
+    // Round 0: the reference and a Latin hypercube, one stratum per seed along every axis
+    pending.push_back(base_);
+    std::vector<PolicyResult> reference = evaluator_.evaluate(pending, trace);
+    result.reference = reference.front();
+    pending.clear();
+
+    std::vector<std::vector<double>> strata(dims);
+    for (size_t d = 0; d < dims; ++d) {
+        strata[d].resize(seeds);
+        for (size_t i = 0; i < seeds; ++i) {
+            strata[d][i] = (i + uniform(rng)) / seeds;
+        }
+        std::shuffle(strata[d].begin(), strata[d].end(), rng);
+    }
+    for (size_t i = 0; i < seeds; ++i) {
+        std::vector<double> point(dims);
+        for (size_t d = 0; d < dims; ++d) {
+            point[d] = strata[d][i];
+        }
+        if (!propose(point)) {
+            result.reference.error = error;
+            return result;
+        }
+    }
+    replay(0);
+
+    while (result.samples.size() < budget) {
+        ++result.rounds;
+
+        // Objectives normalized over what has been seen
+        std::vector<size_t> usable;
+        double minCost = std::numeric_limits<double>::infinity(), maxCost = -minCost;
+        double minViolations = minCost, maxViolations = -minCost;
+        for (size_t i = 0; i < result.samples.size(); ++i) {
+            const PolicyResult& replayed = result.samples[i].result;
+            if (!replayed.ok) continue;
+            usable.push_back(i);
+            minCost = std::min(minCost, replayed.coreSeconds);
+            maxCost = std::max(maxCost, replayed.coreSeconds);
+            minViolations = std::min(minViolations, static_cast<double>(replayed.slaViolations));
+            maxViolations = std::max(maxViolations, static_cast<double>(replayed.slaViolations));
+        }
+        if (usable.size() < 2) {
+            break;      // Every replay failed; the reference carries the reason
+        }
+        const double costRange = std::max(maxCost - minCost, 1e-9);
+        const double violationRange = std::max(maxViolations - minViolations, 1e-9);
+
+        std::vector<std::vector<double>> x;
+        for (size_t i : usable) {
+            x.push_back(unit[i]);
+        }
+
+        const size_t slots = std::min(batch, budget - result.samples.size());
+        for (size_t slot = 0; slot < slots; ++slot) {
+            // One weighting per slot, stratified over the batch
+            const double lambda = (slot + uniform(rng)) / slots;
+            std::vector<double> y;
+            for (size_t i : usable) {
+                const PolicyResult& replayed = result.samples[i].result;
+                double cost = lambda * (replayed.coreSeconds - minCost) / costRange;
+                double violations = (1.0 - lambda) * (replayed.slaViolations - minViolations) / violationRange;
+                y.push_back(std::max(cost, violations) + CHEBYSHEV_AUGMENT * (cost + violations));
+            }
+            GaussianProcess gp;
+            if (!gp.fit(x, y)) {
+                // No usable surrogate for this weighting; explore instead
+                std::vector<double> point(dims);
+                for (double& v : point) v = uniform(rng);
+                if (!propose(point)) {
+                    result.reference.error = error;
+                    return result;
+                }
+                continue;
+            }
+
+            std::vector<size_t> order(y.size());
+            for (size_t i = 0; i < order.size(); ++i) order[i] = i;
+            std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return y[a] < y[b]; });
+            const double best = y[order.front()];
+
+            std::vector<std::vector<double>> candidates;
+            for (size_t c = 0; c < RANDOM_CANDIDATES; ++c) {
+                std::vector<double> point(dims);
+                for (double& v : point) v = uniform(rng);
+                candidates.push_back(std::move(point));
+            }
+            std::normal_distribution<double> step(0.0, LOCAL_SPREAD);
+            for (size_t c = 0; c < std::min(LOCAL_CENTERS, order.size()); ++c) {
+                for (size_t k = 0; k < LOCAL_CANDIDATES; ++k) {
+                    std::vector<double> point = x[order[c]];
+                    for (double& v : point) v = std::min(1.0, std::max(0.0, v + step(rng)));
+                    candidates.push_back(std::move(point));
+                }
+            }
+
+            double bestGain = -1.0;
+            const std::vector<double>* chosen = nullptr;
+            for (const auto& candidate : candidates) {
+                bool redundant = false;
+                for (const auto* taken : {&unit, &pendingUnit}) {
+                    for (const auto& point : *taken) {
+                        if (squaredDistance(point, candidate) < MIN_SEPARATION * MIN_SEPARATION) {
+                            redundant = true;
+                            break;
+                        }
+                    }
+                }
+                if (redundant) continue;
+                double mean, sd;
+                gp.predict(candidate, mean, sd);
+                double gain = expectedImprovement(best, mean, sd);
+                if (gain > bestGain) {
+                    bestGain = gain;
+                    chosen = &candidate;
+                }
+            }
+            if (chosen && !propose(*chosen)) {
+                result.reference.error = error;
+                return result;
+            }
+        }
+        if (pending.empty()) {
+            break;      // The box is exhausted at this resolution
+        }
+        replay(result.rounds);
+
+        size_t front = 0;
+        markFront(result.samples);
+        for (const auto& sample : result.samples) front += sample.pareto;
+        std::cout << "🔁 Round " << result.rounds << ": " << result.samples.size() << "/" << budget
+                  << " replays, " << front << " on the front" << std::endl;
+    }
+
+    markFront(result.samples);
+    result.wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    return result;
+}
+
+// The front by increasing cost, then the reference for comparison
+void PolicyTuner::printFront(const TuneResult& result) const {
+    std::vector<const TuneSample*> front;
+    for (const auto& sample : result.samples) {
+        if (sample.pareto) front.push_back(&sample);
+    }
+    std::sort(front.begin(), front.end(), [](const TuneSample* a, const TuneSample* b) {
+        return a->result.coreSeconds < b->result.coreSeconds;
+    });
+
+    size_t nameWidth = std::max<size_t>(8, result.reference.name.size());
+    std::vector<size_t> widths;
+    for (const auto& parameter : parameters_) {
+        widths.push_back(std::max<size_t>(9, parameter.knob.field().size() + 2));
+    }
+    for (const auto* sample : front) {
+        nameWidth = std::max(nameWidth, sample->result.name.size());
+    }
+
+    std::cout << "\n🎯 ========== NFV Policy Tuning: Cost vs SLA Pareto Front ==========" << std::endl;
+    std::cout << "SLA: modeled latency <= " << (evaluator_.options().slaLatency * 1000) << " ms; "
+              << result.samples.size() << " replays in " << result.rounds << " rounds" << std::endl;
+    std::cout << std::left << std::setw(static_cast<int>(nameWidth)) << "Policy" << std::right;
+    for (size_t d = 0; d < parameters_.size(); ++d) {
+        std::cout << std::setw(static_cast<int>(widths[d])) << parameters_[d].knob.field();
+    }
+    std::cout << std::setw(12) << "Core-s" << std::setw(8) << "SLA!" << std::setw(10) << "SLA!-s"
+              << std::setw(10) << "Mean ms" << std::setw(8) << "Round" << std::endl;
+
+    auto printRow = [&](const std::string& name, const std::vector<double>* values, const PolicyResult& replayed,
+                        size_t round) {
+        std::cout << std::left << std::setw(static_cast<int>(nameWidth)) << name << std::right;
+        if (!replayed.ok) {
+            std::cout << "  ❌ " << replayed.error << std::endl;
+            return;
+        }
+        for (size_t d = 0; d < parameters_.size(); ++d) {
+            std::ostringstream cell;
+            if (values) cell << std::setprecision(4) << (*values)[d];
+            else cell << "-";
+            std::cout << std::setw(static_cast<int>(widths[d])) << cell.str();
+        }
+        std::cout << std::fixed << std::setprecision(1) << std::setw(12) << replayed.coreSeconds
+                  << std::setw(8) << replayed.slaViolations << std::setw(10) << replayed.violationSeconds
+                  << std::setprecision(2) << std::setw(10) << (replayed.meanLatency * 1000);
+        std::cout.unsetf(std::ios::fixed);
+        if (values) std::cout << std::setw(8) << round;
+        std::cout << std::endl;
+    };
+
+    for (const auto* sample : front) {
+        printRow(sample->result.name, &sample->values, sample->result, sample->round);
+    }
+    std::cout << "-----------------------------------------------------" << std::endl;
+    printRow(result.reference.name, nullptr, result.reference, 0);
+
+    size_t dominating = 0;
+    for (const auto* sample : front) {
+        dominating += result.reference.ok && dominates(sample->result, result.reference);
+    }
+    std::cout << dominating << " of " << front.size() << " front points dominate " << result.reference.name
+              << std::endl;
+    std::cout << "=====================================================\n" << std::endl;
+}
+
+bool PolicyTuner::exportSamples(const TuneResult& result, const std::string& filename) const {
+    std::ofstream file(filename);
+    if (!file.is_open()) {
+        std::cerr << "❌ Failed to open tuning export file: " << filename << std::endl;
+        return false;
+    }
+
+    file << "policy,round,pareto";
+    for (const auto& parameter : parameters_) {
+        file << "," << parameter.knob.field();
+    }
+    file << ",ok,core_seconds,sla_violations,violation_seconds,mean_latency_ms,max_latency_ms,peak_instances\n";
+    for (const auto& sample : result.samples) {
+        const PolicyResult& replayed = sample.result;
+        file << "\"" << replayed.name << "\"," << sample.round << "," << (sample.pareto ? 1 : 0);
+        for (double value : sample.values) {
+            file << "," << value;
+        }
+        file << "," << (replayed.ok ? 1 : 0) << "," << replayed.coreSeconds << "," << replayed.slaViolations << ","
+             << replayed.violationSeconds << "," << (replayed.meanLatency * 1000) << ","
+             << (replayed.maxLatency * 1000) << "," << replayed.peakInstances << "\n";
+    }
+    std::cout << "📄 Tuning samples exported to " << filename << std::endl;
+    return true;
+}
+
+} // namespace cosim
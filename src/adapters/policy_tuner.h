@@ -0,0 +1,103 @@
+/*
+Offline auto-tuning of NFV policy thresholds
+Searches a box of policy values (rule thresholds, CPU thresholds, governor and
+migration settings) for the trade-off between reserved cores and SLA violations
+on one recorded trace. Every candidate costs a what-if replay, so the search is
+Bayesian in the ParEGO style:
+
+  1. a Latin hypercube of seed candidates covers the box
+  2. each round draws one cost/SLA weighting per batch slot, scalarizes the
+     normalized objectives with an augmented Chebyshev function, fits a Gaussian
+     process to the scalarized values and proposes the candidate of highest
+     expected improvement
+  3. the batch is replayed in parallel by the PolicyEvaluator
+
+Spreading the weightings over the batch spreads the proposals along the front.
+The result is every candidate with its replay, the non-dominated ones marked.
+
+Tuning section of a policy file (optional; without it the PIT, cache and CPU
+thresholds are tuned):
+{
+  "policies": [{"name": "baseline"}],
+  "tune": {
+    "budget": 64, "batch": 8, "seeds": 8, "seed": 1,
+    "parameters": [
+      {"rule": "router_pit_pressure", "min": 25, "max": 400, "integer": true},
+      {"cpu": "scale_up", "min": 0.5, "max": 0.95},
+      {"governor": "scale_down_cooldown", "min": 5, "max": 120}
+    ]
+  }
+}
+
+The first policy is the starting point: it is replayed as the reference and every
+candidate is a copy of it with the tuned values set.
+*/
+
+#ifndef POLICY_TUNER_H
+#define POLICY_TUNER_H
+
+#include "policy_evaluator.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace cosim {
+
+struct TuneParameter {
+    PolicyKnob knob;
+    double min = 0.0;
+    double max = 1.0;
+    bool integer = false;
+};
+
+struct TunerOptions {
+    size_t budget = 64;     // Replays, seeds included
+    size_t batch = 0;       // Replays per round; 0 uses the evaluator's threads
+    size_t seeds = 0;       // Latin hypercube candidates; 0 uses two per parameter
+    uint64_t seed = 1;
+};
+
+struct TuneSample {
+    std::vector<double> values;     // In parameter order, as replayed
+    PolicyResult result;
+    size_t round = 0;               // 0 for the seeds
+    bool pareto = false;            // Not dominated in core-seconds and SLA violations
+};
+
+struct TuneResult {
+    PolicyResult reference;         // The starting policy, untuned
+    std::vector<TuneSample> samples;
+    size_t rounds = 0;
+    double wallSeconds = 0.0;
+};
+
+class PolicyTuner {
+public:
+    PolicyTuner(const PolicyEvaluator& evaluator, const PolicySpec& base, const TunerOptions& options = TunerOptions());
+
+    bool loadSpace(const std::string& path);
+    bool loadSpaceJson(const std::string& text, std::string& error);
+    void useDefaultSpace();
+    void addParameter(const TuneParameter& parameter) { parameters_.push_back(parameter); }
+    const std::vector<TuneParameter>& parameters() const { return parameters_; }
+    TunerOptions& options() { return options_; }
+
+    TuneResult tune(const MetricsTrace& trace) const;
+
+    void printFront(const TuneResult& result) const;
+    bool exportSamples(const TuneResult& result, const std::string& filename) const;
+
+private:
+    // Unit-box point to policy values; a scale-down threshold is kept below scale-up
+    std::vector<double> decode(const std::vector<double>& unit) const;
+    bool makePolicy(const std::vector<double>& values, size_t index, PolicySpec& policy, std::string& error) const;
+
+    const PolicyEvaluator& evaluator_;
+    PolicySpec base_;
+    TunerOptions options_;
+    std::vector<TuneParameter> parameters_;
+};
+
+} // namespace cosim
+
+#endif // POLICY_TUNER_H
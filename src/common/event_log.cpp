@@ -0,0 +1,144 @@
+/*
+Implementation of the event log reader and summary helpers
+*/
+
+#include "event_log.h"
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+
+namespace cosim {
+
+const char* eventlog::eventTypeName(uint8_t type) {
+    switch (type & ~AGGREGATED) {
+        case IN_INTEREST: return "InInterests";
+        case OUT_INTEREST: return "OutInterests";
+        case IN_DATA: return "InData";
+        case OUT_DATA: return "OutData";
+        case IN_NACK: return "InNacks";
+        case OUT_NACK: return "OutNacks";
+        case SATISFIED: return "SatisfiedInterests";
+        case TIMED_OUT: return "TimedOutInterests";
+        case CS_HIT: return "CacheHits";
+        case CS_MISS: return "CacheMisses";
+        case APP_DELAY: return "AppDelay";
+        default: return "Unknown";
+    }
+}
+
+namespace {
+
+template <typename T>
+bool readColumn(std::ifstream& in, std::vector<T>& column, uint32_t count) {
+    column.resize(count);
+    in.read(reinterpret_cast<char*>(column.data()), static_cast<std::streamsize>(count * sizeof(T)));
+    return static_cast<bool>(in);
+}
+
+} // namespace
+
+bool EventLogReader::read(const std::string& filename,
+                          const std::function<void(const EventBlock&)>& onBlock) {
+    std::ifstream in(filename, std::ios::binary);
+    if (!in.is_open()) {
+        std::cerr << "❌ Failed to open event log: " << filename << std::endl;
+        return false;
+    }
+
+    char magic[sizeof(eventlog::FILE_MAGIC)];
+    uint32_t header[2];
+    in.read(magic, sizeof(magic));
+    in.read(reinterpret_cast<char*>(header), sizeof(header));
+    if (!in || std::memcmp(magic, eventlog::FILE_MAGIC, sizeof(magic)) != 0) {
+        std::cerr << "❌ Not an event log: " << filename << std::endl;
+        return false;
+    }
+    if (header[0] != eventlog::FORMAT_VERSION) {
+        std::cerr << "❌ Unsupported event log version " << header[0] << std::endl;
+        return false;
+    }
+
+    EventBlock block;
+    uint32_t blockHeader[2];
+    while (in.read(reinterpret_cast<char*>(blockHeader), sizeof(blockHeader))) {
+        uint32_t tag = blockHeader[0];
+        uint32_t count = blockHeader[1];
+
+        if (tag == eventlog::TAG_DICT) {
+            for (uint32_t i = 0; i < count; ++i) {
+                uint32_t id = 0;
+                uint16_t length = 0;
+                in.read(reinterpret_cast<char*>(&id), sizeof(id));
+                in.read(reinterpret_cast<char*>(&length), sizeof(length));
+                std::string name(length, '\0');
+                in.read(&name[0], length);
+                if (!in) return false;
+                names_[id] = name;
+            }
+        } else if (tag == eventlog::TAG_EVENTS) {
+            if (count > eventlog::MAX_BLOCK_EVENTS) {
+                std::cerr << "❌ Corrupt event block of " << count << " records in " << filename << std::endl;
+                return false;
+            }
+            if (!readColumn(in, block.time, count) || !readColumn(in, block.node, count) ||
+                !readColumn(in, block.type, count) || !readColumn(in, block.nameId, count) ||
+                !readColumn(in, block.value, count)) {
+                std::cerr << "⚠️ Truncated event block in " << filename << std::endl;
+                return false;
+            }
+            onBlock(block);
+        } else {
+            std::cerr << "❌ Unknown block tag in " << filename << std::endl;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+std::string EventLogReader::nameOf(uint32_t nameId) const {
+    auto it = names_.find(nameId);
+    return it != names_.end() ? it->second : std::string();
+}
+
+bool summarizeEventLog(const std::string& filename, EventLogSummary& summary) {
+    EventLogReader reader;
+    summary = EventLogSummary();
+
+    return reader.read(filename, [&summary](const EventBlock& block) {
+        if (block.size() == 0) return;
+        if (summary.events == 0) {
+            summary.firstTime = block.time.front();
+        }
+        summary.blocks++;
+        summary.lastTime = block.time.back();
+
+        for (size_t i = 0; i < block.size(); ++i) {
+            uint8_t type = block.type[i] & ~eventlog::AGGREGATED;
+            uint64_t count = (block.type[i] & eventlog::AGGREGATED)
+                ? static_cast<uint64_t>(block.value[i]) : 1;
+            if (type < eventlog::EVENT_TYPE_COUNT) {
+                summary.countByType[type] += count;
+            }
+            summary.maxNodeId = std::max(summary.maxNodeId, block.node[i]);
+        }
+        summary.events += block.size();
+    });
+}
+
+void printEventLogSummary(const std::string& filename, const EventLogSummary& summary) {
+    std::cout << "\n📊 === Event Log Summary: " << filename << " ===" << std::endl;
+    std::cout << "  Records: " << summary.events << " in " << summary.blocks << " blocks" << std::endl;
+    std::cout << "  Time span: " << std::fixed << std::setprecision(3)
+              << summary.firstTime << "s - " << summary.lastTime << "s" << std::endl;
+    std::cout << "  Nodes: " << (summary.events > 0 ? summary.maxNodeId + 1 : 0) << std::endl;
+    for (uint8_t type = 1; type < eventlog::EVENT_TYPE_COUNT; ++type) {
+        if (summary.countByType[type] > 0) {
+            std::cout << "  " << std::left << std::setw(20) << eventlog::eventTypeName(type)
+                      << std::right << summary.countByType[type] << std::endl;
+        }
+    }
+    std::cout << "============================================\n" << std::endl;
+}
+
+} // namespace cosim
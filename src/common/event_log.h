@@ -0,0 +1,224 @@
+/*
+Binary columnar event log shared by the platform and the ndnSIM scripts
+Events are buffered and written in blocks, one contiguous array per column,
+so long traces cost a few bytes per packet and load straight into analysis code
+
+The writer is kept inline in this header because ns-3 scratch scripts include it
+directly; the reader and summary helpers live in event_log.cpp
+
+File layout (little-endian):
+  header   : "CSEVLOG1" | uint32 version | uint32 reserved
+  block    : uint32 tag | uint32 count | payload
+    'EVTB' : double time[count] | uint32 node[count] | uint8 type[count]
+             | uint32 nameId[count] | double value[count]
+    'DICT' : count x (uint32 nameId | uint16 length | char name[length])
+*/
+
+#ifndef EVENT_LOG_H
+#define EVENT_LOG_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace cosim {
+
+namespace eventlog {
+
+constexpr char FILE_MAGIC[8] = {'C', 'S', 'E', 'V', 'L', 'O', 'G', '1'};
+constexpr uint32_t FORMAT_VERSION = 1;
+constexpr uint32_t TAG_EVENTS = 0x42545645; // "EVTB"
+constexpr uint32_t TAG_DICT = 0x54434944;   // "DICT"
+constexpr size_t DEFAULT_BLOCK_EVENTS = 8192;
+constexpr size_t MAX_BLOCK_EVENTS = 1 << 20;    // Readers reject larger blocks as corrupt
+
+// Aggregated records carry this flag in the type column; value holds the count
+constexpr uint8_t AGGREGATED = 0x80;
+
+enum EventType : uint8_t {
+    IN_INTEREST = 1,
+    OUT_INTEREST = 2,
+    IN_DATA = 3,
+    OUT_DATA = 4,
+    IN_NACK = 5,
+    OUT_NACK = 6,
+    SATISFIED = 7,
+    TIMED_OUT = 8,
+    CS_HIT = 9,
+    CS_MISS = 10,
+    APP_DELAY = 11,
+    EVENT_TYPE_COUNT
+};
+
+const char* eventTypeName(uint8_t type);
+
+} // namespace eventlog
+
+// One decoded block, column-wise
+struct EventBlock {
+    std::vector<double> time;
+    std::vector<uint32_t> node;
+    std::vector<uint8_t> type;
+    std::vector<uint32_t> nameId;
+    std::vector<double> value;
+
+    size_t size() const { return time.size(); }
+    void clear() {
+        time.clear();
+        node.clear();
+        type.clear();
+        nameId.clear();
+        value.clear();
+    }
+};
+
+// Buffered writer; append() only touches in-memory columns until a block fills up
+class EventLogWriter {
+public:
+    explicit EventLogWriter(size_t blockEvents = eventlog::DEFAULT_BLOCK_EVENTS)
+        : file_(nullptr), blockEvents_(std::min(std::max<size_t>(blockEvents, 1), eventlog::MAX_BLOCK_EVENTS)),
+          eventsWritten_(0), bytesWritten_(0) {}
+    ~EventLogWriter() { close(); }
+
+    EventLogWriter(const EventLogWriter&) = delete;
+    EventLogWriter& operator=(const EventLogWriter&) = delete;
+
+    bool open(const std::string& filename) {
+        close();
+        file_ = std::fopen(filename.c_str(), "wb");
+        if (!file_) return false;
+
+        // Large stdio buffer so block flushes turn into few write(2) calls
+        std::setvbuf(file_, nullptr, _IOFBF, 1 << 20);
+
+        uint32_t header[2] = {eventlog::FORMAT_VERSION, 0};
+        writeRaw(eventlog::FILE_MAGIC, sizeof(eventlog::FILE_MAGIC));
+        writeRaw(header, sizeof(header));
+        reserve();
+        return true;
+    }
+
+    bool isOpen() const { return file_ != nullptr; }
+
+    void append(double time, uint32_t node, uint8_t type, uint32_t nameId, double value) {
+        block_.time.push_back(time);
+        block_.node.push_back(node);
+        block_.type.push_back(type);
+        block_.nameId.push_back(nameId);
+        block_.value.push_back(value);
+        if (block_.size() >= blockEvents_) {
+            flush();
+        }
+    }
+
+    // Returns a stable id for a name, emitting its dictionary entry on first use
+    uint32_t intern(const std::string& name) {
+        auto it = names_.find(name);
+        if (it != names_.end()) return it->second;
+
+        uint32_t id = static_cast<uint32_t>(names_.size()) + 1; // 0 means "no name"
+        names_.emplace(name, id);
+        pendingNames_.emplace_back(id, name);
+        return id;
+    }
+
+    void flush() {
+        if (!file_) return;
+
+        if (!pendingNames_.empty()) {
+            writeBlockHeader(eventlog::TAG_DICT, static_cast<uint32_t>(pendingNames_.size()));
+            for (const auto& entry : pendingNames_) {
+                uint16_t length = static_cast<uint16_t>(std::min<size_t>(entry.second.size(), 0xFFFF));
+                writeRaw(&entry.first, sizeof(entry.first));
+                writeRaw(&length, sizeof(length));
+                writeRaw(entry.second.data(), length);
+            }
+            pendingNames_.clear();
+        }
+
+        size_t n = block_.size();
+        if (n > 0) {
+            writeBlockHeader(eventlog::TAG_EVENTS, static_cast<uint32_t>(n));
+            writeRaw(block_.time.data(), n * sizeof(double));
+            writeRaw(block_.node.data(), n * sizeof(uint32_t));
+            writeRaw(block_.type.data(), n * sizeof(uint8_t));
+            writeRaw(block_.nameId.data(), n * sizeof(uint32_t));
+            writeRaw(block_.value.data(), n * sizeof(double));
+            eventsWritten_ += n;
+            block_.clear();
+        }
+    }
+
+    void close() {
+        if (!file_) return;
+        flush();
+        std::fclose(file_);
+        file_ = nullptr;
+    }
+
+    uint64_t eventsWritten() const { return eventsWritten_ + block_.size(); }
+    uint64_t bytesWritten() const { return bytesWritten_; }
+
+private:
+    void reserve() {
+        block_.time.reserve(blockEvents_);
+        block_.node.reserve(blockEvents_);
+        block_.type.reserve(blockEvents_);
+        block_.nameId.reserve(blockEvents_);
+        block_.value.reserve(blockEvents_);
+    }
+
+    void writeBlockHeader(uint32_t tag, uint32_t count) {
+        writeRaw(&tag, sizeof(tag));
+        writeRaw(&count, sizeof(count));
+    }
+
+    void writeRaw(const void* data, size_t bytes) {
+        bytesWritten_ += std::fwrite(data, 1, bytes, file_);
+    }
+
+    std::FILE* file_;
+    size_t blockEvents_;
+    EventBlock block_;
+    std::unordered_map<std::string, uint32_t> names_;
+    std::vector<std::pair<uint32_t, std::string>> pendingNames_;
+    uint64_t eventsWritten_;
+    uint64_t bytesWritten_;
+};
+
+// Reader used by the platform's analysis side
+class EventLogReader {
+public:
+    EventLogReader() = default;
+
+    // Streams every event block to the callback; returns false on a malformed file
+    bool read(const std::string& filename, const std::function<void(const EventBlock&)>& onBlock);
+
+    const std::unordered_map<uint32_t, std::string>& names() const { return names_; }
+    std::string nameOf(uint32_t nameId) const;
+
+private:
+    std::unordered_map<uint32_t, std::string> names_;
+};
+
+// Per-type totals of an event log, as printed by --summarize-trace
+struct EventLogSummary {
+    uint64_t events = 0;
+    uint64_t blocks = 0;
+    double firstTime = 0.0;
+    double lastTime = 0.0;
+    uint64_t countByType[eventlog::EVENT_TYPE_COUNT] = {};
+    uint32_t maxNodeId = 0;
+};
+
+bool summarizeEventLog(const std::string& filename, EventLogSummary& summary);
+void printEventLogSummary(const std::string& filename, const EventLogSummary& summary);
+
+} // namespace cosim
+
+#endif // EVENT_LOG_H
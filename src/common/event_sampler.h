@@ -0,0 +1,148 @@
+/*
+Bounded-overhead sampling stage for per-packet NDN event export
+Events are stratified by V2X traffic class. Emergency traffic is kept in full up
+to its reserved half of the budget, awareness and other traffic are
+reservoir-sampled in the rest, and every class keeps an exact event count. Each
+interval exports at most the configured budget of sampled records, whatever the
+packet rate.
+
+Sampling is Algorithm R per class and interval, so every event of a class has
+the same inclusion probability kept/seen. Exported records carry the inverse of
+that probability as a Horvitz-Thompson weight, and sums of weights are unbiased
+estimates of the true totals. reserve() decides admission before the caller
+builds the record, so rejected events cost one counter increment and one random
+draw.
+
+Header-only because ns-3 scratch scripts include it directly
+*/
+
+#ifndef EVENT_SAMPLER_H
+#define EVENT_SAMPLER_H
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace cosim {
+
+enum class TrafficClass : uint8_t {
+    EMERGENCY = 0,
+    AWARENESS = 1,
+    OTHER = 2
+};
+
+constexpr size_t TRAFFIC_CLASS_COUNT = 3;
+
+inline const char* trafficClassName(TrafficClass cls) {
+    switch (cls) {
+        case TrafficClass::EMERGENCY: return "emergency";
+        case TrafficClass::AWARENESS: return "awareness";
+        default: return "other";
+    }
+}
+
+// Same name conventions the V2X metrics collector uses for emergency/safety counts
+inline TrafficClass classifyName(const std::string& name) {
+    if (name.find("emergency") != std::string::npos || name.find("collision") != std::string::npos) {
+        return TrafficClass::EMERGENCY;
+    }
+    if (name.find("awareness") != std::string::npos || name.find("safety") != std::string::npos) {
+        return TrafficClass::AWARENESS;
+    }
+    return TrafficClass::OTHER;
+}
+
+template <typename Record>
+class StratifiedSampler {
+public:
+    // budget: sampled records exported per interval over all classes. Emergency records
+    // get half of it (rounded up) and are exempt from sampling until that share fills;
+    // awareness and other traffic split the remainder.
+    explicit StratifiedSampler(size_t budget, uint64_t seed = 0x9E3779B97F4A7C15ull)
+        : rngState_(seed ? seed : 1) {
+        setBudget(budget);
+    }
+
+    void setBudget(size_t budget) {
+        budget_ = budget;
+        size_t emergency = budget - budget / 2;
+        size_t remaining = budget - emergency;
+        strata_[static_cast<size_t>(TrafficClass::EMERGENCY)].capacity = emergency;
+        strata_[static_cast<size_t>(TrafficClass::AWARENESS)].capacity = remaining - remaining / 2;
+        strata_[static_cast<size_t>(TrafficClass::OTHER)].capacity = remaining / 2;
+        for (auto& stratum : strata_) {
+            stratum.records.reserve(stratum.capacity);
+        }
+    }
+
+    size_t budget() const { return budget_; }
+
+    // Counts the event and returns the reservoir slot to fill, or -1 if the event is not sampled
+    long reserve(TrafficClass cls) {
+        Stratum& stratum = strata_[static_cast<size_t>(cls)];
+        uint64_t seen = ++stratum.seen;
+
+        if (stratum.records.size() < stratum.capacity) {
+            stratum.records.emplace_back();
+            return static_cast<long>(stratum.records.size() - 1);
+        }
+        if (stratum.capacity == 0) return -1;
+
+        uint64_t j = nextRandom() % seen;
+        return j < stratum.capacity ? static_cast<long>(j) : -1;
+    }
+
+    void store(TrafficClass cls, long slot, Record record) {
+        strata_[static_cast<size_t>(cls)].records[static_cast<size_t>(slot)] = std::move(record);
+    }
+
+    // Exact number of events seen in the current interval
+    uint64_t seen(TrafficClass cls) const { return strata_[static_cast<size_t>(cls)].seen; }
+    uint64_t totalSeen(TrafficClass cls) const { return strata_[static_cast<size_t>(cls)].totalSeen; }
+    uint64_t totalExported(TrafficClass cls) const { return strata_[static_cast<size_t>(cls)].totalExported; }
+
+    // Closes the interval: onRecord(record, cls, weight) for every kept record, then resets the reservoirs
+    template <typename Fn>
+    void flush(Fn&& onRecord) {
+        for (size_t c = 0; c < TRAFFIC_CLASS_COUNT; ++c) {
+            Stratum& stratum = strata_[c];
+            size_t kept = stratum.records.size();
+            double weight = kept > 0 ? static_cast<double>(stratum.seen) / kept : 0.0;
+
+            for (auto& record : stratum.records) {
+                onRecord(record, static_cast<TrafficClass>(c), weight);
+            }
+
+            stratum.totalSeen += stratum.seen;
+            stratum.totalExported += kept;
+            stratum.seen = 0;
+            stratum.records.clear();
+        }
+    }
+
+private:
+    struct Stratum {
+        size_t capacity = 0;
+        uint64_t seen = 0;
+        uint64_t totalSeen = 0;
+        uint64_t totalExported = 0;
+        std::vector<Record> records;
+    };
+
+    // xorshift64*: cheap and good enough for slot selection
+    uint64_t nextRandom() {
+        rngState_ ^= rngState_ >> 12;
+        rngState_ ^= rngState_ << 25;
+        rngState_ ^= rngState_ >> 27;
+        return rngState_ * 0x2545F4914F6CDD1Dull;
+    }
+
+    size_t budget_;
+    uint64_t rngState_;
+    std::array<Stratum, TRAFFIC_CLASS_COUNT> strata_;
+};
+
+} // namespace cosim
+
+#endif // EVENT_SAMPLER_H
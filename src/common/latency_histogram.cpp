@@ -0,0 +1,206 @@
+/*
+Implementation of the high-dynamic-range latency histogram
+*/
+
+#include "latency_histogram.h"
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <limits>
+
+namespace cosim {
+
+namespace {
+
+constexpr double NS_PER_MS = 1e6;
+constexpr double REPORTED_PERCENTILES[] = {50.0, 90.0, 99.0, 99.9};
+constexpr const char* PERCENTILE_KEYS[] = {"p50", "p90", "p99", "p99_9"};
+
+} // anonymous namespace
+
+LatencyHistogram::LatencyHistogram(uint64_t lowest, uint64_t highest, int significantDigits)
+    : highest_(std::max<uint64_t>(highest, 2 * std::max<uint64_t>(lowest, 1))),
+      min_(std::numeric_limits<uint64_t>::max()) {
+    significantDigits = std::min(5, std::max(1, significantDigits));
+    const int subBucketCountMagnitude =
+        static_cast<int>(std::ceil(std::log2(2.0 * std::pow(10.0, significantDigits))));
+    subBucketHalfCountMagnitude_ = subBucketCountMagnitude - 1;
+    subBucketHalfCount_ = 1ULL << subBucketHalfCountMagnitude_;
+    unitMagnitude_ = static_cast<int>(std::floor(std::log2(static_cast<double>(std::max<uint64_t>(lowest, 1)))));
+    subBucketMask_ = ((1ULL << subBucketCountMagnitude) - 1) << unitMagnitude_;
+    leadingZeroCountBase_ = 64 - unitMagnitude_ - subBucketHalfCountMagnitude_ - 1;
+
+    // Buckets until the first value that cannot be tracked lies past `highest`
+    uint64_t smallestUntrackable = (1ULL << subBucketCountMagnitude) << unitMagnitude_;
+    size_t buckets = 1;
+    while (smallestUntrackable <= highest_) {
+        if (smallestUntrackable > std::numeric_limits<uint64_t>::max() / 2) {
+            ++buckets;
+            break;
+        }
+        smallestUntrackable <<= 1;
+        ++buckets;
+    }
+    countsLength_ = (buckets + 1) * subBucketHalfCount_;
+    counts_.reset(new std::atomic<uint64_t>[countsLength_]());
+}
+
+size_t LatencyHistogram::countsIndex(uint64_t value) const {
+    const int bucket = leadingZeroCountBase_ - __builtin_clzll(value | subBucketMask_);
+    const uint64_t subBucket = value >> (bucket + unitMagnitude_);
+    return (static_cast<size_t>(bucket + 1) << subBucketHalfCountMagnitude_) + (subBucket - subBucketHalfCount_);
+}
+
+uint64_t LatencyHistogram::valueFromIndex(size_t index) const {
+    int bucket = static_cast<int>(index >> subBucketHalfCountMagnitude_) - 1;
+    uint64_t subBucket = (index & (subBucketHalfCount_ - 1)) + subBucketHalfCount_;
+    if (bucket < 0) {
+        subBucket -= subBucketHalfCount_;
+        bucket = 0;
+    }
+    return subBucket << (bucket + unitMagnitude_);
+}
+
+uint64_t LatencyHistogram::highestEquivalent(uint64_t value) const {
+    const int bucket = leadingZeroCountBase_ - __builtin_clzll(value | subBucketMask_);
+    const int shift = bucket + unitMagnitude_;
+    return ((value >> shift) << shift) + (1ULL << shift) - 1;
+}
+
+void LatencyHistogram::record(uint64_t nanoseconds) {
+    if (nanoseconds > highest_) {
+        nanoseconds = highest_;
+        clamped_.fetch_add(1, std::memory_order_relaxed);
+    }
+    counts_[countsIndex(nanoseconds)].fetch_add(1, std::memory_order_relaxed);
+    total_.fetch_add(1, std::memory_order_relaxed);
+    sum_.fetch_add(nanoseconds, std::memory_order_relaxed);
+
+    uint64_t seen = min_.load(std::memory_order_relaxed);
+    while (nanoseconds < seen && !min_.compare_exchange_weak(seen, nanoseconds, std::memory_order_relaxed)) {
+    }
+    seen = max_.load(std::memory_order_relaxed);
+    while (nanoseconds > seen && !max_.compare_exchange_weak(seen, nanoseconds, std::memory_order_relaxed)) {
+    }
+}
+
+void LatencyHistogram::record(std::chrono::steady_clock::duration duration) {
+    auto nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+    record(static_cast<uint64_t>(std::max<int64_t>(0, nanoseconds)));
+}
+
+void LatencyHistogram::recordSeconds(double seconds) {
+    record(static_cast<uint64_t>(std::max(0.0, std::min(seconds * 1e9, static_cast<double>(highest_) + 1.0))));
+}
+
+void LatencyHistogram::reset() {
+    for (size_t i = 0; i < countsLength_; ++i) {
+        counts_[i].store(0, std::memory_order_relaxed);
+    }
+    total_.store(0, std::memory_order_relaxed);
+    sum_.store(0, std::memory_order_relaxed);
+    min_.store(std::numeric_limits<uint64_t>::max(), std::memory_order_relaxed);
+    max_.store(0, std::memory_order_relaxed);
+    clamped_.store(0, std::memory_order_relaxed);
+}
+
+uint64_t LatencyHistogram::min() const {
+    return count() > 0 ? min_.load(std::memory_order_relaxed) : 0;
+}
+
+double LatencyHistogram::mean() const {
+    const uint64_t n = count();
+    return n > 0 ? static_cast<double>(sum_.load(std::memory_order_relaxed)) / n : 0.0;
+}
+
+// Totals come from the same pass as the counts, so a concurrent record cannot skew the rank
+uint64_t LatencyHistogram::valueAtPercentile(double percentile) const {
+    uint64_t total = 0;
+    for (size_t i = 0; i < countsLength_; ++i) {
+        total += counts_[i].load(std::memory_order_relaxed);
+    }
+    if (total == 0) {
+        return 0;
+    }
+
+    percentile = std::min(100.0, std::max(0.0, percentile));
+    const uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(percentile / 100.0 * total)));
+    uint64_t seen = 0;
+    for (size_t i = 0; i < countsLength_; ++i) {
+        seen += counts_[i].load(std::memory_order_relaxed);
+        if (seen >= rank) {
+            return std::min(highestEquivalent(valueFromIndex(i)), max());
+        }
+    }
+    return max();
+}
+
+std::vector<LatencyHistogram::Bucket> LatencyHistogram::distribution() const {
+    std::vector<std::pair<size_t, uint64_t>> filled;
+    uint64_t total = 0;
+    for (size_t i = 0; i < countsLength_; ++i) {
+        uint64_t n = counts_[i].load(std::memory_order_relaxed);
+        if (n > 0) {
+            filled.emplace_back(i, n);
+            total += n;
+        }
+    }
+
+    std::vector<Bucket> buckets;
+    buckets.reserve(filled.size());
+    uint64_t seen = 0;
+    for (const auto& entry : filled) {
+        seen += entry.second;
+        buckets.push_back({highestEquivalent(valueFromIndex(entry.first)), entry.second, 100.0 * seen / total});
+    }
+    return buckets;
+}
+
+void LatencyHistogram::printHeader(std::ostream& out, int labelWidth) {
+    const std::ios_base::fmtflags flags = out.flags();
+    out << "  " << std::left << std::setw(labelWidth) << "" << std::right << std::setw(9) << "count"
+        << std::setw(10) << "mean" << std::setw(10) << "p50" << std::setw(10) << "p90" << std::setw(10) << "p99"
+        << std::setw(10) << "p99.9" << std::setw(10) << "max" << "  (ms)" << std::endl;
+    out.flags(flags);
+}
+
+void LatencyHistogram::printRow(std::ostream& out, const std::string& label, int labelWidth) const {
+    const std::ios_base::fmtflags flags = out.flags();
+    const std::streamsize precision = out.precision();
+    out << "  " << std::left << std::setw(labelWidth) << label << std::right << std::setw(9) << count();
+    if (count() == 0) {
+        out << std::endl;
+        out.flags(flags);
+        return;
+    }
+    out << std::fixed << std::setprecision(3) << std::setw(10) << (mean() / NS_PER_MS);
+    for (double percentile : REPORTED_PERCENTILES) {
+        out << std::setw(10) << (valueAtPercentile(percentile) / NS_PER_MS);
+    }
+    out << std::setw(10) << (max() / NS_PER_MS);
+    if (clamped() > 0) {
+        out << "  (" << clamped() << " over range)";
+    }
+    out << std::endl;
+    out.flags(flags);
+    out.precision(precision);
+}
+
+void LatencyHistogram::exportSummary(std::ostream& out, const std::string& prefix) const {
+    out << prefix << "_count," << count() << "\n";
+    out << prefix << "_mean_ms," << (mean() / NS_PER_MS) << "\n";
+    out << prefix << "_min_ms," << (min() / NS_PER_MS) << "\n";
+    for (size_t p = 0; p < sizeof(REPORTED_PERCENTILES) / sizeof(REPORTED_PERCENTILES[0]); ++p) {
+        out << prefix << "_" << PERCENTILE_KEYS[p] << "_ms," << (valueAtPercentile(REPORTED_PERCENTILES[p]) / NS_PER_MS)
+            << "\n";
+    }
+    out << prefix << "_max_ms," << (max() / NS_PER_MS) << "\n";
+}
+
+void LatencyHistogram::exportDistribution(std::ostream& out, const std::string& prefix) const {
+    for (const auto& bucket : distribution()) {
+        out << prefix << "," << (bucket.upper / NS_PER_MS) << "," << bucket.count << "," << bucket.percentile << "\n";
+    }
+}
+
+} // namespace cosim
@@ -0,0 +1,96 @@
+/*
+High-dynamic-range latency histograms
+Log-linear buckets in the HdrHistogram layout: every power-of-two range of values
+is split into the same number of linear sub-buckets, so any recorded value is
+kept to a fixed number of significant decimal digits across the whole range
+(microseconds to a minute by default). Memory is allocated once at construction.
+
+Recording is one atomic increment and is safe from any number of threads while
+another thread reads percentiles; readers see every count recorded before they
+started and possibly some recorded during the read.
+*/
+
+#ifndef LATENCY_HISTOGRAM_H
+#define LATENCY_HISTOGRAM_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace cosim {
+
+class LatencyHistogram {
+public:
+    // Values are nanoseconds; larger ones are clamped to `highest` and counted
+    explicit LatencyHistogram(uint64_t lowest = 1000, uint64_t highest = 60000000000ULL, int significantDigits = 3);
+
+    LatencyHistogram(const LatencyHistogram&) = delete;
+    LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+
+    void record(uint64_t nanoseconds);
+    void record(std::chrono::steady_clock::duration duration);
+    void recordSeconds(double seconds);
+
+    // Not synchronized with concurrent recording
+    void reset();
+
+    uint64_t count() const { return total_.load(std::memory_order_relaxed); }
+    uint64_t min() const;
+    uint64_t max() const { return max_.load(std::memory_order_relaxed); }
+    double mean() const;
+    uint64_t clamped() const { return clamped_.load(std::memory_order_relaxed); }
+
+    // Highest value equivalent to the one at `percentile` (0-100), nanoseconds
+    uint64_t valueAtPercentile(double percentile) const;
+
+    struct Bucket {
+        uint64_t upper;         // Highest value the bucket holds, nanoseconds
+        uint64_t count;
+        double percentile;      // Share of all values at or below `upper`, 0-100
+    };
+
+    // Non-empty buckets in value order
+    std::vector<Bucket> distribution() const;
+
+    size_t memoryBytes() const { return countsLength_ * sizeof(std::atomic<uint64_t>); }
+
+    // One table row: count, mean, p50, p90, p99, p99.9 and max in milliseconds.
+    // Both leave the stream's flags and precision as they found them
+    static void printHeader(std::ostream& out, int labelWidth);
+    void printRow(std::ostream& out, const std::string& label, int labelWidth) const;
+
+    // "<prefix>_count,...", "<prefix>_p99_ms,..." key-value lines
+    void exportSummary(std::ostream& out, const std::string& prefix) const;
+
+    // One "<prefix>,<upper_ms>,<count>,<percentile>" line per non-empty bucket
+    void exportDistribution(std::ostream& out, const std::string& prefix) const;
+
+private:
+    size_t countsIndex(uint64_t value) const;
+    uint64_t valueFromIndex(size_t index) const;
+    uint64_t highestEquivalent(uint64_t value) const;
+
+    uint64_t highest_;
+    int unitMagnitude_;                 // log2 of the lowest discernible value
+    int subBucketHalfCountMagnitude_;
+    uint64_t subBucketHalfCount_;
+    uint64_t subBucketMask_;
+    int leadingZeroCountBase_;
+    size_t countsLength_;
+
+    std::unique_ptr<std::atomic<uint64_t>[]> counts_;
+    std::atomic<uint64_t> total_{0};
+    std::atomic<uint64_t> sum_{0};
+    std::atomic<uint64_t> min_;
+    std::atomic<uint64_t> max_{0};
+    std::atomic<uint64_t> clamped_{0};
+};
+
+} // namespace cosim
+
+#endif // LATENCY_HISTOGRAM_H
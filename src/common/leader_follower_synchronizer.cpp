@@ -4,13 +4,23 @@ Leader-Follower Synchronizer Implementation
 
 #include "leader_follower_synchronizer.h"
 #include "../adapters/omnet_orchestrator.h"
+#include "metrics_endpoint.h"
+#include "step_tracer.h"
 #include <iostream>
 #include <iomanip>
 #include <fstream>
 #include <algorithm>
+#include <utility>
+#include <vector>
 
 namespace cosim {
 
+namespace {
+
+constexpr int TIMING_LABEL_WIDTH = 16;
+
+} // anonymous namespace
+
 LeaderFollowerSynchronizer::LeaderFollowerSynchronizer(const Config& config)
     : config_(config), leader_(nullptr), follower_(nullptr),
       currentTime_(0.0), running_(false), initialized_(false) {
@@ -19,9 +29,6 @@ LeaderFollowerSynchronizer::LeaderFollowerSynchronizer(const Config& config)
     performanceMetrics_.totalSteps = 0;
     performanceMetrics_.successfulSteps = 0;
     performanceMetrics_.failedSteps = 0;
-    performanceMetrics_.avgStepDuration = 0.0;
-    performanceMetrics_.maxStepDuration = 0.0;
-    performanceMetrics_.minStepDuration = std::numeric_limits<double>::max();
     performanceMetrics_.timeouts = 0;
 }
 
@@ -98,6 +105,7 @@ bool LeaderFollowerSynchronizer::run() {
     
     int stepCount = 0;
     auto lastProgressTime = std::chrono::steady_clock::now();
+    StepTracer::nameThread("sync");
     
     while (running_ && currentTime_ < simulationTime) {
         auto stepStart = std::chrono::steady_clock::now();
@@ -106,11 +114,10 @@ bool LeaderFollowerSynchronizer::run() {
         bool stepSuccess = executeTimeStep();
         
         auto stepEnd = std::chrono::steady_clock::now();
-        auto stepDuration = std::chrono::duration<double>(stepEnd - stepStart).count();
         
         // Update metrics
         updatePerformanceMetrics();
-        logTimeStep(stepDuration);
+        performanceMetrics_.stepDuration.record(stepEnd - stepStart);
         
         if (!stepSuccess) {
             std::cerr << "⚠️ Time step failed at t=" << currentTime_ << "s" << std::endl;
@@ -156,29 +163,51 @@ bool LeaderFollowerSynchronizer::run() {
 
 bool LeaderFollowerSynchronizer::executeTimeStep() {
     double syncInterval = config_.getSyncInterval();
+    TraceSpan stepSpan("time_step", "sync");
     
     try {
         // Step 1: Leader advances time and sends sync command
-        if (!leader_->step(syncInterval)) {
+        auto phaseStart = std::chrono::steady_clock::now();
+        bool leaderStepped;
+        {
+            TraceSpan span("leader_step", "sync");
+            leaderStepped = leader_->step(syncInterval);
+        }
+        auto phaseEnd = std::chrono::steady_clock::now();
+        performanceMetrics_.leaderStep.record(phaseEnd - phaseStart);
+        if (!leaderStepped) {
             std::cerr << "❌ Leader step failed" << std::endl;
             performanceMetrics_.failedSteps++;
             return false;
         }
         
         // Step 2: Follower receives sync command and advances
-        if (!follower_->step(syncInterval)) {
+        phaseStart = phaseEnd;
+        bool followerStepped;
+        {
+            TraceSpan span("follower_step", "sync");
+            followerStepped = follower_->step(syncInterval);
+        }
+        phaseEnd = std::chrono::steady_clock::now();
+        performanceMetrics_.followerStep.record(phaseEnd - phaseStart);
+        if (!followerStepped) {
             std::cerr << "❌ Follower step failed" << std::endl;
             performanceMetrics_.failedSteps++;
             return false;
         }
         
         // Step 3: Exchange vehicle data between simulators
+        phaseStart = phaseEnd;
+        TraceSpan exchangeSpan("vehicle_exchange", "sync");
         auto leaderVehicles = leader_->getVehicleData();
         auto followerVehicles = follower_->getVehicleData();
         
         // Update vehicle data in both simulators
         follower_->updateVehicleData(leaderVehicles);
         leader_->updateVehicleData(followerVehicles);
+        performanceMetrics_.leaderVehicles = static_cast<uint32_t>(leaderVehicles.size());
+        performanceMetrics_.followerVehicles = static_cast<uint32_t>(followerVehicles.size());
+        performanceMetrics_.dataExchange.record(std::chrono::steady_clock::now() - phaseStart);
         
         performanceMetrics_.successfulSteps++;
         return true;
@@ -211,18 +240,6 @@ void LeaderFollowerSynchronizer::updatePerformanceMetrics() {
     performanceMetrics_.totalSteps++;
 }
 
-void LeaderFollowerSynchronizer::logTimeStep(double stepDuration) {
-    std::lock_guard<std::mutex> lock(metricsMutex_);
-    
-    // Update step duration statistics
-    performanceMetrics_.avgStepDuration = 
-        (performanceMetrics_.avgStepDuration * (performanceMetrics_.totalSteps - 1) + stepDuration) / 
-        performanceMetrics_.totalSteps;
-    
-    performanceMetrics_.maxStepDuration = std::max(performanceMetrics_.maxStepDuration, stepDuration);
-    performanceMetrics_.minStepDuration = std::min(performanceMetrics_.minStepDuration, stepDuration);
-}
-
 void LeaderFollowerSynchronizer::stop() {
     if (!running_) return;
     
@@ -264,12 +281,24 @@ void LeaderFollowerSynchronizer::printPerformanceSummary() const {
               << "%" << std::endl;
     
     std::cout << "\n⏲️  Step Timing:" << std::endl;
-    std::cout << "  Average step duration: " << std::setprecision(3) 
-              << (performanceMetrics_.avgStepDuration * 1000) << " ms" << std::endl;
-    std::cout << "  Min step duration: " 
-              << (performanceMetrics_.minStepDuration * 1000) << " ms" << std::endl;
-    std::cout << "  Max step duration: " 
-              << (performanceMetrics_.maxStepDuration * 1000) << " ms" << std::endl;
+    LatencyHistogram::printHeader(std::cout, TIMING_LABEL_WIDTH);
+    performanceMetrics_.stepDuration.printRow(std::cout, "step", TIMING_LABEL_WIDTH);
+    performanceMetrics_.leaderStep.printRow(std::cout, "leader step", TIMING_LABEL_WIDTH);
+    performanceMetrics_.followerStep.printRow(std::cout, "follower step", TIMING_LABEL_WIDTH);
+    performanceMetrics_.dataExchange.printRow(std::cout, "data exchange", TIMING_LABEL_WIDTH);
+    
+    if (auto* orchestrator = dynamic_cast<const OMNeTOrchestrator*>(leader_)) {
+        std::cout << "\n📨 Follower Link Timing:" << std::endl;
+        LatencyHistogram::printHeader(std::cout, TIMING_LABEL_WIDTH);
+        orchestrator->getSyncRoundTrip().printRow(std::cout, "sync round trip", TIMING_LABEL_WIDTH);
+        for (size_t t = 0; t < COSIM_MESSAGE_TYPE_COUNT; ++t) {
+            auto type = static_cast<CoSimMessage::Type>(t);
+            if (orchestrator->getMessageHandling(type).count() > 0) {
+                orchestrator->getMessageHandling(type).printRow(std::cout, coSimMessageTypeName(type),
+                                                                TIMING_LABEL_WIDTH);
+            }
+        }
+    }
     
     if (performanceMetrics_.timeouts > 0) {
         std::cout << "⚠️  Timeouts: " << performanceMetrics_.timeouts << std::endl;
@@ -278,6 +307,32 @@ void LeaderFollowerSynchronizer::printPerformanceSummary() const {
     std::cout << "============================================\n" << std::endl;
 }
 
+// Reads only atomics and histograms, so a scrape never waits on the step loop
+void LeaderFollowerSynchronizer::writePrometheus(PrometheusWriter& out) const {
+    out.gauge("cosim_simulation_time_seconds", "Simulation time reached by the synchronizer", currentTime_.load());
+    out.counter("cosim_steps_total", "Synchronized steps attempted", static_cast<double>(performanceMetrics_.totalSteps));
+    out.counter("cosim_step_failures_total", "Steps the leader or the follower failed",
+                static_cast<double>(performanceMetrics_.failedSteps));
+    out.counter("cosim_sync_timeouts_total", "Steps that timed out waiting for a simulator",
+                static_cast<double>(performanceMetrics_.timeouts));
+    
+    const char* stepHelp = "Wall-clock time of each phase of a synchronized step";
+    out.histogram("cosim_step_duration_seconds", stepHelp, performanceMetrics_.stepDuration,
+                  PrometheusWriter::label("phase", "step"));
+    out.histogram("cosim_step_duration_seconds", stepHelp, performanceMetrics_.leaderStep,
+                  PrometheusWriter::label("phase", "leader"));
+    out.histogram("cosim_step_duration_seconds", stepHelp, performanceMetrics_.followerStep,
+                  PrometheusWriter::label("phase", "follower"));
+    out.histogram("cosim_step_duration_seconds", stepHelp, performanceMetrics_.dataExchange,
+                  PrometheusWriter::label("phase", "data_exchange"));
+    
+    const char* vehicleHelp = "Vehicles each simulator reported in the latest data exchange";
+    out.gauge("cosim_vehicles", vehicleHelp, performanceMetrics_.leaderVehicles,
+              PrometheusWriter::label("simulator", "leader"));
+    out.gauge("cosim_vehicles", vehicleHelp, performanceMetrics_.followerVehicles,
+              PrometheusWriter::label("simulator", "follower"));
+}
+
 void LeaderFollowerSynchronizer::exportPerformanceData(const std::string& filename) const {
     std::ofstream file(filename);
     if (!file.is_open()) {
@@ -301,11 +356,34 @@ void LeaderFollowerSynchronizer::exportPerformanceData(const std::string& filena
     file << "successful_steps," << performanceMetrics_.successfulSteps << "\n";
     file << "failed_steps," << performanceMetrics_.failedSteps << "\n";
     file << "success_rate," << (100.0 * performanceMetrics_.successfulSteps / performanceMetrics_.totalSteps) << "\n";
-    file << "avg_step_duration_ms," << (performanceMetrics_.avgStepDuration * 1000) << "\n";
-    file << "min_step_duration_ms," << (performanceMetrics_.minStepDuration * 1000) << "\n";
-    file << "max_step_duration_ms," << (performanceMetrics_.maxStepDuration * 1000) << "\n";
+    file << "avg_step_duration_ms," << (performanceMetrics_.stepDuration.mean() / 1e6) << "\n";
+    file << "min_step_duration_ms," << (performanceMetrics_.stepDuration.min() / 1e6) << "\n";
+    file << "max_step_duration_ms," << (performanceMetrics_.stepDuration.max() / 1e6) << "\n";
     file << "timeouts," << performanceMetrics_.timeouts << "\n";
     
+    // Percentile summaries, then every non-empty bucket of each histogram
+    std::vector<std::pair<std::string, const LatencyHistogram*>> histograms = {
+        {"step_duration", &performanceMetrics_.stepDuration},
+        {"leader_step", &performanceMetrics_.leaderStep},
+        {"follower_step", &performanceMetrics_.followerStep},
+        {"data_exchange", &performanceMetrics_.dataExchange}
+    };
+    if (auto* orchestrator = dynamic_cast<const OMNeTOrchestrator*>(leader_)) {
+        histograms.emplace_back("sync_round_trip", &orchestrator->getSyncRoundTrip());
+        for (size_t t = 0; t < COSIM_MESSAGE_TYPE_COUNT; ++t) {
+            auto type = static_cast<CoSimMessage::Type>(t);
+            histograms.emplace_back(std::string("message_") + coSimMessageTypeName(type),
+                                    &orchestrator->getMessageHandling(type));
+        }
+    }
+    for (const auto& histogram : histograms) {
+        histogram.second->exportSummary(file, histogram.first);
+    }
+    file << "\nhistogram,upper_ms,count,percentile\n";
+    for (const auto& histogram : histograms) {
+        histogram.second->exportDistribution(file, histogram.first);
+    }
+    
     file.close();
     std::cout << "📁 Performance data exported to: " << filename << std::endl;
 }
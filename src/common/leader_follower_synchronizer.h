@@ -9,6 +9,7 @@ Implements the synchronization protocol between OMNeT++ (Leader) and ndnSIM (Fol
 #include "synchronizer.h"
 #include "config.h"
 #include "message.h"
+#include "latency_histogram.h"
 #include <memory>
 #include <chrono>
 #include <atomic>
@@ -19,6 +20,7 @@ namespace cosim {
 
 // Forward declarations
 class OMNeTOrchestrator;
+class PrometheusWriter;
 
 class LeaderFollowerSynchronizer {
 public:
@@ -41,6 +43,7 @@ public:
     // Performance monitoring
     void printPerformanceSummary() const;
     void exportPerformanceData(const std::string& filename) const;
+    void writePrometheus(PrometheusWriter& out) const;     // Safe from any thread
     
 private:
     // Synchronization loop
@@ -49,7 +52,6 @@ private:
     
     // Performance tracking
     void updatePerformanceMetrics();
-    void logTimeStep(double stepDuration);
     
     Config config_;
     
@@ -62,15 +64,18 @@ private:
     std::atomic<bool> running_;
     std::atomic<bool> initialized_;
     
-    // Performance metrics
+    // Performance metrics; the histograms record without the mutex
     struct SyncPerformanceMetrics {
-        uint64_t totalSteps;
-        uint64_t successfulSteps;
-        uint64_t failedSteps;
-        double avgStepDuration;
-        double maxStepDuration;
-        double minStepDuration;
-        uint64_t timeouts;
+        std::atomic<uint64_t> totalSteps;
+        std::atomic<uint64_t> successfulSteps;
+        std::atomic<uint64_t> failedSteps;
+        std::atomic<uint64_t> timeouts;
+        std::atomic<uint32_t> leaderVehicles{0};    // In the latest data exchange
+        std::atomic<uint32_t> followerVehicles{0};
+        LatencyHistogram stepDuration;      // Whole synchronized step
+        LatencyHistogram leaderStep;
+        LatencyHistogram followerStep;
+        LatencyHistogram dataExchange;      // Vehicle data both ways
         std::chrono::steady_clock::time_point startTime;
         std::chrono::steady_clock::time_point endTime;
     } performanceMetrics_;
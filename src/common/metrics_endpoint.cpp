@@ -0,0 +1,402 @@
+/*
+Implementation of the Prometheus metrics endpoint and its poll() reactor
+*/
+
+#include "metrics_endpoint.h"
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+
+namespace cosim {
+
+namespace {
+
+// Bucket bounds in seconds, from sub-millisecond socket work to stalled steps
+constexpr double HISTOGRAM_BOUNDS[] = {
+    0.0001, 0.00025, 0.0005, 0.001, 0.0025, 0.005, 0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1.0, 2.5, 5.0, 10.0, 30.0, 60.0
+};
+
+constexpr size_t MAX_CLIENTS = 32;
+constexpr size_t MAX_REQUEST_BYTES = 8192;
+constexpr auto CLIENT_TIMEOUT = std::chrono::seconds(10);
+constexpr int REACTOR_TICK_MS = 1000;       // Idle clients are reaped at this period
+
+std::string formatValue(double value) {
+    std::ostringstream out;
+    out.precision(15);
+    out << value;
+    return out.str();
+}
+
+bool setNonBlocking(int socket) {
+    int flags = fcntl(socket, F_GETFL, 0);
+    return flags >= 0 && fcntl(socket, F_SETFL, flags | O_NONBLOCK) == 0;
+}
+
+std::string httpResponse(const char* status, const char* contentType, const std::string& body, bool head) {
+    std::ostringstream out;
+    out << "HTTP/1.1 " << status << "\r\n"
+        << "Content-Type: " << contentType << "\r\n"
+        << "Content-Length: " << body.size() << "\r\n"
+        << "Connection: close\r\n\r\n";
+    if (!head) {
+        out << body;
+    }
+    return out.str();
+}
+
+} // anonymous namespace
+
+// =============================================================================
+// PrometheusWriter
+// =============================================================================
+
+std::string PrometheusWriter::label(const std::string& key, const std::string& value) {
+    std::string escaped;
+    escaped.reserve(value.size());
+    for (char c : value) {
+        if (c == '\\' || c == '"') {
+            escaped += '\\';
+            escaped += c;
+        } else if (c == '\n') {
+            escaped += "\\n";
+        } else {
+            escaped += c;
+        }
+    }
+    return key + "=\"" + escaped + "\"";
+}
+
+void PrometheusWriter::family(const std::string& name, const std::string& help, const char* type) {
+    if (families_.insert(name).second) {
+        text_ += "# HELP " + name + " " + help + "\n";
+        text_ += "# TYPE " + name + " " + type + "\n";
+    }
+}
+
+void PrometheusWriter::sample(const std::string& name, const std::string& labels, double value) {
+    text_ += name;
+    if (!labels.empty()) {
+        text_ += "{" + labels + "}";
+    }
+    text_ += " " + formatValue(value) + "\n";
+}
+
+void PrometheusWriter::counter(const std::string& name, const std::string& help, double value,
+                               const std::string& labels) {
+    family(name, help, "counter");
+    sample(name, labels, value);
+}
+
+void PrometheusWriter::gauge(const std::string& name, const std::string& help, double value,
+                             const std::string& labels) {
+    family(name, help, "gauge");
+    sample(name, labels, value);
+}
+
+// Bucket counts come from one pass over the histogram so they stay monotonic while
+// other threads record; a value sits in the first bound at or above its bucket's top
+void PrometheusWriter::histogram(const std::string& name, const std::string& help,
+                                 const LatencyHistogram& histogram, const std::string& labels) {
+    family(name, help, "histogram");
+    const std::string prefix = labels.empty() ? "" : labels + ",";
+
+    std::vector<LatencyHistogram::Bucket> buckets = histogram.distribution();
+    uint64_t cumulative = 0;
+    size_t next = 0;
+    for (double bound : HISTOGRAM_BOUNDS) {
+        while (next < buckets.size() && buckets[next].upper <= bound * 1e9) {
+            cumulative += buckets[next++].count;
+        }
+        sample(name + "_bucket", prefix + label("le", formatValue(bound)), static_cast<double>(cumulative));
+    }
+    for (; next < buckets.size(); ++next) {
+        cumulative += buckets[next].count;
+    }
+    sample(name + "_bucket", prefix + label("le", "+Inf"), static_cast<double>(cumulative));
+    sample(name + "_sum", labels, histogram.mean() * histogram.count() / 1e9);
+    sample(name + "_count", labels, static_cast<double>(cumulative));
+}
+
+// =============================================================================
+// MetricsEndpoint
+// =============================================================================
+
+MetricsEndpoint::~MetricsEndpoint() {
+    stop();
+}
+
+bool MetricsEndpoint::start(const std::string& address) {
+    if (running_) {
+        return true;
+    }
+
+    bool listening;
+    if (address.find('/') != std::string::npos) {
+        listening = listenUnix(address);
+    } else {
+        size_t colon = address.rfind(':');
+        std::string host = colon == std::string::npos ? "127.0.0.1" : address.substr(0, colon);
+        std::string port = colon == std::string::npos ? address : address.substr(colon + 1);
+        if (port.empty() || port.size() > 5 ||
+            !std::all_of(port.begin(), port.end(), [](unsigned char c) { return std::isdigit(c); }) ||
+            std::stoi(port) > 65535) {
+            std::cerr << "❌ Invalid metrics endpoint address: " << address << std::endl;
+            return false;
+        }
+        listening = listenTcp(host, std::stoi(port));
+    }
+    if (!listening) {
+        return false;
+    }
+
+    if (pipe(wakePipe_) < 0) {
+        std::cerr << "❌ Failed to create the metrics endpoint wake pipe" << std::endl;
+        stop();
+        return false;
+    }
+
+    address_ = address;
+    running_ = true;
+    reactorThread_ = std::thread(&MetricsEndpoint::reactorLoop, this);
+    std::cout << "📡 Metrics endpoint serving Prometheus text on " << address << "/metrics" << std::endl;
+    return true;
+}
+
+bool MetricsEndpoint::listenTcp(const std::string& host, int port) {
+    struct sockaddr_in addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    if (inet_pton(AF_INET, host.c_str(), &addr.sin_addr) != 1) {
+        std::cerr << "❌ Invalid metrics endpoint host: " << host << std::endl;
+        return false;
+    }
+
+    listenSocket_ = socket(AF_INET, SOCK_STREAM, 0);
+    if (listenSocket_ < 0) {
+        std::cerr << "❌ Failed to create metrics endpoint socket" << std::endl;
+        return false;
+    }
+    int opt = 1;
+    setsockopt(listenSocket_, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+
+    if (bind(listenSocket_, (struct sockaddr*)&addr, sizeof(addr)) < 0 ||
+        listen(listenSocket_, static_cast<int>(MAX_CLIENTS)) < 0 || !setNonBlocking(listenSocket_)) {
+        std::cerr << "❌ Failed to listen for metrics scrapes on " << host << ":" << port << std::endl;
+        close(listenSocket_);
+        listenSocket_ = -1;
+        return false;
+    }
+    return true;
+}
+
+bool MetricsEndpoint::listenUnix(const std::string& path) {
+    struct sockaddr_un addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(addr.sun_path)) {
+        std::cerr << "❌ Metrics endpoint socket path too long: " << path << std::endl;
+        return false;
+    }
+    std::strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+
+    listenSocket_ = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listenSocket_ < 0) {
+        std::cerr << "❌ Failed to create metrics endpoint socket" << std::endl;
+        return false;
+    }
+
+    // A socket file left behind by an earlier run would fail the bind
+    unlink(path.c_str());
+    if (bind(listenSocket_, (struct sockaddr*)&addr, sizeof(addr)) < 0 ||
+        listen(listenSocket_, static_cast<int>(MAX_CLIENTS)) < 0 || !setNonBlocking(listenSocket_)) {
+        std::cerr << "❌ Failed to listen for metrics scrapes on " << path << std::endl;
+        close(listenSocket_);
+        listenSocket_ = -1;
+        return false;
+    }
+    unixPath_ = path;
+    return true;
+}
+
+void MetricsEndpoint::stop() {
+    if (running_.exchange(false)) {
+        char wake = 0;
+        if (write(wakePipe_[1], &wake, 1) < 0) {
+            // The reactor still wakes within one tick
+        }
+        if (reactorThread_.joinable()) {
+            reactorThread_.join();
+        }
+    }
+
+    for (auto& client : clients_) {
+        close(client.socket);
+    }
+    clients_.clear();
+    for (int* fd : {&listenSocket_, &wakePipe_[0], &wakePipe_[1]}) {
+        if (*fd >= 0) {
+            close(*fd);
+            *fd = -1;
+        }
+    }
+    if (!unixPath_.empty()) {
+        unlink(unixPath_.c_str());
+        unixPath_.clear();
+    }
+}
+
+// One poll() over the wake pipe, the listening socket and every client; a client
+// is polled for input until its request is complete, then for output
+void MetricsEndpoint::reactorLoop() {
+    std::vector<struct pollfd> fds;
+    while (running_) {
+        fds.clear();
+        fds.push_back({wakePipe_[0], POLLIN, 0});
+        fds.push_back({listenSocket_, POLLIN, 0});
+        for (const auto& client : clients_) {
+            fds.push_back({client.socket, static_cast<short>(client.response.empty() ? POLLIN : POLLOUT), 0});
+        }
+
+        if (poll(fds.data(), fds.size(), REACTOR_TICK_MS) < 0) {
+            continue;
+        }
+        if (fds[0].revents & POLLIN) {
+            break;
+        }
+
+        // Clients first: accepting appends to clients_, which fds no longer matches
+        auto now = std::chrono::steady_clock::now();
+        size_t kept = 0;
+        for (size_t i = 0; i < clients_.size(); ++i) {
+            Client& client = clients_[i];
+            short events = fds[i + 2].revents;
+            bool open = true;
+            if (events & (POLLERR | POLLNVAL)) {
+                open = false;
+            } else if (events & (POLLIN | POLLOUT | POLLHUP)) {
+                open = client.response.empty() ? readRequest(client) : writeResponse(client);
+            } else if (now - client.opened > CLIENT_TIMEOUT) {
+                open = false;
+            }
+
+            if (open) {
+                if (kept != i) {
+                    clients_[kept] = std::move(client);
+                }
+                kept++;
+            } else {
+                close(client.socket);
+            }
+        }
+        clients_.resize(kept);
+
+        if (fds[1].revents & POLLIN) {
+            acceptClients();
+        }
+    }
+}
+
+void MetricsEndpoint::acceptClients() {
+    while (true) {
+        int socket = accept(listenSocket_, nullptr, nullptr);
+        if (socket < 0) {
+            return;
+        }
+        if (clients_.size() >= MAX_CLIENTS || !setNonBlocking(socket)) {
+            close(socket);
+            continue;
+        }
+        Client client;
+        client.socket = socket;
+        client.opened = std::chrono::steady_clock::now();
+        clients_.push_back(std::move(client));
+    }
+}
+
+bool MetricsEndpoint::readRequest(Client& client) {
+    char buffer[2048];
+    ssize_t bytes = recv(client.socket, buffer, sizeof(buffer), 0);
+    if (bytes <= 0) {
+        return false;
+    }
+    client.request.append(buffer, static_cast<size_t>(bytes));
+
+    // Only the request line matters; wait for the end of the headers
+    size_t headersEnd = client.request.find("\r\n\r\n");
+    if (headersEnd == std::string::npos) {
+        headersEnd = client.request.find("\n\n");
+    }
+    if (headersEnd == std::string::npos) {
+        if (client.request.size() <= MAX_REQUEST_BYTES) {
+            return true;
+        }
+        client.response = httpResponse("431 Request Header Fields Too Large", "text/plain", "", false);
+        return writeResponse(client);
+    }
+
+    std::string requestLine = client.request.substr(0, client.request.find_first_of("\r\n"));
+    client.response = respond(requestLine);
+    return writeResponse(client);
+}
+
+bool MetricsEndpoint::writeResponse(Client& client) {
+    while (client.sent < client.response.size()) {
+        ssize_t bytes = send(client.socket, client.response.data() + client.sent,
+                             client.response.size() - client.sent, MSG_NOSIGNAL);
+        if (bytes < 0) {
+            return errno == EAGAIN || errno == EWOULDBLOCK;
+        }
+        client.sent += static_cast<size_t>(bytes);
+    }
+    return false;   // Connection: close
+}
+
+std::string MetricsEndpoint::respond(const std::string& requestLine) {
+    std::istringstream line(requestLine);
+    std::string method;
+    std::string target;
+    line >> method >> target;
+    target = target.substr(0, target.find('?'));
+
+    bool head = method == "HEAD";
+    if (method != "GET" && !head) {
+        return httpResponse("405 Method Not Allowed", "text/plain", "Only GET and HEAD are served\n", false);
+    }
+    if (target == "/metrics") {
+        return httpResponse("200 OK", "text/plain; version=0.0.4; charset=utf-8", render(), head);
+    }
+    if (target == "/") {
+        return httpResponse("200 OK", "text/plain", "V2X-NDN-NFV co-simulation metrics at /metrics\n", head);
+    }
+    return httpResponse("404 Not Found", "text/plain", "Not found\n", head);
+}
+
+std::string MetricsEndpoint::render() {
+    auto started = std::chrono::steady_clock::now();
+    uint64_t scrapes = scrapes_.fetch_add(1, std::memory_order_relaxed) + 1;
+
+    PrometheusWriter writer;
+    for (const auto& collector : collectors_) {
+        collector(writer);
+    }
+    writer.counter("cosim_metrics_scrapes_total", "Scrapes served by this endpoint", static_cast<double>(scrapes));
+    writer.gauge("cosim_metrics_render_seconds", "Time the previous scrape spent running the collectors",
+                 lastRenderSeconds_);
+
+    lastRenderSeconds_ = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    return writer.text();
+}
+
+} // namespace cosim
@@ -0,0 +1,106 @@
+/*
+Live metrics endpoint in the Prometheus text exposition format
+A minimal HTTP/1.1 server on its own reactor thread: one poll() loop accepts
+scrapers, reads their request, renders the page and writes it back, so scraping
+never runs on the simulation thread. The page is built by collectors that the
+simulation components register before start(); they run on the reactor thread
+and must read only atomics and lock-free histograms.
+
+Listen address: "<port>" (loopback), "<host>:<port>", or a Unix socket path
+(anything containing '/'), e.g.
+
+    curl -s localhost:9100/metrics
+    curl -s --unix-socket /tmp/cosim.sock http://cosim/metrics
+*/
+
+#ifndef METRICS_ENDPOINT_H
+#define METRICS_ENDPOINT_H
+
+#include "latency_histogram.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace cosim {
+
+// Writes one exposition page. Samples of one metric family must be written together;
+// the HELP and TYPE lines are emitted with the first sample of each family.
+class PrometheusWriter {
+public:
+    void counter(const std::string& name, const std::string& help, double value, const std::string& labels = "");
+    void gauge(const std::string& name, const std::string& help, double value, const std::string& labels = "");
+
+    // Cumulative buckets in seconds from a nanosecond LatencyHistogram, then _sum and _count
+    void histogram(const std::string& name, const std::string& help, const LatencyHistogram& histogram,
+                   const std::string& labels = "");
+
+    // key="value" with the value escaped; join several with ','
+    static std::string label(const std::string& key, const std::string& value);
+
+    const std::string& text() const { return text_; }
+
+private:
+    void family(const std::string& name, const std::string& help, const char* type);
+    void sample(const std::string& name, const std::string& labels, double value);
+
+    std::string text_;
+    std::set<std::string> families_;
+};
+
+class MetricsEndpoint {
+public:
+    using Collector = std::function<void(PrometheusWriter&)>;
+
+    MetricsEndpoint() = default;
+    ~MetricsEndpoint();
+
+    MetricsEndpoint(const MetricsEndpoint&) = delete;
+    MetricsEndpoint& operator=(const MetricsEndpoint&) = delete;
+
+    // Collectors are called in registration order; add them all before start()
+    void addCollector(Collector collector) { collectors_.push_back(std::move(collector)); }
+
+    bool start(const std::string& address);
+    void stop();
+
+    const std::string& address() const { return address_; }
+    uint64_t scrapes() const { return scrapes_.load(std::memory_order_relaxed); }
+
+private:
+    struct Client {
+        int socket = -1;
+        std::string request;
+        std::string response;
+        size_t sent = 0;
+        std::chrono::steady_clock::time_point opened;
+    };
+
+    bool listenTcp(const std::string& host, int port);
+    bool listenUnix(const std::string& path);
+    void reactorLoop();
+    void acceptClients();
+    bool readRequest(Client& client);       // False once the client is done with
+    bool writeResponse(Client& client);
+    std::string respond(const std::string& requestLine);
+    std::string render();
+
+    std::vector<Collector> collectors_;
+    std::string address_;
+    std::string unixPath_;                  // Unlinked on stop
+    int listenSocket_ = -1;
+    int wakePipe_[2] = {-1, -1};            // stop() wakes the reactor out of poll()
+    std::vector<Client> clients_;           // Reactor thread only
+    std::thread reactorThread_;
+    std::atomic<bool> running_{false};
+    std::atomic<uint64_t> scrapes_{0};
+    double lastRenderSeconds_ = 0.0;        // Reactor thread only
+};
+
+} // namespace cosim
+
+#endif // METRICS_ENDPOINT_H
@@ -0,0 +1,108 @@
+/*
+Implementation of the metrics trace writer and mapped reader
+*/
+
+#include "metrics_trace.h"
+#include <cstring>
+#include <iostream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace cosim {
+
+bool MetricsTraceWriter::open(const std::string& filename) {
+    close();
+    file_ = std::fopen(filename.c_str(), "wb");
+    if (!file_) {
+        std::cerr << "❌ Failed to open metrics trace: " << filename << std::endl;
+        return false;
+    }
+    std::setvbuf(file_, nullptr, _IOFBF, 1 << 20);
+
+    uint32_t header[2] = {metricstrace::FORMAT_VERSION, 0};
+    std::fwrite(metricstrace::FILE_MAGIC, 1, sizeof(metricstrace::FILE_MAGIC), file_);
+    std::fwrite(header, 1, sizeof(header), file_);
+    records_ = 0;
+    return true;
+}
+
+void MetricsTraceWriter::append(double leaderTime, const std::string& payload) {
+    if (!file_) return;
+
+    uint32_t length = static_cast<uint32_t>(payload.size());
+    std::fwrite(&leaderTime, 1, sizeof(leaderTime), file_);
+    std::fwrite(&length, 1, sizeof(length), file_);
+    std::fwrite(payload.data(), 1, length, file_);
+    records_++;
+}
+
+void MetricsTraceWriter::close() {
+    if (!file_) return;
+    std::fclose(file_);
+    file_ = nullptr;
+}
+
+bool MetricsTrace::open(const std::string& filename) {
+    close();
+
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        std::cerr << "❌ Failed to open metrics trace: " << filename << std::endl;
+        return false;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < sizeof(metricstrace::FILE_MAGIC) + 8) {
+        std::cerr << "❌ Not a metrics trace: " << filename << std::endl;
+        ::close(fd);
+        return false;
+    }
+
+    mappedBytes_ = static_cast<size_t>(info.st_size);
+    mapping_ = mmap(nullptr, mappedBytes_, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapping_ == MAP_FAILED) {
+        mapping_ = nullptr;
+        std::cerr << "❌ Failed to map metrics trace: " << filename << std::endl;
+        return false;
+    }
+    madvise(mapping_, mappedBytes_, MADV_SEQUENTIAL);
+
+    const char* data = static_cast<const char*>(mapping_);
+    uint32_t version = 0;
+    std::memcpy(&version, data + sizeof(metricstrace::FILE_MAGIC), sizeof(version));
+    if (std::memcmp(data, metricstrace::FILE_MAGIC, sizeof(metricstrace::FILE_MAGIC)) != 0 ||
+        version != metricstrace::FORMAT_VERSION) {
+        std::cerr << "❌ Not a metrics trace (or unsupported version): " << filename << std::endl;
+        close();
+        return false;
+    }
+
+    // A record cut short by a crash ends the trace
+    size_t offset = sizeof(metricstrace::FILE_MAGIC) + 8;
+    while (offset + sizeof(double) + sizeof(uint32_t) <= mappedBytes_) {
+        TraceRecord record;
+        std::memcpy(&record.leaderTime, data + offset, sizeof(double));
+        std::memcpy(&record.size, data + offset + sizeof(double), sizeof(uint32_t));
+        offset += sizeof(double) + sizeof(uint32_t);
+        if (offset + record.size > mappedBytes_) {
+            break;
+        }
+        record.payload = data + offset;
+        offset += record.size;
+        records_.push_back(record);
+    }
+    return true;
+}
+
+void MetricsTrace::close() {
+    if (mapping_) {
+        munmap(mapping_, mappedBytes_);
+        mapping_ = nullptr;
+    }
+    mappedBytes_ = 0;
+    records_.clear();
+}
+
+} // namespace cosim
@@ -0,0 +1,81 @@
+/*
+Recorded trace of the follower's metrics reports
+The leader appends every NDN metrics report it ingests, verbatim, together with
+its own simulation time, so a run can be replayed offline through any number of
+NFV policies. The reader maps the file read-only and indexes the records in
+place; the mapping is immutable, so any number of threads can share one reader.
+
+File layout (little-endian):
+  header : "CSMTRACE" | uint32 version | uint32 reserved
+  record : double leaderTime | uint32 length | char payload[length]
+*/
+
+#ifndef METRICS_TRACE_H
+#define METRICS_TRACE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace cosim {
+
+namespace metricstrace {
+
+constexpr char FILE_MAGIC[8] = {'C', 'S', 'M', 'T', 'R', 'A', 'C', 'E'};
+constexpr uint32_t FORMAT_VERSION = 1;
+
+} // namespace metricstrace
+
+class MetricsTraceWriter {
+public:
+    MetricsTraceWriter() = default;
+    ~MetricsTraceWriter() { close(); }
+
+    MetricsTraceWriter(const MetricsTraceWriter&) = delete;
+    MetricsTraceWriter& operator=(const MetricsTraceWriter&) = delete;
+
+    bool open(const std::string& filename);
+    bool isOpen() const { return file_ != nullptr; }
+    void append(double leaderTime, const std::string& payload);
+    void close();
+
+    uint64_t records() const { return records_; }
+
+private:
+    std::FILE* file_ = nullptr;
+    uint64_t records_ = 0;
+};
+
+struct TraceRecord {
+    double leaderTime;
+    const char* payload;    // Points into the mapping; not NUL-terminated
+    uint32_t size;
+};
+
+class MetricsTrace {
+public:
+    MetricsTrace() = default;
+    ~MetricsTrace() { close(); }
+
+    MetricsTrace(const MetricsTrace&) = delete;
+    MetricsTrace& operator=(const MetricsTrace&) = delete;
+
+    bool open(const std::string& filename);
+    void close();
+
+    size_t size() const { return records_.size(); }
+    const TraceRecord& operator[](size_t i) const { return records_[i]; }
+    const std::vector<TraceRecord>& records() const { return records_; }
+    double duration() const { return records_.empty() ? 0.0 : records_.back().leaderTime - records_.front().leaderTime; }
+
+private:
+    void* mapping_ = nullptr;
+    size_t mappedBytes_ = 0;
+    std::vector<TraceRecord> records_;
+};
+
+} // namespace cosim
+
+#endif // METRICS_TRACE_H
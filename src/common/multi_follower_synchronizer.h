@@ -0,0 +1,120 @@
+/*
+Multi-Follower Synchronizer for partitioned ndnSIM co-simulation
+Successor to LeaderFollowerSynchronizer when the network is split across several
+ndnSIM processes, one per region. Followers advance in conservative windows whose
+length is the lookahead, i.e. the smallest delay of any cross-partition link, so a
+packet sent inside a window can never arrive before the window ends. Proxied
+packets are relayed to their peer partition at each window barrier.
+*/
+
+#ifndef MULTI_FOLLOWER_SYNCHRONIZER_H
+#define MULTI_FOLLOWER_SYNCHRONIZER_H
+
+#include "synchronizer.h"
+#include "config.h"
+#include "latency_histogram.h"
+#include "partition_protocol.h"
+#include <jsoncpp/json/json.h>
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace cosim {
+
+class PrometheusWriter;
+
+class MultiFollowerSynchronizer {
+public:
+    MultiFollowerSynchronizer(const Config& config, int port, uint32_t partitions);
+    ~MultiFollowerSynchronizer();
+
+    // Setup
+    void setLeader(SimulatorInterface* leader);
+    void setConnectTimeout(double seconds) { connectTimeoutSeconds_ = seconds; }
+
+    // Control
+    bool initialize();
+    bool run();
+    void stop();
+
+    // Status
+    double getCurrentTime() const { return currentTime_.load(); }
+    bool isRunning() const { return running_.load(); }
+    double getLookahead() const { return lookaheadNs_ * 1e-9; }
+
+    // Performance monitoring
+    void printPerformanceSummary() const;
+    void exportPerformanceData(const std::string& filename) const;
+    void writePrometheus(PrometheusWriter& out) const;     // Safe from any thread
+
+private:
+    struct Partition {
+        int socket = -1;
+        std::string readBuffer;
+        std::vector<partition::LinkInfo> links;
+        Json::Value outbox{Json::arrayValue};  // Packets to deliver with the next grant
+        bool done = false;
+        uint64_t packetsSent = 0;
+        uint64_t packetsReceived = 0;
+        double busySeconds = 0.0;        // Wall time between grant and WINDOW_DONE, summed
+    };
+
+    // Setup helpers
+    bool acceptPartitions();
+    bool readHello(int socket);
+    bool buildLinkTable();
+
+    // Conservative window loop
+    bool executeWindow(int64_t untilNs);
+    bool collectDone(int64_t untilNs);
+    void routePackets(uint32_t fromPartition, const Json::Value& packets, int64_t untilNs);
+
+    // Line-delimited JSON over TCP
+    bool sendJson(int socket, const Json::Value& message);
+    bool receiveData(Partition& partition);
+    bool nextLine(Partition& partition, std::string& line);
+    bool parseLine(const std::string& line, Json::Value& message);
+    void closeSockets();
+
+    static constexpr int WINDOW_TIMEOUT_MS = 30000;
+
+    Config config_;
+    int port_;
+    uint32_t partitionCount_;
+    double connectTimeoutSeconds_;
+
+    SimulatorInterface* leader_;
+    int serverSocket_;
+    std::vector<Partition> partitions_;
+
+    // linkId -> (partition a, partition b) and its delay
+    std::map<uint32_t, std::pair<uint32_t, uint32_t>> linkEnds_;
+    std::map<uint32_t, int64_t> linkDelays_;
+    int64_t lookaheadNs_;
+    int64_t currentTimeNs_;
+
+    std::atomic<double> currentTime_;
+    std::atomic<bool> running_;
+    std::atomic<bool> initialized_;
+
+    struct SyncPerformanceMetrics {
+        std::atomic<uint64_t> totalSteps{0};
+        std::atomic<uint64_t> windows{0};
+        std::atomic<uint64_t> proxiedPackets{0};
+        std::atomic<uint64_t> proxiedBytes{0};
+        std::atomic<uint64_t> failedWindows{0};
+        LatencyHistogram windowDuration;
+        std::chrono::steady_clock::time_point startTime;
+        std::chrono::steady_clock::time_point endTime;
+    } performanceMetrics_;
+
+    mutable std::mutex metricsMutex_;
+};
+
+} // namespace cosim
+
+#endif // MULTI_FOLLOWER_SYNCHRONIZER_H
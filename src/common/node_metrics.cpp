@@ -0,0 +1,301 @@
+/*
+Implementation of the per-node NDN metrics matrix
+*/
+
+#include "node_metrics.h"
+#include <algorithm>
+#include <cmath>
+#include <jsoncpp/json/json.h>
+
+namespace cosim {
+
+// =============================================================================
+// LatencySketch
+// =============================================================================
+
+void LatencySketch::record(double latencySeconds) {
+    double ms = std::max(0.0, latencySeconds * 1000.0);
+    size_t bucket = 0;
+    if (ms >= 1.0) {
+        bucket = std::min(BUCKETS - 1, static_cast<size_t>(std::log2(ms)) + 1);
+    }
+    buckets[bucket]++;
+    count++;
+    sumMs += ms;
+}
+
+void LatencySketch::merge(const LatencySketch& other) {
+    for (size_t i = 0; i < BUCKETS; ++i) {
+        buckets[i] += other.buckets[i];
+    }
+    count += other.count;
+    sumMs += other.sumMs;
+}
+
+void LatencySketch::clear() {
+    buckets.fill(0);
+    count = 0;
+    sumMs = 0.0;
+}
+
+double LatencySketch::quantile(double q) const {
+    if (count == 0) return 0.0;
+
+    uint64_t rank = static_cast<uint64_t>(std::ceil(q * count));
+    uint64_t seen = 0;
+    for (size_t i = 0; i < BUCKETS; ++i) {
+        seen += buckets[i];
+        if (seen >= rank && buckets[i] > 0) {
+            return std::ldexp(1.0, static_cast<int>(i)) / 1000.0;
+        }
+    }
+    return std::ldexp(1.0, static_cast<int>(BUCKETS - 1)) / 1000.0;
+}
+
+// =============================================================================
+// NodeMetricsMatrix - follower side
+// =============================================================================
+
+NodeMetricsRow* NodeMetricsMatrix::touch(uint32_t nodeId) {
+    if (nodeId >= maxNodes_) {
+        return nullptr;
+    }
+    if (nodeId >= rows_.size()) {
+        rows_.resize(nodeId + 1);
+        lastSent_.resize(nodeId + 1);
+        dirtyFlags_.resize(nodeId + 1, 0);
+    }
+
+    NodeMetricsRow& row = rows_[nodeId];
+    if (!row.present) {
+        row.present = true;
+        row.nodeId = nodeId;
+        activeCount_++;
+    }
+
+    if (!dirtyFlags_[nodeId]) {
+        dirtyFlags_[nodeId] = 1;
+        dirty_.push_back(nodeId);
+    }
+    return &row;
+}
+
+void NodeMetricsMatrix::recordInterest(uint32_t nodeId) {
+    NodeMetricsRow* row = touch(nodeId);
+    if (!row) return;
+    row->interests++;
+    row->pitSize++;
+}
+
+void NodeMetricsMatrix::recordData(uint32_t nodeId, double latencySeconds) {
+    NodeMetricsRow* row = touch(nodeId);
+    if (!row) return;
+    row->dataPackets++;
+    if (row->pitSize > 0) {
+        row->pitSize--;
+    }
+    if (latencySeconds >= 0.0) {
+        row->latency.record(latencySeconds);
+    }
+}
+
+void NodeMetricsMatrix::recordTimeout(uint32_t nodeId) {
+    NodeMetricsRow* row = touch(nodeId);
+    if (!row) return;
+    row->timeouts++;
+    if (row->pitSize > 0) {
+        row->pitSize--;
+    }
+}
+
+void NodeMetricsMatrix::recordCacheHit(uint32_t nodeId) {
+    if (NodeMetricsRow* row = touch(nodeId)) {
+        row->csHits++;
+    }
+}
+
+void NodeMetricsMatrix::recordCacheMiss(uint32_t nodeId) {
+    if (NodeMetricsRow* row = touch(nodeId)) {
+        row->csMisses++;
+    }
+}
+
+void NodeMetricsMatrix::setPitSize(uint32_t nodeId, uint32_t pitSize) {
+    if (NodeMetricsRow* row = touch(nodeId)) {
+        row->pitSize = pitSize;
+    }
+}
+
+void NodeMetricsMatrix::addCounts(uint32_t nodeId, uint64_t interests, uint64_t dataPackets, uint64_t timeouts) {
+    NodeMetricsRow* row = touch(nodeId);
+    if (!row) return;
+    row->interests += interests;
+    row->dataPackets += dataPackets;
+    row->timeouts += timeouts;
+
+    uint64_t resolved = dataPackets + timeouts;
+    uint64_t pit = row->pitSize + interests;
+    row->pitSize = static_cast<uint32_t>(pit > resolved ? pit - resolved : 0);
+}
+
+void NodeMetricsMatrix::recordLatency(uint32_t nodeId, double latencySeconds) {
+    if (latencySeconds < 0.0) return;
+    if (NodeMetricsRow* row = touch(nodeId)) {
+        row->latency.record(latencySeconds);
+    }
+}
+
+void NodeMetricsMatrix::encodeDelta(double stepDuration, Json::Value& out) {
+    out = Json::Value(Json::arrayValue);
+
+    std::vector<uint32_t> candidates;
+    candidates.swap(dirty_);
+
+    for (uint32_t nodeId : candidates) {
+        dirtyFlags_[nodeId] = 0;
+        NodeMetricsRow& row = rows_[nodeId];
+        NodeMetricsRow& sent = lastSent_[nodeId];
+
+        row.interestRate = (stepDuration > 0.0)
+            ? static_cast<double>(row.interests - sent.interests) / stepDuration : 0.0;
+
+        uint32_t mask = 0;
+        if (!sent.present || row.pitSize != sent.pitSize) mask |= FIELD_PIT;
+        if (row.csHits != sent.csHits) mask |= FIELD_CS_HITS;
+        if (row.csMisses != sent.csMisses) mask |= FIELD_CS_MISSES;
+        if (row.interests != sent.interests) mask |= FIELD_INTERESTS;
+        if (row.dataPackets != sent.dataPackets) mask |= FIELD_DATA;
+        if (row.timeouts != sent.timeouts) mask |= FIELD_TIMEOUTS;
+        if (row.interestRate != sent.interestRate) mask |= FIELD_RATE;
+        if (!row.latency.empty() || !sent.latency.empty()) mask |= FIELD_LATENCY;
+
+        if (mask != 0) {
+            Json::Value entry(Json::arrayValue);
+            entry.append(nodeId);
+            entry.append(mask);
+            if (mask & FIELD_PIT) entry.append(row.pitSize);
+            if (mask & FIELD_CS_HITS) entry.append(static_cast<Json::UInt64>(row.csHits));
+            if (mask & FIELD_CS_MISSES) entry.append(static_cast<Json::UInt64>(row.csMisses));
+            if (mask & FIELD_INTERESTS) entry.append(static_cast<Json::UInt64>(row.interests));
+            if (mask & FIELD_DATA) entry.append(static_cast<Json::UInt64>(row.dataPackets));
+            if (mask & FIELD_TIMEOUTS) entry.append(static_cast<Json::UInt64>(row.timeouts));
+            if (mask & FIELD_RATE) entry.append(row.interestRate);
+            if (mask & FIELD_LATENCY) {
+                // Latency window as [count, sumMs, bucket, n, bucket, n, ...] with empty buckets omitted
+                Json::Value sketch(Json::arrayValue);
+                sketch.append(row.latency.count);
+                sketch.append(row.latency.sumMs);
+                for (size_t i = 0; i < LatencySketch::BUCKETS; ++i) {
+                    if (row.latency.buckets[i] > 0) {
+                        sketch.append(static_cast<Json::UInt>(i));
+                        sketch.append(row.latency.buckets[i]);
+                    }
+                }
+                entry.append(sketch);
+            }
+            out.append(entry);
+        }
+
+        sent = row;
+        row.latency.clear();
+
+        // A non-zero rate or latency window must be re-sent as zero once traffic stops
+        if (sent.interestRate != 0.0 || !sent.latency.empty()) {
+            dirtyFlags_[nodeId] = 1;
+            dirty_.push_back(nodeId);
+        }
+    }
+}
+
+// =============================================================================
+// NodeMetricsMatrix - leader side
+// =============================================================================
+
+void NodeMetricsMatrix::applyDelta(const Json::Value& delta) {
+    if (!delta.isArray()) return;
+
+    for (const auto& entry : delta) {
+        if (!entry.isArray() || entry.size() < 2 || !entry[0].isUInt() || !entry[1].isUInt()) continue;
+
+        // Ids come off the wire; one bogus id must not size the matrix
+        uint32_t nodeId = entry[0].asUInt();
+        uint32_t mask = entry[1].asUInt();
+        if (nodeId >= maxNodes_) continue;
+        Json::ArrayIndex k = 2;
+
+        if (nodeId >= rows_.size()) {
+            rows_.resize(nodeId + 1);
+        }
+        NodeMetricsRow& row = rows_[nodeId];
+        if (!row.present) {
+            row.present = true;
+            row.nodeId = nodeId;
+            activeCount_++;
+        }
+
+        if ((mask & FIELD_PIT) && k < entry.size()) row.pitSize = entry[k++].asUInt();
+        if ((mask & FIELD_CS_HITS) && k < entry.size()) row.csHits = entry[k++].asUInt64();
+        if ((mask & FIELD_CS_MISSES) && k < entry.size()) row.csMisses = entry[k++].asUInt64();
+        if ((mask & FIELD_INTERESTS) && k < entry.size()) row.interests = entry[k++].asUInt64();
+        if ((mask & FIELD_DATA) && k < entry.size()) row.dataPackets = entry[k++].asUInt64();
+        if ((mask & FIELD_TIMEOUTS) && k < entry.size()) row.timeouts = entry[k++].asUInt64();
+        if ((mask & FIELD_RATE) && k < entry.size()) row.interestRate = entry[k++].asDouble();
+        if ((mask & FIELD_LATENCY) && k < entry.size()) {
+            const Json::Value& sketch = entry[k++];
+            row.latency.clear();
+            if (sketch.isArray() && sketch.size() >= 2) {
+                row.latency.count = sketch[0].asUInt();
+                row.latency.sumMs = sketch[1].asDouble();
+                for (Json::ArrayIndex i = 2; i + 1 < sketch.size(); i += 2) {
+                    uint32_t bucket = sketch[i].asUInt();
+                    if (bucket < LatencySketch::BUCKETS) {
+                        row.latency.buckets[bucket] = sketch[i + 1].asUInt();
+                    }
+                }
+            }
+        }
+    }
+}
+
+// =============================================================================
+// Queries
+// =============================================================================
+
+const NodeMetricsRow* NodeMetricsMatrix::row(uint32_t nodeId) const {
+    if (nodeId >= rows_.size() || !rows_[nodeId].present) return nullptr;
+    return &rows_[nodeId];
+}
+
+const NodeMetricsRow* NodeMetricsMatrix::maxPitNode() const {
+    const NodeMetricsRow* best = nullptr;
+    for (const auto& row : rows_) {
+        if (row.present && (!best || row.pitSize > best->pitSize)) {
+            best = &row;
+        }
+    }
+    return best;
+}
+
+const NodeMetricsRow* NodeMetricsMatrix::maxLatencyNode() const {
+    const NodeMetricsRow* best = nullptr;
+    for (const auto& row : rows_) {
+        if (row.present && !row.latency.empty() &&
+            (!best || row.latency.mean() > best->latency.mean())) {
+            best = &row;
+        }
+    }
+    return best;
+}
+
+const NodeMetricsRow* NodeMetricsMatrix::minCacheHitNode() const {
+    const NodeMetricsRow* best = nullptr;
+    for (const auto& row : rows_) {
+        if (row.present && (row.csHits + row.csMisses) > 0 &&
+            (!best || row.cacheHitRatio() < best->cacheHitRatio())) {
+            best = &row;
+        }
+    }
+    return best;
+}
+
+} // namespace cosim
@@ -0,0 +1,122 @@
+/*
+Per-node NDN metrics matrix for the co-simulation follower
+Keeps one row of PIT, Content Store, rate and latency statistics per ndnSIM node
+and encodes only the rows that changed since the previous sync step
+*/
+
+#ifndef NODE_METRICS_H
+#define NODE_METRICS_H
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Json {
+class Value;
+}
+
+namespace cosim {
+
+// Fixed-size log2 latency histogram (bucket 0 < 1ms, bucket i covers [2^(i-1), 2^i) ms)
+struct LatencySketch {
+    static constexpr size_t BUCKETS = 12;
+
+    std::array<uint32_t, BUCKETS> buckets{};
+    uint32_t count = 0;
+    double sumMs = 0.0;
+
+    void record(double latencySeconds);
+    void merge(const LatencySketch& other);
+    void clear();
+    bool empty() const { return count == 0; }
+    double mean() const { return count > 0 ? (sumMs / count) / 1000.0 : 0.0; }
+    double quantile(double q) const; // seconds, upper bucket bound
+};
+
+// One row of the matrix, indexed densely by ndnSIM node id
+struct NodeMetricsRow {
+    uint32_t nodeId = 0;
+    uint32_t pitSize = 0;
+    uint64_t csHits = 0;
+    uint64_t csMisses = 0;
+    uint64_t interests = 0;
+    uint64_t dataPackets = 0;
+    uint64_t timeouts = 0;
+    double interestRate = 0.0;   // Interests per second over the last step
+    LatencySketch latency;       // Latency window since the last step
+    bool present = false;
+
+    double cacheHitRatio() const {
+        uint64_t lookups = csHits + csMisses;
+        return lookups > 0 ? static_cast<double>(csHits) / lookups : 0.0;
+    }
+};
+
+class NodeMetricsMatrix {
+public:
+    // Field mask bits used by the sparse delta encoding
+    enum Field : uint32_t {
+        FIELD_PIT = 1u << 0,
+        FIELD_CS_HITS = 1u << 1,
+        FIELD_CS_MISSES = 1u << 2,
+        FIELD_INTERESTS = 1u << 3,
+        FIELD_DATA = 1u << 4,
+        FIELD_TIMEOUTS = 1u << 5,
+        FIELD_RATE = 1u << 6,
+        FIELD_LATENCY = 1u << 7
+    };
+
+    // Node ids are dense in ndnSIM; anything at or above the bound is ignored
+    static constexpr uint32_t DEFAULT_MAX_NODES = 65536;
+
+    NodeMetricsMatrix() = default;
+
+    void setMaxNodes(uint32_t maxNodes) { maxNodes_ = maxNodes; }
+    uint32_t maxNodes() const { return maxNodes_; }
+
+    // Follower-side updates
+    void recordInterest(uint32_t nodeId);
+    void recordData(uint32_t nodeId, double latencySeconds);
+    void recordTimeout(uint32_t nodeId);
+    void recordCacheHit(uint32_t nodeId);
+    void recordCacheMiss(uint32_t nodeId);
+    void setPitSize(uint32_t nodeId, uint32_t pitSize);
+    
+    // Exact per-interval counts from a sampled export, and latency from sampled records
+    void addCounts(uint32_t nodeId, uint64_t interests, uint64_t dataPackets, uint64_t timeouts);
+    void recordLatency(uint32_t nodeId, double latencySeconds);
+
+    // Encode rows changed since the last call as [nodeId, mask, values...] arrays.
+    // Closes the current step: rates are computed over stepDuration and latency windows reset.
+    void encodeDelta(double stepDuration, Json::Value& out);
+
+    // Leader-side application of a delta produced by encodeDelta()
+    void applyDelta(const Json::Value& delta);
+
+    // Queries
+    size_t size() const { return rows_.size(); }
+    size_t activeNodes() const { return activeCount_; }
+    const NodeMetricsRow* row(uint32_t nodeId) const;
+    const std::vector<NodeMetricsRow>& rows() const { return rows_; }
+
+    const NodeMetricsRow* maxPitNode() const;
+    const NodeMetricsRow* maxLatencyNode() const;
+    const NodeMetricsRow* minCacheHitNode() const;
+
+    static std::string locationName(uint32_t nodeId) { return "RSU_" + std::to_string(nodeId); }
+
+private:
+    NodeMetricsRow* touch(uint32_t nodeId);     // Null for ids beyond maxNodes_
+
+    std::vector<NodeMetricsRow> rows_;
+    std::vector<NodeMetricsRow> lastSent_;   // Follower: values as of the last encoded delta
+    std::vector<uint32_t> dirty_;            // Follower: rows touched since last encode
+    std::vector<uint8_t> dirtyFlags_;
+    size_t activeCount_ = 0;
+    uint32_t maxNodes_ = DEFAULT_MAX_NODES;
+};
+
+} // namespace cosim
+
+#endif // NODE_METRICS_H
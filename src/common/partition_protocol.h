@@ -0,0 +1,96 @@
+/*
+Wire protocol between the platform and partitioned ndnSIM followers
+Each follower simulates one region; links that cross a region boundary are
+replaced by proxy faces whose packets are relayed by the platform at window
+barriers. Messages are single-line JSON objects terminated by '\n'.
+
+  follower -> platform  PARTITION_HELLO  {partition, links: [{link, peer, delay_ns}]}
+  platform -> follower  WINDOW_GRANT     {until_ns, packets: [{link, t_ns, wire}]}
+  follower -> platform  WINDOW_DONE      {now_ns, packets: [{link, t_ns, wire}]}
+  platform -> follower  PARTITION_END    {}
+
+Times are integer nanoseconds so arrival stamps compare exactly on both sides.
+Packet wire encodings are base64 and are never decoded by the platform.
+
+Header-only because ns-3 scratch scripts include it directly
+*/
+
+#ifndef PARTITION_PROTOCOL_H
+#define PARTITION_PROTOCOL_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace cosim {
+
+namespace partition {
+
+constexpr const char* MSG_HELLO = "PARTITION_HELLO";
+constexpr const char* MSG_GRANT = "WINDOW_GRANT";
+constexpr const char* MSG_DONE = "WINDOW_DONE";
+constexpr const char* MSG_END = "PARTITION_END";
+
+// One cross-partition link as announced by either of its endpoints
+struct LinkInfo {
+    uint32_t linkId = 0;
+    uint32_t peerPartition = 0;
+    int64_t delayNs = 0;
+};
+
+inline std::string base64Encode(const uint8_t* data, size_t size) {
+    static const char table[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+    std::string out;
+    out.reserve(((size + 2) / 3) * 4);
+    size_t i = 0;
+    for (; i + 2 < size; i += 3) {
+        uint32_t v = (data[i] << 16) | (data[i + 1] << 8) | data[i + 2];
+        out.push_back(table[(v >> 18) & 0x3F]);
+        out.push_back(table[(v >> 12) & 0x3F]);
+        out.push_back(table[(v >> 6) & 0x3F]);
+        out.push_back(table[v & 0x3F]);
+    }
+    if (i < size) {
+        uint32_t v = data[i] << 16;
+        if (i + 1 < size) v |= data[i + 1] << 8;
+        out.push_back(table[(v >> 18) & 0x3F]);
+        out.push_back(table[(v >> 12) & 0x3F]);
+        out.push_back(i + 1 < size ? table[(v >> 6) & 0x3F] : '=');
+        out.push_back('=');
+    }
+    return out;
+}
+
+// Returns false on characters outside the base64 alphabet
+inline bool base64Decode(const std::string& text, std::vector<uint8_t>& out) {
+    out.clear();
+    out.reserve((text.size() / 4) * 3);
+
+    uint32_t acc = 0;
+    int bits = 0;
+    for (char c : text) {
+        int v;
+        if (c >= 'A' && c <= 'Z') v = c - 'A';
+        else if (c >= 'a' && c <= 'z') v = c - 'a' + 26;
+        else if (c >= '0' && c <= '9') v = c - '0' + 52;
+        else if (c == '+') v = 62;
+        else if (c == '/') v = 63;
+        else if (c == '=') break;
+        else return false;
+
+        acc = (acc << 6) | static_cast<uint32_t>(v);
+        bits += 6;
+        if (bits >= 8) {
+            bits -= 8;
+            out.push_back(static_cast<uint8_t>((acc >> bits) & 0xFF));
+        }
+    }
+    return true;
+}
+
+} // namespace partition
+
+} // namespace cosim
+
+#endif // PARTITION_PROTOCOL_H
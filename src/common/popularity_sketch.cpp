@@ -0,0 +1,357 @@
+/*
+Implementation of the NDN name popularity sketches
+*/
+
+#include "popularity_sketch.h"
+#include <algorithm>
+#include <cmath>
+#include <jsoncpp/json/json.h>
+
+namespace cosim {
+
+uint64_t hashName(const char* data, size_t size) {
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= static_cast<uint8_t>(data[i]);
+        hash *= 0x100000001b3ull;
+    }
+    // FNV-1a mixes the low bits poorly; finish with the splitmix64 finalizer
+    hash ^= hash >> 30;
+    hash *= 0xbf58476d1ce4e5b9ull;
+    hash ^= hash >> 27;
+    hash *= 0x94d049bb133111ebull;
+    hash ^= hash >> 31;
+    return hash;
+}
+
+size_t namePrefixLength(const std::string& name, size_t depth) {
+    size_t components = 0;
+    for (size_t i = 1; i < name.size(); ++i) {
+        if (name[i] == '/' && ++components == depth) {
+            return i;
+        }
+    }
+    return name.size();
+}
+
+// =============================================================================
+// CountMinSketch
+// =============================================================================
+
+size_t CountMinSketch::column(uint64_t hash, size_t row) {
+    // Kirsch-Mitzenmacher: row hashes derived from the two halves of one 64-bit hash
+    uint64_t h1 = hash & 0xffffffffull;
+    uint64_t h2 = (hash >> 32) | 1;
+    return row * WIDTH + ((h1 + row * h2) & (WIDTH - 1));
+}
+
+void CountMinSketch::add(uint64_t hash, uint32_t count) {
+    for (size_t row = 0; row < DEPTH; ++row) {
+        cells_[column(hash, row)] += count;
+    }
+}
+
+uint64_t CountMinSketch::estimate(uint64_t hash) const {
+    uint32_t best = cells_[column(hash, 0)];
+    for (size_t row = 1; row < DEPTH; ++row) {
+        best = std::min(best, cells_[column(hash, row)]);
+    }
+    return best;
+}
+
+void CountMinSketch::merge(const CountMinSketch& other) {
+    for (size_t i = 0; i < cells_.size(); ++i) {
+        cells_[i] += other.cells_[i];
+    }
+}
+
+void CountMinSketch::halve() {
+    for (auto& cell : cells_) {
+        cell >>= 1;
+    }
+}
+
+void CountMinSketch::clear() {
+    cells_.fill(0);
+}
+
+void CountMinSketch::encode(Json::Value& out) const {
+    out = Json::Value(Json::arrayValue);
+    for (size_t i = 0; i < cells_.size(); ++i) {
+        if (cells_[i] > 0) {
+            out.append(static_cast<Json::UInt>(i));
+            out.append(cells_[i]);
+        }
+    }
+}
+
+void CountMinSketch::decode(const Json::Value& in) {
+    clear();
+    if (!in.isArray()) return;
+    for (Json::ArrayIndex i = 0; i + 1 < in.size(); i += 2) {
+        uint32_t cell = in[i].asUInt();
+        if (cell < cells_.size()) {
+            cells_[cell] = in[i + 1].asUInt();
+        }
+    }
+}
+
+// =============================================================================
+// HyperLogLog
+// =============================================================================
+
+void HyperLogLog::add(uint64_t hash) {
+    size_t index = hash >> (64 - PRECISION);
+    uint64_t rest = hash << PRECISION;
+    uint8_t rank = rest == 0 ? static_cast<uint8_t>(64 - PRECISION + 1)
+                             : static_cast<uint8_t>(__builtin_clzll(rest) + 1);
+    registers_[index] = std::max(registers_[index], rank);
+}
+
+double HyperLogLog::estimate() const {
+    const double m = static_cast<double>(REGISTERS);
+    double sum = 0.0;
+    size_t zeros = 0;
+    for (uint8_t rank : registers_) {
+        sum += std::ldexp(1.0, -rank);
+        if (rank == 0) zeros++;
+    }
+
+    double alpha = 0.7213 / (1.0 + 1.079 / m);
+    double raw = alpha * m * m / sum;
+
+    // Linear counting is more accurate while many registers are still empty
+    if (raw <= 2.5 * m && zeros > 0) {
+        return m * std::log(m / static_cast<double>(zeros));
+    }
+    return raw;
+}
+
+void HyperLogLog::merge(const HyperLogLog& other) {
+    for (size_t i = 0; i < REGISTERS; ++i) {
+        registers_[i] = std::max(registers_[i], other.registers_[i]);
+    }
+}
+
+void HyperLogLog::encode(Json::Value& out) const {
+    out = Json::Value(Json::arrayValue);
+    for (size_t i = 0; i < REGISTERS; ++i) {
+        if (registers_[i] > 0) {
+            out.append(static_cast<Json::UInt>(i));
+            out.append(registers_[i]);
+        }
+    }
+}
+
+void HyperLogLog::decode(const Json::Value& in) {
+    clear();
+    if (!in.isArray()) return;
+    for (Json::ArrayIndex i = 0; i + 1 < in.size(); i += 2) {
+        uint32_t index = in[i].asUInt();
+        if (index < REGISTERS) {
+            registers_[index] = static_cast<uint8_t>(std::min(64u, in[i + 1].asUInt()));
+        }
+    }
+}
+
+// =============================================================================
+// TopKSummary
+// =============================================================================
+
+uint64_t TopKSummary::minCount() const {
+    if (entries_.size() < CAPACITY) return 0;
+    uint64_t smallest = entries_[0].count;
+    for (const auto& entry : entries_) {
+        smallest = std::min(smallest, entry.count);
+    }
+    return smallest;
+}
+
+void TopKSummary::add(uint64_t hash, const char* prefix, size_t prefixLength, uint64_t count) {
+    for (auto& entry : entries_) {
+        if (entry.hash == hash) {
+            entry.count += count;
+            return;
+        }
+    }
+
+    if (entries_.size() < CAPACITY) {
+        entries_.push_back({hash, std::string(prefix, prefixLength), count, 0});
+        return;
+    }
+
+    // Evict the smallest counter; the newcomer inherits its count as error bound
+    auto victim = std::min_element(entries_.begin(), entries_.end(),
+        [](const HeavyHitter& a, const HeavyHitter& b) { return a.count < b.count; });
+    victim->hash = hash;
+    victim->prefix.assign(prefix, prefixLength);
+    victim->error = victim->count;
+    victim->count += count;
+}
+
+// Mergeable summaries (Agarwal et al.): a key missing from a full summary may have
+// occurred up to that summary's minimum count, so it is credited as error
+void TopKSummary::merge(const TopKSummary& other) {
+    uint64_t ownMin = minCount();
+    uint64_t otherMin = other.minCount();
+
+    std::vector<HeavyHitter> merged = entries_;
+    for (auto& entry : merged) {
+        entry.count += otherMin;
+        entry.error += otherMin;
+    }
+    for (const auto& theirs : other.entries_) {
+        auto it = std::find_if(merged.begin(), merged.end(),
+            [&](const HeavyHitter& e) { return e.hash == theirs.hash; });
+        if (it != merged.end()) {
+            it->count += theirs.count - otherMin;
+            it->error += theirs.error - otherMin;
+        } else {
+            HeavyHitter entry = theirs;
+            entry.count += ownMin;
+            entry.error += ownMin;
+            merged.push_back(std::move(entry));
+        }
+    }
+
+    if (merged.size() > CAPACITY) {
+        std::nth_element(merged.begin(), merged.begin() + CAPACITY, merged.end(),
+            [](const HeavyHitter& a, const HeavyHitter& b) { return a.count > b.count; });
+        merged.resize(CAPACITY);
+    }
+    entries_.swap(merged);
+}
+
+void TopKSummary::halve() {
+    for (auto& entry : entries_) {
+        entry.count >>= 1;
+        entry.error >>= 1;
+    }
+    entries_.erase(std::remove_if(entries_.begin(), entries_.end(),
+        [](const HeavyHitter& e) { return e.count == 0; }), entries_.end());
+}
+
+std::vector<HeavyHitter> TopKSummary::sorted() const {
+    std::vector<HeavyHitter> result = entries_;
+    std::sort(result.begin(), result.end(),
+        [](const HeavyHitter& a, const HeavyHitter& b) { return a.count > b.count; });
+    return result;
+}
+
+void TopKSummary::encode(Json::Value& out) const {
+    out = Json::Value(Json::arrayValue);
+    for (const auto& entry : entries_) {
+        Json::Value item(Json::arrayValue);
+        item.append(entry.prefix);
+        item.append(static_cast<Json::UInt64>(entry.count));
+        item.append(static_cast<Json::UInt64>(entry.error));
+        out.append(item);
+    }
+}
+
+void TopKSummary::decode(const Json::Value& in) {
+    clear();
+    if (!in.isArray()) return;
+    for (const auto& item : in) {
+        if (!item.isArray() || item.size() < 3 || entries_.size() >= CAPACITY) continue;
+        HeavyHitter entry;
+        entry.prefix = item[0].asString();
+        entry.hash = hashName(entry.prefix.data(), entry.prefix.size());
+        entry.count = item[1].asUInt64();
+        entry.error = item[2].asUInt64();
+        entries_.push_back(std::move(entry));
+    }
+}
+
+// =============================================================================
+// PopularitySketch
+// =============================================================================
+
+void PopularitySketch::record(const std::string& name, uint32_t weight) {
+    if (weight == 0) return;
+
+    size_t prefixLength = namePrefixLength(name, prefixDepth_);
+    uint64_t prefixHash = hashName(name.data(), prefixLength);
+
+    counts_.add(prefixHash, weight);
+    topK_.add(prefixHash, name.data(), prefixLength, weight);
+    distinct_.add(hashName(name.data(), name.size()));
+    total_ += weight;
+}
+
+void PopularitySketch::merge(const PopularitySketch& other) {
+    counts_.merge(other.counts_);
+    topK_.merge(other.topK_);
+    distinct_.merge(other.distinct_);
+    total_ += other.total_;
+}
+
+void PopularitySketch::mergeReport(const Json::Value& report) {
+    if (!report.isObject()) return;
+
+    // Reports from a build with different dimensions cannot be merged cell by cell
+    const Json::Value& dims = report["dims"];
+    if (!dims.isArray() || dims.size() != 3 ||
+        dims[0].asUInt() != CountMinSketch::DEPTH || dims[1].asUInt() != CountMinSketch::WIDTH ||
+        dims[2].asUInt() != HyperLogLog::PRECISION) {
+        return;
+    }
+
+    counts_.halve();
+    topK_.halve();
+    total_ >>= 1;
+    distinct_.clear();
+
+    PopularitySketch window(prefixDepth_);
+    window.total_ = report.get("total", 0).asUInt64();
+    window.counts_.decode(report["cms"]);
+    window.topK_.decode(report["top"]);
+    window.distinct_.decode(report["hll"]);
+    merge(window);
+}
+
+void PopularitySketch::clear() {
+    counts_.clear();
+    topK_.clear();
+    distinct_.clear();
+    total_ = 0;
+}
+
+void PopularitySketch::encode(Json::Value& out) const {
+    out = Json::Value(Json::objectValue);
+    out["dims"].append(static_cast<Json::UInt>(CountMinSketch::DEPTH));
+    out["dims"].append(static_cast<Json::UInt>(CountMinSketch::WIDTH));
+    out["dims"].append(static_cast<Json::UInt>(HyperLogLog::PRECISION));
+    out["total"] = static_cast<Json::UInt64>(total_);
+    counts_.encode(out["cms"]);
+    topK_.encode(out["top"]);
+    distinct_.encode(out["hll"]);
+}
+
+uint64_t PopularitySketch::estimate(const std::string& prefix) const {
+    return counts_.estimate(hashName(prefix.data(), prefix.size()));
+}
+
+double PopularitySketch::topShare() const {
+    if (total_ == 0) return 0.0;
+    uint64_t covered = 0;
+    for (const auto& entry : topK_.sorted()) {
+        covered += entry.count - entry.error;
+    }
+    return std::min(1.0, static_cast<double>(covered) / total_);
+}
+
+size_t PopularitySketch::prefixesForCoverage(double coverage) const {
+    if (total_ == 0) return 0;
+    double target = coverage * total_;
+    uint64_t covered = 0;
+    size_t prefixes = 0;
+    for (const auto& entry : topK_.sorted()) {
+        covered += entry.count - entry.error;
+        prefixes++;
+        if (covered >= target) return prefixes;
+    }
+    return 0;
+}
+
+} // namespace cosim
@@ -0,0 +1,141 @@
+/*
+Content popularity sketches for NDN name prefixes
+The follower feeds every Interest name into a count-min sketch and a SpaceSaving
+top-K summary keyed by the name's leading components, and into a HyperLogLog of
+distinct full names. All three live in fixed memory and cost a constant number of
+operations per packet. Sketches are mergeable, so the follower ships the sparse
+non-zero part of each report window and the leader folds it into an aged aggregate
+that drives Content Store placement and sizing.
+*/
+
+#ifndef POPULARITY_SKETCH_H
+#define POPULARITY_SKETCH_H
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Json {
+class Value;
+}
+
+namespace cosim {
+
+// Prefixes are interned by their 64-bit FNV-1a hash; strings are only kept for top-K entries
+uint64_t hashName(const char* data, size_t size);
+
+// Length of the leading `depth` components of an NDN URI ("/v2x/emergency/12/7" -> "/v2x/emergency/12" for 3)
+size_t namePrefixLength(const std::string& name, size_t depth);
+
+class CountMinSketch {
+public:
+    static constexpr size_t DEPTH = 4;
+    static constexpr size_t WIDTH = 1024;
+
+    void add(uint64_t hash, uint32_t count);
+    uint64_t estimate(uint64_t hash) const;
+    void merge(const CountMinSketch& other);
+    void halve();
+    void clear();
+
+    // Sparse encoding: [cell, count, cell, count, ...] over the flattened DEPTH x WIDTH table
+    void encode(Json::Value& out) const;
+    void decode(const Json::Value& in);
+
+private:
+    static size_t column(uint64_t hash, size_t row);
+
+    std::array<uint32_t, DEPTH * WIDTH> cells_{};
+};
+
+// Distinct-name counter, 2^PRECISION one-byte registers (~3% standard error)
+class HyperLogLog {
+public:
+    static constexpr size_t PRECISION = 10;
+    static constexpr size_t REGISTERS = 1u << PRECISION;
+
+    void add(uint64_t hash);
+    double estimate() const;
+    void merge(const HyperLogLog& other);
+    void clear() { registers_.fill(0); }
+
+    // Sparse encoding: [register, rank, register, rank, ...]
+    void encode(Json::Value& out) const;
+    void decode(const Json::Value& in);
+
+private:
+    std::array<uint8_t, REGISTERS> registers_{};
+};
+
+// SpaceSaving heavy hitters: count overestimates by at most `error`
+struct HeavyHitter {
+    uint64_t hash = 0;
+    std::string prefix;
+    uint64_t count = 0;
+    uint64_t error = 0;
+};
+
+class TopKSummary {
+public:
+    static constexpr size_t CAPACITY = 32;
+
+    void add(uint64_t hash, const char* prefix, size_t prefixLength, uint64_t count);
+    void merge(const TopKSummary& other);
+    void halve();
+    void clear() { entries_.clear(); }
+
+    // Entries by descending count
+    std::vector<HeavyHitter> sorted() const;
+    size_t size() const { return entries_.size(); }
+
+    // Encoding: [[prefix, count, error], ...]
+    void encode(Json::Value& out) const;
+    void decode(const Json::Value& in);
+
+private:
+    uint64_t minCount() const;
+
+    std::vector<HeavyHitter> entries_;
+};
+
+class PopularitySketch {
+public:
+    explicit PopularitySketch(size_t prefixDepth = 3) : prefixDepth_(prefixDepth) {}
+
+    // Follower side: one Interest name, weighted by its sampling weight
+    void record(const std::string& name, uint32_t weight = 1);
+
+    // Leader side: ages counts by half, then folds in a report produced by encode().
+    // HyperLogLog registers cannot be aged, so the distinct estimate covers the latest report.
+    void mergeReport(const Json::Value& report);
+
+    void merge(const PopularitySketch& other);
+    void clear();
+    bool empty() const { return total_ == 0; }
+
+    void encode(Json::Value& out) const;
+
+    // Queries
+    uint64_t total() const { return total_; }
+    uint64_t estimate(const std::string& prefix) const;
+    double distinctNames() const { return distinct_.estimate(); }
+    std::vector<HeavyHitter> topPrefixes() const { return topK_.sorted(); }
+
+    // Share of requests that go to the tracked heavy hitters
+    double topShare() const;
+
+    // Fewest heavy-hitter prefixes whose requests cover `coverage` of the total (0 if the top-K cannot)
+    size_t prefixesForCoverage(double coverage) const;
+
+private:
+    size_t prefixDepth_;
+    uint64_t total_ = 0;
+    CountMinSketch counts_;
+    TopKSummary topK_;
+    HyperLogLog distinct_;
+};
+
+} // namespace cosim
+
+#endif // POPULARITY_SKETCH_H
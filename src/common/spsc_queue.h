@@ -0,0 +1,100 @@
+/*
+Lock-free single-producer/single-consumer queue and stage wake-up signal
+Used to connect the orchestrator's pipeline stages. Push and pop never block and
+never take a lock; a consumer with nothing to do sleeps on a StageSignal, which
+the producer raises after pushing.
+*/
+
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace cosim {
+
+template <typename T>
+class SPSCQueue {
+public:
+    // Capacity is rounded up to a power of two
+    explicit SPSCQueue(size_t capacity) {
+        size_t size = 2;
+        while (size < capacity) size <<= 1;
+        slots_.resize(size);
+        mask_ = size - 1;
+    }
+
+    // Producer side; false if the queue is full
+    bool tryPush(T&& value) {
+        size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail - headCache_ > mask_) {
+            headCache_ = head_.load(std::memory_order_acquire);
+            if (tail - headCache_ > mask_) return false;
+        }
+        slots_[tail & mask_] = std::move(value);
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side; false if the queue is empty
+    bool tryPop(T& value) {
+        size_t head = head_.load(std::memory_order_relaxed);
+        if (head == tailCache_) {
+            tailCache_ = tail_.load(std::memory_order_acquire);
+            if (head == tailCache_) return false;
+        }
+        value = std::move(slots_[head & mask_]);
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Approximate when called concurrently with push or pop
+    size_t size() const {
+        return tail_.load(std::memory_order_acquire) - head_.load(std::memory_order_acquire);
+    }
+    bool empty() const { return size() == 0; }
+    size_t capacity() const { return mask_ + 1; }
+
+private:
+    std::vector<T> slots_;
+    size_t mask_;
+
+    // Producer and consumer indexes on separate cache lines, each with a cached copy of the other
+    alignas(64) std::atomic<size_t> head_{0};
+    size_t tailCache_ = 0;
+    alignas(64) std::atomic<size_t> tail_{0};
+    size_t headCache_ = 0;
+};
+
+// Sleep/wake for a pipeline stage; the queues themselves stay lock-free
+class StageSignal {
+public:
+    void raise() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            pending_ = true;
+        }
+        condition_.notify_one();
+    }
+
+    // Returns once raised or after the timeout; clears the signal
+    void wait(std::chrono::milliseconds timeout) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        condition_.wait_for(lock, timeout, [this] { return pending_; });
+        pending_ = false;
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable condition_;
+    bool pending_ = false;
+};
+
+} // namespace cosim
+
+#endif // SPSC_QUEUE_H
@@ -0,0 +1,141 @@
+/*
+Implementation of the per-thread step tracer and its Chrome trace-event export
+*/
+
+#include "step_tracer.h"
+#include <jsoncpp/json/json.h>
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+
+namespace cosim {
+
+namespace {
+
+// Chrome trace timestamps are microseconds
+void writeMicros(std::ostream& out, int64_t nanoseconds) {
+    out << (nanoseconds / 1000) << '.' << std::setw(3) << std::setfill('0') << (nanoseconds % 1000)
+        << std::setfill(' ');
+}
+
+} // anonymous namespace
+
+std::atomic<bool> StepTracer::enabled_{false};
+thread_local StepTracer::ThreadRing* StepTracer::threadRing_ = nullptr;
+thread_local const char* StepTracer::threadName_ = nullptr;
+
+StepTracer& StepTracer::instance() {
+    static StepTracer tracer;
+    return tracer;
+}
+
+void StepTracer::enable() {
+    std::lock_guard<std::mutex> lock(ringsMutex_);
+    if (epochNanoseconds_ == 0) {
+        epochNanoseconds_ = steadyNanoseconds();
+        epochTicks_ = now();
+    }
+    enabled_.store(true, std::memory_order_relaxed);
+}
+
+void StepTracer::nameThread(const char* name) {
+    threadName_ = name;
+    if (threadRing_) {
+        StepTracer& tracer = instance();
+        std::lock_guard<std::mutex> lock(tracer.ringsMutex_);
+        threadRing_->name = name;
+    }
+}
+
+StepTracer::ThreadRing* StepTracer::registerThread() {
+    auto ring = std::make_unique<ThreadRing>();
+    ring->spans.reset(new Span[SPANS_PER_THREAD]());
+
+    std::lock_guard<std::mutex> lock(ringsMutex_);
+    ring->name = threadName_;
+    ring->tid = static_cast<uint32_t>(rings_.size() + 1);
+    rings_.push_back(std::move(ring));
+    return rings_.back().get();
+}
+
+void StepTracer::record(const char* name, const char* category, int64_t start, int64_t end) {
+    if (!threadRing_) {
+        threadRing_ = instance().registerThread();
+    }
+    ThreadRing* ring = threadRing_;
+    uint64_t head = ring->head.load(std::memory_order_relaxed);
+    ring->spans[head & (SPANS_PER_THREAD - 1)] = {name, category, start, end};
+    ring->head.store(head + 1, std::memory_order_release);
+}
+
+size_t StepTracer::spanCount() const {
+    std::lock_guard<std::mutex> lock(ringsMutex_);
+    size_t count = 0;
+    for (const auto& ring : rings_) {
+        count += std::min<uint64_t>(ring->head.load(std::memory_order_acquire), SPANS_PER_THREAD);
+    }
+    return count;
+}
+
+uint64_t StepTracer::overwrittenSpans() const {
+    std::lock_guard<std::mutex> lock(ringsMutex_);
+    uint64_t overwritten = 0;
+    for (const auto& ring : rings_) {
+        uint64_t head = ring->head.load(std::memory_order_acquire);
+        overwritten += head > SPANS_PER_THREAD ? head - SPANS_PER_THREAD : 0;
+    }
+    return overwritten;
+}
+
+bool StepTracer::exportChromeTrace(const std::string& filename) const {
+    std::ofstream file(filename);
+    if (!file.is_open()) {
+        std::cerr << "❌ Failed to open step trace file: " << filename << std::endl;
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(ringsMutex_);
+
+    // Ticks per nanosecond over the traced interval; the counter is invariant on current x86
+    const int64_t elapsedNanoseconds = steadyNanoseconds() - epochNanoseconds_;
+    const int64_t elapsedTicks = now() - epochTicks_;
+    const double nanosecondsPerTick = elapsedNanoseconds > 0 && elapsedTicks > 0
+        ? static_cast<double>(elapsedNanoseconds) / elapsedTicks : 1.0;
+    auto toNanoseconds = [nanosecondsPerTick](int64_t ticks) {
+        return static_cast<int64_t>(std::llround(std::max<int64_t>(0, ticks) * nanosecondsPerTick));
+    };
+
+    file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    file << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"v2x-ndn-nfv-cosim\"}}";
+    for (const auto& ring : rings_) {
+        std::string name = ring->name ? ring->name : "thread " + std::to_string(ring->tid);
+        file << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << ring->tid
+             << ",\"args\":{\"name\":" << Json::valueToQuotedString(name.c_str()) << "}}";
+        file << ",\n{\"name\":\"thread_sort_index\",\"ph\":\"M\",\"pid\":1,\"tid\":" << ring->tid
+             << ",\"args\":{\"sort_index\":" << ring->tid << "}}";
+    }
+
+    // Complete ("X") events; each ring is already in time order of span end
+    for (const auto& ring : rings_) {
+        uint64_t head = ring->head.load(std::memory_order_acquire);
+        uint64_t first = head > SPANS_PER_THREAD ? head - SPANS_PER_THREAD : 0;
+        for (uint64_t i = first; i < head; ++i) {
+            const Span& span = ring->spans[i & (SPANS_PER_THREAD - 1)];
+            file << ",\n{\"name\":" << Json::valueToQuotedString(span.name)
+                 << ",\"cat\":" << Json::valueToQuotedString(span.category)
+                 << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << ring->tid << ",\"ts\":";
+            writeMicros(file, toNanoseconds(span.start - epochTicks_));
+            file << ",\"dur\":";
+            writeMicros(file, toNanoseconds(span.end - span.start));
+            file << "}";
+        }
+    }
+    file << "\n]}\n";
+
+    file.close();
+    return !file.fail();
+}
+
+} // namespace cosim
@@ -0,0 +1,124 @@
+/*
+Scoped trace spans for per-phase step timing
+A TraceSpan marks the wall-clock extent of one phase (leader step, ack wait, report
+parsing, ...) on the thread that runs it. Spans go to a fixed ring owned by that
+thread, so recording takes no lock and shares no cache line with other threads;
+when a ring wraps, its oldest spans are overwritten. The tracer exports every ring
+as Chrome trace-event JSON, which chrome://tracing and ui.perfetto.dev show as one
+timeline row per thread with nested phases stacked.
+
+Tracing is off until enable(); a span is then one relaxed load. Span names and
+categories are stored as pointers, so they must be string literals. On x86 spans
+are stamped with the time-stamp counter, which costs about half a steady clock
+read, and converted to steady clock time at export.
+
+    {
+        TraceSpan span("leader_step", "sync");
+        leader_->step(syncInterval);
+    }
+*/
+
+#ifndef STEP_TRACER_H
+#define STEP_TRACER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace cosim {
+
+class StepTracer {
+public:
+    static constexpr size_t SPANS_PER_THREAD = 1 << 16;    // Power of two; 32 bytes each
+
+    static StepTracer& instance();
+
+    void enable();
+    void disable() { enabled_.store(false, std::memory_order_relaxed); }
+    static bool enabled() { return enabled_.load(std::memory_order_relaxed); }
+
+    // Label of the calling thread's row; may be called before enable()
+    static void nameThread(const char* name);
+
+    // Span timestamp in ticks: TSC cycles on x86, steady clock nanoseconds elsewhere
+    static int64_t now() {
+#if defined(__x86_64__) || defined(__i386__)
+        return static_cast<int64_t>(__rdtsc());
+#else
+        return steadyNanoseconds();
+#endif
+    }
+
+    static int64_t steadyNanoseconds() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    // Ticks from now(), on the calling thread's ring
+    static void record(const char* name, const char* category, int64_t start, int64_t end);
+
+    // Spans still in the rings, and spans lost to ring wraps
+    size_t spanCount() const;
+    uint64_t overwrittenSpans() const;
+
+    // Export once the traced threads are quiet; a span recorded meanwhile may be torn
+    bool exportChromeTrace(const std::string& filename) const;
+
+private:
+    struct Span {
+        const char* name;
+        const char* category;
+        int64_t start;
+        int64_t end;
+    };
+
+    struct ThreadRing {
+        std::unique_ptr<Span[]> spans;
+        std::atomic<uint64_t> head{0};  // Spans ever recorded; published with release
+        const char* name = nullptr;
+        uint32_t tid = 0;
+    };
+
+    StepTracer() = default;
+    ThreadRing* registerThread();
+
+    static std::atomic<bool> enabled_;
+    static thread_local ThreadRing* threadRing_;
+    static thread_local const char* threadName_;
+    mutable std::mutex ringsMutex_;     // Ring registration, thread names, clock and export
+    int64_t epochTicks_ = 0;            // Trace time zero: the first enable()
+    int64_t epochNanoseconds_ = 0;
+    std::vector<std::unique_ptr<ThreadRing>> rings_;
+};
+
+class TraceSpan {
+public:
+    TraceSpan(const char* name, const char* category)
+        : name_(name), category_(category), start_(StepTracer::enabled() ? StepTracer::now() : 0) {}
+
+    ~TraceSpan() {
+        if (start_ != 0) {
+            StepTracer::record(name_, category_, start_, StepTracer::now());
+        }
+    }
+
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+
+private:
+    const char* name_;
+    const char* category_;
+    int64_t start_;     // 0 when tracing was off as the span opened
+};
+
+} // namespace cosim
+
+#endif // STEP_TRACER_H
@@ -0,0 +1,470 @@
+/*
+Implementation of the in-memory time-series store
+*/
+
+#include "timeseries_store.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace cosim {
+
+namespace {
+
+uint64_t doubleBits(double value) {
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+double bitsDouble(uint64_t bits) {
+    double value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+int64_t toMicros(double time) {
+    return static_cast<int64_t>(std::llround(time * 1e6));
+}
+
+unsigned leadingZeros(uint64_t bits) {
+    return bits == 0 ? 64 : static_cast<unsigned>(__builtin_clzll(bits));
+}
+
+unsigned trailingZeros(uint64_t bits) {
+    return bits == 0 ? 64 : static_cast<unsigned>(__builtin_ctzll(bits));
+}
+
+uint64_t lowMask(unsigned width) {
+    return width >= 64 ? ~0ULL : ((1ULL << width) - 1);
+}
+
+// Reads back what GorillaBlock::writeBits wrote: fields are packed LSB first
+class BitReader {
+public:
+    explicit BitReader(const std::vector<uint64_t>& words) : words_(words) {}
+
+    uint64_t read(unsigned width) {
+        if (width == 0) {
+            return 0;
+        }
+        size_t word = position_ / 64;
+        unsigned offset = position_ % 64;
+        uint64_t bits = words_[word] >> offset;
+        if (offset + width > 64) {
+            bits |= words_[word + 1] << (64 - offset);
+        }
+        position_ += width;
+        return bits & lowMask(width);
+    }
+
+    bool bit() { return read(1) != 0; }
+
+private:
+    const std::vector<uint64_t>& words_;
+    size_t position_ = 0;
+};
+
+// Delta-of-delta timestamp classes: control bits, payload width and payload bias
+struct DodClass {
+    unsigned controlBits;
+    uint64_t control;
+    unsigned width;
+    int64_t bias;
+};
+
+constexpr DodClass DOD_CLASSES[] = {
+    {2, 0x1, 7, 63},     // '10'   [-63, 64]
+    {3, 0x3, 9, 255},    // '110'  [-255, 256]
+    {4, 0x7, 12, 2047},  // '1110' [-2047, 2048]
+};
+
+} // anonymous namespace
+
+// ============================================================================
+// Rollups
+// ============================================================================
+
+void Rollup::add(double value) {
+    if (count == 0) {
+        min = value;
+        max = value;
+    } else {
+        min = std::min(min, value);
+        max = std::max(max, value);
+    }
+    sum += value;
+    count++;
+}
+
+void Rollup::merge(const Rollup& other) {
+    if (other.count == 0) {
+        return;
+    }
+    if (count == 0) {
+        min = other.min;
+        max = other.max;
+    } else {
+        min = std::min(min, other.min);
+        max = std::max(max, other.max);
+    }
+    sum += other.sum;
+    count += other.count;
+}
+
+// ============================================================================
+// Gorilla blocks
+// ============================================================================
+
+void GorillaBlock::writeBits(uint64_t bits, unsigned width) {
+    if (width == 0) {
+        return;
+    }
+    bits &= lowMask(width);
+    unsigned offset = bitCount_ % 64;
+    if (offset == 0) {
+        words_.push_back(0);
+    }
+    words_.back() |= bits << offset;
+    if (offset + width > 64) {
+        words_.push_back(bits >> (64 - offset));
+    }
+    bitCount_ += width;
+}
+
+void GorillaBlock::append(double time, double value) {
+    int64_t micros = toMicros(time);
+    uint64_t valueBits = doubleBits(value);
+
+    if (count_ == 0) {
+        writeBits(static_cast<uint64_t>(micros), 64);
+        writeBits(valueBits, 64);
+        firstTime_ = time;
+    } else {
+        // Timestamp: delta of delta in the smallest class that holds it
+        int64_t delta = micros - prevTime_;
+        int64_t dod = delta - prevDelta_;
+        if (dod == 0) {
+            writeBits(0, 1);
+        } else {
+            bool written = false;
+            for (const auto& cls : DOD_CLASSES) {
+                if (dod >= -cls.bias && dod <= cls.bias + 1) {
+                    writeBits(cls.control, cls.controlBits);
+                    writeBits(static_cast<uint64_t>(dod + cls.bias), cls.width);
+                    written = true;
+                    break;
+                }
+            }
+            if (!written) {
+                writeBits(0xF, 4);
+                writeBits(static_cast<uint64_t>(dod), 64);
+            }
+        }
+        prevDelta_ = delta;
+
+        // Value: XOR with the previous one, reusing its leading/trailing window when it fits
+        uint64_t xorBits = valueBits ^ prevValue_;
+        if (xorBits == 0) {
+            writeBits(0, 1);
+        } else {
+            writeBits(1, 1);
+            unsigned leading = std::min(leadingZeros(xorBits), 31u);
+            unsigned trailing = trailingZeros(xorBits);
+            if (prevLeading_ < 64 && leading >= prevLeading_ && trailing >= prevTrailing_) {
+                writeBits(0, 1);
+                writeBits(xorBits >> prevTrailing_, 64 - prevLeading_ - prevTrailing_);
+            } else {
+                unsigned meaningful = 64 - leading - trailing;
+                writeBits(1, 1);
+                writeBits(leading, 5);
+                writeBits(meaningful & 0x3F, 6);    // 64 is stored as 0
+                writeBits(xorBits >> trailing, meaningful);
+                prevLeading_ = leading;
+                prevTrailing_ = trailing;
+            }
+        }
+    }
+
+    prevTime_ = micros;
+    prevValue_ = valueBits;
+    lastTime_ = time;
+    count_++;
+}
+
+void GorillaBlock::decode(std::vector<Sample>& out, double from, double to) const {
+    BitReader reader(words_);
+    int64_t micros = 0;
+    int64_t delta = 0;
+    uint64_t valueBits = 0;
+    unsigned leading = 64;
+    unsigned trailing = 0;
+
+    for (size_t i = 0; i < count_; ++i) {
+        if (i == 0) {
+            micros = static_cast<int64_t>(reader.read(64));
+            valueBits = reader.read(64);
+        } else {
+            int64_t dod = 0;
+            if (reader.bit()) {
+                bool matched = false;
+                for (const auto& cls : DOD_CLASSES) {
+                    if (!reader.bit()) {
+                        dod = static_cast<int64_t>(reader.read(cls.width)) - cls.bias;
+                        matched = true;
+                        break;
+                    }
+                }
+                if (!matched) {
+                    dod = static_cast<int64_t>(reader.read(64));
+                }
+            }
+            delta += dod;
+            micros += delta;
+
+            if (reader.bit()) {
+                if (reader.bit()) {
+                    leading = static_cast<unsigned>(reader.read(5));
+                    unsigned meaningful = static_cast<unsigned>(reader.read(6));
+                    if (meaningful == 0) {
+                        meaningful = 64;
+                    }
+                    trailing = 64 - leading - meaningful;
+                }
+                valueBits ^= reader.read(64 - leading - trailing) << trailing;
+            }
+        }
+
+        double time = static_cast<double>(micros) / 1e6;
+        if (time > to) {
+            break;
+        }
+        if (time >= from) {
+            out.push_back({time, bitsDouble(valueBits)});
+        }
+    }
+}
+
+// ============================================================================
+// Store
+// ============================================================================
+
+TimeSeriesStore::TimeSeriesStore(const TimeSeriesConfig& config) : config_(config) {
+    config_.rawCapacity = std::max<size_t>(1, config_.rawCapacity);
+    config_.blockSamples = std::max<size_t>(1, config_.blockSamples);
+    for (size_t r = 0; r < RESOLUTION_COUNT; ++r) {
+        config_.tierCapacity[r] = std::max<size_t>(1, config_.tierCapacity[r]);
+    }
+}
+
+SeriesId TimeSeriesStore::series(const std::string& name) {
+    auto it = ids_.find(name);
+    if (it != ids_.end()) {
+        return it->second;
+    }
+
+    SeriesId id = static_cast<SeriesId>(series_.size());
+    series_.emplace_back();
+    series_.back().name = name;
+    ids_.emplace(name, id);
+    return id;
+}
+
+SeriesId TimeSeriesStore::find(const std::string& name) const {
+    auto it = ids_.find(name);
+    return it != ids_.end() ? it->second : INVALID_SERIES;
+}
+
+bool TimeSeriesStore::append(SeriesId id, double time, double value) {
+    if (id >= series_.size()) {
+        return false;
+    }
+    Series& series = series_[id];
+    const size_t size = series.times.size();
+
+    if (size > 0 && time < series.times[(series.head + size - 1) % size]) {
+        return false;
+    }
+
+    if (size < config_.rawCapacity) {
+        series.times.push_back(time);
+        series.values.push_back(value);
+    } else {
+        evict(series, series.times[series.head], series.values[series.head]);
+        series.times[series.head] = time;
+        series.values[series.head] = value;
+        series.head = (series.head + 1) % size;
+    }
+
+    for (size_t r = 0; r < RESOLUTION_COUNT; ++r) {
+        rollup(series.tiers[r], config_.tierWidth[r], config_.tierCapacity[r], time, value);
+    }
+    return true;
+}
+
+void TimeSeriesStore::evict(Series& series, double time, double value) {
+    if (series.cold.empty() || series.cold.back().size() >= config_.blockSamples) {
+        if (!series.cold.empty()) {
+            series.coldBytes += series.cold.back().bytes();
+        }
+        while (!series.cold.empty() && series.coldBytes > config_.coldBudgetBytes) {
+            series.coldBytes -= series.cold.front().bytes();
+            series.droppedSamples += series.cold.front().size();
+            series.cold.pop_front();
+        }
+        series.cold.emplace_back();
+    }
+    series.cold.back().append(time, value);
+}
+
+void TimeSeriesStore::rollup(Tier& tier, double width, size_t capacity, double time, double value) {
+    double start = std::floor(time / width) * width;
+    const size_t size = tier.start.size();
+
+    if (size > 0) {
+        size_t newest = (tier.head + size - 1) % size;
+        if (start <= tier.start[newest]) {
+            tier.min[newest] = std::min(tier.min[newest], value);
+            tier.max[newest] = std::max(tier.max[newest], value);
+            tier.sum[newest] += value;
+            tier.count[newest]++;
+            return;
+        }
+    }
+
+    if (size < capacity) {
+        tier.start.push_back(start);
+        tier.min.push_back(value);
+        tier.max.push_back(value);
+        tier.sum.push_back(value);
+        tier.count.push_back(1);
+    } else {
+        size_t slot = tier.head;
+        tier.start[slot] = start;
+        tier.min[slot] = value;
+        tier.max[slot] = value;
+        tier.sum[slot] = value;
+        tier.count[slot] = 1;
+        tier.head = (tier.head + 1) % size;
+    }
+}
+
+bool TimeSeriesStore::latest(SeriesId id, Sample& out) const {
+    if (id >= series_.size() || series_[id].times.empty()) {
+        return false;
+    }
+    const Series& series = series_[id];
+    size_t newest = (series.head + series.times.size() - 1) % series.times.size();
+    out = {series.times[newest], series.values[newest]};
+    return true;
+}
+
+size_t TimeSeriesStore::range(SeriesId id, double from, double to, std::vector<Sample>& out) const {
+    if (id >= series_.size()) {
+        return 0;
+    }
+    const Series& series = series_[id];
+    size_t before = out.size();
+
+    for (const auto& block : series.cold) {
+        if (block.lastTime() >= from && block.firstTime() <= to) {
+            block.decode(out, from, to);
+        }
+    }
+
+    const size_t size = series.times.size();
+    for (size_t k = 0; k < size; ++k) {
+        size_t i = (series.head + k) % size;
+        if (series.times[i] > to) {
+            break;
+        }
+        if (series.times[i] >= from) {
+            out.push_back({series.times[i], series.values[i]});
+        }
+    }
+    return out.size() - before;
+}
+
+size_t TimeSeriesStore::rollups(SeriesId id, Resolution resolution, double from, double to,
+                                std::vector<Rollup>& out) const {
+    if (id >= series_.size()) {
+        return 0;
+    }
+    size_t r = static_cast<size_t>(resolution);
+    const Tier& tier = series_[id].tiers[r];
+    const double width = config_.tierWidth[r];
+    const size_t size = tier.start.size();
+    size_t before = out.size();
+
+    for (size_t k = 0; k < size; ++k) {
+        size_t i = (tier.head + k) % size;
+        if (tier.start[i] > to) {
+            break;
+        }
+        if (tier.start[i] + width > from) {
+            Rollup bucket;
+            bucket.start = tier.start[i];
+            bucket.min = tier.min[i];
+            bucket.max = tier.max[i];
+            bucket.sum = tier.sum[i];
+            bucket.count = tier.count[i];
+            out.push_back(bucket);
+        }
+    }
+    return out.size() - before;
+}
+
+Rollup TimeSeriesStore::summarize(SeriesId id, double from, double to) const {
+    Rollup result;
+    result.start = from;
+    if (id >= series_.size()) {
+        return result;
+    }
+    const Series& series = series_[id];
+
+    // Finest tier whose oldest bucket reaches back to `from`, else the longest history
+    size_t r = RESOLUTION_COUNT - 1;
+    for (size_t candidate = 0; candidate < RESOLUTION_COUNT; ++candidate) {
+        const Tier& tier = series.tiers[candidate];
+        if (!tier.start.empty() && tier.start[tier.head] <= from) {
+            r = candidate;
+            break;
+        }
+    }
+
+    const Tier& tier = series.tiers[r];
+    const double width = config_.tierWidth[r];
+    const size_t size = tier.start.size();
+    for (size_t k = 0; k < size; ++k) {
+        size_t i = (tier.head + k) % size;
+        if (tier.start[i] > to) {
+            break;
+        }
+        if (tier.start[i] + width > from) {
+            Rollup bucket;
+            bucket.min = tier.min[i];
+            bucket.max = tier.max[i];
+            bucket.sum = tier.sum[i];
+            bucket.count = tier.count[i];
+            result.merge(bucket);
+        }
+    }
+    return result;
+}
+
+size_t TimeSeriesStore::memoryBytes() const {
+    size_t bytes = 0;
+    for (const auto& series : series_) {
+        bytes += (series.times.capacity() + series.values.capacity()) * sizeof(double);
+        for (const auto& block : series.cold) {
+            bytes += block.bytes();
+        }
+        for (const auto& tier : series.tiers) {
+            bytes += (tier.start.capacity() + tier.min.capacity() + tier.max.capacity() +
+                      tier.sum.capacity()) * sizeof(double) + tier.count.capacity() * sizeof(uint32_t);
+        }
+    }
+    return bytes;
+}
+
+} // namespace cosim
@@ -0,0 +1,153 @@
+/*
+In-memory time-series store for co-simulation metrics
+Each series keeps its newest samples uncompressed in a fixed-capacity ring of
+time and value columns. Samples leaving the ring are Gorilla-compressed into
+cold blocks (delta-of-delta timestamps, XOR-encoded values), and the oldest
+blocks are dropped once a series exceeds its byte budget. Every sample is also
+rolled up on arrival into 1 s, 10 s and 1 min tiers of min/max/sum/count
+buckets, themselves fixed-capacity rings, so window queries never touch raw
+samples and memory stays bounded however long the run is.
+*/
+
+#ifndef TIMESERIES_STORE_H
+#define TIMESERIES_STORE_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace cosim {
+
+enum class Resolution : uint8_t {
+    SECOND,
+    TEN_SECONDS,
+    MINUTE
+};
+
+constexpr size_t RESOLUTION_COUNT = 3;
+
+struct TimeSeriesConfig {
+    size_t rawCapacity = 2048;                              // Newest samples kept uncompressed per series
+    size_t blockSamples = 256;                              // Samples per compressed cold block
+    size_t coldBudgetBytes = 256 * 1024;                    // Per series; oldest cold blocks are dropped first
+    std::array<double, RESOLUTION_COUNT> tierWidth{{1.0, 10.0, 60.0}};
+    std::array<size_t, RESOLUTION_COUNT> tierCapacity{{3600, 2160, 1440}};  // 1 h, 6 h and 24 h
+};
+
+struct Sample {
+    double time;
+    double value;
+};
+
+struct Rollup {
+    double start = 0.0;     // Bucket (or window) start, simulation seconds
+    double min = 0.0;
+    double max = 0.0;
+    double sum = 0.0;
+    uint32_t count = 0;
+
+    double avg() const { return count > 0 ? sum / count : 0.0; }
+    void add(double value);
+    void merge(const Rollup& other);
+};
+
+// Append-only Gorilla block. Timestamps are kept at microsecond precision.
+class GorillaBlock {
+public:
+    void append(double time, double value);
+    void decode(std::vector<Sample>& out, double from, double to) const;
+
+    size_t size() const { return count_; }
+    size_t bytes() const { return words_.size() * sizeof(uint64_t); }
+    double firstTime() const { return firstTime_; }
+    double lastTime() const { return lastTime_; }
+
+private:
+    void writeBits(uint64_t bits, unsigned width);
+
+    std::vector<uint64_t> words_;
+    size_t bitCount_ = 0;
+    size_t count_ = 0;
+    double firstTime_ = 0.0;
+    double lastTime_ = 0.0;
+
+    // Encoder state
+    int64_t prevTime_ = 0;
+    int64_t prevDelta_ = 0;
+    uint64_t prevValue_ = 0;
+    unsigned prevLeading_ = 64;     // No XOR window yet
+    unsigned prevTrailing_ = 0;
+};
+
+using SeriesId = uint32_t;
+
+class TimeSeriesStore {
+public:
+    static constexpr SeriesId INVALID_SERIES = UINT32_MAX;
+
+    explicit TimeSeriesStore(const TimeSeriesConfig& config = TimeSeriesConfig());
+
+    // Interns the name, creating an empty series on first use
+    SeriesId series(const std::string& name);
+    SeriesId find(const std::string& name) const;
+    const std::string& name(SeriesId id) const { return series_[id].name; }
+    size_t seriesCount() const { return series_.size(); }
+
+    // Samples must arrive in time order per series; older ones are rejected
+    bool append(SeriesId id, double time, double value);
+
+    bool latest(SeriesId id, Sample& out) const;
+
+    // Raw samples with from <= time <= to, oldest first, including compressed history
+    size_t range(SeriesId id, double from, double to, std::vector<Sample>& out) const;
+
+    // Tier buckets overlapping [from, to], oldest first
+    size_t rollups(SeriesId id, Resolution resolution, double from, double to, std::vector<Rollup>& out) const;
+
+    // Min/max/avg over [from, to] from the finest tier that still covers `from`;
+    // window edges are rounded out to that tier's bucket boundaries
+    Rollup summarize(SeriesId id, double from, double to) const;
+
+    size_t memoryBytes() const;
+    const TimeSeriesConfig& config() const { return config_; }
+
+private:
+    struct Tier {
+        std::vector<double> start;
+        std::vector<double> min;
+        std::vector<double> max;
+        std::vector<double> sum;
+        std::vector<uint32_t> count;
+        size_t head = 0;    // Oldest bucket once the columns reach capacity
+    };
+
+    struct Series {
+        std::string name;
+
+        // Raw ring; columns grow to capacity, then wrap at head
+        std::vector<double> times;
+        std::vector<double> values;
+        size_t head = 0;
+
+        std::deque<GorillaBlock> cold;    // Back block is still being filled
+        size_t coldBytes = 0;             // Sealed blocks only
+        uint64_t droppedSamples = 0;      // Aged out of the cold budget
+
+        std::array<Tier, RESOLUTION_COUNT> tiers;
+    };
+
+    void evict(Series& series, double time, double value);
+    void rollup(Tier& tier, double width, size_t capacity, double time, double value);
+
+    TimeSeriesConfig config_;
+    std::vector<Series> series_;
+    std::unordered_map<std::string, SeriesId> ids_;
+};
+
+} // namespace cosim
+
+#endif // TIMESERIES_STORE_H
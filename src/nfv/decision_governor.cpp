@@ -0,0 +1,180 @@
+/*
+Implementation of the NFV decision governor
+*/
+
+#include "decision_governor.h"
+#include <algorithm>
+#include <cmath>
+
+namespace cosim {
+
+const char* governorVerdictName(GovernorVerdict verdict) {
+    switch (verdict) {
+        case GovernorVerdict::ADMIT: return "admit";
+        case GovernorVerdict::COOLDOWN: return "cooldown";
+        case GovernorVerdict::HYSTERESIS: return "hysteresis";
+        case GovernorVerdict::DUPLICATE: return "duplicate";
+        default: return "unknown";
+    }
+}
+
+DecisionGovernor::DecisionGovernor(const GovernorConfig& config) : config_(config) {}
+
+size_t DecisionGovernor::coalesce(std::vector<NFVDecision>& decisions) {
+    std::vector<NFVDecision> merged;
+    merged.reserve(decisions.size());
+
+    for (auto& decision : decisions) {
+        auto same = std::find_if(merged.begin(), merged.end(), [&](const NFVDecision& kept) {
+            return kept.vnfType == decision.vnfType && kept.action == decision.action &&
+                   kept.sourceLocation == decision.sourceLocation &&
+                   kept.targetLocation == decision.targetLocation;
+        });
+        if (same == merged.end()) {
+            merged.push_back(std::move(decision));
+            continue;
+        }
+
+        int targetInstances = std::max(same->targetInstances, decision.targetInstances);
+        int priority = std::min(same->priority, decision.priority);
+        *same = std::move(decision);
+        same->targetInstances = targetInstances;
+        same->priority = priority;
+    }
+
+    size_t count = decisions.size() - merged.size();
+    decisions = std::move(merged);
+    return count;
+}
+
+DecisionGovernor::KeyState& DecisionGovernor::key(VNFType type, const std::string& location) {
+    auto it = locationIds_.find(location);
+    if (it == locationIds_.end()) {
+        it = locationIds_.emplace(location, static_cast<uint32_t>(locationIds_.size())).first;
+        for (auto& perLocation : keys_) {
+            perLocation.emplace_back();
+        }
+    }
+    return keys_[static_cast<size_t>(type)][it->second];
+}
+
+const DecisionGovernor::KeyState* DecisionGovernor::findKey(VNFType type, const std::string& location) const {
+    auto it = locationIds_.find(location);
+    return it != locationIds_.end() ? &keys_[static_cast<size_t>(type)][it->second] : nullptr;
+}
+
+void DecisionGovernor::enter(KeyState& key, GovernorState state, double until) {
+    key.state = state;
+    key.until = until;
+}
+
+GovernorState DecisionGovernor::state(VNFType type, const std::string& location, double now) const {
+    const KeyState* key = findKey(type, location);
+    return (key && cooling(*key, now)) ? key->state : GovernorState::STABLE;
+}
+
+GovernorVerdict DecisionGovernor::admit(NFVDecision& decision, const VNFRegistry& registry, double now) {
+    bool urgent = decision.priority <= 1;
+
+    if (decision.action == "SCALE_UP") {
+        return admitScaleUp(decision, registry, now, urgent);
+    } else if (decision.action == "SCALE_DOWN") {
+        return admitScaleDown(decision, registry, now, urgent);
+    } else if (decision.action == "MIGRATE") {
+        return admitMigrate(decision, registry, now);
+    } else if (decision.action == "OPTIMIZE") {
+        return admitOptimize(decision, now);
+    }
+    return GovernorVerdict::ADMIT;
+}
+
+GovernorVerdict DecisionGovernor::admitScaleUp(NFVDecision& decision, const VNFRegistry& registry,
+                                               double now, bool urgent) {
+    int shortfall = decision.targetInstances - static_cast<int>(registry.count(decision.vnfType));
+    if (shortfall <= 0) {
+        return GovernorVerdict::HYSTERESIS;
+    }
+
+    KeyState& target = key(decision.vnfType, decision.targetLocation);
+    if (!urgent && cooling(target, now)) {
+        return GovernorVerdict::COOLDOWN;
+    }
+
+    decision.targetInstances = shortfall;
+    if (decision.placements.size() > static_cast<size_t>(shortfall)) {
+        decision.placements.resize(static_cast<size_t>(shortfall));
+    }
+
+    double until = now + config_.scaleUpCooldown;
+    enter(target, GovernorState::SCALED_UP, until);
+    for (const auto& site : decision.placements) {
+        enter(key(decision.vnfType, site), GovernorState::SCALED_UP, until);
+    }
+    return GovernorVerdict::ADMIT;
+}
+
+GovernorVerdict DecisionGovernor::admitScaleDown(NFVDecision& decision, const VNFRegistry& registry,
+                                                 double now, bool urgent) {
+    // Actuation removes an instance at the source when it has one, else the most recently
+    // indexed instance; govern the site the victim sits on
+    const VNFInstance* victim = registry.get(registry.firstOf(decision.vnfType, decision.sourceLocation));
+    if (!victim) {
+        victim = registry.get(registry.lastOf(decision.vnfType));
+    }
+    if (!victim || registry.count(decision.vnfType) <= 1) {
+        return GovernorVerdict::HYSTERESIS;
+    }
+
+    KeyState& source = key(decision.vnfType, victim->location);
+    if (!urgent && cooling(source, now)) {
+        return GovernorVerdict::COOLDOWN;
+    }
+
+    decision.sourceLocation = victim->location;
+    enter(source, GovernorState::SCALED_DOWN, now + config_.scaleDownCooldown);
+    return GovernorVerdict::ADMIT;
+}
+
+GovernorVerdict DecisionGovernor::admitMigrate(NFVDecision& decision, const VNFRegistry& registry, double now) {
+    size_t total = registry.count(decision.vnfType);
+    if (total == 0 || decision.sourceLocation == decision.targetLocation ||
+        registry.count(decision.vnfType, decision.targetLocation) >= total) {
+        return GovernorVerdict::HYSTERESIS;
+    }
+
+    // Both ends cool down so an instance is not moved straight back; bouncing an
+    // instance never helps, so this holds for critical decisions too
+    // key() may grow the per-location lists, so create the target before holding the source
+    key(decision.vnfType, decision.targetLocation);
+    KeyState& source = key(decision.vnfType, decision.sourceLocation);
+    KeyState& target = key(decision.vnfType, decision.targetLocation);
+    if (cooling(source, now) || cooling(target, now)) {
+        return GovernorVerdict::COOLDOWN;
+    }
+
+    double until = now + config_.migrateCooldown;
+    enter(source, GovernorState::MIGRATED, until);
+    enter(target, GovernorState::MIGRATED, until);
+    return GovernorVerdict::ADMIT;
+}
+
+GovernorVerdict DecisionGovernor::admitOptimize(NFVDecision& decision, double now) {
+    KeyState& target = key(decision.vnfType, decision.targetLocation);
+
+    if (target.optimized && now - target.optimizedAt < config_.optimizeRefresh &&
+        target.optimizedPrefixes == decision.hotPrefixes) {
+        double previous = target.optimizedCapacity;
+        double change = std::fabs(static_cast<double>(decision.cacheCapacity) - previous);
+        if (change <= config_.capacityBand * std::max(1.0, previous)) {
+            return GovernorVerdict::DUPLICATE;
+        }
+    }
+
+    target.optimized = true;
+    target.optimizedAt = now;
+    target.optimizedCapacity = decision.cacheCapacity;
+    target.optimizedPrefixes = decision.hotPrefixes;
+    return GovernorVerdict::ADMIT;
+}
+
+} // namespace cosim
@@ -0,0 +1,100 @@
+/*
+NFV decision governor
+Sits between decision making and actuation. Equivalent decisions that queued up
+while actuation was busy are coalesced into one, and each remaining decision
+passes a per-(VNF type, location) state machine before it may touch the fleet:
+
+  STABLE --scale up--> SCALED_UP --cooldown--> STABLE
+  STABLE --scale down--> SCALED_DOWN --cooldown--> STABLE
+  STABLE --migrate--> MIGRATED --cooldown--> STABLE   (source and target)
+
+A scale-up's targetInstances is the fleet size the policy asks for, so the
+governor only deploys the shortfall and nothing once it is met; a scale-down
+never removes the last instance. Opposite actions inside a cooldown are held
+back so the fleet cannot flap, and cache optimizations are only re-issued when
+their capacity moves outside a hysteresis band, their hot set changes, or the
+refresh period has passed. Critical decisions (priority 1) skip scaling cooldowns.
+*/
+
+#ifndef DECISION_GOVERNOR_H
+#define DECISION_GOVERNOR_H
+
+#include "nfv_decision.h"
+#include "vnf_registry.h"
+#include <array>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace cosim {
+
+struct GovernorConfig {
+    double scaleUpCooldown = 10.0;     // Seconds of simulation time
+    double scaleDownCooldown = 30.0;
+    double migrateCooldown = 30.0;
+    double optimizeRefresh = 60.0;     // Identical cache optimizations are re-sent after this long
+    double capacityBand = 0.1;         // Relative cache capacity change that counts as new
+};
+
+enum class GovernorState : uint8_t {
+    STABLE,
+    SCALED_UP,
+    SCALED_DOWN,
+    MIGRATED
+};
+
+enum class GovernorVerdict : uint8_t {
+    ADMIT,
+    COOLDOWN,     // Inside the cooldown of an earlier action on the same key
+    HYSTERESIS,   // The fleet already satisfies the decision
+    DUPLICATE     // Same as the last decision issued for the key
+};
+
+const char* governorVerdictName(GovernorVerdict verdict);
+
+class DecisionGovernor {
+public:
+    explicit DecisionGovernor(const GovernorConfig& config = GovernorConfig());
+
+    // Merges decisions with the same type, action and locations, keeping the newest
+    // with the largest instance target and most urgent priority. Returns how many were merged.
+    static size_t coalesce(std::vector<NFVDecision>& decisions);
+
+    // May rewrite the decision (a scale-up is reduced to the shortfall); updates the state
+    // machine when the decision is admitted. `now` is simulation time.
+    GovernorVerdict admit(NFVDecision& decision, const VNFRegistry& registry, double now);
+
+    GovernorState state(VNFType type, const std::string& location, double now) const;
+    const GovernorConfig& config() const { return config_; }
+
+private:
+    struct KeyState {
+        GovernorState state = GovernorState::STABLE;
+        double until = 0.0;
+
+        // Last cache optimization issued for the key
+        bool optimized = false;
+        double optimizedAt = 0.0;
+        uint32_t optimizedCapacity = 0;
+        std::vector<std::string> optimizedPrefixes;
+    };
+
+    KeyState& key(VNFType type, const std::string& location);
+    const KeyState* findKey(VNFType type, const std::string& location) const;
+    static bool cooling(const KeyState& key, double now) { return key.state != GovernorState::STABLE && now < key.until; }
+    static void enter(KeyState& key, GovernorState state, double until);
+
+    GovernorVerdict admitScaleUp(NFVDecision& decision, const VNFRegistry& registry, double now, bool urgent);
+    GovernorVerdict admitScaleDown(NFVDecision& decision, const VNFRegistry& registry, double now, bool urgent);
+    GovernorVerdict admitMigrate(NFVDecision& decision, const VNFRegistry& registry, double now);
+    GovernorVerdict admitOptimize(NFVDecision& decision, double now);
+
+    GovernorConfig config_;
+    std::unordered_map<std::string, uint32_t> locationIds_;
+    std::array<std::vector<KeyState>, VNF_TYPE_COUNT> keys_;   // [type][locationId]
+};
+
+} // namespace cosim
+
+#endif // DECISION_GOVERNOR_H
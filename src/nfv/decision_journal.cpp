@@ -0,0 +1,420 @@
+/*
+Implementation of the NFV decision journal writer and snapshot-indexed reader
+*/
+
+#include "decision_journal.h"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <unordered_map>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace cosim {
+
+using namespace decisionjournal;
+
+namespace {
+
+constexpr size_t FILE_HEADER_BYTES = sizeof(FILE_MAGIC) + 8;
+
+template <typename T>
+T load(const char* data) {
+    T value;
+    std::memcpy(&value, data, sizeof(T));
+    return value;
+}
+
+// Whether a record's payload can be read as its kind says. Name ids are handed out
+// in order, so a valid one is at most one past the names seen so far.
+bool recordConsistent(const RecordHeader& header, const char* payload, size_t nameCount) {
+    switch (header.kind) {
+        case NAME: {
+            if (header.length < sizeof(uint32_t)) return false;
+            uint32_t id = load<uint32_t>(payload);
+            return id != 0 && id <= nameCount;
+        }
+        case DECISION:
+            return header.length >= sizeof(DecisionRecord);
+        case CHANGE:
+            return header.length >= sizeof(ChangeRecord);
+        case SNAPSHOT: {
+            if (header.length < sizeof(SnapshotHeader)) return false;
+            uint64_t count = load<SnapshotHeader>(payload).count;
+            return sizeof(SnapshotHeader) + count * sizeof(SnapshotInstance) <= header.length;
+        }
+        default:
+            return true;    // Unknown kinds are skipped
+    }
+}
+
+} // namespace
+
+// ============================================================================
+// Writer
+// ============================================================================
+
+bool DecisionJournalWriter::open(const std::string& filename, double snapshotInterval) {
+    close();
+    file_ = std::fopen(filename.c_str(), "wb");
+    if (!file_) {
+        std::cerr << "❌ Failed to open decision journal: " << filename << std::endl;
+        return false;
+    }
+    std::setvbuf(file_, nullptr, _IOFBF, 1 << 16);
+
+    uint32_t header[2] = {FORMAT_VERSION, 0};
+    bytesWritten_ = std::fwrite(FILE_MAGIC, 1, sizeof(FILE_MAGIC), file_);
+    bytesWritten_ += std::fwrite(header, 1, sizeof(header), file_);
+
+    snapshotInterval_ = snapshotInterval;
+    recordsSinceSnapshot_ = 0;
+    decisions_ = 0;
+    admitted_ = 0;
+    names_.clear();
+    locationNames_.clear();
+    return true;
+}
+
+void DecisionJournalWriter::close() {
+    if (!file_) return;
+    std::fclose(file_);
+    file_ = nullptr;
+}
+
+void DecisionJournalWriter::writeRecord(uint8_t kind, double time, const void* payload, uint32_t length,
+                                        const void* extra, uint32_t extraLength) {
+    RecordHeader header = {};
+    header.kind = kind;
+    header.length = length + extraLength;
+    header.time = time;
+    bytesWritten_ += std::fwrite(&header, 1, sizeof(header), file_);
+    bytesWritten_ += std::fwrite(payload, 1, length, file_);
+    if (extraLength > 0) {
+        bytesWritten_ += std::fwrite(extra, 1, extraLength, file_);
+    }
+    recordsSinceSnapshot_++;
+}
+
+uint32_t DecisionJournalWriter::intern(double time, const std::string& name) {
+    if (name.empty()) return 0;
+    auto it = names_.find(name);
+    if (it != names_.end()) return it->second;
+
+    uint32_t id = static_cast<uint32_t>(names_.size()) + 1;
+    names_.emplace(name, id);
+    writeRecord(NAME, time, &id, sizeof(id), name.data(), static_cast<uint32_t>(name.size()));
+    return id;
+}
+
+uint32_t DecisionJournalWriter::internLocation(double time, const VNFRegistry& registry, uint32_t location) {
+    if (location >= locationNames_.size()) {
+        locationNames_.resize(registry.locationCount(), 0);
+    }
+    uint32_t& id = locationNames_[location];
+    if (id == 0) {
+        id = intern(time, registry.locationName(location));
+    }
+    return id;
+}
+
+uint64_t DecisionJournalWriter::appendDecision(double time, const NFVDecision& decision, GovernorVerdict verdict) {
+    if (!file_) return 0;
+
+    DecisionRecord record = {};
+    record.sequence = ++decisions_;
+    record.reason = intern(time, decision.reasonKey);
+    record.action = intern(time, decision.action);
+    record.source = intern(time, decision.sourceLocation);
+    record.target = intern(time, decision.targetLocation);
+    record.targetInstances = decision.targetInstances;
+    record.vnfType = static_cast<uint8_t>(decision.vnfType);
+    record.priority = static_cast<uint8_t>(decision.priority);
+    record.verdict = static_cast<uint8_t>(verdict);
+    writeRecord(DECISION, time, &record, sizeof(record));
+
+    if (verdict == GovernorVerdict::ADMIT) {
+        admitted_++;
+    }
+    return record.sequence;
+}
+
+void DecisionJournalWriter::appendChanges(const VNFRegistry& registry, const std::vector<VNFChange>& changes,
+                                          uint64_t decision) {
+    if (!file_) return;
+
+    for (const auto& change : changes) {
+        ChangeRecord record = {};
+        record.decision = decision;
+        record.handleIndex = change.handle.index;
+        record.handleGeneration = change.handle.generation;
+        record.fromLocation = internLocation(change.timestamp, registry, change.fromLocation);
+        record.toLocation = internLocation(change.timestamp, registry, change.toLocation);
+        if (change.kind == VNFChangeKind::CREATED) {
+            // Read right after the mutation, so the instance is still live
+            const VNFInstance* instance = registry.get(change.handle);
+            record.instance = instance ? intern(change.timestamp, instance->instanceId) : 0;
+        }
+        record.kind = static_cast<uint8_t>(change.kind);
+        record.vnfType = static_cast<uint8_t>(change.type);
+        record.fromState = static_cast<uint8_t>(change.fromState);
+        record.toState = static_cast<uint8_t>(change.toState);
+        writeRecord(CHANGE, change.timestamp, &record, sizeof(record));
+    }
+}
+
+bool DecisionJournalWriter::snapshotDue(double time) const {
+    return file_ && (time - lastSnapshot_ >= snapshotInterval_ || recordsSinceSnapshot_ >= SNAPSHOT_MAX_RECORDS);
+}
+
+void DecisionJournalWriter::snapshot(double time, const VNFRegistry& registry) {
+    if (!file_) return;
+
+    // Names first: they are records of their own and must precede the snapshot
+    std::vector<SnapshotInstance> instances;
+    instances.reserve(registry.size());
+    registry.forEach([&](VNFHandle handle, const VNFInstance& instance) {
+        SnapshotInstance entry = {};
+        entry.handleIndex = handle.index;
+        entry.handleGeneration = handle.generation;
+        entry.location = intern(time, instance.location);
+        entry.instance = intern(time, instance.instanceId);
+        entry.vnfType = static_cast<uint8_t>(instance.type);
+        entry.state = static_cast<uint8_t>(instance.state);
+        instances.push_back(entry);
+    });
+
+    SnapshotHeader header = {};
+    header.decisions = decisions_;
+    header.admitted = admitted_;
+    header.count = static_cast<uint32_t>(instances.size());
+    writeRecord(SNAPSHOT, time, &header, sizeof(header), instances.data(),
+                static_cast<uint32_t>(instances.size() * sizeof(SnapshotInstance)));
+
+    lastSnapshot_ = time;
+    recordsSinceSnapshot_ = 0;
+}
+
+// ============================================================================
+// Reader
+// ============================================================================
+
+bool DecisionJournal::open(const std::string& filename) {
+    close();
+
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        std::cerr << "❌ Failed to open decision journal: " << filename << std::endl;
+        return false;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < FILE_HEADER_BYTES) {
+        std::cerr << "❌ Not a decision journal: " << filename << std::endl;
+        ::close(fd);
+        return false;
+    }
+
+    mappedBytes_ = static_cast<size_t>(info.st_size);
+    mapping_ = mmap(nullptr, mappedBytes_, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapping_ == MAP_FAILED) {
+        mapping_ = nullptr;
+        std::cerr << "❌ Failed to map decision journal: " << filename << std::endl;
+        return false;
+    }
+
+    const char* data = static_cast<const char*>(mapping_);
+    if (std::memcmp(data, FILE_MAGIC, sizeof(FILE_MAGIC)) != 0 ||
+        load<uint32_t>(data + sizeof(FILE_MAGIC)) != FORMAT_VERSION) {
+        std::cerr << "❌ Not a decision journal (or unsupported version): " << filename << std::endl;
+        close();
+        return false;
+    }
+
+    // One hop per record header: names and snapshot offsets only
+    names_.assign(1, std::string());
+    size_t offset = FILE_HEADER_BYTES;
+    bool first = true;
+    while (offset + sizeof(RecordHeader) <= mappedBytes_) {
+        RecordHeader header = load<RecordHeader>(data + offset);
+        const char* payload = data + offset + sizeof(RecordHeader);
+        if (offset + sizeof(RecordHeader) + header.length > mappedBytes_) {
+            break;
+        }
+        if (!recordConsistent(header, payload, names_.size())) {
+            std::cerr << "⚠️ Inconsistent record at offset " << offset << " in decision journal "
+                      << filename << "; replay stops there" << std::endl;
+            break;
+        }
+
+        if (header.kind == NAME) {
+            uint32_t id = load<uint32_t>(payload);
+            if (id == names_.size()) {
+                names_.emplace_back();
+            }
+            names_[id].assign(payload + sizeof(uint32_t), header.length - sizeof(uint32_t));
+        } else if (header.kind == SNAPSHOT) {
+            snapshots_.push_back({header.time, offset});
+        } else if (header.kind == DECISION) {
+            decisionCount_++;
+        }
+
+        if (first) {
+            startTime_ = header.time;
+            first = false;
+        }
+        endTime_ = header.time;
+        offset += sizeof(RecordHeader) + header.length;
+    }
+    end_ = offset;
+    return true;
+}
+
+void DecisionJournal::close() {
+    if (mapping_) {
+        munmap(mapping_, mappedBytes_);
+        mapping_ = nullptr;
+    }
+    mappedBytes_ = 0;
+    end_ = 0;
+    names_.clear();
+    snapshots_.clear();
+    startTime_ = 0.0;
+    endTime_ = 0.0;
+    decisionCount_ = 0;
+}
+
+const std::string& DecisionJournal::name(uint32_t id) const {
+    return id < names_.size() ? names_[id] : names_.front();
+}
+
+size_t DecisionJournal::seek(double time, const SnapshotIndex** snapshot, bool strict) const {
+    auto after = strict
+        ? std::lower_bound(snapshots_.begin(), snapshots_.end(), time,
+                           [](const SnapshotIndex& index, double t) { return index.time < t; })
+        : std::upper_bound(snapshots_.begin(), snapshots_.end(), time,
+                           [](double t, const SnapshotIndex& index) { return t < index.time; });
+    if (after == snapshots_.begin()) {
+        *snapshot = nullptr;
+        return FILE_HEADER_BYTES;
+    }
+    *snapshot = &*(after - 1);
+    return (*snapshot)->offset;
+}
+
+bool DecisionJournal::stateAt(double time, JournalState& state) const {
+    if (!mapping_) return false;
+
+    const char* data = static_cast<const char*>(mapping_);
+    const SnapshotIndex* snapshot = nullptr;
+    size_t offset = seek(time, &snapshot);
+
+    state = JournalState();
+    state.time = time;
+    std::unordered_map<uint32_t, JournalInstance> fleet;
+
+    if (snapshot) {
+        const char* payload = data + offset + sizeof(RecordHeader);
+        SnapshotHeader header = load<SnapshotHeader>(payload);
+        state.snapshotTime = snapshot->time;
+        state.decisions = header.decisions;
+        state.admitted = header.admitted;
+
+        const char* entries = payload + sizeof(SnapshotHeader);
+        for (uint32_t i = 0; i < header.count; ++i) {
+            SnapshotInstance entry = load<SnapshotInstance>(entries + i * sizeof(SnapshotInstance));
+            JournalInstance& instance = fleet[entry.handleIndex];
+            instance.handle = {entry.handleIndex, entry.handleGeneration};
+            instance.type = static_cast<VNFType>(entry.vnfType);
+            instance.state = static_cast<VNFState>(entry.state);
+            instance.instanceId = name(entry.instance);
+            instance.location = name(entry.location);
+        }
+        offset += sizeof(RecordHeader) + load<RecordHeader>(data + offset).length;
+    }
+
+    while (offset < end_) {
+        RecordHeader header = load<RecordHeader>(data + offset);
+        if (header.time > time) break;
+        const char* payload = data + offset + sizeof(RecordHeader);
+        offset += sizeof(RecordHeader) + header.length;
+
+        if (header.kind == DECISION) {
+            DecisionRecord record = load<DecisionRecord>(payload);
+            state.decisions++;
+            if (record.verdict == static_cast<uint8_t>(GovernorVerdict::ADMIT)) {
+                state.admitted++;
+            }
+        } else if (header.kind == CHANGE) {
+            ChangeRecord record = load<ChangeRecord>(payload);
+            switch (static_cast<VNFChangeKind>(record.kind)) {
+                case VNFChangeKind::CREATED: {
+                    JournalInstance& instance = fleet[record.handleIndex];
+                    instance.handle = {record.handleIndex, record.handleGeneration};
+                    instance.type = static_cast<VNFType>(record.vnfType);
+                    instance.state = static_cast<VNFState>(record.toState);
+                    instance.instanceId = name(record.instance);
+                    instance.location = name(record.toLocation);
+                    break;
+                }
+                case VNFChangeKind::DESTROYED:
+                    fleet.erase(record.handleIndex);
+                    break;
+                case VNFChangeKind::RELOCATED:
+                case VNFChangeKind::STATE_CHANGED: {
+                    auto it = fleet.find(record.handleIndex);
+                    if (it != fleet.end()) {
+                        it->second.location = name(record.toLocation);
+                        it->second.state = static_cast<VNFState>(record.toState);
+                    }
+                    break;
+                }
+            }
+        } else {
+            continue;   // Names are indexed; later snapshots repeat what was replayed
+        }
+        state.recordsReplayed++;
+    }
+
+    state.instances.reserve(fleet.size());
+    for (auto& entry : fleet) {
+        state.instances.push_back(std::move(entry.second));
+    }
+    std::sort(state.instances.begin(), state.instances.end(),
+              [](const JournalInstance& a, const JournalInstance& b) { return a.handle.index < b.handle.index; });
+    return true;
+}
+
+void DecisionJournal::decisionsBetween(double from, double to, std::vector<JournalDecision>& out) const {
+    if (!mapping_) return;
+
+    const char* data = static_cast<const char*>(mapping_);
+    const SnapshotIndex* snapshot = nullptr;
+    size_t offset = seek(from, &snapshot, true);
+
+    while (offset < end_) {
+        RecordHeader header = load<RecordHeader>(data + offset);
+        if (header.time > to) break;
+        const char* payload = data + offset + sizeof(RecordHeader);
+        offset += sizeof(RecordHeader) + header.length;
+        if (header.kind != DECISION || header.time < from) continue;
+
+        DecisionRecord record = load<DecisionRecord>(payload);
+        JournalDecision decision;
+        decision.sequence = record.sequence;
+        decision.time = header.time;
+        decision.reason = name(record.reason);
+        decision.action = name(record.action);
+        decision.type = static_cast<VNFType>(record.vnfType);
+        decision.source = name(record.source);
+        decision.target = name(record.target);
+        decision.targetInstances = record.targetInstances;
+        decision.priority = record.priority;
+        decision.verdict = static_cast<GovernorVerdict>(record.verdict);
+        out.push_back(std::move(decision));
+    }
+}
+
+} // namespace cosim
@@ -0,0 +1,229 @@
+/*
+Binary NFV decision journal
+Every governed NFVDecision and every registry lifecycle change it caused is
+appended to a compact binary journal, stamped with the leader's simulation time.
+Strings (reason keys, actions, locations, instance ids) are interned into a
+dictionary that is written inline the first time a name is used, so a decision
+costs a fixed-size record instead of its free-text reason.
+
+The writer also drops a full snapshot of the fleet every few simulated seconds.
+The reader indexes the snapshots when it opens a journal, so the fleet at any
+simulation time is rebuilt from the nearest earlier snapshot plus the changes
+after it, without re-running the simulation.
+
+File layout (little-endian):
+  header : "CSNFVJNL" | uint32 version | uint32 reserved
+  record : RecordHeader | payload[length]
+    NAME     : uint32 id | char name[length - 4]
+    DECISION : DecisionRecord
+    CHANGE   : ChangeRecord
+    SNAPSHOT : SnapshotHeader | SnapshotInstance[count]
+Name ids start at 1; 0 means "none".
+*/
+
+#ifndef DECISION_JOURNAL_H
+#define DECISION_JOURNAL_H
+
+#include "decision_governor.h"
+#include "nfv_decision.h"
+#include "vnf_registry.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace cosim {
+
+namespace decisionjournal {
+
+constexpr char FILE_MAGIC[8] = {'C', 'S', 'N', 'F', 'V', 'J', 'N', 'L'};
+constexpr uint32_t FORMAT_VERSION = 1;
+constexpr double DEFAULT_SNAPSHOT_INTERVAL = 10.0;   // Simulation seconds
+constexpr uint64_t SNAPSHOT_MAX_RECORDS = 1024;      // Also bounds the replay work per seek
+
+enum RecordKind : uint8_t {
+    NAME = 1,
+    DECISION = 2,
+    CHANGE = 3,
+    SNAPSHOT = 4
+};
+
+struct RecordHeader {
+    uint8_t kind;
+    uint8_t reserved[3];
+    uint32_t length;        // Payload bytes
+    double time;
+};
+
+struct DecisionRecord {
+    uint64_t sequence;      // 1-based, in journal order
+    uint32_t reason;        // Name id of the reason key
+    uint32_t action;
+    uint32_t source;
+    uint32_t target;
+    int32_t targetInstances;
+    uint8_t vnfType;
+    uint8_t priority;
+    uint8_t verdict;        // GovernorVerdict
+    uint8_t reserved;
+};
+
+struct ChangeRecord {
+    uint64_t decision;      // Sequence of the decision that caused it; 0 for none
+    uint32_t handleIndex;
+    uint32_t handleGeneration;
+    uint32_t fromLocation;  // Name ids
+    uint32_t toLocation;
+    uint32_t instance;      // Name id of the instance id; CREATED only
+    uint8_t kind;           // VNFChangeKind
+    uint8_t vnfType;
+    uint8_t fromState;
+    uint8_t toState;
+};
+
+struct SnapshotHeader {
+    uint64_t decisions;     // Decisions journaled so far
+    uint64_t admitted;
+    uint32_t count;
+    uint32_t reserved;
+};
+
+struct SnapshotInstance {
+    uint32_t handleIndex;
+    uint32_t handleGeneration;
+    uint32_t location;
+    uint32_t instance;
+    uint8_t vnfType;
+    uint8_t state;
+    uint8_t reserved[2];
+};
+
+static_assert(sizeof(RecordHeader) == 16, "journal record header must stay packed");
+static_assert(sizeof(DecisionRecord) == 32, "journal decision record must stay packed");
+static_assert(sizeof(ChangeRecord) == 32, "journal change record must stay packed");
+static_assert(sizeof(SnapshotHeader) == 24, "journal snapshot header must stay packed");
+static_assert(sizeof(SnapshotInstance) == 20, "journal snapshot instance must stay packed");
+
+} // namespace decisionjournal
+
+class DecisionJournalWriter {
+public:
+    DecisionJournalWriter() = default;
+    ~DecisionJournalWriter() { close(); }
+
+    DecisionJournalWriter(const DecisionJournalWriter&) = delete;
+    DecisionJournalWriter& operator=(const DecisionJournalWriter&) = delete;
+
+    bool open(const std::string& filename, double snapshotInterval = decisionjournal::DEFAULT_SNAPSHOT_INTERVAL);
+    bool isOpen() const { return file_ != nullptr; }
+    void close();
+
+    // Returns the decision's sequence number, for the changes it causes
+    uint64_t appendDecision(double time, const NFVDecision& decision, GovernorVerdict verdict);
+    void appendChanges(const VNFRegistry& registry, const std::vector<VNFChange>& changes, uint64_t decision);
+
+    bool snapshotDue(double time) const;
+    void snapshot(double time, const VNFRegistry& registry);
+
+    uint64_t decisions() const { return decisions_; }
+    uint64_t bytesWritten() const { return bytesWritten_; }
+
+private:
+    uint32_t intern(double time, const std::string& name);
+    uint32_t internLocation(double time, const VNFRegistry& registry, uint32_t location);
+    void writeRecord(uint8_t kind, double time, const void* payload, uint32_t length,
+                     const void* extra = nullptr, uint32_t extraLength = 0);
+
+    std::FILE* file_ = nullptr;
+    double snapshotInterval_ = decisionjournal::DEFAULT_SNAPSHOT_INTERVAL;
+    double lastSnapshot_ = 0.0;
+    uint64_t recordsSinceSnapshot_ = 0;
+    uint64_t decisions_ = 0;
+    uint64_t admitted_ = 0;
+    uint64_t bytesWritten_ = 0;
+
+    std::unordered_map<std::string, uint32_t> names_;
+    std::vector<uint32_t> locationNames_;   // Registry location id -> name id, 0 until interned
+};
+
+// One instance of a reconstructed fleet
+struct JournalInstance {
+    VNFHandle handle;
+    VNFType type = VNFType::NDN_ROUTER;
+    VNFState state = VNFState::ACTIVE;
+    std::string instanceId;
+    std::string location;
+};
+
+struct JournalDecision {
+    uint64_t sequence = 0;
+    double time = 0.0;
+    std::string reason;
+    std::string action;
+    VNFType type = VNFType::NDN_ROUTER;
+    std::string source;
+    std::string target;
+    int targetInstances = 0;
+    int priority = 3;
+    GovernorVerdict verdict = GovernorVerdict::ADMIT;
+};
+
+// Orchestrator state at one simulation time
+struct JournalState {
+    double time = 0.0;
+    double snapshotTime = 0.0;      // Snapshot the state was rebuilt from
+    size_t recordsReplayed = 0;     // Records applied on top of it
+    uint64_t decisions = 0;
+    uint64_t admitted = 0;
+    std::vector<JournalInstance> instances;   // By handle index
+};
+
+class DecisionJournal {
+public:
+    DecisionJournal() = default;
+    ~DecisionJournal() { close(); }
+
+    DecisionJournal(const DecisionJournal&) = delete;
+    DecisionJournal& operator=(const DecisionJournal&) = delete;
+
+    // Maps the journal and indexes its snapshots and names; a record cut short or inconsistent ends it
+    bool open(const std::string& filename);
+    void close();
+
+    double startTime() const { return startTime_; }
+    double endTime() const { return endTime_; }
+    uint64_t decisionCount() const { return decisionCount_; }
+    size_t snapshotCount() const { return snapshots_.size(); }
+    const std::string& name(uint32_t id) const;
+
+    // Fleet and decision counts after every record stamped at or before `time`
+    bool stateAt(double time, JournalState& state) const;
+
+    // Decisions stamped in [from, to], in journal order
+    void decisionsBetween(double from, double to, std::vector<JournalDecision>& out) const;
+
+private:
+    struct SnapshotIndex {
+        double time;
+        size_t offset;      // Of the record header
+    };
+
+    // Offset of the last snapshot at or before `time` (strictly before it when `strict`,
+    // since records stamped at a snapshot's time may precede it), or of the first record
+    size_t seek(double time, const SnapshotIndex** snapshot, bool strict = false) const;
+
+    void* mapping_ = nullptr;
+    size_t mappedBytes_ = 0;
+    size_t end_ = 0;                // End of the last complete record
+    std::vector<std::string> names_;
+    std::vector<SnapshotIndex> snapshots_;
+    double startTime_ = 0.0;
+    double endTime_ = 0.0;
+    uint64_t decisionCount_ = 0;
+};
+
+} // namespace cosim
+
+#endif // DECISION_JOURNAL_H
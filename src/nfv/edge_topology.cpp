@@ -0,0 +1,194 @@
+/*
+Implementation of the edge infrastructure model
+*/
+
+#include "edge_topology.h"
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include <jsoncpp/json/json.h>
+
+namespace cosim {
+
+namespace {
+
+// Eight RSUs around the intersection, two edge servers each aggregating four of
+// them, and a regional cloud behind both edges
+const char* DEFAULT_TOPOLOGY = R"({
+  "sites": [
+    {"name": "RSU_0", "tier": "rsu", "cpu": 2, "memory": 4},
+    {"name": "RSU_1", "tier": "rsu", "cpu": 2, "memory": 4},
+    {"name": "RSU_2", "tier": "rsu", "cpu": 2, "memory": 4},
+    {"name": "RSU_3", "tier": "rsu", "cpu": 2, "memory": 4},
+    {"name": "RSU_4", "tier": "rsu", "cpu": 2, "memory": 4},
+    {"name": "RSU_5", "tier": "rsu", "cpu": 2, "memory": 4},
+    {"name": "RSU_6", "tier": "rsu", "cpu": 2, "memory": 4},
+    {"name": "RSU_7", "tier": "rsu", "cpu": 2, "memory": 4},
+    {"name": "EDGE_1", "tier": "edge", "cpu": 16, "memory": 32},
+    {"name": "EDGE_2", "tier": "edge", "cpu": 16, "memory": 32},
+    {"name": "CLOUD_1", "tier": "cloud", "cpu": 256, "memory": 1024}
+  ],
+  "links": [
+    {"from": "RSU_0", "to": "EDGE_1", "latency_ms": 2.0},
+    {"from": "RSU_1", "to": "EDGE_1", "latency_ms": 2.0},
+    {"from": "RSU_2", "to": "EDGE_1", "latency_ms": 2.5},
+    {"from": "RSU_3", "to": "EDGE_1", "latency_ms": 2.5},
+    {"from": "RSU_4", "to": "EDGE_2", "latency_ms": 2.0},
+    {"from": "RSU_5", "to": "EDGE_2", "latency_ms": 2.0},
+    {"from": "RSU_6", "to": "EDGE_2", "latency_ms": 2.5},
+    {"from": "RSU_7", "to": "EDGE_2", "latency_ms": 2.5},
+    {"from": "RSU_0", "to": "RSU_1", "latency_ms": 3.0},
+    {"from": "RSU_2", "to": "RSU_3", "latency_ms": 3.0},
+    {"from": "RSU_4", "to": "RSU_5", "latency_ms": 3.0},
+    {"from": "RSU_6", "to": "RSU_7", "latency_ms": 3.0},
+    {"from": "EDGE_1", "to": "EDGE_2", "latency_ms": 5.0},
+    {"from": "EDGE_1", "to": "CLOUD_1", "latency_ms": 20.0},
+    {"from": "EDGE_2", "to": "CLOUD_1", "latency_ms": 20.0}
+  ]
+})";
+
+bool parseTier(const std::string& name, SiteTier& tier) {
+    if (name == "rsu") {
+        tier = SiteTier::RSU;
+    } else if (name == "edge") {
+        tier = SiteTier::EDGE;
+    } else if (name == "cloud") {
+        tier = SiteTier::CLOUD;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+EdgeTopology::EdgeTopology() {
+    loadDefaults();
+}
+
+const char* EdgeTopology::defaultTopology() {
+    return DEFAULT_TOPOLOGY;
+}
+
+void EdgeTopology::loadDefaults() {
+    std::string error;
+    if (!loadJson(DEFAULT_TOPOLOGY, error)) {
+        std::cerr << "❌ Built-in edge topology failed to load: " << error << std::endl;
+    }
+    source_ = "built-in";
+}
+
+bool EdgeTopology::loadFile(const std::string& path) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        std::cerr << "❌ Cannot open edge topology file " << path << std::endl;
+        return false;
+    }
+
+    std::stringstream text;
+    text << file.rdbuf();
+
+    std::string error;
+    if (!loadJson(text.str(), error)) {
+        std::cerr << "❌ Invalid edge topology file " << path << ": " << error << std::endl;
+        return false;
+    }
+
+    source_ = path;
+    std::cout << "🗺️  Loaded edge topology with " << sites_.size() << " sites from " << path << std::endl;
+    return true;
+}
+
+uint32_t EdgeTopology::findSite(const std::string& name) const {
+    auto it = siteIds_.find(name);
+    return it != siteIds_.end() ? it->second : INVALID_SITE;
+}
+
+bool EdgeTopology::loadJson(const std::string& text, std::string& error) {
+    Json::Value root;
+    Json::CharReaderBuilder builder;
+    std::istringstream stream(text);
+    if (!Json::parseFromStream(builder, stream, &root, &error)) {
+        return false;
+    }
+
+    const Json::Value& siteList = root["sites"];
+    if (!siteList.isArray() || siteList.empty()) {
+        error = "missing \"sites\" array";
+        return false;
+    }
+
+    // Build into scratch tables so a bad file leaves the current model in place
+    std::vector<EdgeSite> sites;
+    std::unordered_map<std::string, uint32_t> siteIds;
+
+    for (const auto& entry : siteList) {
+        EdgeSite site;
+        site.name = entry.get("name", "").asString();
+        if (site.name.empty()) {
+            error = "site without a name";
+            return false;
+        }
+        if (!parseTier(entry.get("tier", "edge").asString(), site.tier)) {
+            error = "site " + site.name + ": unknown tier";
+            return false;
+        }
+        site.cpuCapacity = entry.get("cpu", 0.0).asDouble();
+        site.memoryCapacity = entry.get("memory", 0.0).asDouble();
+        if (site.cpuCapacity < 0.0 || site.memoryCapacity < 0.0) {
+            error = "site " + site.name + ": negative capacity";
+            return false;
+        }
+        if (!siteIds.emplace(site.name, static_cast<uint32_t>(sites.size())).second) {
+            error = "duplicate site " + site.name;
+            return false;
+        }
+        sites.push_back(site);
+    }
+
+    const size_t n = sites.size();
+    std::vector<double> latency(n * n, std::numeric_limits<double>::infinity());
+    for (size_t i = 0; i < n; ++i) {
+        latency[i * n + i] = 0.0;
+    }
+
+    for (const auto& link : root["links"]) {
+        auto from = siteIds.find(link.get("from", "").asString());
+        auto to = siteIds.find(link.get("to", "").asString());
+        if (from == siteIds.end() || to == siteIds.end()) {
+            error = "link between unknown sites";
+            return false;
+        }
+        double ms = link.get("latency_ms", 0.0).asDouble();
+        if (ms < 0.0) {
+            error = "negative link latency";
+            return false;
+        }
+        size_t a = from->second;
+        size_t b = to->second;
+        latency[a * n + b] = std::min(latency[a * n + b], ms);
+        latency[b * n + a] = std::min(latency[b * n + a], ms);
+    }
+
+    // Floyd-Warshall; topologies are tens to hundreds of sites
+    for (size_t k = 0; k < n; ++k) {
+        const double* rowK = &latency[k * n];
+        for (size_t i = 0; i < n; ++i) {
+            double viaK = latency[i * n + k];
+            if (viaK == std::numeric_limits<double>::infinity()) continue;
+            double* rowI = &latency[i * n];
+            for (size_t j = 0; j < n; ++j) {
+                rowI[j] = std::min(rowI[j], viaK + rowK[j]);
+            }
+        }
+    }
+
+    sites_ = std::move(sites);
+    siteIds_ = std::move(siteIds);
+    latencyMs_ = std::move(latency);
+    return true;
+}
+
+} // namespace cosim
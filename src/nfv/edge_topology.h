@@ -0,0 +1,76 @@
+/*
+Edge infrastructure model for VNF placement
+Sites (RSUs, edge servers, the regional cloud) carry CPU and memory capacity and
+are indexed densely; the site-to-site latency matrix is stored row-major so the
+placement solver reads one contiguous row per demand point. Links are declared
+pairwise and closed into end-to-end latencies with all-pairs shortest paths.
+
+Topology file format:
+{
+  "sites": [
+    {"name": "RSU_1", "tier": "rsu", "cpu": 2, "memory": 4},
+    {"name": "EDGE_1", "tier": "edge", "cpu": 16, "memory": 32}
+  ],
+  "links": [
+    {"from": "RSU_1", "to": "EDGE_1", "latency_ms": 2.0}
+  ]
+}
+
+Site names match VNF locations and NodeMetricsMatrix::locationName() for RSUs.
+*/
+
+#ifndef EDGE_TOPOLOGY_H
+#define EDGE_TOPOLOGY_H
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace cosim {
+
+enum class SiteTier : uint8_t {
+    RSU,
+    EDGE,
+    CLOUD
+};
+
+struct EdgeSite {
+    std::string name;
+    SiteTier tier = SiteTier::EDGE;
+    double cpuCapacity = 0.0;     // Cores
+    double memoryCapacity = 0.0;  // GB
+};
+
+class EdgeTopology {
+public:
+    static constexpr uint32_t INVALID_SITE = 0xffffffffu;
+
+    // Starts with the built-in intersection topology
+    EdgeTopology();
+
+    bool loadFile(const std::string& path);
+    bool loadJson(const std::string& text, std::string& error);
+    void loadDefaults();
+
+    size_t siteCount() const { return sites_.size(); }
+    const EdgeSite& site(uint32_t id) const { return sites_[id]; }
+    uint32_t findSite(const std::string& name) const;
+    const std::string& source() const { return source_; }
+
+    // End-to-end latency in ms; unreachable pairs are infinite
+    double latency(uint32_t from, uint32_t to) const { return latencyMs_[from * sites_.size() + to]; }
+    const double* latencyRow(uint32_t from) const { return &latencyMs_[from * sites_.size()]; }
+
+    static const char* defaultTopology();
+
+private:
+    std::vector<EdgeSite> sites_;
+    std::vector<double> latencyMs_;   // siteCount x siteCount, row-major
+    std::unordered_map<std::string, uint32_t> siteIds_;
+    std::string source_;
+};
+
+} // namespace cosim
+
+#endif // EDGE_TOPOLOGY_H
@@ -0,0 +1,129 @@
+/*
+Implementation of the streaming metrics forecaster
+*/
+
+#include "metrics_forecaster.h"
+#include <algorithm>
+#include <cmath>
+
+namespace cosim {
+
+// =============================================================================
+// HoltWinters
+// =============================================================================
+
+HoltWinters::HoltWinters(const ForecastConfig& config) : config_(config) {
+    if (config_.seasonPeriod > 0.0 && config_.seasonSlots > 0) {
+        seasonal_.assign(config_.seasonSlots, 0.0);
+    }
+}
+
+size_t HoltWinters::slot(double time) const {
+    double phase = std::fmod(time, config_.seasonPeriod) / config_.seasonPeriod;
+    if (phase < 0.0) phase += 1.0;
+    return std::min(seasonal_.size() - 1, static_cast<size_t>(phase * seasonal_.size()));
+}
+
+void HoltWinters::update(double time, double value) {
+    double* season = seasonal_.empty() ? nullptr : &seasonal_[slot(time)];
+    double seasonal = season ? *season : 0.0;
+
+    if (samples_ == 0) {
+        level_ = value - seasonal;
+        trend_ = 0.0;
+        lastTime_ = time;
+        samples_ = 1;
+        return;
+    }
+
+    // Reports sharing a timestamp refine the level without skewing the trend
+    double dt = std::max(0.0, time - lastTime_);
+    double level = config_.alpha * (value - seasonal) + (1.0 - config_.alpha) * (level_ + trend_ * dt);
+    if (dt > 0.0) {
+        trend_ = config_.beta * (level - level_) / dt + (1.0 - config_.beta) * trend_;
+    }
+    level_ = level;
+    if (season) {
+        *season = config_.gamma * (value - level) + (1.0 - config_.gamma) * seasonal;
+    }
+
+    lastTime_ = std::max(lastTime_, time);
+    samples_++;
+}
+
+double HoltWinters::forecast(double horizon) const {
+    double value = level_ + trend_ * horizon;
+    if (!seasonal_.empty()) {
+        value += seasonal_[slot(lastTime_ + horizon)];
+    }
+    return value;
+}
+
+// =============================================================================
+// MetricsForecaster
+// =============================================================================
+
+MetricsForecaster::MetricsForecaster(const ForecastConfig& config) {
+    configure(config);
+}
+
+void MetricsForecaster::configure(const ForecastConfig& config) {
+    config_ = config;
+    pit_ = HoltWinters(config);
+    fib_ = HoltWinters(config);
+    cacheHit_ = HoltWinters(config);
+    interests_ = HoltWinters(config);
+    data_ = HoltWinters(config);
+    latency_ = HoltWinters(config);
+    unsatisfied_ = HoltWinters(config);
+    utilization_ = HoltWinters(config);
+    nodeRates_.clear();
+}
+
+void MetricsForecaster::update(double time, const NDNMetrics& metrics) {
+    pit_.update(time, metrics.pitSize);
+    fib_.update(time, metrics.fibEntries);
+    cacheHit_.update(time, metrics.cacheHitRatio);
+    interests_.update(time, static_cast<double>(metrics.interestCount));
+    data_.update(time, static_cast<double>(metrics.dataCount));
+    latency_.update(time, metrics.avgLatency);
+    unsatisfied_.update(time, metrics.unsatisfiedInterests);
+    utilization_.update(time, metrics.networkUtilization);
+}
+
+NDNMetrics MetricsForecaster::forecast(double horizon) const {
+    auto count = [horizon](const HoltWinters& series) {
+        return std::max(0.0, std::round(series.forecast(horizon)));
+    };
+    auto ratio = [horizon](const HoltWinters& series) {
+        return std::min(1.0, std::max(0.0, series.forecast(horizon)));
+    };
+
+    NDNMetrics metrics;
+    metrics.pitSize = static_cast<uint32_t>(count(pit_));
+    metrics.fibEntries = static_cast<uint32_t>(count(fib_));
+    metrics.cacheHitRatio = ratio(cacheHit_);
+    metrics.interestCount = static_cast<uint64_t>(count(interests_));
+    metrics.dataCount = static_cast<uint64_t>(count(data_));
+    metrics.avgLatency = std::max(0.0, latency_.forecast(horizon));
+    metrics.unsatisfiedInterests = static_cast<uint32_t>(count(unsatisfied_));
+    metrics.networkUtilization = ratio(utilization_);
+    metrics.timestamp = pit_.lastTime() + horizon;
+    return metrics;
+}
+
+void MetricsForecaster::updateNode(uint32_t nodeId, double time, double interestRate) {
+    if (nodeId >= nodeRates_.size()) {
+        nodeRates_.resize(nodeId + 1, HoltWinters(config_));
+    }
+    nodeRates_[nodeId].update(time, interestRate);
+}
+
+double MetricsForecaster::forecastNodeRate(uint32_t nodeId, double horizon) const {
+    if (nodeId >= nodeRates_.size() || nodeRates_[nodeId].samples() < config_.warmupSamples) {
+        return -1.0;
+    }
+    return std::max(0.0, nodeRates_[nodeId].forecast(horizon));
+}
+
+} // namespace cosim
@@ -0,0 +1,86 @@
+/*
+Streaming forecaster for the NDN metrics series
+Each series is tracked by an additive Holt-Winters model (level, trend and an
+optional seasonal profile) that takes irregularly spaced samples: the trend is
+kept per second of simulation time and the seasonal profile is binned by phase
+within a fixed period, e.g. the traffic-light cycle of the intersection. An
+update is O(1) per series, so the whole report and every node's Interest rate
+can be folded in at the sync rate.
+*/
+
+#ifndef METRICS_FORECASTER_H
+#define METRICS_FORECASTER_H
+
+#include "message.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace cosim {
+
+struct ForecastConfig {
+    double alpha = 0.5;          // Level smoothing
+    double beta = 0.2;           // Trend smoothing
+    double gamma = 0.3;          // Seasonal smoothing
+    double seasonPeriod = 0.0;   // Seconds; 0 disables the seasonal term
+    size_t seasonSlots = 24;     // Phase bins per period
+    size_t warmupSamples = 8;    // Samples before forecasts are trusted
+};
+
+class HoltWinters {
+public:
+    explicit HoltWinters(const ForecastConfig& config = ForecastConfig());
+
+    void update(double time, double value);
+    double forecast(double horizon) const;  // Value expected `horizon` seconds after the last sample
+    uint64_t samples() const { return samples_; }
+    double lastTime() const { return lastTime_; }
+
+private:
+    size_t slot(double time) const;
+
+    ForecastConfig config_;
+    double level_ = 0.0;
+    double trend_ = 0.0;          // Per second
+    double lastTime_ = 0.0;
+    uint64_t samples_ = 0;
+    std::vector<double> seasonal_;
+};
+
+class MetricsForecaster {
+public:
+    explicit MetricsForecaster(const ForecastConfig& config = ForecastConfig());
+
+    // Drops all history
+    void configure(const ForecastConfig& config);
+    const ForecastConfig& config() const { return config_; }
+
+    // Aggregate report; time is simulation seconds
+    void update(double time, const NDNMetrics& metrics);
+    bool ready() const { return pit_.samples() >= config_.warmupSamples; }
+
+    // Emergency and safety message counts are events, not load, and forecast as zero
+    NDNMetrics forecast(double horizon) const;
+
+    // Per-node Interest rate, indexed densely by ndnSIM node id
+    void updateNode(uint32_t nodeId, double time, double interestRate);
+    double forecastNodeRate(uint32_t nodeId, double horizon) const;  // Negative if the node is not warmed up
+
+private:
+    ForecastConfig config_;
+
+    HoltWinters pit_;
+    HoltWinters fib_;
+    HoltWinters cacheHit_;
+    HoltWinters interests_;
+    HoltWinters data_;
+    HoltWinters latency_;
+    HoltWinters unsatisfied_;
+    HoltWinters utilization_;
+
+    std::vector<HoltWinters> nodeRates_;
+};
+
+} // namespace cosim
+
+#endif // METRICS_FORECASTER_H
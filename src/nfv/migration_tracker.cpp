@@ -0,0 +1,247 @@
+/*
+Implementation of the in-flight migration model and its timer wheel
+*/
+
+#include "migration_tracker.h"
+#include <algorithm>
+#include <cmath>
+
+namespace cosim {
+
+const char* migrationStrategyName(MigrationStrategy strategy) {
+    switch (strategy) {
+        case MigrationStrategy::PRE_COPY: return "pre-copy";
+        case MigrationStrategy::POST_COPY: return "post-copy";
+        default: return "unknown";
+    }
+}
+
+bool parseMigrationStrategy(const std::string& name, MigrationStrategy& strategy) {
+    if (name == "pre-copy" || name == "pre_copy" || name == "precopy") {
+        strategy = MigrationStrategy::PRE_COPY;
+        return true;
+    }
+    if (name == "post-copy" || name == "post_copy" || name == "postcopy") {
+        strategy = MigrationStrategy::POST_COPY;
+        return true;
+    }
+    return false;
+}
+
+MigrationTracker::MigrationTracker(const MigrationConfig& config) : wheel_(WHEEL_SLOTS) {
+    configure(config);
+}
+
+void MigrationTracker::configure(const MigrationConfig& config) {
+    config_ = config;
+    if (!(config_.tickSeconds > 0.0)) {
+        config_.tickSeconds = MigrationConfig().tickSeconds;
+    }
+}
+
+bool MigrationTracker::start(double now, VNFHandle handle, VNFType type, const std::string& source,
+                             const std::string& target, double cores, double stateBytes, double cpu) {
+    if (handle.index >= byHandle_.size()) {
+        byHandle_.resize(handle.index + 1, 0);
+    }
+    if (byHandle_[handle.index] != 0) {
+        return false;
+    }
+
+    uint32_t slot;
+    if (freeHead_ != 0) {
+        slot = freeHead_ - 1;
+        freeHead_ = slots_[slot].nextFree;
+    } else {
+        slot = static_cast<uint32_t>(slots_.size());
+        slots_.emplace_back();
+    }
+
+    Slot& entry = slots_[slot];
+    entry.live = true;
+    entry.nextFree = 0;
+    Migration& migration = entry.migration;
+    migration = Migration();
+    migration.handle = handle;
+    migration.type = type;
+    migration.strategy = config_.strategy;
+    migration.phase = MigrationPhase::COPYING;
+    migration.source = source;
+    migration.target = target;
+    migration.cores = cores;
+    migration.stateBytes = std::max(0.0, stateBytes);
+    migration.start = now;
+    plan(migration, cpu);
+
+    byHandle_[handle.index] = slot + 1;
+    ++active_;
+    ++started_;
+    reservedCores_ += cores;
+    schedule(slot, nextChange(migration));
+    return true;
+}
+
+// Closed-form schedule: pre-copy rounds shrink geometrically while the dirty rate
+// stays below the bandwidth; once a round no longer shrinks, iterating is pointless
+// and the instance stops for whatever is dirty
+void MigrationTracker::plan(Migration& migration, double cpu) const {
+    const double bytesPerSecond = config_.bandwidthMbps * 1e6 / 8.0;
+    const double state = migration.stateBytes;
+    auto seconds = [bytesPerSecond](double bytes) { return bytesPerSecond > 0.0 ? bytes / bytesPerSecond : 0.0; };
+
+    if (migration.strategy == MigrationStrategy::POST_COPY) {
+        migration.rounds = 1;
+        migration.transferBytes = state;
+        migration.downtimeStart = migration.start;
+        migration.downtimeEnd = migration.start + config_.switchoverSeconds;
+        migration.end = migration.downtimeEnd + seconds(state);
+        return;
+    }
+
+    const double dirtyPerSecond = config_.dirtyRate * std::min(1.0, std::max(0.0, cpu)) * state;
+    double send = state;
+    double elapsed = 0.0;
+    double total = 0.0;
+    int rounds = 0;
+    while (true) {
+        const double round = seconds(send);
+        elapsed += round;
+        total += send;
+        ++rounds;
+        const double dirty = std::min(state, dirtyPerSecond * round);
+        const bool converging = dirty < send;
+        send = dirty;
+        if (send <= config_.stopCopyBytes || !converging || rounds >= config_.maxRounds) {
+            break;
+        }
+    }
+
+    migration.rounds = rounds;
+    migration.transferBytes = total + send;
+    migration.downtimeStart = migration.start + elapsed;
+    migration.downtimeEnd = migration.downtimeStart + seconds(send) + config_.switchoverSeconds;
+    migration.end = migration.downtimeEnd;
+}
+
+double MigrationTracker::nextChange(const Migration& migration) const {
+    switch (migration.phase) {
+        case MigrationPhase::COPYING: return migration.downtimeStart;
+        case MigrationPhase::DOWNTIME: return migration.downtimeEnd;
+        default: return migration.end;
+    }
+}
+
+int64_t MigrationTracker::tickOf(double time) const {
+    return static_cast<int64_t>(std::floor(time / config_.tickSeconds));
+}
+
+void MigrationTracker::schedule(uint32_t slot, double time) {
+    const int64_t tick = std::max(tickOf(time), visited_ + 1);
+    wheel_[static_cast<size_t>(tick) % WHEEL_SLOTS].push_back({slot, slots_[slot].generation, tick});
+}
+
+void MigrationTracker::advance(double now, std::vector<MigrationEvent>& events) {
+    const int64_t nowTick = tickOf(now);
+    if (nowTick <= visited_) {
+        return;
+    }
+
+    // Every slot at most once, however long since the last call
+    const int64_t first = std::max(visited_ + 1, nowTick - static_cast<int64_t>(WHEEL_SLOTS) + 1);
+    firing_.clear();
+    for (int64_t tick = first; tick <= nowTick; ++tick) {
+        auto& bucket = wheel_[static_cast<size_t>(tick) % WHEEL_SLOTS];
+        size_t kept = 0;
+        for (const Timer& timer : bucket) {
+            if (timer.tick > nowTick) {
+                bucket[kept++] = timer;
+            } else if (slots_[timer.slot].live && slots_[timer.slot].generation == timer.generation) {
+                firing_.push_back(timer);
+            }
+        }
+        bucket.resize(kept);
+    }
+
+    // The current tick stays open: later changes inside it are scheduled back into it
+    visited_ = nowTick - 1;
+
+    for (const Timer& timer : firing_) {
+        Migration& migration = slots_[timer.slot].migration;
+        while (migration.phase != MigrationPhase::DONE && nextChange(migration) <= now) {
+            const double time = nextChange(migration);
+            switch (migration.phase) {
+                case MigrationPhase::COPYING:
+                    migration.phase = MigrationPhase::DOWNTIME;
+                    break;
+                case MigrationPhase::DOWNTIME:
+                    migration.phase = migration.end > migration.downtimeEnd ? MigrationPhase::POST_COPYING
+                                                                            : MigrationPhase::DONE;
+                    break;
+                default:
+                    migration.phase = MigrationPhase::DONE;
+                    break;
+            }
+            events.push_back({migration, time});
+        }
+
+        if (migration.phase == MigrationPhase::DONE) {
+            retire(timer.slot, true);
+        } else {
+            schedule(timer.slot, nextChange(migration));
+        }
+    }
+}
+
+void MigrationTracker::cancel(VNFHandle handle) {
+    const Migration* migration = of(handle);
+    if (migration) {
+        retire(byHandle_[handle.index] - 1, false);
+    }
+}
+
+void MigrationTracker::retire(uint32_t slot, bool finished) {
+    Slot& entry = slots_[slot];
+    const Migration& migration = entry.migration;
+    if (finished) {
+        ++completed_;
+        transferredBytes_ += migration.transferBytes;
+        transferSeconds_ += migration.end - migration.start;
+        downtimeSeconds_ += migration.downtimeEnd - migration.downtimeStart;
+    }
+
+    byHandle_[migration.handle.index] = 0;
+    --active_;
+    reservedCores_ = active_ > 0 ? reservedCores_ - migration.cores : 0.0;
+
+    // Stale timers of this slot are dropped by the generation check
+    entry.live = false;
+    ++entry.generation;
+    entry.nextFree = freeHead_;
+    freeHead_ = slot + 1;
+}
+
+const Migration* MigrationTracker::of(VNFHandle handle) const {
+    if (handle.index >= byHandle_.size() || byHandle_[handle.index] == 0) {
+        return nullptr;
+    }
+    const Migration& migration = slots_[byHandle_[handle.index] - 1].migration;
+    return migration.handle == handle ? &migration : nullptr;
+}
+
+double MigrationTracker::stall(VNFHandle handle, double now) const {
+    const Migration* migration = of(handle);
+    if (!migration || migration->phase != MigrationPhase::DOWNTIME) {
+        return 0.0;
+    }
+    return std::max(0.0, migration->downtimeEnd - now);
+}
+
+double MigrationTracker::serviceFactor(VNFHandle handle) const {
+    const Migration* migration = of(handle);
+    if (!migration || migration->phase != MigrationPhase::POST_COPYING) {
+        return 1.0;
+    }
+    return config_.postCopySpeed;
+}
+
+} // namespace cosim
@@ -0,0 +1,153 @@
+/*
+In-flight VNF migrations
+A MIGRATE no longer relocates an instance instantly. Each migration is planned
+from the instance's state size, how fast it dirties that state and the backhaul
+bandwidth it may use, following one of two strategies:
+
+  PRE_COPY : the source keeps serving while the state is copied in rounds,
+             each round resending what the previous one dirtied; the instance
+             then stops for the final dirty set and switches over
+  POST_COPY: the instance stops only to switch over, then serves from the
+             target at reduced speed while the rest of its state is pulled
+
+Phase changes are kept in a hashed timer wheel keyed by simulation time, so
+advancing costs the ticks that passed plus the migrations that changed phase,
+however many are in flight. Per-instance queries are O(1) by handle index.
+*/
+
+#ifndef MIGRATION_TRACKER_H
+#define MIGRATION_TRACKER_H
+
+#include "vnf_registry.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace cosim {
+
+enum class MigrationStrategy : uint8_t {
+    PRE_COPY,
+    POST_COPY
+};
+
+enum class MigrationPhase : uint8_t {
+    COPYING,        // Pre-copy rounds; the source still serves
+    DOWNTIME,       // Neither side serves
+    POST_COPYING,   // Serving from the target while state is pulled
+    DONE
+};
+
+const char* migrationStrategyName(MigrationStrategy strategy);
+bool parseMigrationStrategy(const std::string& name, MigrationStrategy& strategy);
+
+struct MigrationConfig {
+    MigrationStrategy strategy = MigrationStrategy::PRE_COPY;
+    double bandwidthMbps = 1000.0;      // Backhaul share per migration; 0 migrates instantly
+    double dirtyRate = 0.2;             // Share of the state rewritten per second at full CPU
+    double stopCopyBytes = 8e6;         // Pre-copy stops iterating below this dirty set
+    int maxRounds = 8;                  // Pre-copy rounds before forcing the stop
+    double switchoverSeconds = 0.05;    // Re-pointing faces and routes at the target
+    double postCopySpeed = 0.5;         // Service rate while post-copy faults pull state
+    double tickSeconds = 0.1;           // Timer wheel resolution
+};
+
+struct Migration {
+    VNFHandle handle;
+    VNFType type = VNFType::NDN_ROUTER;
+    MigrationStrategy strategy = MigrationStrategy::PRE_COPY;
+    MigrationPhase phase = MigrationPhase::COPYING;
+    std::string source;
+    std::string target;
+    double cores = 0.0;             // Reserved at the target while in flight
+    double stateBytes = 0.0;
+    double transferBytes = 0.0;     // State plus every resent dirty set
+    int rounds = 0;
+    double start = 0.0;
+    double downtimeStart = 0.0;
+    double downtimeEnd = 0.0;
+    double end = 0.0;
+};
+
+// A migration entering `migration.phase`; a copy, as finished migrations are retired
+struct MigrationEvent {
+    Migration migration;
+    double time;
+};
+
+class MigrationTracker {
+public:
+    static constexpr size_t WHEEL_SLOTS = 512;
+
+    explicit MigrationTracker(const MigrationConfig& config = MigrationConfig());
+
+    // Only affects migrations started afterwards
+    void configure(const MigrationConfig& config);
+    const MigrationConfig& config() const { return config_; }
+    bool instant() const { return config_.bandwidthMbps <= 0.0; }
+
+    // Plans a migration of `handle`; false when the instance is already in flight
+    bool start(double now, VNFHandle handle, VNFType type, const std::string& source,
+                   const std::string& target, double cores, double stateBytes, double cpu);
+
+    // Appends every phase change due by `now`, in time order per migration, and retires
+    // finished migrations
+    void advance(double now, std::vector<MigrationEvent>& events);
+
+    // Drops the migration of a destroyed instance
+    void cancel(VNFHandle handle);
+
+    const Migration* of(VNFHandle handle) const;
+    bool inFlight(VNFHandle handle) const { return of(handle) != nullptr; }
+    double stall(VNFHandle handle, double now) const;       // Remaining downtime, seconds
+    double serviceFactor(VNFHandle handle) const;           // Service rate multiplier
+
+    // Totals
+    size_t active() const { return active_; }
+    double reservedCores() const { return reservedCores_; }
+    uint64_t started() const { return started_; }
+    uint64_t completed() const { return completed_; }
+    double transferredBytes() const { return transferredBytes_; }   // Of completed migrations
+    double transferSeconds() const { return transferSeconds_; }
+    double downtimeSeconds() const { return downtimeSeconds_; }
+
+private:
+    struct Slot {
+        Migration migration;
+        uint32_t generation = 0;
+        uint32_t nextFree = 0;      // 1-based; 0 ends the free list
+        bool live = false;
+    };
+
+    struct Timer {
+        uint32_t slot;
+        uint32_t generation;
+        int64_t tick;
+    };
+
+    void plan(Migration& migration, double cpu) const;
+    double nextChange(const Migration& migration) const;
+    void schedule(uint32_t slot, double time);
+    void retire(uint32_t slot, bool finished);
+    int64_t tickOf(double time) const;
+
+    MigrationConfig config_;
+    std::vector<Slot> slots_;
+    uint32_t freeHead_ = 0;
+    std::vector<uint32_t> byHandle_;        // Handle index -> slot + 1, 0 when not migrating
+    std::vector<std::vector<Timer>> wheel_;
+    std::vector<Timer> firing_;
+    int64_t visited_ = -1;                  // Ticks up to here are drained; its successor is not
+
+    size_t active_ = 0;
+    double reservedCores_ = 0.0;
+    uint64_t started_ = 0;
+    uint64_t completed_ = 0;
+    double transferredBytes_ = 0.0;
+    double transferSeconds_ = 0.0;
+    double downtimeSeconds_ = 0.0;
+};
+
+} // namespace cosim
+
+#endif // MIGRATION_TRACKER_H
@@ -0,0 +1,42 @@
+/*
+NFV decision produced by the orchestrator's policy and consumed by actuation,
+the follower and the decision governor
+*/
+
+#ifndef NFV_DECISION_H
+#define NFV_DECISION_H
+
+#include "vnf_registry.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace cosim {
+
+// NFV Decision structure
+struct NFVDecision {
+    VNFType vnfType;
+    std::string action; // SCALE_UP, SCALE_DOWN, MIGRATE, OPTIMIZE
+    int targetInstances;
+    std::string sourceLocation;
+    std::string targetLocation;
+    std::string reason;
+    std::string reasonKey; // Stable name of what produced it (rule name, ...); interned by the decision journal
+    double timestamp;
+    int priority; // 1=critical, 2=high, 3=normal
+    
+    // Content Store sizing for OPTIMIZE decisions on CACHE_OPTIMIZER, from the popularity sketches
+    uint32_t cacheCapacity = 0;
+    std::vector<std::string> hotPrefixes;
+    
+    // Per-instance sites for SCALE_UP decisions, from the placement solver
+    std::vector<std::string> placements;
+    
+    // State transfer of an executed MIGRATE, published so the follower can load its backhaul
+    double transferBytes = 0.0;
+    double transferSeconds = 0.0;
+};
+
+} // namespace cosim
+
+#endif // NFV_DECISION_H
@@ -0,0 +1,429 @@
+/*
+Implementation of the compiled NFV rule engine
+*/
+
+#include "nfv_rule_engine.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include <jsoncpp/json/json.h>
+
+namespace cosim {
+
+namespace {
+
+const char* METRIC_NAMES[RULE_METRIC_COUNT] = {
+    "pit_size",
+    "fib_entries",
+    "cache_hit_ratio",
+    "interest_count",
+    "data_count",
+    "avg_latency",
+    "avg_latency_ms",
+    "unsatisfied_interests",
+    "emergency_messages",
+    "safety_messages",
+    "network_utilization"
+};
+
+bool isCountMetric(RuleMetric metric) {
+    switch (metric) {
+        case RuleMetric::CACHE_HIT_RATIO:
+        case RuleMetric::AVG_LATENCY:
+        case RuleMetric::AVG_LATENCY_MS:
+        case RuleMetric::NETWORK_UTILIZATION:
+            return false;
+        default:
+            return true;
+    }
+}
+
+// Built-in policy; identical to the thresholds the orchestrator used to hard-code
+const char* DEFAULT_RULES = R"({
+  "rules": [
+    {
+      "name": "router_pit_pressure",
+      "vnf": "NDNRouter",
+      "action": "SCALE_UP",
+      "when": [{"metric": "pit_size", "op": ">", "value": 100}],
+      "instances": {"metric": "pit_size", "per": 50, "offset": 1, "max": 5},
+      "location": "@optimal",
+      "priority": 2,
+      "escalate": {"when": [{"metric": "emergency_messages", "op": ">", "value": 0}], "priority": 1},
+      "event": "scaling",
+      "reason": "PIT size exceeded threshold: {pit_size}"
+    },
+    {
+      "name": "cache_efficiency",
+      "vnf": "CacheOptimizer",
+      "action": "OPTIMIZE",
+      "when": [{"metric": "cache_hit_ratio", "op": "<", "value": 0.5}],
+      "instances": 1,
+      "location": "EDGE_1",
+      "priority": 3,
+      "reason": "Cache hit ratio below threshold: {cache_hit_ratio}"
+    },
+    {
+      "name": "router_latency_migration",
+      "vnf": "NDNRouter",
+      "action": "MIGRATE",
+      "when": [{"metric": "avg_latency", "op": ">", "value": 0.1}],
+      "instances": 1,
+      "source": "@max_latency_node|RSU_1",
+      "location": "@optimal",
+      "priority": 2,
+      "escalate": {"when": [{"metric": "avg_latency", "op": ">", "value": 0.05}], "priority": 1},
+      "event": "migration",
+      "reason": "High latency: {avg_latency_ms}ms"
+    },
+    {
+      "name": "emergency_security",
+      "vnf": "SecurityVNF",
+      "action": "SCALE_UP",
+      "when": [{"metric": "emergency_messages", "op": ">", "value": 0}],
+      "instances": 2,
+      "location": "RSU_1",
+      "priority": 1,
+      "event": "emergency",
+      "reason": "Emergency messages detected: {emergency_messages}"
+    }
+  ]
+})";
+
+} // namespace
+
+const char* ruleMetricName(RuleMetric metric) {
+    size_t index = static_cast<size_t>(metric);
+    return index < RULE_METRIC_COUNT ? METRIC_NAMES[index] : "unknown";
+}
+
+bool parseRuleMetric(const std::string& name, RuleMetric& metric) {
+    for (size_t i = 0; i < RULE_METRIC_COUNT; ++i) {
+        if (name == METRIC_NAMES[i]) {
+            metric = static_cast<RuleMetric>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+double ruleMetricValue(const NDNMetrics& metrics, RuleMetric metric) {
+    switch (metric) {
+        case RuleMetric::PIT_SIZE: return metrics.pitSize;
+        case RuleMetric::FIB_ENTRIES: return metrics.fibEntries;
+        case RuleMetric::CACHE_HIT_RATIO: return metrics.cacheHitRatio;
+        case RuleMetric::INTEREST_COUNT: return static_cast<double>(metrics.interestCount);
+        case RuleMetric::DATA_COUNT: return static_cast<double>(metrics.dataCount);
+        case RuleMetric::AVG_LATENCY: return metrics.avgLatency;
+        case RuleMetric::AVG_LATENCY_MS: return metrics.avgLatency * 1000.0;
+        case RuleMetric::UNSATISFIED_INTERESTS: return metrics.unsatisfiedInterests;
+        case RuleMetric::EMERGENCY_MESSAGES: return metrics.emergencyMessages;
+        case RuleMetric::SAFETY_MESSAGES: return metrics.safetyMessages;
+        case RuleMetric::NETWORK_UTILIZATION: return metrics.networkUtilization;
+        default: return 0.0;
+    }
+}
+
+// =============================================================================
+// MetricsBatch
+// =============================================================================
+
+void MetricsBatch::clear() {
+    for (auto& column : columns_) {
+        column.clear();
+    }
+    size_ = 0;
+}
+
+void MetricsBatch::reserve(size_t records) {
+    for (auto& column : columns_) {
+        column.reserve(records);
+    }
+}
+
+void MetricsBatch::append(const NDNMetrics& metrics) {
+    for (size_t i = 0; i < RULE_METRIC_COUNT; ++i) {
+        columns_[i].push_back(ruleMetricValue(metrics, static_cast<RuleMetric>(i)));
+    }
+    size_++;
+}
+
+// =============================================================================
+// NFVRuleEngine
+// =============================================================================
+
+NFVRuleEngine::NFVRuleEngine() {
+    loadDefaults();
+}
+
+const char* NFVRuleEngine::defaultRules() {
+    return DEFAULT_RULES;
+}
+
+void NFVRuleEngine::loadDefaults() {
+    std::string error;
+    if (!loadJson(DEFAULT_RULES, error)) {
+        std::cerr << "❌ Built-in NFV rules failed to compile: " << error << std::endl;
+    }
+    source_ = "built-in";
+}
+
+bool NFVRuleEngine::loadFile(const std::string& path) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        std::cerr << "❌ Cannot open NFV rule file " << path << std::endl;
+        return false;
+    }
+
+    std::stringstream text;
+    text << file.rdbuf();
+
+    std::string error;
+    if (!loadJson(text.str(), error)) {
+        std::cerr << "❌ Invalid NFV rule file " << path << ": " << error << std::endl;
+        return false;
+    }
+
+    source_ = path;
+    std::cout << "📜 Loaded " << actions_.size() << " NFV rules (" << predicates_.size()
+              << " predicates) from " << path << std::endl;
+    return true;
+}
+
+bool NFVRuleEngine::compileBlock(const Json::Value& conditions, Block& block,
+                                 std::vector<Predicate>& predicates, std::string& error) const {
+    if (!conditions.isArray()) {
+        error = "\"when\" must be an array of conditions";
+        return false;
+    }
+
+    block.first = static_cast<uint32_t>(predicates.size());
+    block.count = 0;
+
+    for (const auto& condition : conditions) {
+        Predicate predicate;
+        std::string metricName = condition.get("metric", "").asString();
+        if (!parseRuleMetric(metricName, predicate.metric)) {
+            error = "unknown metric \"" + metricName + "\"";
+            return false;
+        }
+        if (!condition.isMember("value") || !condition["value"].isNumeric()) {
+            error = "condition on \"" + metricName + "\" needs a numeric value";
+            return false;
+        }
+        predicate.threshold = condition["value"].asDouble();
+
+        // Every operator becomes sign * (x - threshold) > 0, optionally OR equality
+        std::string op = condition.get("op", "").asString();
+        if (op == ">") {
+            predicate.sign = 1.0; predicate.inclusive = 0;
+        } else if (op == ">=") {
+            predicate.sign = 1.0; predicate.inclusive = 1;
+        } else if (op == "<") {
+            predicate.sign = -1.0; predicate.inclusive = 0;
+        } else if (op == "<=") {
+            predicate.sign = -1.0; predicate.inclusive = 1;
+        } else if (op == "==") {
+            predicate.sign = 0.0; predicate.inclusive = 1;
+        } else {
+            error = "unknown operator \"" + op + "\"";
+            return false;
+        }
+
+        predicates.push_back(predicate);
+        block.count++;
+    }
+    return true;
+}
+
+bool NFVRuleEngine::loadJson(const std::string& text, std::string& error) {
+    Json::Value root;
+    Json::CharReaderBuilder builder;
+    std::istringstream stream(text);
+    if (!Json::parseFromStream(builder, stream, &root, &error)) {
+        return false;
+    }
+
+    const Json::Value& rules = root["rules"];
+    if (!rules.isArray()) {
+        error = "missing \"rules\" array";
+        return false;
+    }
+    if (rules.size() > MAX_RULES) {
+        error = "at most " + std::to_string(MAX_RULES) + " rules are supported";
+        return false;
+    }
+
+    // Compile into scratch tables so a bad file leaves the current program in place
+    std::vector<Predicate> predicates;
+    std::vector<Block> conditions;
+    std::vector<Block> escalations;
+    std::vector<RuleAction> actions;
+
+    for (const auto& rule : rules) {
+        RuleAction action;
+        action.name = rule.get("name", "rule_" + std::to_string(actions.size())).asString();
+        action.vnfType = rule.get("vnf", "").asString();
+        action.action = rule.get("action", "").asString();
+        if (action.vnfType.empty() || action.action.empty()) {
+            error = "rule \"" + action.name + "\" needs \"vnf\" and \"action\"";
+            return false;
+        }
+
+        Block block;
+        if (!compileBlock(rule.isMember("when") ? rule["when"] : Json::Value(Json::arrayValue),
+                          block, predicates, error)) {
+            error = "rule \"" + action.name + "\": " + error;
+            return false;
+        }
+        conditions.push_back(block);
+
+        Block escalation;
+        action.priority = rule.get("priority", 3).asInt();
+        action.escalatedPriority = action.priority;
+        if (rule.isMember("escalate")) {
+            const Json::Value& escalate = rule["escalate"];
+            if (!compileBlock(escalate["when"], escalation, predicates, error) || escalation.count == 0) {
+                error = "rule \"" + action.name + "\" escalation: " +
+                        (error.empty() ? std::string("needs at least one condition") : error);
+                return false;
+            }
+            action.escalatedPriority = escalate.get("priority", action.priority).asInt();
+        }
+        escalations.push_back(escalation);
+
+        const Json::Value& instances = rule["instances"];
+        if (instances.isObject()) {
+            std::string metricName = instances.get("metric", "").asString();
+            if (!parseRuleMetric(metricName, action.instancesMetric)) {
+                error = "rule \"" + action.name + "\": unknown instances metric \"" + metricName + "\"";
+                return false;
+            }
+            action.instancesFromMetric = true;
+            action.instancesPer = instances.get("per", 1.0).asDouble();
+            action.instancesOffset = instances.get("offset", 0).asInt();
+            action.minInstances = instances.get("min", 1).asInt();
+            action.maxInstances = instances.get("max", std::numeric_limits<int>::max()).asInt();
+            if (action.instancesPer <= 0.0) {
+                error = "rule \"" + action.name + "\": instances \"per\" must be positive";
+                return false;
+            }
+        } else {
+            action.instancesOffset = instances.isNumeric() ? instances.asInt() : 1;
+            action.minInstances = action.maxInstances = action.instancesOffset;
+        }
+
+        action.location = rule.get("location", "").asString();
+        action.sourceLocation = rule.get("source", "").asString();
+        action.reason = rule.get("reason", action.name).asString();
+        action.event = rule.get("event", "").asString();
+        actions.push_back(std::move(action));
+    }
+
+    predicates_.swap(predicates);
+    conditions_.swap(conditions);
+    escalations_.swap(escalations);
+    actions_.swap(actions);
+    return true;
+}
+
+void NFVRuleEngine::evaluateBlock(const Block& block, const MetricsBatch& batch, std::vector<uint8_t>& match) const {
+    const size_t n = batch.size();
+    match.assign(n, 1);
+
+    for (uint32_t p = block.first; p < block.first + block.count; ++p) {
+        const Predicate& predicate = predicates_[p];
+        const double* column = batch.column(predicate.metric);
+        const double sign = predicate.sign;
+        const double threshold = predicate.threshold;
+        const uint8_t inclusive = predicate.inclusive;
+
+        for (size_t i = 0; i < n; ++i) {
+            uint8_t above = (sign * (column[i] - threshold)) > 0.0;
+            uint8_t equal = column[i] == threshold;
+            match[i] &= above | (inclusive & equal);
+        }
+    }
+}
+
+void NFVRuleEngine::evaluate(const MetricsBatch& batch, std::vector<uint64_t>& fired,
+                             std::vector<uint64_t>& escalated) const {
+    const size_t n = batch.size();
+    fired.assign(n, 0);
+    escalated.assign(n, 0);
+
+    std::vector<uint8_t> match;
+    for (size_t r = 0; r < actions_.size(); ++r) {
+        evaluateBlock(conditions_[r], batch, match);
+        for (size_t i = 0; i < n; ++i) {
+            fired[i] |= static_cast<uint64_t>(match[i]) << r;
+        }
+
+        if (escalations_[r].count > 0) {
+            evaluateBlock(escalations_[r], batch, match);
+            for (size_t i = 0; i < n; ++i) {
+                escalated[i] |= static_cast<uint64_t>(match[i]) << r;
+            }
+        }
+    }
+}
+
+uint64_t NFVRuleEngine::evaluate(const NDNMetrics& metrics, uint64_t& escalated) const {
+    MetricsBatch batch;
+    batch.append(metrics);
+
+    std::vector<uint64_t> fired, escalations;
+    evaluate(batch, fired, escalations);
+    escalated = escalations[0];
+    return fired[0];
+}
+
+int NFVRuleEngine::instancesFor(size_t rule, const NDNMetrics& metrics) const {
+    const RuleAction& action = actions_[rule];
+    if (!action.instancesFromMetric) {
+        return action.instancesOffset;
+    }
+
+    double value = ruleMetricValue(metrics, action.instancesMetric);
+    int instances = static_cast<int>(std::floor(value / action.instancesPer)) + action.instancesOffset;
+    return std::max(action.minInstances, std::min(action.maxInstances, instances));
+}
+
+int NFVRuleEngine::priorityFor(size_t rule, bool escalated) const {
+    return escalated ? actions_[rule].escalatedPriority : actions_[rule].priority;
+}
+
+std::string NFVRuleEngine::reasonFor(size_t rule, const NDNMetrics& metrics) const {
+    const std::string& pattern = actions_[rule].reason;
+    std::string reason;
+    reason.reserve(pattern.size() + 16);
+
+    size_t pos = 0;
+    while (pos < pattern.size()) {
+        size_t open = pattern.find('{', pos);
+        size_t close = open == std::string::npos ? std::string::npos : pattern.find('}', open);
+        if (close == std::string::npos) {
+            reason.append(pattern, pos, std::string::npos);
+            break;
+        }
+
+        // Unknown placeholders stay in the text as written
+        RuleMetric metric;
+        if (!parseRuleMetric(pattern.substr(open + 1, close - open - 1), metric)) {
+            reason.append(pattern, pos, close + 1 - pos);
+            pos = close + 1;
+            continue;
+        }
+
+        reason.append(pattern, pos, open - pos);
+        double value = ruleMetricValue(metrics, metric);
+        reason += isCountMetric(metric) ? std::to_string(static_cast<uint64_t>(value)) : std::to_string(value);
+        pos = close + 1;
+    }
+    return reason;
+}
+
+} // namespace cosim
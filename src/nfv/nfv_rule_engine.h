@@ -0,0 +1,160 @@
+/*
+Compiled NFV rule engine
+Scaling, optimization and migration policies are declared as JSON rules and
+compiled at load time into a flat predicate program. Each predicate is a
+(metric, sign, threshold, inclusive) tuple, so every comparison operator is
+evaluated with the same arithmetic and no branch on the operator. Records are
+evaluated as a structure-of-arrays batch, one predicate over one metric column
+at a time, and each record gets a bitmask of the rules that fired.
+
+Rule file format:
+{
+  "rules": [
+    {
+      "name": "router_pit_pressure",
+      "vnf": "NDNRouter",
+      "action": "SCALE_UP",
+      "when": [{"metric": "pit_size", "op": ">", "value": 100}],
+      "instances": {"metric": "pit_size", "per": 50, "offset": 1, "min": 1, "max": 5},
+      "location": "@optimal",
+      "priority": 2,
+      "escalate": {"when": [{"metric": "emergency_messages", "op": ">", "value": 0}], "priority": 1},
+      "event": "scaling",
+      "reason": "PIT size exceeded threshold: {pit_size}"
+    }
+  ]
+}
+
+Locations starting with '@' are resolved by the orchestrator against the per-node
+metrics ("@optimal", "@max_pit_node", "@max_latency_node", "@min_cache_hit_node");
+"|SITE" after a selector names the fallback site.
+*/
+
+#ifndef NFV_RULE_ENGINE_H
+#define NFV_RULE_ENGINE_H
+
+#include "message.h"
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Json {
+class Value;
+}
+
+namespace cosim {
+
+// Metrics a rule can test, one column each in a MetricsBatch
+enum class RuleMetric : uint8_t {
+    PIT_SIZE,
+    FIB_ENTRIES,
+    CACHE_HIT_RATIO,
+    INTEREST_COUNT,
+    DATA_COUNT,
+    AVG_LATENCY,
+    AVG_LATENCY_MS,
+    UNSATISFIED_INTERESTS,
+    EMERGENCY_MESSAGES,
+    SAFETY_MESSAGES,
+    NETWORK_UTILIZATION,
+    COUNT
+};
+
+constexpr size_t RULE_METRIC_COUNT = static_cast<size_t>(RuleMetric::COUNT);
+
+const char* ruleMetricName(RuleMetric metric);
+bool parseRuleMetric(const std::string& name, RuleMetric& metric);
+double ruleMetricValue(const NDNMetrics& metrics, RuleMetric metric);
+
+// Structure-of-arrays view of many metrics records
+class MetricsBatch {
+public:
+    void clear();
+    void reserve(size_t records);
+    void append(const NDNMetrics& metrics);
+
+    size_t size() const { return size_; }
+    const double* column(RuleMetric metric) const { return columns_[static_cast<size_t>(metric)].data(); }
+    double value(size_t record, RuleMetric metric) const { return columns_[static_cast<size_t>(metric)][record]; }
+
+private:
+    std::array<std::vector<double>, RULE_METRIC_COUNT> columns_;
+    size_t size_ = 0;
+};
+
+// Cold part of a rule, used only to materialize decisions for rules that fired
+struct RuleAction {
+    std::string name;
+    std::string vnfType;         // vnfTypeToString() spelling
+    std::string action;          // SCALE_UP, SCALE_DOWN, MIGRATE, OPTIMIZE
+    std::string location;
+    std::string sourceLocation;
+    std::string reason;          // "{metric}" placeholders are substituted
+    std::string event;           // Performance counter fed by the rule: scaling, migration, emergency
+
+    bool instancesFromMetric = false;
+    RuleMetric instancesMetric = RuleMetric::PIT_SIZE;
+    double instancesPer = 1.0;
+    int instancesOffset = 1;
+    int minInstances = 1;
+    int maxInstances = 1;
+
+    int priority = 3;
+    int escalatedPriority = 3;
+};
+
+class NFVRuleEngine {
+public:
+    static constexpr size_t MAX_RULES = 64;  // One bit per rule in the fired mask
+
+    // Starts with the built-in rules, which reproduce the original threshold policy
+    NFVRuleEngine();
+
+    bool loadFile(const std::string& path);
+    bool loadJson(const std::string& text, std::string& error);
+    void loadDefaults();
+
+    // fired[i] and escalated[i] receive one bit per rule for record i
+    void evaluate(const MetricsBatch& batch, std::vector<uint64_t>& fired, std::vector<uint64_t>& escalated) const;
+    uint64_t evaluate(const NDNMetrics& metrics, uint64_t& escalated) const;
+
+    size_t ruleCount() const { return actions_.size(); }
+    size_t predicateCount() const { return predicates_.size(); }
+    const RuleAction& action(size_t rule) const { return actions_[rule]; }
+    const std::string& source() const { return source_; }
+
+    // Materialization helpers for a fired rule
+    int instancesFor(size_t rule, const NDNMetrics& metrics) const;
+    int priorityFor(size_t rule, bool escalated) const;
+    std::string reasonFor(size_t rule, const NDNMetrics& metrics) const;
+
+    static const char* defaultRules();
+
+private:
+    struct Predicate {
+        RuleMetric metric;
+        double sign;        // +1 for > and >=, -1 for < and <=, 0 for ==
+        double threshold;
+        uint8_t inclusive;  // Also true on equality
+    };
+
+    struct Block {
+        uint32_t first = 0;
+        uint32_t count = 0;
+    };
+
+    bool compileBlock(const Json::Value& conditions, Block& block, std::vector<Predicate>& predicates,
+                      std::string& error) const;
+    void evaluateBlock(const Block& block, const MetricsBatch& batch, std::vector<uint8_t>& match) const;
+
+    std::vector<Predicate> predicates_;
+    std::vector<Block> conditions_;
+    std::vector<Block> escalations_;
+    std::vector<RuleAction> actions_;
+    std::string source_;
+};
+
+} // namespace cosim
+
+#endif // NFV_RULE_ENGINE_H
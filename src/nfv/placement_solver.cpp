@@ -0,0 +1,318 @@
+/*
+Implementation of the VNF placement solver
+*/
+
+#include "placement_solver.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <thread>
+
+namespace cosim {
+
+namespace {
+
+constexpr double UNPLACED_PENALTY = 1e9;         // Objective cost of a request left without a site
+constexpr uint64_t MOVES_PER_CELL = 200;         // Chains stop early on small problems
+constexpr uint64_t CLOCK_CHECK_INTERVAL = 128;
+constexpr double FINAL_TEMPERATURE_RATIO = 1e-3;
+
+bool fits(const SiteCapacity& residual, const VNFFootprint& footprint) {
+    return residual.cpu >= footprint.cpu && residual.memory >= footprint.memory;
+}
+
+void reserve(SiteCapacity& residual, const VNFFootprint& footprint, double sign) {
+    residual.cpu -= sign * footprint.cpu;
+    residual.memory -= sign * footprint.memory;
+}
+
+bool sameDemand(const PlacementRequest& a, const PlacementRequest& b) {
+    return a.demand.size() == b.demand.size() &&
+           std::equal(a.demand.begin(), a.demand.end(), b.demand.begin(),
+                      [](const PlacementDemand& x, const PlacementDemand& y) {
+                          return x.site == y.site && x.weight == y.weight;
+                      });
+}
+
+} // namespace
+
+VNFFootprint vnfFootprint(VNFType type) {
+    switch (type) {
+        case VNFType::NDN_ROUTER: return {1.0, 1.0};
+        case VNFType::TRAFFIC_ANALYZER: return {2.0, 4.0};
+        case VNFType::SECURITY_VNF: return {1.0, 2.0};
+        case VNFType::CACHE_OPTIMIZER: return {0.5, 4.0};  // Content Store dominates
+        default: return {1.0, 1.0};
+    }
+}
+
+struct PlacementSolver::Chain {
+    std::vector<uint32_t> sites;
+    std::vector<SiteCapacity> residual;
+    double cost = 0.0;
+    size_t unplaced = 0;
+
+    std::vector<uint32_t> bestSites;
+    double bestObjective = 0.0;
+    uint64_t moves = 0;
+    std::mt19937_64 rng;
+
+    double objective() const { return cost + UNPLACED_PENALTY * unplaced; }
+};
+
+PlacementSolver::PlacementSolver(const EdgeTopology& topology, unsigned workers)
+    : topology_(topology), workers_(1) {
+    setWorkers(workers);
+}
+
+void PlacementSolver::setWorkers(unsigned workers) {
+    workers_ = workers > 0 ? workers : std::max(1u, std::thread::hardware_concurrency());
+}
+
+// Several instances of one type arrive as consecutive requests with the same demand; each
+// distinct demand is summed once and its row copied to the requests that repeat it
+void PlacementSolver::fillCosts(const std::vector<PlacementRequest>& requests, std::vector<double>& costs) const {
+    const size_t siteCount = topology_.siteCount();
+    costs.assign(requests.size() * siteCount, 0.0);
+
+    std::vector<size_t> distinct;
+    std::vector<size_t> source(requests.size());
+    size_t cells = 0;
+    for (size_t r = 0; r < requests.size(); ++r) {
+        if (r > 0 && sameDemand(requests[r], requests[source[r - 1]])) {
+            source[r] = source[r - 1];
+            continue;
+        }
+        source[r] = r;
+        distinct.push_back(r);
+        cells += requests[r].demand.size() * siteCount;
+    }
+
+    auto fillRange = [&](size_t first, size_t last) {
+        for (size_t i = first; i < last; ++i) {
+            size_t r = distinct[i];
+            double* row = &costs[r * siteCount];
+            for (const auto& demand : requests[r].demand) {
+                const double* latency = topology_.latencyRow(demand.site);
+                for (size_t s = 0; s < siteCount; ++s) {
+                    row[s] += demand.weight * latency[s];
+                }
+            }
+        }
+    };
+
+    size_t threads = std::min<size_t>(workers_, distinct.size());
+    if (cells < PARALLEL_MIN_CELLS || threads <= 1) {
+        fillRange(0, distinct.size());
+    } else {
+        std::vector<std::thread> pool;
+        size_t chunk = (distinct.size() + threads - 1) / threads;
+        for (size_t first = chunk; first < distinct.size(); first += chunk) {
+            pool.emplace_back(fillRange, first, std::min(distinct.size(), first + chunk));
+        }
+        fillRange(0, std::min(distinct.size(), chunk));
+        for (auto& thread : pool) {
+            thread.join();
+        }
+    }
+
+    for (size_t r = 0; r < requests.size(); ++r) {
+        if (source[r] != r) {
+            std::copy_n(&costs[source[r] * siteCount], siteCount, &costs[r * siteCount]);
+        }
+    }
+}
+
+// Largest requests first, each on its cheapest site that still has room
+void PlacementSolver::greedy(const std::vector<PlacementRequest>& requests, const std::vector<double>& costs,
+                             std::vector<SiteCapacity>& residual, std::vector<uint32_t>& sites) const {
+    const size_t siteCount = topology_.siteCount();
+    std::vector<size_t> order(requests.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        const VNFFootprint& fa = requests[a].footprint;
+        const VNFFootprint& fb = requests[b].footprint;
+        return fa.cpu != fb.cpu ? fa.cpu > fb.cpu : fa.memory > fb.memory;
+    });
+
+    sites.assign(requests.size(), EdgeTopology::INVALID_SITE);
+    for (size_t r : order) {
+        const double* row = &costs[r * siteCount];
+        double best = std::numeric_limits<double>::infinity();
+        for (uint32_t s = 0; s < siteCount; ++s) {
+            if (row[s] < best && fits(residual[s], requests[r].footprint)) {
+                best = row[s];
+                sites[r] = s;
+            }
+        }
+        if (sites[r] != EdgeTopology::INVALID_SITE) {
+            reserve(residual[sites[r]], requests[r].footprint, 1.0);
+        }
+    }
+}
+
+double PlacementSolver::totalCost(const std::vector<uint32_t>& sites, const std::vector<double>& costs,
+                                  size_t& unplaced) const {
+    const size_t siteCount = topology_.siteCount();
+    double cost = 0.0;
+    unplaced = 0;
+    for (size_t r = 0; r < sites.size(); ++r) {
+        if (sites[r] == EdgeTopology::INVALID_SITE) {
+            unplaced++;
+        } else {
+            cost += costs[r * siteCount + sites[r]];
+        }
+    }
+    return cost;
+}
+
+void PlacementSolver::anneal(Chain& chain, const std::vector<PlacementRequest>& requests,
+                             const std::vector<double>& costs,
+                             std::chrono::steady_clock::time_point deadline) const {
+    const size_t siteCount = topology_.siteCount();
+    const size_t requestCount = requests.size();
+    const uint64_t maxMoves = MOVES_PER_CELL * requestCount * siteCount;
+    const auto started = std::chrono::steady_clock::now();
+    const double span = std::max(1e-9, std::chrono::duration<double>(deadline - started).count());
+
+    // Start hot enough to accept moves worth a tenth of an average request's cost
+    const double initialTemperature = std::max(1e-6, 0.1 * chain.cost / std::max<size_t>(1, requestCount - chain.unplaced));
+    double temperature = initialTemperature;
+
+    std::uniform_int_distribution<size_t> pickRequest(0, requestCount - 1);
+    std::uniform_int_distribution<uint32_t> pickSite(0, static_cast<uint32_t>(siteCount - 1));
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+
+    auto cost = [&](size_t r, uint32_t s) {
+        return s == EdgeTopology::INVALID_SITE ? UNPLACED_PENALTY : costs[r * siteCount + s];
+    };
+    auto accept = [&](double delta) {
+        return delta <= 0.0 || unit(chain.rng) < std::exp(-delta / temperature);
+    };
+
+    while (chain.moves < maxMoves) {
+        if (chain.moves % CLOCK_CHECK_INTERVAL == 0) {
+            auto now = std::chrono::steady_clock::now();
+            if (now >= deadline) break;
+            double progress = std::chrono::duration<double>(now - started).count() / span;
+            temperature = initialTemperature * std::pow(FINAL_TEMPERATURE_RATIO, progress);
+        }
+        chain.moves++;
+
+        size_t r = pickRequest(chain.rng);
+        uint32_t current = chain.sites[r];
+        const VNFFootprint& footprint = requests[r].footprint;
+
+        if (requestCount < 2 || unit(chain.rng) < 0.5) {
+            // Relocate one request
+            uint32_t target = pickSite(chain.rng);
+            if (target == current || !std::isfinite(costs[r * siteCount + target]) ||
+                !fits(chain.residual[target], footprint)) {
+                continue;
+            }
+            double delta = cost(r, target) - cost(r, current);
+            if (!accept(delta)) continue;
+
+            if (current != EdgeTopology::INVALID_SITE) {
+                reserve(chain.residual[current], footprint, -1.0);
+                chain.cost -= costs[r * siteCount + current];
+            } else {
+                chain.unplaced--;
+            }
+            reserve(chain.residual[target], footprint, 1.0);
+            chain.cost += costs[r * siteCount + target];
+            chain.sites[r] = target;
+        } else {
+            // Swap the sites of two placed requests
+            size_t other = pickRequest(chain.rng);
+            uint32_t otherSite = chain.sites[other];
+            if (other == r || current == EdgeTopology::INVALID_SITE || otherSite == EdgeTopology::INVALID_SITE ||
+                current == otherSite) {
+                continue;
+            }
+            const VNFFootprint& otherFootprint = requests[other].footprint;
+            SiteCapacity atCurrent = chain.residual[current];
+            SiteCapacity atOther = chain.residual[otherSite];
+            reserve(atCurrent, footprint, -1.0);
+            reserve(atCurrent, otherFootprint, 1.0);
+            reserve(atOther, otherFootprint, -1.0);
+            reserve(atOther, footprint, 1.0);
+            if (atCurrent.cpu < 0.0 || atCurrent.memory < 0.0 || atOther.cpu < 0.0 || atOther.memory < 0.0) {
+                continue;
+            }
+            double delta = cost(r, otherSite) + cost(other, current) - cost(r, current) - cost(other, otherSite);
+            if (!std::isfinite(delta) || !accept(delta)) continue;
+
+            chain.residual[current] = atCurrent;
+            chain.residual[otherSite] = atOther;
+            chain.cost += delta;
+            chain.sites[r] = otherSite;
+            chain.sites[other] = current;
+        }
+
+        if (chain.objective() < chain.bestObjective) {
+            chain.bestObjective = chain.objective();
+            chain.bestSites = chain.sites;
+        }
+    }
+}
+
+PlacementResult PlacementSolver::solve(const std::vector<PlacementRequest>& requests,
+                                       const std::vector<SiteCapacity>& capacity,
+                                       std::chrono::microseconds budget) const {
+    const auto deadline = std::chrono::steady_clock::now() + budget;
+    PlacementResult result;
+    if (requests.empty() || topology_.siteCount() == 0) {
+        return result;
+    }
+
+    std::vector<double> costs;
+    fillCosts(requests, costs);
+
+    Chain seed;
+    seed.residual = capacity;
+    seed.residual.resize(topology_.siteCount());
+    greedy(requests, costs, seed.residual, seed.sites);
+    seed.cost = totalCost(seed.sites, costs, seed.unplaced);
+    seed.bestSites = seed.sites;
+    seed.bestObjective = seed.objective();
+
+    // One request on its cheapest feasible site is already optimal
+    if (requests.size() < 2 || topology_.siteCount() < 2 || std::chrono::steady_clock::now() >= deadline) {
+        result.sites = seed.sites;
+        result.cost = seed.cost;
+        result.unplaced = seed.unplaced;
+        return result;
+    }
+
+    std::vector<Chain> chains(workers_, seed);
+    for (unsigned i = 0; i < workers_; ++i) {
+        chains[i].rng.seed(0x9e3779b97f4a7c15ull * (i + 1));
+    }
+
+    std::vector<std::thread> pool;
+    for (unsigned i = 1; i < workers_; ++i) {
+        pool.emplace_back([&, i] { anneal(chains[i], requests, costs, deadline); });
+    }
+    anneal(chains[0], requests, costs, deadline);
+    for (auto& thread : pool) {
+        thread.join();
+    }
+
+    const Chain* best = &chains[0];
+    for (const auto& chain : chains) {
+        result.moves += chain.moves;
+        if (chain.bestObjective < best->bestObjective) {
+            best = &chain;
+        }
+    }
+
+    result.sites = best->bestSites;
+    result.cost = totalCost(result.sites, costs, result.unplaced);
+    result.workers = workers_;
+    return result;
+}
+
+} // namespace cosim
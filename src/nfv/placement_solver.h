@@ -0,0 +1,87 @@
+/*
+VNF placement solver over the edge topology
+Places a batch of VNF instances on sites so that the demand-weighted latency
+from where requests enter the network is minimal, subject to each site's
+residual CPU and memory. A dense (request x site) cost table is filled first,
+split across worker threads; a capacity-aware greedy pass gives the initial
+placement, and independent simulated-annealing chains (relocate and swap moves)
+then improve it in parallel until the per-decision time budget runs out. The
+best chain wins. A single request is solved exactly by the greedy pass.
+*/
+
+#ifndef PLACEMENT_SOLVER_H
+#define PLACEMENT_SOLVER_H
+
+#include "edge_topology.h"
+#include "vnf_registry.h"
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+namespace cosim {
+
+// Resources one instance reserves on its site
+struct VNFFootprint {
+    double cpu;     // Cores
+    double memory;  // GB
+};
+
+VNFFootprint vnfFootprint(VNFType type);
+
+// Requests entering at `site`, weighted by their rate
+struct PlacementDemand {
+    uint32_t site;
+    double weight;
+};
+
+struct PlacementRequest {
+    VNFType type = VNFType::NDN_ROUTER;
+    VNFFootprint footprint{0.0, 0.0};
+    std::vector<PlacementDemand> demand;
+};
+
+struct SiteCapacity {
+    double cpu = 0.0;
+    double memory = 0.0;
+};
+
+struct PlacementResult {
+    std::vector<uint32_t> sites;  // Per request; EdgeTopology::INVALID_SITE if nothing fits
+    double cost = 0.0;            // Demand-weighted latency (ms) of the placed requests
+    size_t unplaced = 0;
+    uint64_t moves = 0;           // Annealing moves evaluated across all chains
+    unsigned workers = 1;
+};
+
+class PlacementSolver {
+public:
+    static constexpr size_t PARALLEL_MIN_CELLS = 1 << 14;  // Cost-table work below this stays on the caller
+
+    // workers == 0 uses the hardware concurrency
+    explicit PlacementSolver(const EdgeTopology& topology, unsigned workers = 0);
+
+    // `capacity` is the residual capacity per topology site
+    PlacementResult solve(const std::vector<PlacementRequest>& requests,
+                          const std::vector<SiteCapacity>& capacity,
+                          std::chrono::microseconds budget) const;
+
+    unsigned workers() const { return workers_; }
+    void setWorkers(unsigned workers);  // 0 uses the hardware concurrency
+
+private:
+    struct Chain;
+
+    void fillCosts(const std::vector<PlacementRequest>& requests, std::vector<double>& costs) const;
+    void greedy(const std::vector<PlacementRequest>& requests, const std::vector<double>& costs,
+                std::vector<SiteCapacity>& residual, std::vector<uint32_t>& sites) const;
+    void anneal(Chain& chain, const std::vector<PlacementRequest>& requests, const std::vector<double>& costs,
+                std::chrono::steady_clock::time_point deadline) const;
+    double totalCost(const std::vector<uint32_t>& sites, const std::vector<double>& costs, size_t& unplaced) const;
+
+    const EdgeTopology& topology_;
+    unsigned workers_;
+};
+
+} // namespace cosim
+
+#endif // PLACEMENT_SOLVER_H
@@ -0,0 +1,159 @@
+/*
+Implementation of the per-class admission and scheduling model
+*/
+
+#include "service_classes.h"
+#include <algorithm>
+#include <limits>
+
+namespace cosim {
+
+void ServiceClassModel::clear() {
+    service_.clear();
+    capacity_.clear();
+    for (size_t k = 0; k < TRAFFIC_CLASS_COUNT; ++k) {
+        for (auto* column : {&offered_[k], &admitted_[k], &delay_[k], &loss_[k]}) {
+            column->clear();
+        }
+    }
+}
+
+size_t ServiceClassModel::add(VNFHandle handle, const ClassRates& offered, double serviceRate,
+                              uint32_t servers, double elapsed) {
+    const double capacity = std::max<uint32_t>(1, servers) * serviceRate;
+    service_.push_back(serviceRate);
+    capacity_.push_back(capacity);
+
+    Bucket* bucket = nullptr;
+    if (handle.valid()) {
+        if (handle.index >= buckets_.size()) {
+            buckets_.resize(handle.index + 1);
+        }
+        bucket = &buckets_[handle.index];
+        if (!bucket->live || bucket->generation != handle.generation) {
+            // A new instance starts with full buckets
+            bucket->live = true;
+            bucket->generation = handle.generation;
+            for (size_t k = 0; k < TRAFFIC_CLASS_COUNT; ++k) {
+                const ServiceClass& cls = policy_.classes[k];
+                bucket->tokens[k] = cls.tokenShare * capacity * cls.burstSeconds;
+            }
+        }
+    }
+
+    // Fluid token bucket: tokens earned over the interval plus the saved burst
+    const double interval = std::max(elapsed, 1e-3);
+    for (size_t k = 0; k < TRAFFIC_CLASS_COUNT; ++k) {
+        const ServiceClass& cls = policy_.classes[k];
+        const double rate = cls.tokenShare * capacity;
+        const double demand = std::max(0.0, offered[k]);
+        double allowed = rate;
+        if (cls.tokenShare >= 1.0) {
+            allowed = demand;       // The queue sheds what the servers cannot take
+        } else if (bucket) {
+            double tokens = bucket->tokens[k] + rate * interval;
+            double taken = std::min(demand * interval, tokens);
+            bucket->tokens[k] = std::min(tokens - taken, rate * cls.burstSeconds);
+            allowed = taken / interval;
+        }
+        offered_[k].push_back(demand);
+        admitted_[k].push_back(std::min(demand, allowed));
+    }
+    return capacity_.size() - 1;
+}
+
+double ServiceClassModel::admittedTotal(size_t row) const {
+    double total = 0.0;
+    for (size_t k = 0; k < TRAFFIC_CLASS_COUNT; ++k) {
+        total += admitted_[k][row];
+    }
+    return total;
+}
+
+void ServiceClassModel::evaluate(const VNFLoadModel& aggregate) {
+    const size_t rows = capacity_.size();
+    const double unbounded = std::numeric_limits<double>::infinity();
+    double weightSum = 0.0;
+    for (const auto& cls : policy_.classes) {
+        weightSum += cls.weight;
+    }
+
+    for (size_t k = 0; k < TRAFFIC_CLASS_COUNT; ++k) {
+        delay_[k].resize(rows);
+        loss_[k].resize(rows);
+    }
+
+    for (size_t i = 0; i < rows; ++i) {
+        const double mu = service_[i];
+        const double capacity = capacity_[i];
+        const double service = 1.0 / mu;
+        const double total = admittedTotal(i);
+
+        ClassRates lambda;
+        for (size_t k = 0; k < TRAFFIC_CLASS_COUNT; ++k) {
+            lambda[k] = admitted_[k][i];
+        }
+
+        // M/M/1 waiting at a dedicated rate, for a class that stays below it
+        auto waitAt = [](double rate, double arrivals) {
+            return arrivals < rate ? (arrivals / rate) / (rate - arrivals) : std::numeric_limits<double>::infinity();
+        };
+
+        ClassRates served = lambda;
+        ClassRates wait{};
+        if (total < capacity) {
+            const double queueWait = std::max(0.0, aggregate.delay(i) - service);
+            double inverseLoad = 0.0;
+            for (size_t k = 0; k < TRAFFIC_CLASS_COUNT; ++k) {
+                inverseLoad += lambda[k] / policy_.classes[k].weight;
+            }
+            for (size_t k = 0; k < TRAFFIC_CLASS_COUNT; ++k) {
+                const double weight = policy_.classes[k].weight;
+                const double split = inverseLoad > 0.0 ? queueWait * total / (weight * inverseLoad) : 0.0;
+                const double guaranteed = weightSum > 0.0 ? capacity * weight / weightSum : capacity;
+                wait[k] = std::min(split, waitAt(guaranteed, lambda[k]));
+            }
+        } else {
+            // Water-filling: the level is the rate per unit weight of the classes left unsatisfied
+            std::array<bool, TRAFFIC_CLASS_COUNT> satisfied{};
+            double remaining = capacity;
+            double level = 0.0;
+            bool changed = true;
+            while (changed) {
+                changed = false;
+                double weights = 0.0;
+                for (size_t k = 0; k < TRAFFIC_CLASS_COUNT; ++k) {
+                    if (!satisfied[k] && lambda[k] > 0.0) weights += policy_.classes[k].weight;
+                }
+                level = weights > 0.0 ? remaining / weights : unbounded;
+                for (size_t k = 0; k < TRAFFIC_CLASS_COUNT; ++k) {
+                    if (!satisfied[k] && lambda[k] > 0.0 && lambda[k] <= level * policy_.classes[k].weight) {
+                        satisfied[k] = true;
+                        remaining -= lambda[k];
+                        changed = true;
+                    }
+                }
+            }
+            const double fullBuffer = std::max(0.0, aggregate.delay(i) - service);
+            for (size_t k = 0; k < TRAFFIC_CLASS_COUNT; ++k) {
+                const double weight = policy_.classes[k].weight;
+                const double share = level < unbounded ? level * weight : capacity * weight / weightSum;
+                if (lambda[k] <= 0.0 || satisfied[k]) {
+                    wait[k] = std::min(fullBuffer, waitAt(share, lambda[k]));
+                } else {
+                    served[k] = share;
+                    wait[k] = fullBuffer;
+                }
+            }
+        }
+
+        const double queueDrop = total < capacity ? aggregate.dropProbability(i) : 0.0;
+        for (size_t k = 0; k < TRAFFIC_CLASS_COUNT; ++k) {
+            const double offered = offered_[k][i];
+            delay_[k][i] = wait[k] + service;
+            loss_[k][i] = offered > 0.0 ? 1.0 - served[k] * (1.0 - queueDrop) / offered : 0.0;
+        }
+    }
+}
+
+} // namespace cosim
@@ -0,0 +1,106 @@
+/*
+SLA classes at the modeled VNFs
+Emergency, awareness and other traffic share every VNF instance, but not equally.
+Each class is admitted through its own token bucket per instance, sized as a
+share of the instance's service capacity, and the admitted traffic is served by
+a weighted scheduler:
+
+  - below saturation the instance's mean waiting time (from the M/M/c solution
+    of VNFLoadModel) is split between the classes in inverse proportion to their
+    weights, conserving the total work, and capped by what each class would wait
+    at its guaranteed GPS share of the servers
+  - past saturation the capacity is water-filled by weight: classes within
+    their weighted share are served in full, the others are served at the water
+    level and lose the rest
+
+Rows are added in the same order as the load model's, so one evaluate() after
+VNFLoadModel::evaluate() yields per-class delay and loss for every instance.
+Token buckets persist per instance across reports, keyed by registry handle.
+*/
+
+#ifndef SERVICE_CLASSES_H
+#define SERVICE_CLASSES_H
+
+#include "event_sampler.h"
+#include "vnf_load_model.h"
+#include "vnf_registry.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace cosim {
+
+using ClassRates = std::array<double, TRAFFIC_CLASS_COUNT>;
+
+struct ServiceClass {
+    double weight;          // Scheduling weight
+    double tokenShare;      // Token rate as a share of the instance's service capacity; 1 or more is unpoliced
+    double burstSeconds;    // Bucket depth, in seconds of token rate
+    double latencyBudget;   // End-to-end SLA, seconds
+};
+
+struct ServiceClassPolicy {
+    // Emergency is policed like expedited forwarding: scheduled first, but only up to
+    // half the capacity, so a flood of emergency names cannot starve the rest
+    std::array<ServiceClass, TRAFFIC_CLASS_COUNT> classes = {{
+        {8.0, 0.5, 1.0, 0.05},      // EMERGENCY
+        {2.0, 1.0, 0.5, 0.1},       // AWARENESS
+        {1.0, 1.0, 0.5, 0.1}        // OTHER
+    }};
+
+    const ServiceClass& of(TrafficClass cls) const { return classes[static_cast<size_t>(cls)]; }
+};
+
+// One class as the traffic saw it end to end
+struct ClassOutcome {
+    double offered = 0.0;   // Interests per second
+    double latency = 0.0;   // Modeled, seconds
+    double loss = 0.0;      // Share refused at admission or dropped in a queue
+};
+
+class ServiceClassModel {
+public:
+    void setPolicy(const ServiceClassPolicy& policy) { policy_ = policy; }
+    const ServiceClassPolicy& policy() const { return policy_; }
+
+    void clear();
+
+    // Admits `offered` (packets per second per class) through the instance's token buckets
+    // over the `elapsed` seconds since the last report; returns the row of the instance
+    size_t add(VNFHandle handle, const ClassRates& offered, double serviceRate, uint32_t servers, double elapsed);
+
+    // Per-class delay and loss for every row; `aggregate` holds the same rows, solved
+    void evaluate(const VNFLoadModel& aggregate);
+
+    size_t size() const { return capacity_.size(); }
+    double offered(size_t row, size_t cls) const { return offered_[cls][row]; }
+    double admitted(size_t row, size_t cls) const { return admitted_[cls][row]; }
+    double admittedTotal(size_t row) const;
+    double delay(size_t row, size_t cls) const { return delay_[cls][row]; }    // Mean sojourn, seconds
+    double loss(size_t row, size_t cls) const { return loss_[cls][row]; }      // Refused or dropped
+
+private:
+    struct Bucket {
+        uint32_t generation = 0;
+        bool live = false;
+        ClassRates tokens{};
+    };
+
+    ServiceClassPolicy policy_;
+    std::vector<Bucket> buckets_;       // By handle index; a new generation starts full
+
+    // Inputs
+    std::vector<double> service_;
+    std::vector<double> capacity_;      // Servers x service rate, packets per second
+    std::array<std::vector<double>, TRAFFIC_CLASS_COUNT> offered_;
+    std::array<std::vector<double>, TRAFFIC_CLASS_COUNT> admitted_;
+
+    // Outputs
+    std::array<std::vector<double>, TRAFFIC_CLASS_COUNT> delay_;
+    std::array<std::vector<double>, TRAFFIC_CLASS_COUNT> loss_;
+};
+
+} // namespace cosim
+
+#endif // SERVICE_CLASSES_H
@@ -0,0 +1,111 @@
+/*
+Implementation of the per-site verdict passes
+*/
+
+#include "site_evaluator.h"
+
+namespace cosim {
+
+const char* siteVerdictName(SiteVerdict verdict) {
+    switch (verdict) {
+        case SiteVerdict::HOLD: return "HOLD";
+        case SiteVerdict::SCALE_UP: return "SCALE_UP";
+        case SiteVerdict::SCALE_DOWN: return "SCALE_DOWN";
+        case SiteVerdict::MIGRATE: return "MIGRATE";
+        case SiteVerdict::OPTIMIZE: return "OPTIMIZE";
+        default: return "UNKNOWN";
+    }
+}
+
+SiteEvaluator::SiteEvaluator(const SiteThresholds& thresholds) : thresholds_(thresholds) {
+    for (size_t flags = 0; flags < priority_.size(); ++flags) {
+        SiteVerdict verdict = SiteVerdict::HOLD;
+        if (flags & OVERCOMMITTED) {
+            verdict = SiteVerdict::MIGRATE;
+        } else if (flags & HOT) {
+            verdict = SiteVerdict::SCALE_UP;
+        } else if (flags & MISSING) {
+            verdict = SiteVerdict::OPTIMIZE;
+        } else if (flags & IDLE) {
+            verdict = SiteVerdict::SCALE_DOWN;
+        }
+        priority_[flags] = static_cast<uint8_t>(verdict);
+    }
+}
+
+void SiteEvaluator::resize(size_t sites) {
+    for (auto* column : {&capacity_, &reserved_, &cpu_, &interestRate_, &hitRatio_}) {
+        column->resize(sites, 0.0f);
+    }
+    instances_.resize(sites, 0);
+    duplicateType_.resize(sites, NO_TYPE);
+    flags_.resize(sites, 0);
+    next_.resize(sites, static_cast<uint8_t>(SiteVerdict::HOLD));
+    verdict_.resize(sites, static_cast<uint8_t>(SiteVerdict::HOLD));
+}
+
+// Columns are read through raw pointers so the loops stay free of calls and branches
+const std::vector<SiteChange>& SiteEvaluator::evaluate() {
+    const size_t sites = capacity_.size();
+    const float* capacity = capacity_.data();
+    const float* reserved = reserved_.data();
+    const float* cpu = cpu_.data();
+    const uint16_t* instances = instances_.data();
+    const uint8_t* duplicate = duplicateType_.data();
+    const float* rate = interestRate_.data();
+    const float* hits = hitRatio_.data();
+    const uint8_t* verdict = verdict_.data();
+    uint8_t* flags = flags_.data();
+    uint8_t* next = next_.data();
+
+    const uint8_t scaleUp = static_cast<uint8_t>(SiteVerdict::SCALE_UP);
+    const uint8_t scaleDown = static_cast<uint8_t>(SiteVerdict::SCALE_DOWN);
+    const uint8_t migrate = static_cast<uint8_t>(SiteVerdict::MIGRATE);
+    const uint8_t optimize = static_cast<uint8_t>(SiteVerdict::OPTIMIZE);
+
+    // Thresholds in locals: the byte stores below may alias any member
+    const float margin = thresholds_.hysteresis;
+    const float scaleUpCpu = thresholds_.scaleUpCpu;
+    const float scaleDownCpu = thresholds_.scaleDownCpu;
+    const float overcommit = thresholds_.overcommit;
+    const float optimizeRate = thresholds_.optimizeRate;
+    const float optimizeHitRatio = thresholds_.optimizeHitRatio;
+
+    // Pass 1: condition flags; a held verdict widens its own thresholds by the margin
+    for (size_t s = 0; s < sites; ++s) {
+        const float heldUp = static_cast<float>(verdict[s] == scaleUp);
+        const float heldMigrate = static_cast<float>(verdict[s] == migrate);
+        const float heldOptimize = static_cast<float>(verdict[s] == optimize);
+        const float heldDown = static_cast<float>(verdict[s] == scaleDown);
+        const uint8_t hosting = instances[s] > 0;
+
+        const uint8_t hot = hosting & (cpu[s] > scaleUpCpu * (1.0f - margin * heldUp));
+        const uint8_t overcommitted =
+            reserved[s] > capacity[s] * overcommit * (1.0f - margin * heldMigrate);
+        const uint8_t missing = (rate[s] > optimizeRate * (1.0f - margin * heldOptimize)) &
+                                (hits[s] < optimizeHitRatio * (1.0f + margin * heldOptimize));
+        const uint8_t idle = hosting & (duplicate[s] != NO_TYPE) &
+                             (cpu[s] < scaleDownCpu * (1.0f + margin * heldDown));
+
+        flags[s] = static_cast<uint8_t>(hot | (overcommitted << 1) | (missing << 2) | (idle << 3));
+    }
+
+    // Pass 2: flags to verdict
+    const uint8_t* priority = priority_.data();
+    for (size_t s = 0; s < sites; ++s) {
+        next[s] = priority[flags[s]];
+    }
+
+    // Pass 3: sparse list of the sites whose verdict changed
+    changes_.clear();
+    for (size_t s = 0; s < sites; ++s) {
+        if (next[s] != verdict[s]) {
+            changes_.push_back({static_cast<uint32_t>(s), static_cast<SiteVerdict>(next[s]),
+                                static_cast<SiteVerdict>(verdict[s])});
+        }
+    }
+    verdict_.swap(next_);
+    return changes_;
+}
+
+} // namespace cosim
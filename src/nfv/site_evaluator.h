@@ -0,0 +1,122 @@
+/*
+Per-site NFV verdicts over structure-of-arrays columns
+Every edge site carries its own scale, migrate and optimize verdict. The caller
+fills one column per input (capacity, reserved cores, modeled CPU of the hosted
+instances, Interest rate and cache hit ratio at the site, ...) and a cycle is
+three passes over all sites:
+
+  1. condition flags, with the thresholds widened by a hysteresis margin for
+     sites that already hold the matching verdict
+  2. flags to verdict through a priority table
+     (MIGRATE > SCALE_UP > OPTIMIZE > SCALE_DOWN > HOLD)
+  3. comparison with the previous cycle's verdicts
+
+Only the sites whose verdict changed are returned, so the caller materializes
+decisions for a sparse list instead of the whole city. The passes are straight
+loops over contiguous float and byte columns without branches on the data.
+*/
+
+#ifndef SITE_EVALUATOR_H
+#define SITE_EVALUATOR_H
+
+#include "vnf_registry.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace cosim {
+
+enum class SiteVerdict : uint8_t {
+    HOLD,
+    SCALE_UP,       // Hosted instances run hot
+    SCALE_DOWN,     // A type runs more than one idle instance at the site
+    MIGRATE,        // Reserved beyond capacity
+    OPTIMIZE        // Busy RSU whose Content Store misses
+};
+
+const char* siteVerdictName(SiteVerdict verdict);
+
+struct SiteThresholds {
+    float scaleUpCpu = 0.8f;        // Mean modeled CPU of the site's instances
+    float scaleDownCpu = 0.3f;
+    float overcommit = 1.0f;        // Reserved share of capacity that forces a migration
+    float optimizeRate = 50.0f;     // Interests per second at the site
+    float optimizeHitRatio = 0.5f;
+    float hysteresis = 0.05f;       // Relative margin a value must cross back to release a verdict
+};
+
+struct SiteChange {
+    uint32_t site;
+    SiteVerdict verdict;
+    SiteVerdict previous;
+};
+
+class SiteEvaluator {
+public:
+    static constexpr uint8_t NO_TYPE = 0xff;
+
+    explicit SiteEvaluator(const SiteThresholds& thresholds = SiteThresholds());
+
+    // Existing sites keep their verdicts; new sites start at HOLD
+    void resize(size_t sites);
+    size_t size() const { return capacity_.size(); }
+
+    const SiteThresholds& thresholds() const { return thresholds_; }
+    void setThresholds(const SiteThresholds& thresholds) { thresholds_ = thresholds; }
+
+    // Input columns, one entry per site; the caller writes every entry before evaluate()
+    float* capacity() { return capacity_.data(); }          // Cores
+    float* reserved() { return reserved_.data(); }          // Cores held by hosted instances
+    float* cpu() { return cpu_.data(); }                    // Mean modeled CPU of hosted instances
+    uint16_t* instances() { return instances_.data(); }
+    uint8_t* duplicateType() { return duplicateType_.data(); }  // A type with two or more instances here
+    float* interestRate() { return interestRate_.data(); }
+    float* hitRatio() { return hitRatio_.data(); }
+
+    const float* capacity() const { return capacity_.data(); }
+    const float* reserved() const { return reserved_.data(); }
+    const float* cpu() const { return cpu_.data(); }
+    const uint16_t* instances() const { return instances_.data(); }
+    const uint8_t* duplicateType() const { return duplicateType_.data(); }
+    const float* interestRate() const { return interestRate_.data(); }
+    const float* hitRatio() const { return hitRatio_.data(); }
+
+    // Runs the three passes; the result is valid until the next call
+    const std::vector<SiteChange>& evaluate();
+
+    SiteVerdict verdict(uint32_t site) const { return static_cast<SiteVerdict>(verdict_[site]); }
+
+    // Forgets a verdict the caller could not act on, so the next cycle reports it again
+    void release(uint32_t site) { verdict_[site] = static_cast<uint8_t>(SiteVerdict::HOLD); }
+
+private:
+    enum Flag : uint8_t {
+        HOT = 1u << 0,
+        OVERCOMMITTED = 1u << 1,
+        MISSING = 1u << 2,          // Busy and missing in the Content Store
+        IDLE = 1u << 3              // Idle with a duplicated type
+    };
+
+    SiteThresholds thresholds_;
+    std::array<uint8_t, 16> priority_;   // Flags -> verdict
+
+    // Inputs
+    std::vector<float> capacity_;
+    std::vector<float> reserved_;
+    std::vector<float> cpu_;
+    std::vector<uint16_t> instances_;
+    std::vector<uint8_t> duplicateType_;
+    std::vector<float> interestRate_;
+    std::vector<float> hitRatio_;
+
+    // Per-cycle state
+    std::vector<uint8_t> flags_;
+    std::vector<uint8_t> next_;
+    std::vector<uint8_t> verdict_;
+    std::vector<SiteChange> changes_;
+};
+
+} // namespace cosim
+
+#endif // SITE_EVALUATOR_H
@@ -0,0 +1,83 @@
+/*
+Implementation of the running resource utilization aggregates
+*/
+
+#include "utilization_aggregates.h"
+#include <algorithm>
+#include <cmath>
+
+namespace cosim {
+
+// =============================================================================
+// RunningAggregate
+// =============================================================================
+
+size_t RunningAggregate::bucket(double value) {
+    double clamped = std::min(1.0, std::max(0.0, value));
+    return static_cast<size_t>(std::lround(clamped * (BUCKETS - 1)));
+}
+
+void RunningAggregate::add(double value) {
+    size_t b = bucket(value);
+    if (count_ == 0) {
+        minBucket_ = maxBucket_ = b;
+    } else {
+        minBucket_ = std::min(minBucket_, b);
+        maxBucket_ = std::max(maxBucket_, b);
+    }
+    buckets_[b]++;
+    count_++;
+    sum_ += value;
+}
+
+void RunningAggregate::remove(double value) {
+    size_t b = bucket(value);
+    if (count_ == 0 || buckets_[b] == 0) return;
+
+    buckets_[b]--;
+    count_--;
+    if (count_ == 0) {
+        sum_ = 0.0; // Drop accumulated rounding error once the group is empty
+        return;
+    }
+    sum_ -= value;
+
+    // Walks at most BUCKETS entries, independent of the number of instances
+    while (buckets_[minBucket_] == 0) minBucket_++;
+    while (buckets_[maxBucket_] == 0) maxBucket_--;
+}
+
+// =============================================================================
+// UtilizationAggregate / UtilizationIndex
+// =============================================================================
+
+void UtilizationAggregate::add(const ResourceLoad& load) {
+    cpu.add(load.cpu);
+    memory.add(load.memory);
+    network.add(load.network);
+}
+
+void UtilizationAggregate::remove(const ResourceLoad& load) {
+    cpu.remove(load.cpu);
+    memory.remove(load.memory);
+    network.remove(load.network);
+}
+
+void UtilizationIndex::add(size_t type, uint32_t location, const ResourceLoad& load) {
+    total_.add(load);
+    byType_[type].add(load);
+    byLocation_[location].add(load);
+}
+
+void UtilizationIndex::remove(size_t type, uint32_t location, const ResourceLoad& load) {
+    total_.remove(load);
+    byType_[type].remove(load);
+    byLocation_[location].remove(load);
+}
+
+void UtilizationIndex::move(uint32_t fromLocation, uint32_t toLocation, const ResourceLoad& load) {
+    byLocation_[fromLocation].remove(load);
+    byLocation_[toLocation].add(load);
+}
+
+} // namespace cosim
@@ -0,0 +1,83 @@
+/*
+Running resource utilization aggregates for the VNF registry
+Count, sum, min and max of CPU, memory and network load are maintained per VNF
+type, per location and over the whole fleet as instances are created, removed,
+relocated or change load, so every utilization query is O(1). Loads are fractions
+of capacity; sums are exact, while min and max come from a 256-bucket histogram
+over [0, 1] so that removing the current extreme never needs a fleet scan.
+*/
+
+#ifndef UTILIZATION_AGGREGATES_H
+#define UTILIZATION_AGGREGATES_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace cosim {
+
+class RunningAggregate {
+public:
+    static constexpr size_t BUCKETS = 256;
+
+    void add(double value);
+    void remove(double value);
+
+    uint32_t count() const { return count_; }
+    double sum() const { return sum_; }
+    double mean() const { return count_ > 0 ? sum_ / count_ : 0.0; }
+    double min() const { return count_ > 0 ? bucketValue(minBucket_) : 0.0; }  // 1/255 resolution
+    double max() const { return count_ > 0 ? bucketValue(maxBucket_) : 0.0; }
+
+private:
+    static size_t bucket(double value);
+    static double bucketValue(size_t bucket) { return static_cast<double>(bucket) / (BUCKETS - 1); }
+
+    std::array<uint32_t, BUCKETS> buckets_{};
+    uint32_t count_ = 0;
+    double sum_ = 0.0;
+    size_t minBucket_ = 0;
+    size_t maxBucket_ = 0;
+};
+
+struct ResourceLoad {
+    double cpu = 0.0;
+    double memory = 0.0;
+    double network = 0.0;
+};
+
+struct UtilizationAggregate {
+    RunningAggregate cpu;
+    RunningAggregate memory;
+    RunningAggregate network;
+
+    void add(const ResourceLoad& load);
+    void remove(const ResourceLoad& load);
+    uint32_t instances() const { return cpu.count(); }
+};
+
+// Fleet, per-type and per-location aggregates, kept in step by VNFRegistry
+class UtilizationIndex {
+public:
+    explicit UtilizationIndex(size_t typeCount) : byType_(typeCount) {}
+
+    void addLocation() { byLocation_.emplace_back(); }
+
+    void add(size_t type, uint32_t location, const ResourceLoad& load);
+    void remove(size_t type, uint32_t location, const ResourceLoad& load);
+    void move(uint32_t fromLocation, uint32_t toLocation, const ResourceLoad& load);
+
+    const UtilizationAggregate& total() const { return total_; }
+    const UtilizationAggregate& ofType(size_t type) const { return byType_[type]; }
+    const UtilizationAggregate& atLocation(uint32_t location) const { return byLocation_[location]; }
+
+private:
+    UtilizationAggregate total_;
+    std::vector<UtilizationAggregate> byType_;
+    std::vector<UtilizationAggregate> byLocation_;
+};
+
+} // namespace cosim
+
+#endif // UTILIZATION_AGGREGATES_H
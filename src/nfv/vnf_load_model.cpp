@@ -0,0 +1,87 @@
+/*
+Implementation of the VNF queueing model
+*/
+
+#include "vnf_load_model.h"
+#include <algorithm>
+#include <cmath>
+
+namespace cosim {
+
+// Capacities are scaled to ndnSIM consumer rates (tens to hundreds of Interests per second
+// per node) so that the intersection scenarios exercise the CPU thresholds
+VNFServiceProfile vnfServiceProfile(VNFType type) {
+    switch (type) {
+        case VNFType::NDN_ROUTER: return {500.0, 2.0, 200.0, 0.05, 0.2, true};        // Interest and Data
+        case VNFType::TRAFFIC_ANALYZER: return {1000.0, 2.0, 500.0, 0.05, 0.2, false}; // Mirrored traffic
+        case VNFType::SECURITY_VNF: return {400.0, 2.0, 100.0, 0.05, 0.2, true};      // Signature checks
+        case VNFType::CACHE_OPTIMIZER: return {2000.0, 1.0, 200.0, 0.05, 0.2, true};  // Content Store lookups
+        default: return {500.0, 2.0, 200.0, 0.05, 0.2, true};
+    }
+}
+
+void VNFLoadModel::clear() {
+    for (auto* column : {&arrival_, &service_, &servers_, &buffer_, &idle_, &baseMemory_,
+                         &utilization_, &cpu_, &memory_, &delay_, &drop_}) {
+        column->clear();
+    }
+}
+
+void VNFLoadModel::reserve(size_t instances) {
+    for (auto* column : {&arrival_, &service_, &servers_, &buffer_, &idle_, &baseMemory_,
+                         &utilization_, &cpu_, &memory_, &delay_, &drop_}) {
+        column->reserve(instances);
+    }
+}
+
+size_t VNFLoadModel::add(double interestRate, const VNFServiceProfile& profile, uint32_t servers) {
+    arrival_.push_back(std::max(0.0, interestRate) * profile.packetsPerInterest);
+    service_.push_back(profile.serviceRate);
+    servers_.push_back(std::max<uint32_t>(1, servers));
+    buffer_.push_back(std::max(1.0, profile.bufferPackets));
+    idle_.push_back(profile.idleUtilization);
+    baseMemory_.push_back(profile.baseMemory);
+    return arrival_.size() - 1;
+}
+
+void VNFLoadModel::evaluate() {
+    const size_t rows = arrival_.size();
+    utilization_.resize(rows);
+    cpu_.resize(rows);
+    memory_.resize(rows);
+    delay_.resize(rows);
+    drop_.resize(rows);
+
+    for (size_t i = 0; i < rows; ++i) {
+        const double lambda = arrival_[i];
+        const double mu = service_[i];
+        const double c = servers_[i];
+        const double a = lambda / mu;   // Offered load in Erlangs
+        const double rho = a / c;
+
+        double queued;                  // Mean packets waiting
+        if (rho < 1.0) {
+            // Erlang B by recursion over the servers, then Erlang C
+            double erlangB = 1.0;
+            for (double k = 1.0; k <= c; k += 1.0) {
+                erlangB = a * erlangB / (k + a * erlangB);
+            }
+            double erlangC = erlangB / (1.0 - rho * (1.0 - erlangB));
+            double wait = lambda > 0.0 ? erlangC / (c * mu - lambda) : 0.0;
+
+            queued = lambda * wait;
+            delay_[i] = wait + 1.0 / mu;
+            drop_[i] = erlangC * std::pow(rho, buffer_[i]);  // Queue already holds a full buffer
+        } else {
+            queued = buffer_[i];
+            delay_[i] = buffer_[i] / (c * mu) + 1.0 / mu;
+            drop_[i] = 1.0 - 1.0 / rho;
+        }
+
+        utilization_[i] = std::min(1.0, rho);
+        cpu_[i] = idle_[i] + (1.0 - idle_[i]) * utilization_[i];
+        memory_[i] = baseMemory_[i] + (1.0 - baseMemory_[i]) * std::min(1.0, queued / buffer_[i]);
+    }
+}
+
+} // namespace cosim
@@ -0,0 +1,70 @@
+/*
+Queueing model of VNF load
+Every instance is an M/M/c queue with a finite buffer: c servers (the cores it
+reserves), a per-server service rate from its type's profile and the packet
+rate routed to it. Utilization, mean sojourn time (Erlang C waiting plus
+service) and drop probability are computed for all instances at once over
+structure-of-arrays columns. Past saturation the queue is treated as a full
+buffer that sheds the excess.
+*/
+
+#ifndef VNF_LOAD_MODEL_H
+#define VNF_LOAD_MODEL_H
+
+#include "vnf_registry.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace cosim {
+
+struct VNFServiceProfile {
+    double serviceRate;         // Packets per second per server
+    double packetsPerInterest;  // Packets the VNF handles for each Interest routed to it
+    double bufferPackets;       // Queue capacity beyond the servers
+    double idleUtilization;     // CPU used with no traffic
+    double baseMemory;          // Memory fraction used with an empty queue
+    bool onPath;                // Sits on the Interest path (adds its sojourn time to latency)
+};
+
+VNFServiceProfile vnfServiceProfile(VNFType type);
+
+class VNFLoadModel {
+public:
+    void clear();
+    void reserve(size_t instances);
+
+    // Returns the row of the new instance
+    size_t add(double interestRate, const VNFServiceProfile& profile, uint32_t servers);
+
+    // Solves every row; O(rows x servers)
+    void evaluate();
+
+    size_t size() const { return arrival_.size(); }
+    double arrivalRate(size_t row) const { return arrival_[row]; }     // Packets per second
+    double utilization(size_t row) const { return utilization_[row]; } // Busy fraction of the servers
+    double cpu(size_t row) const { return cpu_[row]; }
+    double memory(size_t row) const { return memory_[row]; }
+    double delay(size_t row) const { return delay_[row]; }             // Mean sojourn time, seconds
+    double dropProbability(size_t row) const { return drop_[row]; }
+
+private:
+    // Inputs
+    std::vector<double> arrival_;
+    std::vector<double> service_;
+    std::vector<double> servers_;
+    std::vector<double> buffer_;
+    std::vector<double> idle_;
+    std::vector<double> baseMemory_;
+
+    // Outputs
+    std::vector<double> utilization_;
+    std::vector<double> cpu_;
+    std::vector<double> memory_;
+    std::vector<double> delay_;
+    std::vector<double> drop_;
+};
+
+} // namespace cosim
+
+#endif // VNF_LOAD_MODEL_H
@@ -0,0 +1,227 @@
+/*
+Implementation of the VNF instance registry
+*/
+
+#include "vnf_registry.h"
+#include <algorithm>
+
+namespace cosim {
+
+VNFRegistry::VNFRegistry() : utilization_(VNF_TYPE_COUNT), journal_(JOURNAL_CAPACITY) {}
+
+VNFRegistry::Slot* VNFRegistry::liveSlot(VNFHandle handle) {
+    if (handle.index >= slots_.size()) return nullptr;
+    Slot& slot = slots_[handle.index];
+    return (slot.live && slot.generation == handle.generation) ? &slot : nullptr;
+}
+
+const VNFRegistry::Slot* VNFRegistry::liveSlot(VNFHandle handle) const {
+    if (handle.index >= slots_.size()) return nullptr;
+    const Slot& slot = slots_[handle.index];
+    return (slot.live && slot.generation == handle.generation) ? &slot : nullptr;
+}
+
+const VNFInstance* VNFRegistry::get(VNFHandle handle) const {
+    const Slot* slot = liveSlot(handle);
+    return slot ? &slot->instance : nullptr;
+}
+
+VNFHandle VNFRegistry::find(const std::string& instanceId) const {
+    auto it = idIndex_.find(instanceId);
+    return it != idIndex_.end() ? handleOf(it->second) : VNFHandle{};
+}
+
+void VNFRegistry::link(std::vector<uint32_t>& list, uint32_t index, uint32_t Slot::*backPointer) {
+    slots_[index].*backPointer = static_cast<uint32_t>(list.size());
+    list.push_back(index);
+}
+
+void VNFRegistry::unlink(std::vector<uint32_t>& list, uint32_t pos, uint32_t Slot::*backPointer) {
+    uint32_t moved = list.back();
+    list[pos] = moved;
+    slots_[moved].*backPointer = pos;
+    list.pop_back();
+}
+
+uint32_t VNFRegistry::internLocation(const std::string& location) {
+    auto it = locationIds_.find(location);
+    if (it != locationIds_.end()) {
+        return it->second;
+    }
+
+    uint32_t id = static_cast<uint32_t>(locationNames_.size());
+    locationIds_.emplace(location, id);
+    locationNames_.push_back(location);
+    for (auto& perLocation : byTypeLocation_) {
+        perLocation.emplace_back();
+    }
+    utilization_.addLocation();
+    return id;
+}
+
+bool VNFRegistry::findLocation(const std::string& location, uint32_t& id) const {
+    auto it = locationIds_.find(location);
+    if (it == locationIds_.end()) return false;
+    id = it->second;
+    return true;
+}
+
+const std::vector<uint32_t>* VNFRegistry::typeLocationList(VNFType type, const std::string& location) const {
+    uint32_t id;
+    if (!findLocation(location, id)) return nullptr;
+    return &byTypeLocation_[typeIndex(type)][id];
+}
+
+VNFHandle VNFRegistry::create(VNFInstance instance) {
+    uint32_t index;
+    if (freeHead_ != VNFHandle::INVALID) {
+        index = freeHead_;
+        freeHead_ = slots_[index].nextFree;
+    } else {
+        index = static_cast<uint32_t>(slots_.size());
+        slots_.emplace_back();
+    }
+
+    uint32_t locationId = internLocation(instance.location);
+    size_t type = typeIndex(instance.type);
+
+    Slot& slot = slots_[index];
+    slot.instance = std::move(instance);
+    slot.locationId = locationId;
+    slot.live = true;
+    slot.nextFree = VNFHandle::INVALID;
+
+    link(byType_[type], index, &Slot::typePos);
+    link(byTypeLocation_[type][locationId], index, &Slot::typeLocationPos);
+    link(byState_[static_cast<size_t>(slot.instance.state)], index, &Slot::statePos);
+    idIndex_[slot.instance.instanceId] = index;
+    utilization_.add(type, locationId, loadOf(slot.instance));
+
+    liveCount_++;
+    createdTotal_[type]++;
+    record(VNFChangeKind::CREATED, index, locationId, slot.instance.state);
+    return handleOf(index);
+}
+
+bool VNFRegistry::destroy(VNFHandle handle) {
+    Slot* slot = liveSlot(handle);
+    if (!slot) return false;
+
+    size_t type = typeIndex(slot->instance.type);
+    unlink(byType_[type], slot->typePos, &Slot::typePos);
+    unlink(byTypeLocation_[type][slot->locationId], slot->typeLocationPos, &Slot::typeLocationPos);
+    unlink(byState_[static_cast<size_t>(slot->instance.state)], slot->statePos, &Slot::statePos);
+    idIndex_.erase(slot->instance.instanceId);
+    utilization_.remove(type, slot->locationId, loadOf(slot->instance));
+
+    // Journal before the generation bump so the entry names the handle callers held
+    record(VNFChangeKind::DESTROYED, handle.index, slot->locationId, slot->instance.state);
+
+    slot->live = false;
+    slot->generation++;
+    slot->nextFree = freeHead_;
+    freeHead_ = handle.index;
+    liveCount_--;
+    return true;
+}
+
+bool VNFRegistry::relocate(VNFHandle handle, const std::string& location) {
+    Slot* slot = liveSlot(handle);
+    if (!slot) return false;
+
+    // internLocation may grow the per-location lists; slot pointers stay valid
+    uint32_t target = internLocation(location);
+    uint32_t source = slot->locationId;
+    if (target == source) return true;
+
+    size_t type = typeIndex(slot->instance.type);
+    unlink(byTypeLocation_[type][source], slot->typeLocationPos, &Slot::typeLocationPos);
+    link(byTypeLocation_[type][target], handle.index, &Slot::typeLocationPos);
+    utilization_.move(source, target, loadOf(slot->instance));
+    slot->locationId = target;
+    slot->instance.location = location;
+
+    record(VNFChangeKind::RELOCATED, handle.index, source, slot->instance.state);
+    return true;
+}
+
+bool VNFRegistry::setState(VNFHandle handle, VNFState state) {
+    Slot* slot = liveSlot(handle);
+    if (!slot) return false;
+
+    VNFState previous = slot->instance.state;
+    if (previous == state) return true;
+
+    unlink(byState_[static_cast<size_t>(previous)], slot->statePos, &Slot::statePos);
+    link(byState_[static_cast<size_t>(state)], handle.index, &Slot::statePos);
+    slot->instance.state = state;
+
+    record(VNFChangeKind::STATE_CHANGED, handle.index, slot->locationId, previous);
+    return true;
+}
+
+bool VNFRegistry::updateLoad(VNFHandle handle, const ResourceLoad& load) {
+    Slot* slot = liveSlot(handle);
+    if (!slot) return false;
+
+    size_t type = typeIndex(slot->instance.type);
+    utilization_.remove(type, slot->locationId, loadOf(slot->instance));
+    slot->instance.cpuUsage = load.cpu;
+    slot->instance.memoryUsage = load.memory;
+    slot->instance.networkLoad = load.network;
+    utilization_.add(type, slot->locationId, load);
+    return true;
+}
+
+const UtilizationAggregate* VNFRegistry::utilizationAt(const std::string& location) const {
+    uint32_t id;
+    return findLocation(location, id) ? &utilization_.atLocation(id) : nullptr;
+}
+
+size_t VNFRegistry::count(VNFType type, const std::string& location) const {
+    const std::vector<uint32_t>* list = typeLocationList(type, location);
+    return list ? list->size() : 0;
+}
+
+VNFHandle VNFRegistry::firstOf(VNFType type) const {
+    const auto& list = byType_[typeIndex(type)];
+    return list.empty() ? VNFHandle{} : handleOf(list.front());
+}
+
+VNFHandle VNFRegistry::lastOf(VNFType type) const {
+    const auto& list = byType_[typeIndex(type)];
+    return list.empty() ? VNFHandle{} : handleOf(list.back());
+}
+
+VNFHandle VNFRegistry::firstOf(VNFType type, const std::string& location) const {
+    const std::vector<uint32_t>* list = typeLocationList(type, location);
+    return (list && !list->empty()) ? handleOf(list->front()) : VNFHandle{};
+}
+
+void VNFRegistry::record(VNFChangeKind kind, uint32_t index, uint32_t fromLocation, VNFState fromState) {
+    const Slot& slot = slots_[index];
+
+    VNFChange& change = journal_[journalSequence_ % JOURNAL_CAPACITY];
+    change.sequence = journalSequence_++;
+    change.timestamp = now_;
+    change.kind = kind;
+    change.handle = {index, slot.generation};
+    change.type = slot.instance.type;
+    change.fromLocation = fromLocation;
+    change.toLocation = slot.locationId;
+    change.fromState = fromState;
+    change.toState = slot.instance.state;
+}
+
+uint64_t VNFRegistry::readJournal(uint64_t& cursor, std::vector<VNFChange>& out) const {
+    uint64_t oldest = journalSequence_ > JOURNAL_CAPACITY ? journalSequence_ - JOURNAL_CAPACITY : 0;
+    uint64_t lost = cursor < oldest ? oldest - cursor : 0;
+
+    for (uint64_t seq = std::max(cursor, oldest); seq < journalSequence_; ++seq) {
+        out.push_back(journal_[seq % JOURNAL_CAPACITY]);
+    }
+    cursor = journalSequence_;
+    return lost;
+}
+
+} // namespace cosim
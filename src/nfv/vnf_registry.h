@@ -0,0 +1,211 @@
+/*
+VNF instance registry
+Instances live in a pooled slot array and are addressed by (index, generation)
+handles, so a handle to a removed instance is detected instead of aliasing the
+slot's next occupant. Secondary indexes by type, by (type, location) and by state
+are kept as dense lists with back-pointers, which makes create, destroy,
+relocate and state changes O(1) and lets queries visit only matching instances.
+Resource utilization aggregates per type, per location and fleet-wide are kept
+in step with every mutation. Every lifecycle change is appended to a bounded
+change journal that consumers read with a cursor.
+*/
+
+#ifndef VNF_REGISTRY_H
+#define VNF_REGISTRY_H
+
+#include "utilization_aggregates.h"
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace cosim {
+
+// VNF Types as defined in methodology
+enum class VNFType {
+    NDN_ROUTER,
+    TRAFFIC_ANALYZER,
+    SECURITY_VNF,
+    CACHE_OPTIMIZER
+};
+
+constexpr size_t VNF_TYPE_COUNT = 4;
+
+enum class VNFState : uint8_t {
+    ACTIVE,
+    INACTIVE
+};
+
+constexpr size_t VNF_STATE_COUNT = 2;
+
+// VNF Instance state
+struct VNFInstance {
+    std::string instanceId;
+    VNFType type;
+    std::string location;
+    double cpuUsage;
+    double memoryUsage;
+    double networkLoad;
+    VNFState state;
+    std::chrono::steady_clock::time_point createdAt;
+};
+
+struct VNFHandle {
+    static constexpr uint32_t INVALID = 0xffffffffu;
+
+    uint32_t index = INVALID;
+    uint32_t generation = 0;
+
+    bool valid() const { return index != INVALID; }
+    bool operator==(const VNFHandle& other) const { return index == other.index && generation == other.generation; }
+    bool operator!=(const VNFHandle& other) const { return !(*this == other); }
+};
+
+enum class VNFChangeKind : uint8_t {
+    CREATED,
+    DESTROYED,
+    RELOCATED,
+    STATE_CHANGED
+};
+
+// One journal entry; locations are registry location ids (see locationName())
+struct VNFChange {
+    uint64_t sequence = 0;
+    double timestamp = 0.0;
+    VNFChangeKind kind = VNFChangeKind::CREATED;
+    VNFHandle handle;
+    VNFType type = VNFType::NDN_ROUTER;
+    uint32_t fromLocation = 0;
+    uint32_t toLocation = 0;
+    VNFState fromState = VNFState::ACTIVE;
+    VNFState toState = VNFState::ACTIVE;
+};
+
+class VNFRegistry {
+public:
+    static constexpr size_t JOURNAL_CAPACITY = 4096;
+
+    VNFRegistry();
+
+    // Simulation time stamped on journal entries
+    void setTime(double simTime) { now_ = simTime; }
+
+    // Lifecycle; all O(1) amortized
+    VNFHandle create(VNFInstance instance);
+    bool destroy(VNFHandle handle);
+    bool relocate(VNFHandle handle, const std::string& location);
+    bool setState(VNFHandle handle, VNFState state);
+
+    // Load fields must change through here so the utilization aggregates stay exact
+    bool updateLoad(VNFHandle handle, const ResourceLoad& load);
+
+    // Lookup; nullptr for stale or invalid handles
+    const VNFInstance* get(VNFHandle handle) const;
+    VNFHandle find(const std::string& instanceId) const;
+
+    // Index queries
+    size_t size() const { return liveCount_; }
+    size_t count(VNFType type) const { return byType_[typeIndex(type)].size(); }
+    size_t count(VNFType type, const std::string& location) const;
+    size_t count(VNFType type, uint32_t locationId) const { return byTypeLocation_[typeIndex(type)][locationId].size(); }
+    size_t count(VNFState state) const { return byState_[static_cast<size_t>(state)].size(); }
+    uint64_t createdTotal(VNFType type) const { return createdTotal_[typeIndex(type)]; }
+
+    // Utilization aggregates, O(1)
+    const UtilizationAggregate& utilization() const { return utilization_.total(); }
+    const UtilizationAggregate& utilization(VNFType type) const { return utilization_.ofType(typeIndex(type)); }
+    const UtilizationAggregate* utilizationAt(const std::string& location) const;
+    const UtilizationAggregate& utilizationAt(uint32_t locationId) const { return utilization_.atLocation(locationId); }
+
+    // Any instance of a type (optionally at a location); invalid handle if there is none
+    VNFHandle firstOf(VNFType type) const;
+    VNFHandle lastOf(VNFType type) const;
+    VNFHandle firstOf(VNFType type, const std::string& location) const;
+
+    template <typename Fn>
+    void forEach(Fn&& fn) const {
+        for (const auto& list : byType_) visit(list, fn);
+    }
+    template <typename Fn>
+    void forEachOfType(VNFType type, Fn&& fn) const {
+        visit(byType_[typeIndex(type)], fn);
+    }
+    template <typename Fn>
+    void forEachAt(VNFType type, const std::string& location, Fn&& fn) const {
+        const std::vector<uint32_t>* list = typeLocationList(type, location);
+        if (list) visit(*list, fn);
+    }
+    template <typename Fn>
+    void forEachInState(VNFState state, Fn&& fn) const {
+        visit(byState_[static_cast<size_t>(state)], fn);
+    }
+
+    // Dense location ids shared with the journal
+    uint32_t internLocation(const std::string& location);
+    bool findLocation(const std::string& location, uint32_t& id) const;
+    const std::string& locationName(uint32_t id) const { return locationNames_[id]; }
+    size_t locationCount() const { return locationNames_.size(); }
+    uint32_t locationIdOf(VNFHandle handle) const { return slots_[handle.index].locationId; }   // Live handles only
+
+    // Change journal. Copies entries after `cursor` into `out` and advances it;
+    // returns how many entries were overwritten before they could be read.
+    uint64_t journalHead() const { return journalSequence_; }
+    uint64_t readJournal(uint64_t& cursor, std::vector<VNFChange>& out) const;
+
+private:
+    struct Slot {
+        VNFInstance instance;
+        uint32_t generation = 0;
+        uint32_t nextFree = VNFHandle::INVALID;
+        uint32_t locationId = 0;
+        uint32_t typePos = 0;          // Back-pointers into the index lists
+        uint32_t typeLocationPos = 0;
+        uint32_t statePos = 0;
+        bool live = false;
+    };
+
+    static size_t typeIndex(VNFType type) { return static_cast<size_t>(type); }
+    static ResourceLoad loadOf(const VNFInstance& instance) {
+        return {instance.cpuUsage, instance.memoryUsage, instance.networkLoad};
+    }
+
+    Slot* liveSlot(VNFHandle handle);
+    const Slot* liveSlot(VNFHandle handle) const;
+    VNFHandle handleOf(uint32_t index) const { return {index, slots_[index].generation}; }
+    const std::vector<uint32_t>* typeLocationList(VNFType type, const std::string& location) const;
+
+    // Swap-remove from an index list, fixing the back-pointer of the entry moved into the hole
+    void unlink(std::vector<uint32_t>& list, uint32_t pos, uint32_t Slot::*backPointer);
+    void link(std::vector<uint32_t>& list, uint32_t index, uint32_t Slot::*backPointer);
+
+    void record(VNFChangeKind kind, uint32_t index, uint32_t fromLocation, VNFState fromState);
+
+    template <typename Fn>
+    void visit(const std::vector<uint32_t>& list, Fn& fn) const {
+        for (uint32_t index : list) fn(handleOf(index), slots_[index].instance);
+    }
+
+    std::vector<Slot> slots_;
+    uint32_t freeHead_ = VNFHandle::INVALID;
+    size_t liveCount_ = 0;
+
+    std::array<std::vector<uint32_t>, VNF_TYPE_COUNT> byType_;
+    std::array<std::vector<std::vector<uint32_t>>, VNF_TYPE_COUNT> byTypeLocation_; // [type][locationId]
+    std::array<std::vector<uint32_t>, VNF_STATE_COUNT> byState_;
+    std::array<uint64_t, VNF_TYPE_COUNT> createdTotal_{};
+    UtilizationIndex utilization_;
+
+    std::unordered_map<std::string, uint32_t> idIndex_;
+    std::unordered_map<std::string, uint32_t> locationIds_;
+    std::vector<std::string> locationNames_;
+
+    std::vector<VNFChange> journal_;
+    uint64_t journalSequence_ = 0;
+    double now_ = 0.0;
+};
+
+} // namespace cosim
+
+#endif // VNF_REGISTRY_H
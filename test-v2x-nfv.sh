@@ -33,9 +33,17 @@ fi
 
 echo "✅ Build successful"
 
+# Round-trip checks for the stored formats, accuracy of the latency histogram
+echo "🧪 Running format and histogram checks..."
+if ! make check; then
+    echo "❌ Format or histogram checks failed"
+    exit 1
+fi
+
 # Copy NS-3 script to the right location
 echo "📋 Preparing NS-3 co-simulation script..."
 cp ns3-scripts/v2x-ndn-nfv-cosim.cc /home/rajesh/ndnSIM/ns-3/scratch/
+cp ns3-scripts/ndn-binary-tracer.hpp ns3-scripts/ndn-partition-bridge.hpp src/common/event_log.h src/common/partition_protocol.h src/common/event_sampler.h /home/rajesh/ndnSIM/ns-3/scratch/
 
 # Test 1: Mock simulators
 echo "🧪 Test 1: Mock simulators (basic functionality)"
@@ -118,3 +126,7 @@ echo ""
 echo "  # Fast sync for V2X applications:"
 echo "  ./v2x-ndn-nfv-cosim --real-ns3 --sync-interval 50 --sim-time 30"
 echo ""
+echo "  # Kathmandu regions split across 4 ndnSIM processes:"
+echo "  ./v2x-ndn-nfv-cosim --real-omnet --partitions 4 --partition-port 10000 --sim-time 60"
+echo "  ./waf --run \"v2x-ndn-nfv-cosim --partition=<i> --partitions=4 --partition-port=10000\"  # i = 0..3"
+echo ""
@@ -0,0 +1,155 @@
+/*
+Accuracy check for the latency histogram
+Records known values and compares percentiles, bucket bounds and the summary
+statistics with exact ones computed from the sorted samples: every reported
+value must lie in the bucket of the exact one, i.e. at or above it and less
+than one bucket width (3 significant digits, or the 512 ns unit) past it.
+Also checks clamping, reset and that the table printers leave the stream's
+format state alone.
+*/
+
+#include "latency_histogram.h"
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <vector>
+
+using namespace cosim;
+
+namespace {
+
+int failures = 0;
+
+void check(bool ok, const std::string& what) {
+    if (!ok) {
+        std::cerr << "❌ " << what << std::endl;
+        failures++;
+    }
+}
+
+// Widest bucket that may hold `value` with the default range and precision
+bool withinBucket(uint64_t reported, uint64_t exact) {
+    return reported >= exact && static_cast<double>(reported - exact) < std::max(512.0, exact / 1024.0);
+}
+
+void checkBuckets() {
+    std::mt19937_64 rng(5);
+    for (int magnitude = 0; magnitude < 35; ++magnitude) {      // Up to 34 s, inside the default range
+        for (int i = 0; i < 50; ++i) {
+            uint64_t value = (1ULL << magnitude) + rng() % (1ULL << magnitude);
+            LatencyHistogram histogram;
+            histogram.record(value);
+            std::vector<LatencyHistogram::Bucket> buckets = histogram.distribution();
+            if (buckets.size() != 1 || !withinBucket(buckets.front().upper, value) ||
+                buckets.front().percentile != 100.0) {
+                check(false, "bucket bounds for " + std::to_string(value) + " ns");
+                return;
+            }
+
+            // The next value past the bucket starts another one
+            histogram.record(buckets.front().upper + 1);
+            if (histogram.distribution().size() != 2) {
+                check(false, "bucket after " + std::to_string(buckets.front().upper) + " ns");
+                return;
+            }
+        }
+    }
+}
+
+void checkPercentiles() {
+    std::mt19937_64 rng(9);
+    std::lognormal_distribution<double> latency(std::log(2e6), 1.5);     // Around 2 ms, long tail
+    std::vector<uint64_t> values;
+    LatencyHistogram histogram;
+    uint64_t sum = 0;
+    for (int i = 0; i < 200000; ++i) {
+        uint64_t value = 1 + static_cast<uint64_t>(std::min(latency(rng), 5e10));
+        values.push_back(value);
+        histogram.record(value);
+        sum += value;
+    }
+    std::sort(values.begin(), values.end());
+
+    check(histogram.count() == values.size(), "count");
+    check(histogram.min() == values.front() && histogram.max() == values.back(), "min and max are exact");
+    check(histogram.mean() == static_cast<double>(sum) / values.size(), "mean is exact");
+    check(histogram.clamped() == 0, "nothing clamped in range");
+
+    for (double percentile : {0.0, 1.0, 25.0, 50.0, 90.0, 99.0, 99.9, 99.99, 100.0}) {
+        size_t rank = std::max<size_t>(1, static_cast<size_t>(std::ceil(percentile / 100.0 * values.size())));
+        uint64_t exact = values[rank - 1];
+        uint64_t reported = histogram.valueAtPercentile(percentile);
+        check(withinBucket(reported, exact) || (percentile == 100.0 && reported == exact),
+              "p" + std::to_string(percentile) + ": " + std::to_string(reported) + " ns for exact " +
+              std::to_string(exact) + " ns");
+    }
+
+    // Buckets are in value order, partition the samples and end at 100%
+    std::vector<LatencyHistogram::Bucket> buckets = histogram.distribution();
+    uint64_t counted = 0;
+    size_t below = 0;
+    bool ordered = true;
+    for (size_t i = 0; i < buckets.size(); ++i) {
+        ordered = ordered && (i == 0 || (buckets[i].upper > buckets[i - 1].upper &&
+                                         buckets[i].percentile >= buckets[i - 1].percentile));
+        counted += buckets[i].count;
+        below = std::upper_bound(values.begin(), values.end(), buckets[i].upper) - values.begin();
+        if (below != counted) {
+            check(false, "bucket up to " + std::to_string(buckets[i].upper) + " ns holds the samples below it");
+            break;
+        }
+    }
+    check(ordered, "buckets in value order");
+    check(counted == values.size(), "bucket counts add up");
+    check(!buckets.empty() && buckets.back().percentile == 100.0, "last bucket at 100%");
+}
+
+void checkClampAndReset() {
+    LatencyHistogram histogram(1000, 1000000000ULL);
+    histogram.record(5000);
+    histogram.record(std::chrono::seconds(3));
+    histogram.recordSeconds(-1.0);
+    check(histogram.clamped() == 1, "value over the range is clamped");
+    check(histogram.max() == 1000000000ULL, "clamped value counts as the highest");
+    check(histogram.min() == 0, "negative seconds record as zero");
+    check(withinBucket(histogram.valueAtPercentile(100.0), 1000000000ULL) ||
+          histogram.valueAtPercentile(100.0) == 1000000000ULL, "p100 of a clamped value");
+
+    histogram.reset();
+    check(histogram.count() == 0 && histogram.max() == 0 && histogram.min() == 0 && histogram.clamped() == 0,
+          "reset clears the counters");
+    check(histogram.valueAtPercentile(50.0) == 0 && histogram.distribution().empty(), "reset clears the buckets");
+}
+
+void checkPrinting() {
+    LatencyHistogram empty;
+    LatencyHistogram filled;
+    filled.record(1500000);
+
+    std::ostringstream out;
+    out << std::scientific << std::setprecision(9);
+    const std::ios_base::fmtflags flags = out.flags();
+    LatencyHistogram::printHeader(out, 8);
+    filled.printRow(out, "filled", 8);
+    empty.printRow(out, "empty", 8);
+    check(out.flags() == flags && out.precision() == 9, "table rows leave the stream format alone");
+    check(out.str().find("     1.500") != std::string::npos, "row prints milliseconds to 3 decimals");
+}
+
+} // anonymous namespace
+
+int main() {
+    checkBuckets();
+    checkPercentiles();
+    checkClampAndReset();
+    checkPrinting();
+    if (failures > 0) {
+        std::cerr << "❌ histogram_check: " << failures << " failure(s)" << std::endl;
+        return 1;
+    }
+    std::cout << "✅ histogram_check passed" << std::endl;
+    return 0;
+}
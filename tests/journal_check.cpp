@@ -0,0 +1,244 @@
+/*
+Round-trip check for the binary decision journal
+Drives a registry through creates, relocations, state changes and removals,
+journals every step, then rebuilds the fleet with DecisionJournal::stateAt at
+each step and compares it with what the registry held. Corrupted copies of the
+journal (a runaway name id, an oversized snapshot, a short decision) must stop
+the replay at the bad record instead of reading past it.
+*/
+
+#include "decision_journal.h"
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <random>
+#include <set>
+#include <unistd.h>
+
+using namespace cosim;
+using namespace cosim::decisionjournal;
+
+namespace {
+
+int failures = 0;
+
+void check(bool ok, const std::string& what) {
+    if (!ok) {
+        std::cerr << "❌ " << what << std::endl;
+        failures++;
+    }
+}
+
+using Fleet = std::set<std::string>;
+
+std::string describe(const std::string& id, const std::string& location, VNFState state) {
+    return id + "@" + location + (state == VNFState::ACTIVE ? "" : "/inactive");
+}
+
+Fleet fleetOf(const VNFRegistry& registry) {
+    Fleet fleet;
+    registry.forEach([&](VNFHandle, const VNFInstance& instance) {
+        fleet.insert(describe(instance.instanceId, instance.location, instance.state));
+    });
+    return fleet;
+}
+
+Fleet fleetOf(const JournalState& state) {
+    Fleet fleet;
+    for (const auto& instance : state.instances) {
+        fleet.insert(describe(instance.instanceId, instance.location, instance.state));
+    }
+    return fleet;
+}
+
+std::string tempPath() {
+    char path[] = "/tmp/journal_checkXXXXXX";
+    int fd = mkstemp(path);
+    if (fd >= 0) {
+        ::close(fd);
+    }
+    return path;
+}
+
+std::string readFile(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+void writeFile(const std::string& path, const std::string& bytes) {
+    std::ofstream(path, std::ios::binary | std::ios::trunc).write(bytes.data(), bytes.size());
+}
+
+// Offset of the record of `kind` that follows `skip` others past the middle of the journal, or 0
+size_t findRecord(const std::string& bytes, uint8_t kind, size_t skip) {
+    size_t offset = sizeof(FILE_MAGIC) + 8;
+    while (offset + sizeof(RecordHeader) <= bytes.size()) {
+        RecordHeader header;
+        std::memcpy(&header, bytes.data() + offset, sizeof(header));
+        if (header.kind == kind && offset > bytes.size() / 2 && skip-- == 0) {
+            return offset;
+        }
+        offset += sizeof(RecordHeader) + header.length;
+    }
+    return 0;
+}
+
+// A corrupted copy opens, but its replay ends before the bad record
+void checkCorrupted(const std::string& bytes, const std::string& what, double badTime) {
+    std::string path = tempPath();
+    writeFile(path, bytes);
+    DecisionJournal journal;
+    check(journal.open(path), what + ": journal still opens");
+    check(journal.endTime() <= badTime, what + ": replay stops at the bad record");
+    JournalState state;
+    check(journal.stateAt(1e9, state), what + ": state before the bad record is readable");
+    std::remove(path.c_str());
+}
+
+} // anonymous namespace
+
+int main() {
+    std::string path = tempPath();
+    std::map<double, Fleet> expected;
+    uint64_t decisions = 0;
+
+    {
+        VNFRegistry registry;
+        DecisionJournalWriter writer;
+        if (!writer.open(path, 5.0)) return 1;
+
+        std::mt19937 rng(11);
+        const char* sites[] = {"RSU_1", "RSU_2", "EDGE_1", "EDGE_2", "CLOUD"};
+        std::vector<VNFHandle> live;
+        uint64_t cursor = registry.journalHead();
+        int created = 0;
+
+        for (int step = 1; step <= 400; ++step) {
+            double time = step * 0.5;
+            registry.setTime(time);
+
+            NFVDecision decision = {};
+            decision.vnfType = static_cast<VNFType>(rng() % VNF_TYPE_COUNT);
+            decision.targetInstances = static_cast<int>(rng() % 5);
+            decision.timestamp = time;
+            decision.priority = 3;
+
+            unsigned op = live.empty() ? 0 : rng() % 4;
+            if (op == 0) {
+                VNFInstance instance = {};
+                instance.instanceId = "vnf_" + std::to_string(++created);
+                instance.type = decision.vnfType;
+                instance.location = sites[rng() % 5];
+                instance.state = VNFState::ACTIVE;
+                live.push_back(registry.create(instance));
+                decision.action = "SCALE_UP";
+                decision.reasonKey = "load";
+            } else {
+                size_t pick = rng() % live.size();
+                VNFHandle handle = live[pick];
+                if (op == 1) {
+                    registry.destroy(handle);
+                    live.erase(live.begin() + pick);
+                    decision.action = "SCALE_DOWN";
+                } else if (op == 2) {
+                    decision.targetLocation = sites[rng() % 5];
+                    registry.relocate(handle, decision.targetLocation);
+                    decision.action = "MIGRATE";
+                } else {
+                    const VNFInstance* instance = registry.get(handle);
+                    registry.setState(handle, instance->state == VNFState::ACTIVE ? VNFState::INACTIVE
+                                                                                  : VNFState::ACTIVE);
+                    decision.action = "OPTIMIZE";
+                }
+                decision.reasonKey = "rule_" + std::to_string(op);
+            }
+
+            GovernorVerdict verdict = step % 7 == 0 ? GovernorVerdict::COOLDOWN : GovernorVerdict::ADMIT;
+            uint64_t sequence = writer.appendDecision(time, decision, verdict);
+            std::vector<VNFChange> changes;
+            registry.readJournal(cursor, changes);
+            writer.appendChanges(registry, changes, sequence);
+            if (writer.snapshotDue(time)) {
+                writer.snapshot(time, registry);
+            }
+            expected[time] = fleetOf(registry);
+            decisions++;
+        }
+        writer.close();
+    }
+
+    DecisionJournal journal;
+    check(journal.open(path), "journal opens");
+    check(journal.decisionCount() == decisions, "decision count");
+    check(journal.snapshotCount() > 10, "snapshots written every 5 s");
+
+    for (const auto& step : expected) {
+        JournalState state;
+        check(journal.stateAt(step.first, state), "stateAt succeeds");
+        if (fleetOf(state) != step.second) {
+            check(false, "fleet at t=" + std::to_string(step.first) + " differs from the registry");
+            break;
+        }
+    }
+
+    std::vector<JournalDecision> between;
+    journal.decisionsBetween(10.0, 20.0, between);
+    check(between.size() == 21, "decisions in [10, 20]");
+    check(!between.empty() && between.front().time == 10.0 && between.front().sequence == 20,
+          "first decision in the window");
+    journal.close();
+
+    // Corruptions past the middle of the journal: a name id far beyond the names seen,
+    // a snapshot whose instance count overruns its record, a decision cut to 8 bytes
+    std::string bytes = readFile(path);
+    auto recordTime = [&](size_t offset) {
+        RecordHeader header;
+        std::memcpy(&header, bytes.data() + offset, sizeof(header));
+        return header.time;
+    };
+
+    size_t name = findRecord(bytes, NAME, 0);
+    check(name != 0, "journal has a name record to corrupt");
+    if (name != 0) {
+        std::string copy = bytes;
+        uint32_t id = 0xFFFFFFFF;
+        std::memcpy(&copy[name + sizeof(RecordHeader)], &id, sizeof(id));
+        checkCorrupted(copy, "runaway name id", recordTime(name));
+    }
+
+    size_t snapshot = findRecord(bytes, SNAPSHOT, 0);
+    check(snapshot != 0, "journal has a snapshot record to corrupt");
+    if (snapshot != 0) {
+        std::string copy = bytes;
+        SnapshotHeader header;
+        std::memcpy(&header, &copy[snapshot + sizeof(RecordHeader)], sizeof(header));
+        header.count += 1000;
+        std::memcpy(&copy[snapshot + sizeof(RecordHeader)], &header, sizeof(header));
+        checkCorrupted(copy, "oversized snapshot", recordTime(snapshot));
+    }
+
+    size_t decision = findRecord(bytes, DECISION, 3);
+    check(decision != 0, "journal has a decision record to corrupt");
+    if (decision != 0) {
+        std::string copy = bytes;
+        RecordHeader header;
+        std::memcpy(&header, &copy[decision], sizeof(header));
+        uint32_t shortLength = 8;
+        std::string tail = copy.substr(decision + sizeof(RecordHeader) + header.length);
+        header.length = shortLength;
+        std::memcpy(&copy[decision], &header, sizeof(header));
+        copy = copy.substr(0, decision + sizeof(RecordHeader) + shortLength) + tail;
+        checkCorrupted(copy, "short decision record", recordTime(decision));
+    }
+
+    std::remove(path.c_str());
+    if (failures > 0) {
+        std::cerr << "❌ journal_check: " << failures << " failure(s)" << std::endl;
+        return 1;
+    }
+    std::cout << "✅ journal_check passed" << std::endl;
+    return 0;
+}
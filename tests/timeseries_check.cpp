@@ -0,0 +1,163 @@
+/*
+Round-trip check for the time-series store
+Encodes samples that exercise every Gorilla timestamp class and value window,
+decodes them back and compares bit for bit (timestamps at the encoder's
+microsecond resolution), then checks the same through the store's ring-to-cold
+eviction path and its rollups.
+*/
+
+#include "timeseries_store.h"
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <vector>
+
+using namespace cosim;
+
+namespace {
+
+int failures = 0;
+
+void check(bool ok, const std::string& what) {
+    if (!ok) {
+        std::cerr << "❌ " << what << std::endl;
+        failures++;
+    }
+}
+
+bool sameBits(double a, double b) {
+    return std::memcmp(&a, &b, sizeof(a)) == 0;
+}
+
+int64_t micros(double time) {
+    return std::llround(time * 1e6);
+}
+
+// Times on a microsecond grid with jitter hitting every delta-of-delta class,
+// values mixing repeats, small steps, random doubles and special values
+std::vector<Sample> makeSamples(size_t count) {
+    std::mt19937_64 rng(7);
+    std::uniform_int_distribution<int64_t> jitter(-3000, 3000);
+    std::uniform_real_distribution<double> noise(-1e6, 1e6);
+    const double specials[] = {0.0, -0.0, 1e-300, -1e300, std::numeric_limits<double>::infinity(),
+                               std::numeric_limits<double>::quiet_NaN()};
+
+    std::vector<Sample> samples;
+    int64_t time = 1000000;
+    for (size_t i = 0; i < count; ++i) {
+        switch (i % 6) {
+            case 0: time += 100000; break;                  // Steady 100 ms
+            case 1: time += 100000 + jitter(rng) / 50; break;
+            case 2: time += 100000 + jitter(rng) / 10; break;
+            case 3: time += 100000 + jitter(rng); break;
+            case 4: time += 100000 + 5000000 * (i % 4); break;   // Gaps beyond every class
+            default: time += 1; break;
+        }
+        double value;
+        switch (i % 5) {
+            case 0: value = samples.empty() ? 1.0 : samples.back().value; break;
+            case 1: value = static_cast<double>(i % 40); break;
+            case 2: value = noise(rng); break;
+            case 3: value = specials[i % 6]; break;
+            default: value = 42.5 + (i % 3) * 0.25; break;
+        }
+        samples.push_back({static_cast<double>(time) / 1e6, value});
+    }
+    return samples;
+}
+
+void checkSamples(const std::vector<Sample>& expected, const std::vector<Sample>& actual,
+                  const std::string& what) {
+    check(actual.size() == expected.size(), what + ": decoded " + std::to_string(actual.size()) +
+          " of " + std::to_string(expected.size()) + " samples");
+    size_t n = std::min(actual.size(), expected.size());
+    for (size_t i = 0; i < n; ++i) {
+        if (micros(actual[i].time) != micros(expected[i].time) ||
+            !sameBits(actual[i].value, expected[i].value)) {
+            check(false, what + ": sample " + std::to_string(i) + " differs");
+            return;
+        }
+    }
+}
+
+void checkBlock() {
+    std::vector<Sample> samples = makeSamples(5000);
+    GorillaBlock block;
+    for (const auto& s : samples) {
+        block.append(s.time, s.value);
+    }
+    check(block.size() == samples.size(), "block sample count");
+
+    std::vector<Sample> decoded;
+    block.decode(decoded, -1.0, 1e12);
+    checkSamples(samples, decoded, "block round trip");
+
+    // A window decodes exactly the samples inside it
+    double from = samples[1000].time;
+    double to = samples[1999].time;
+    std::vector<Sample> window;
+    block.decode(window, from, to);
+    std::vector<Sample> expected;
+    for (const auto& s : samples) {
+        if (s.time >= from && s.time <= to) {
+            expected.push_back(s);
+        }
+    }
+    checkSamples(expected, window, "block window");
+}
+
+void checkStore() {
+    TimeSeriesConfig config;
+    config.rawCapacity = 64;
+    config.blockSamples = 100;
+    config.coldBudgetBytes = 1 << 30;
+    TimeSeriesStore store(config);
+    SeriesId id = store.series("pit_entries");
+
+    std::vector<Sample> samples = makeSamples(3000);
+    for (const auto& s : samples) {
+        check(store.append(id, s.time, s.value), "append in time order");
+    }
+    check(!store.append(id, samples.front().time, 1.0), "append older than the newest sample is rejected");
+
+    std::vector<Sample> out;
+    store.range(id, -1.0, 1e12, out);
+    checkSamples(samples, out, "store range across cold blocks and ring");
+
+    Sample latest;
+    check(store.latest(id, latest) && sameBits(latest.value, samples.back().value), "latest sample");
+
+    // Whole-second rollups agree with the raw samples they cover
+    TimeSeriesStore smooth;
+    SeriesId sid = smooth.series("latency");
+    double sum = 0.0;
+    for (int i = 0; i < 100; ++i) {
+        double value = 10.0 + i % 7;
+        smooth.append(sid, i * 0.25, value);
+        sum += value;
+    }
+    std::vector<Rollup> rollups;
+    smooth.rollups(sid, Resolution::SECOND, 0.0, 1e9, rollups);
+    Rollup total;
+    for (const auto& r : rollups) {
+        total.merge(r);
+        check(r.count == 4, "4 samples per 1 s bucket");
+    }
+    check(total.count == 100 && std::fabs(total.sum - sum) < 1e-9, "rollup sum");
+    check(total.min == 10.0 && total.max == 16.0, "rollup min/max");
+}
+
+} // anonymous namespace
+
+int main() {
+    checkBlock();
+    checkStore();
+    if (failures > 0) {
+        std::cerr << "❌ timeseries_check: " << failures << " failure(s)" << std::endl;
+        return 1;
+    }
+    std::cout << "✅ timeseries_check passed" << std::endl;
+    return 0;
+}